@@ -152,12 +152,14 @@
 
 #include "SimTKcommon/internal/MatrixHelper.h"
 #include "SimTKcommon/internal/MatrixCharacteristics.h"
+#include "SimTKcommon/internal/ThreadingPolicy.h"
 
 #include <iostream>
 #include <cassert>
 #include <complex>
 #include <cstddef>
 #include <limits>
+#include <type_traits>
 
 namespace SimTK {
     template <class ELT>    class MatrixBase;
@@ -284,13 +286,24 @@ MatrixBase<ELT>::updRow(int i) {
     return RowVectorView_<ELT>(h.stealRep()); 
 }
 
+// The row and column scaling kernels below, and the Matrix products further
+// down, compute each result element independently so they split their outer
+// loop into chunks that may run on separate threads as permitted by the
+// ThreadingPolicy. When there is only one chunk the loop body is called
+// directly to avoid any overhead for small matrices.
+
 // M = diag(v) * M; v must have nrow() elements.
 // That is, M[i] *= v[i].
 template <class ELT> template <class EE> inline MatrixBase<ELT>& 
 MatrixBase<ELT>::rowScaleInPlace(const VectorBase<EE>& v) {
     assert(v.nrow() == nrow());
-    for (int i=0; i < nrow(); ++i)
-        (*this)[i] *= v[i];
+    auto scaleRows = [&](int, int begin, int end) {
+        for (int i=begin; i < end; ++i)
+            (*this)[i] *= v[i];
+    };
+    const int nChunks = ThreadingPolicy::calcNumChunks(nrow(), ncol());
+    if (nChunks == 1) scaleRows(0, 0, nrow());
+    else ThreadingPolicy::executeChunks(nrow(), nChunks, scaleRows);
     return *this;
 }
 
@@ -298,9 +311,14 @@ template <class ELT> template <class EE> inline void
 MatrixBase<ELT>::rowScale(const VectorBase<EE>& v, typename MatrixBase<ELT>::template EltResult<EE>::Mul& out) const {
     assert(v.nrow() == nrow());
     out.resize(nrow(), ncol());
-    for (int j=0; j<ncol(); ++j)
-        for (int i=0; i<nrow(); ++i)
-           out(i,j) = (*this)(i,j) * v[i];
+    auto scaleCols = [&](int, int begin, int end) {
+        for (int j=begin; j<end; ++j)
+            for (int i=0; i<nrow(); ++i)
+               out(i,j) = (*this)(i,j) * v[i];
+    };
+    const int nChunks = ThreadingPolicy::calcNumChunks(ncol(), nrow());
+    if (nChunks == 1) scaleCols(0, 0, ncol());
+    else ThreadingPolicy::executeChunks(ncol(), nChunks, scaleCols);
 }
 
 // M = M * diag(v); v must have ncol() elements
@@ -308,8 +326,13 @@ MatrixBase<ELT>::rowScale(const VectorBase<EE>& v, typename MatrixBase<ELT>::tem
 template <class ELT> template <class EE>  inline MatrixBase<ELT>& 
 MatrixBase<ELT>::colScaleInPlace(const VectorBase<EE>& v) {
     assert(v.nrow() == ncol());
-    for (int j=0; j < ncol(); ++j)
-        (*this)(j) *= v[j];
+    auto scaleCols = [&](int, int begin, int end) {
+        for (int j=begin; j < end; ++j)
+            (*this)(j) *= v[j];
+    };
+    const int nChunks = ThreadingPolicy::calcNumChunks(ncol(), nrow());
+    if (nChunks == 1) scaleCols(0, 0, ncol());
+    else ThreadingPolicy::executeChunks(ncol(), nChunks, scaleCols);
     return *this;
 }
 
@@ -317,9 +340,14 @@ template <class ELT> template <class EE> inline void
 MatrixBase<ELT>::colScale(const VectorBase<EE>& v, typename MatrixBase<ELT>::template EltResult<EE>::Mul& out) const {
     assert(v.nrow() == ncol());
     out.resize(nrow(), ncol());
-    for (int j=0; j<ncol(); ++j)
-        for (int i=0; i<nrow(); ++i)
-           out(i,j) = (*this)(i,j) * v[j];
+    auto scaleCols = [&](int, int begin, int end) {
+        for (int j=begin; j<end; ++j)
+            for (int i=0; i<nrow(); ++i)
+               out(i,j) = (*this)(i,j) * v[j];
+    };
+    const int nChunks = ThreadingPolicy::calcNumChunks(ncol(), nrow());
+    if (nChunks == 1) scaleCols(0, 0, ncol());
+    else ThreadingPolicy::executeChunks(ncol(), nChunks, scaleCols);
 }
 
 
@@ -943,8 +971,13 @@ Vector_<typename CNT<E1>::template Result<E2>::Mul>
 operator*(const MatrixBase<E1>& m, const VectorBase<E2>& v) {
     assert(m.ncol() == v.nrow());
     Vector_<typename CNT<E1>::template Result<E2>::Mul> res(m.nrow());
-    for (int i=0; i< m.nrow(); ++i)
-        res[i] = m[i]*v;
+    auto multiplyRows = [&](int, int begin, int end) {
+        for (int i=begin; i < end; ++i)
+            res[i] = m[i]*v;
+    };
+    const int nChunks = ThreadingPolicy::calcNumChunks(m.nrow(), m.ncol());
+    if (nChunks == 1) multiplyRows(0, 0, m.nrow());
+    else ThreadingPolicy::executeChunks(m.nrow(), nChunks, multiplyRows);
     return res;
 }
 
@@ -955,9 +988,17 @@ operator*(const MatrixBase<E1>& m1, const MatrixBase<E2>& m2) {
     Matrix_<typename CNT<E1>::template Result<E2>::Mul> 
         res(m1.nrow(),m2.ncol());
 
-    for (int j=0; j < res.ncol(); ++j)
-        for (int i=0; i < res.nrow(); ++i)
-            res(i,j) = m1[i] * m2(j);
+    auto multiplyCols = [&](int, int begin, int end) {
+        for (int j=begin; j < end; ++j) {
+            const VectorView_<E2> m2j = m2(j);
+            for (int i=0; i < res.nrow(); ++i)
+                res(i,j) = m1[i] * m2j;
+        }
+    };
+    const int nChunks = ThreadingPolicy::calcNumChunks
+       (res.ncol(), double(m1.nrow())*m1.ncol());
+    if (nChunks == 1) multiplyCols(0, 0, res.ncol());
+    else ThreadingPolicy::executeChunks(res.ncol(), nChunks, multiplyCols);
 
     return res;
 }
@@ -155,6 +155,122 @@ public:
     template <class EE> VectorBase& operator-=(const VectorBase<EE>& b) 
       { Base::operator-=(b); return *this; } 
 
+    //  ------------------------------------------------------------------------
+    /// @name       VectorBase fused linear combinations
+    ///
+    /// An operator expression like <tt>y0 + h*f0</tt> allocates a new Vector
+    /// for every intermediate result and makes a separate pass over memory for
+    /// each operator. The methods here compute the common BLAS-1 combinations
+    /// of scaled vectors in a single loop and without any heap allocation;
+    /// use them in inner loops such as integrator stages. Elements are
+    /// combined one index at a time so it is fine for this Vector to be one
+    /// of the operands. When all the operands are densely packed, the loop
+    /// runs directly over the underlying scalars so that the compiler can
+    /// vectorize it. The terms are summed left to right, so
+    /// <tt>setToLinearCombination(a,x, b,y, c,z)</tt> gives exactly the same
+    /// result as <tt>a*x + b*y + c*z</tt>. That is not true of a regrouped
+    /// expression like <tt>a*(x+y)</tt>, which rounds differently.
+    /// @{
+
+    /** Add a scaled Vector to this one in place: this += s*x. This is the
+    BLAS \c axpy operation. **/
+    VectorBase& addScaledInPlace(const StdNumber& s, const VectorBase& x) {
+        const int n = size();
+        SimTK_ERRCHK2_ALWAYS(x.size()==n, "VectorBase::addScaledInPlace()",
+            "Operand has length %d but this Vector has length %d.",
+            x.size(), n);
+        if (isPackedLike(x)) {
+            StdNumber* p = updPackedData(); const StdNumber* px = x.getPackedData();
+            const ptrdiff_t ns = Base::getContiguousScalarDataLength();
+            for (ptrdiff_t k=0; k < ns; ++k) p[k] += s*px[k];
+        } else {
+            for (int i=0; i < n; ++i) (*this)[i] += s*x[i];
+        }
+        return *this;
+    }
+
+    /** Set this Vector to a*x + b*y. If this is a resizable Vector it is
+    resized to match the operands if necessary. Use <tt>a=1</tt> for the
+    <tt>x + b*y</tt> form, and <tt>y=*this</tt> for the BLAS \c axpby
+    operation. **/
+    VectorBase& setToLinearCombination
+       (const StdNumber& a, const VectorBase& x,
+        const StdNumber& b, const VectorBase& y) {
+        const int n = x.size();
+        SimTK_ERRCHK2_ALWAYS(y.size()==n,
+            "VectorBase::setToLinearCombination()",
+            "Operands have lengths %d and %d; they must match.", n, y.size());
+        if (size() != n) resize(n);
+        if (isPackedLike(x) && isPackedLike(y)) {
+            StdNumber* p = updPackedData();
+            const StdNumber* px = x.getPackedData();
+            const StdNumber* py = y.getPackedData();
+            const ptrdiff_t ns = Base::getContiguousScalarDataLength();
+            for (ptrdiff_t k=0; k < ns; ++k) p[k] = a*px[k] + b*py[k];
+        } else {
+            for (int i=0; i < n; ++i) (*this)[i] = a*x[i] + b*y[i];
+        }
+        return *this;
+    }
+
+    /** Set this Vector to a*x + b*y + c*z; see the two-term version for
+    details. **/
+    VectorBase& setToLinearCombination
+       (const StdNumber& a, const VectorBase& x,
+        const StdNumber& b, const VectorBase& y,
+        const StdNumber& c, const VectorBase& z) {
+        const int n = x.size();
+        SimTK_ERRCHK3_ALWAYS(y.size()==n && z.size()==n,
+            "VectorBase::setToLinearCombination()",
+            "Operands have lengths %d, %d, and %d; they must match.",
+            n, y.size(), z.size());
+        if (size() != n) resize(n);
+        if (isPackedLike(x) && isPackedLike(y) && isPackedLike(z)) {
+            StdNumber* p = updPackedData();
+            const StdNumber* px = x.getPackedData();
+            const StdNumber* py = y.getPackedData();
+            const StdNumber* pz = z.getPackedData();
+            const ptrdiff_t ns = Base::getContiguousScalarDataLength();
+            for (ptrdiff_t k=0; k < ns; ++k)
+                p[k] = a*px[k] + b*py[k] + c*pz[k];
+        } else {
+            for (int i=0; i < n; ++i)
+                (*this)[i] = a*x[i] + b*y[i] + c*z[i];
+        }
+        return *this;
+    }
+
+    /** Set this Vector to a*x + b*y + c*z + d*w; see the two-term version for
+    details. Longer combinations can be finished with addScaledInPlace(). **/
+    VectorBase& setToLinearCombination
+       (const StdNumber& a, const VectorBase& x,
+        const StdNumber& b, const VectorBase& y,
+        const StdNumber& c, const VectorBase& z,
+        const StdNumber& d, const VectorBase& w) {
+        const int n = x.size();
+        SimTK_ERRCHK4_ALWAYS(y.size()==n && z.size()==n && w.size()==n,
+            "VectorBase::setToLinearCombination()",
+            "Operands have lengths %d, %d, %d, and %d; they must match.",
+            n, y.size(), z.size(), w.size());
+        if (size() != n) resize(n);
+        if (isPackedLike(x) && isPackedLike(y) && isPackedLike(z)
+            && isPackedLike(w)) {
+            StdNumber* p = updPackedData();
+            const StdNumber* px = x.getPackedData();
+            const StdNumber* py = y.getPackedData();
+            const StdNumber* pz = z.getPackedData();
+            const StdNumber* pw = w.getPackedData();
+            const ptrdiff_t ns = Base::getContiguousScalarDataLength();
+            for (ptrdiff_t k=0; k < ns; ++k)
+                p[k] = a*px[k] + b*py[k] + c*pz[k] + d*pw[k];
+        } else {
+            for (int i=0; i < n; ++i)
+                (*this)[i] = a*x[i] + b*y[i] + c*z[i] + d*w[i];
+        }
+        return *this;
+    }
+    /// @}
+
 
     /// Fill current allocation with copies of element. Note that this is not the 
     /// same behavior as assignment for Matrices, where only the diagonal is set (and
@@ -187,21 +303,8 @@ public:
             return typename CNT<ScalarNormSq>::TSqrt(0);
         }
 
-        ScalarNormSq sumsq = 0;
-        if (worstOne) {
-            *worstOne = 0;
-            ScalarNormSq maxsq = 0; 
-            for (int i=0; i<n; ++i) {
-                const ScalarNormSq v2 = square((*this)[i]);
-                if (v2 > maxsq) maxsq=v2, *worstOne=i;
-                sumsq += v2;
-            }
-        } else { // don't track the worst element
-            for (int i=0; i<n; ++i) {
-                const ScalarNormSq v2 = square((*this)[i]);
-                sumsq += v2;
-            }
-        }
+        const ScalarNormSq sumsq = sumTermsAndFindLargest
+           ([&](int i) {return square((*this)[i]);}, worstOne);
 
         return CNT<ScalarNormSq>::sqrt(sumsq/n);
     }
@@ -225,21 +328,8 @@ public:
             return typename CNT<ScalarNormSq>::TSqrt(0);
         }
 
-        ScalarNormSq sumsq = 0;
-        if (worstOne) {
-            *worstOne = 0;
-            ScalarNormSq maxsq = 0; 
-            for (int i=0; i<n; ++i) {
-                const ScalarNormSq wv2 = square(w[i]*(*this)[i]);
-                if (wv2 > maxsq) maxsq=wv2, *worstOne=i;
-                sumsq += wv2;
-            }
-        } else { // don't track the worst element
-            for (int i=0; i<n; ++i) {
-                const ScalarNormSq wv2 = square(w[i]*(*this)[i]);
-                sumsq += wv2;
-            }
-        }
+        const ScalarNormSq sumsq = sumTermsAndFindLargest
+           ([&](int i) {return square(w[i]*(*this)[i]);}, worstOne);
 
         return CNT<ScalarNormSq>::sqrt(sumsq/n);
     }
@@ -467,6 +557,62 @@ protected:
     explicit VectorBase(MatrixHelperRep<Scalar>* hrep) : Base(hrep) {}
 
 private:
+    // Return the sum of term(i) for all elements i, and optionally the index
+    // of the first largest term. This is the inner loop of the RMS norms. If
+    // the ThreadingPolicy allows it, contiguous chunks are summed on separate
+    // threads and the partial sums are then added in chunk order.
+    template <class F> ScalarNormSq
+    sumTermsAndFindLargest(const F& term, int* worstOne) const {
+        const int n = nrow();
+        auto sumChunk = [&](int begin, int end, ScalarNormSq& sumsq,
+                            ScalarNormSq& maxsq, int& worst) {
+            sumsq = 0; maxsq = 0; worst = begin;
+            if (worstOne) {
+                for (int i=begin; i<end; ++i) {
+                    const ScalarNormSq t = term(i);
+                    if (t > maxsq) maxsq=t, worst=i;
+                    sumsq += t;
+                }
+            } else { // don't track the worst element
+                for (int i=begin; i<end; ++i)
+                    sumsq += term(i);
+            }
+        };
+
+        ScalarNormSq sumsq, maxsq; int worst;
+        const int nChunks = ThreadingPolicy::calcNumChunks(n, 1);
+        if (nChunks == 1)
+            sumChunk(0, n, sumsq, maxsq, worst);
+        else {
+            Array_<ScalarNormSq> sums(nChunks), maxes(nChunks);
+            Array_<int> worsts(nChunks);
+            ThreadingPolicy::executeChunks(n, nChunks,
+                [&](int c, int begin, int end)
+                {   sumChunk(begin, end, sums[c], maxes[c], worsts[c]); });
+            sumsq = sums[0]; maxsq = maxes[0]; worst = worsts[0];
+            for (int c=1; c < nChunks; ++c) {
+                sumsq += sums[c];
+                if (maxes[c] > maxsq) maxsq=maxes[c], worst=worsts[c];
+            }
+        }
+        if (worstOne) *worstOne = worst;
+        return sumsq;
+    }
+
+    // The fused linear combination loops can work directly on the scalars if
+    // the elements are built from plain (not negated or conjugated) numbers
+    // and both this Vector and the operand have densely packed storage. The
+    // operand has the same element type so the scalars correspond one-to-one.
+    bool isPackedLike(const VectorBase& x) const {
+        return std::is_same<Scalar,StdNumber>::value
+            && Base::hasContiguousData() && x.hasContiguousData();
+    }
+    const StdNumber* getPackedData() const
+    {   return reinterpret_cast<const StdNumber*>
+                                        (Base::getContiguousScalarData()); }
+    StdNumber* updPackedData()
+    {   return reinterpret_cast<StdNumber*>(Base::updContiguousScalarData()); }
+
     // NO DATA MEMBERS ALLOWED
 };
 
@@ -1443,8 +1443,19 @@ template <class P> inline Rotation_<P>
 operator*(const InverseRotation_<P>& R1, const Rotation_<P>&        R2)  
 {return Rotation_<P>(R1) *= R2;}
 template <class P> inline Rotation_<P>
-operator*(const InverseRotation_<P>& R1, const InverseRotation_<P>& R2)  
+operator*(const InverseRotation_<P>& R1, const InverseRotation_<P>& R2)
 {return Rotation_<P>(R1) *= R2;}
+
+#if defined(SimTK_SIMD_SSE2)
+// Double precision compositions use the vectorized 3x3 kernels from
+// SmallMatrixSIMD.h. (Rotation*Vec3 gets them automatically.)
+inline Rotation_<double>
+operator*(const Rotation_<double>&        R1, const Rotation_<double>& R2)
+{return Rotation_<double>(R1.asMat33() * R2.asMat33(), true);}
+inline Rotation_<double>
+operator*(const InverseRotation_<double>& R1, const Rotation_<double>& R2)
+{return Rotation_<double>(R1.asMat33() * R2.asMat33(), true);}
+#endif
 //@}
 
 /// Composition of a Rotation matrix and the inverse of another Rotation via operator/, that is
@@ -0,0 +1,362 @@
+#ifndef SimTK_SIMMATRIX_BATCHED_CHOLESKY_H_
+#define SimTK_SIMMATRIX_BATCHED_CHOLESKY_H_
+
+/* -------------------------------------------------------------------------- *
+ *                       Simbody(tm): SimTKcommon                             *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2018 Stanford University and the Authors.           *
+ * Authors: Simbody developers                                                *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+/**@file
+This file defines BatchedCholesky, which factors and solves many independent
+small symmetric positive definite systems of the same size at once, with the
+SIMD lanes running across the systems rather than within one of them. **/
+
+#include "SimTKcommon/basics.h"
+#include "SimTKcommon/SmallMatrix.h"
+
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <vector>
+
+namespace SimTK {
+
+// Hide from Doxygen.
+/** @cond **/
+namespace Impl {
+inline namespace SimTK_SIMD_NAMESPACE {
+
+/* A pack holds one double from each of Width consecutive systems. The
+batched kernels are written once in terms of these operations; ScalarPack
+runs them on a single system. Loads and stores are unaligned. */
+struct ScalarPack {
+    static const int Width = 1;
+    double v;
+    static ScalarPack load(const double* p) {return {*p};}
+    static ScalarPack broadcast(double s) {return {s};}
+    void store(double* p) const {*p = v;}
+    friend ScalarPack operator-(ScalarPack a, ScalarPack b) {return {a.v-b.v};}
+    friend ScalarPack operator*(ScalarPack a, ScalarPack b) {return {a.v*b.v};}
+    friend ScalarPack operator/(ScalarPack a, ScalarPack b) {return {a.v/b.v};}
+    friend ScalarPack sqrt(ScalarPack a) {return {std::sqrt(a.v)};}
+};
+
+#if defined(SimTK_SIMD_AVX)
+struct DoublePack {
+    static const int Width = 4;
+    __m256d v;
+    static DoublePack load(const double* p) {return {_mm256_loadu_pd(p)};}
+    static DoublePack broadcast(double s) {return {_mm256_set1_pd(s)};}
+    void store(double* p) const {_mm256_storeu_pd(p, v);}
+    friend DoublePack operator-(DoublePack a, DoublePack b)
+    {   return {_mm256_sub_pd(a.v, b.v)}; }
+    friend DoublePack operator*(DoublePack a, DoublePack b)
+    {   return {_mm256_mul_pd(a.v, b.v)}; }
+    friend DoublePack operator/(DoublePack a, DoublePack b)
+    {   return {_mm256_div_pd(a.v, b.v)}; }
+    friend DoublePack sqrt(DoublePack a) {return {_mm256_sqrt_pd(a.v)};}
+};
+#elif defined(SimTK_SIMD_SSE2)
+struct DoublePack {
+    static const int Width = 2;
+    __m128d v;
+    static DoublePack load(const double* p) {return {_mm_loadu_pd(p)};}
+    static DoublePack broadcast(double s) {return {_mm_set1_pd(s)};}
+    void store(double* p) const {_mm_storeu_pd(p, v);}
+    friend DoublePack operator-(DoublePack a, DoublePack b)
+    {   return {_mm_sub_pd(a.v, b.v)}; }
+    friend DoublePack operator*(DoublePack a, DoublePack b)
+    {   return {_mm_mul_pd(a.v, b.v)}; }
+    friend DoublePack operator/(DoublePack a, DoublePack b)
+    {   return {_mm_div_pd(a.v, b.v)}; }
+    friend DoublePack sqrt(DoublePack a) {return {_mm_sqrt_pd(a.v)};}
+};
+#else
+typedef ScalarPack DoublePack;
+#endif
+
+// Index of element (i,j), i >= j, of a packed lower triangle stored by rows.
+inline constexpr int lowerIndex(int i, int j) {return i*(i+1)/2 + j;}
+
+/* Factor Pack::Width N x N systems in place. Element (i,j) of the lower
+triangle of the system in lane 0 is at a[lowerIndex(i,j)*stride]. On return
+the strict lower triangle holds L's elements and the diagonal holds the
+reciprocals of L's diagonal; a lane whose matrix was not positive definite
+gets a nonpositive, infinite or NaN reciprocal. The other lanes are not
+affected. */
+template <int N, class Pack>
+inline void choleskyFactorPack(double* a, int stride) {
+    Pack L[N*(N+1)/2];
+    for (int e=0; e < N*(N+1)/2; ++e)
+        L[e] = Pack::load(a + e*stride);
+    const Pack one = Pack::broadcast(1);
+    for (int j=0; j < N; ++j) {
+        Pack d = L[lowerIndex(j,j)];
+        for (int k=0; k < j; ++k)
+            d = d - L[lowerIndex(j,k)]*L[lowerIndex(j,k)];
+        const Pack r = one/sqrt(d);
+        L[lowerIndex(j,j)] = r;
+        for (int i=j+1; i < N; ++i) {
+            Pack s = L[lowerIndex(i,j)];
+            for (int k=0; k < j; ++k)
+                s = s - L[lowerIndex(i,k)]*L[lowerIndex(j,k)];
+            L[lowerIndex(i,j)] = s*r;
+        }
+    }
+    for (int e=0; e < N*(N+1)/2; ++e)
+        L[e].store(a + e*stride);
+}
+
+/* Overwrite the right hand sides b (element i of lane 0 at b[i*bstride])
+with the solutions of L*~L*x = b, using factors from choleskyFactorPack(). */
+template <int N, class Pack>
+inline void choleskySolvePack(const double* a, int stride,
+                              double* b, int bstride) {
+    Pack x[N];
+    for (int i=0; i < N; ++i) {
+        Pack s = Pack::load(b + i*bstride);
+        for (int k=0; k < i; ++k)
+            s = s - Pack::load(a + lowerIndex(i,k)*stride)*x[k];
+        x[i] = s*Pack::load(a + lowerIndex(i,i)*stride);
+    }
+    for (int i=N-1; i >= 0; --i) {
+        Pack s = x[i];
+        for (int k=i+1; k < N; ++k)
+            s = s - Pack::load(a + lowerIndex(k,i)*stride)*x[k];
+        x[i] = s*Pack::load(a + lowerIndex(i,i)*stride);
+    }
+    for (int i=0; i < N; ++i)
+        x[i].store(b + i*bstride);
+}
+
+} // inline namespace SimTK_SIMD_NAMESPACE
+} // namespace Impl
+/** @endcond **/
+
+// The class is in the same instruction set specific namespace as the
+// kernels it calls; see SmallMatrixSIMD.h.
+inline namespace SimTK_SIMD_NAMESPACE {
+
+/** This class factors and solves a batch of independent N x N symmetric
+positive definite systems, 1 <= N <= 6, such as the D = ~H*P*H matrices of
+all the mobilizers of one kind at a level of a multibody tree, or the 3x3
+blocks of a set of contacts. Doing them one at a time with SymMat::invert()
+or a Mat solve leaves most of each SIMD register idle because the matrices
+are so small; here the matrices are stored "structure of arrays" (element
+(i,j) of every system is contiguous) and each SIMD instruction works on the
+same element of several systems. The instruction set is the one chosen in
+SmallMatrixSIMD.h; with SimTK_NO_SIMD the same code runs one system at a
+time. The batch pays off from N=3 up (see tests/adhoc/BatchedCholeskyTiming);
+for 1x1 and 2x2 systems the closed form Mat::invert() is faster.
+
+Only double precision is supported. You can fill the matrices in with
+setMatrix(), or write the lower triangle elements directly into the arrays
+returned by updLowerData(), which is the fastest way when the elements are
+computed in a loop over the systems. Then call factor() and solve as many
+right hand sides as you like. Systems whose matrices turn out not to be
+positive definite are flagged (see isPositiveDefinite()) without disturbing
+the others; their solutions are meaningless.
+
+@code
+    BatchedCholesky<3> chol(numContacts);
+    for (int k=0; k < numContacts; ++k) chol.setMatrix(k, A[k]);
+    if (chol.factor() != 0) { ... some were singular ... }
+    chol.solve(&b[0], &x[0]); // x[k] = A[k]^-1 * b[k]
+@endcode **/
+template <int N>
+class BatchedCholesky {
+    static_assert(1 <= N && N <= 6,
+                  "BatchedCholesky supports systems of size 1 to 6.");
+    typedef Impl::DoublePack Pack;
+    static const int NumElements = N*(N+1)/2;
+public:
+    /** The number of systems is rounded up to a multiple of this to get
+    the length of each structure of arrays row. It is the same for every
+    instruction set so storage can be shared between them. **/
+    static const int Padding = 4;
+
+    /** Create an empty batch; use resize() to give it systems. **/
+    BatchedCholesky() : numSystems(0), stride(0), factored(false) {}
+    /** Create a batch of \a numSystems systems whose matrices are all
+    initially the identity. **/
+    explicit BatchedCholesky(int numSystems) : BatchedCholesky()
+    {   resize(numSystems); }
+
+    /** Change the number of systems. All matrices are reset to the identity
+    and the batch is no longer factored. Memory is reused when the batch
+    doesn't grow. **/
+    void resize(int n) {
+        SimTK_APIARGCHECK1_ALWAYS(n >= 0, "BatchedCholesky", "resize",
+            "The number of systems must be nonnegative but was %d.", n);
+        numSystems = n;
+        stride = (n + Padding-1)/Padding*Padding;
+        data.assign(NumElements*stride, 0.);
+        for (int i=0; i < N; ++i)
+            std::fill_n(updLowerData(i,i), stride, 1.);
+        factored = false;
+    }
+
+    /** Return the number of systems in the batch. **/
+    int getNumSystems() const {return numSystems;}
+    /** Return the length of each structure of arrays row, which is
+    getNumSystems() rounded up to a multiple of Padding. **/
+    int getStride() const {return stride;}
+
+    /** Return the array holding element (i,j) of the lower triangle (i >= j)
+    of every system; element k belongs to system k. The entries past
+    getNumSystems() are padding and must be left alone. Writing to this
+    invalidates the factorization. **/
+    double* updLowerData(int i, int j) {
+        assert(0 <= j && j <= i && i < N);
+        factored = false;
+        return &data[Impl::lowerIndex(i,j)*stride];
+    }
+
+    /** Set the matrix of system \a k. **/
+    void setMatrix(int k, const SymMat<N,double>& A) {
+        checkIndex(k, "setMatrix");
+        factored = false;
+        for (int i=0; i < N; ++i)
+            for (int j=0; j <= i; ++j)
+                data[Impl::lowerIndex(i,j)*stride + k] = A(i,j);
+    }
+    /** Set the matrix of system \a k from the lower triangle of \a A; the
+    upper triangle is not looked at. **/
+    void setMatrix(int k, const Mat<N,N,double>& A) {
+        checkIndex(k, "setMatrix");
+        factored = false;
+        for (int i=0; i < N; ++i)
+            for (int j=0; j <= i; ++j)
+                data[Impl::lowerIndex(i,j)*stride + k] = A(i,j);
+    }
+
+    /** Factor all the systems. Returns the number of them that were not
+    positive definite (to working precision), so 0 means all is well. **/
+    int factor() {
+        for (int k=0; k < stride; k += Pack::Width)
+            Impl::choleskyFactorPack<N,Pack>(&data[k], stride);
+        // A system failed if any of its reciprocal pivots is not a positive
+        // finite number.
+        isPD.assign(numSystems, 1);
+        for (int i=0; i < N; ++i) {
+            const double* r = &data[Impl::lowerIndex(i,i)*stride];
+            for (int k=0; k < numSystems; ++k)
+                isPD[k] &= (r[k] > 0 && r[k] < Infinity);
+        }
+        int numFailed = 0;
+        for (int k=0; k < numSystems; ++k)
+            numFailed += !isPD[k];
+        factored = true;
+        return numFailed;
+    }
+
+    /** Return true if factor() has been called since the matrices were
+    last changed. **/
+    bool isFactored() const {return factored;}
+
+    /** After factor(), return true if the matrix of system \a k was
+    positive definite. **/
+    bool isPositiveDefinite(int k) const {
+        checkFactored("isPositiveDefinite");
+        checkIndex(k, "isPositiveDefinite");
+        return isPD[k] != 0;
+    }
+
+    /** Solve all the systems in place. \a b holds N rows of getStride()
+    elements; on input element k of row i is b[i] for system k, and on
+    return it is x[i]. The padding elements are overwritten. **/
+    void solveInPlace(double* b) const {
+        checkFactored("solveInPlace");
+        for (int k=0; k < stride; k += Pack::Width)
+            Impl::choleskySolvePack<N,Pack>(&data[k], stride, b+k, stride);
+    }
+
+    /** Solve all the systems, with b[k] the right hand side for system k
+    and the result going to x[k]. \a b and \a x must each have
+    getNumSystems() elements; they may be the same array. **/
+    void solve(const Vec<N,double>* b, Vec<N,double>* x) const {
+        checkFactored("solve");
+        const int W = Pack::Width;
+        double buf[N*W];
+        int k0 = 0;
+        for (; k0+W <= numSystems; k0 += W) {
+            for (int l=0; l < W; ++l)
+                for (int i=0; i < N; ++i)
+                    buf[i*W + l] = b[k0+l][i];
+            Impl::choleskySolvePack<N,Pack>(&data[k0], stride, buf, W);
+            for (int l=0; l < W; ++l)
+                for (int i=0; i < N; ++i)
+                    x[k0+l][i] = buf[i*W + l];
+        }
+        for (; k0 < numSystems; ++k0) {
+            x[k0] = b[k0];
+            Impl::choleskySolvePack<N,Impl::ScalarPack>
+               (&data[k0], stride, &x[k0][0], 1);
+        }
+    }
+
+    /** Solve system \a k alone. **/
+    void solve(int k, const Vec<N,double>& b, Vec<N,double>& x) const {
+        checkFactored("solve");
+        checkIndex(k, "solve");
+        x = b;
+        Impl::choleskySolvePack<N,Impl::ScalarPack>(&data[k], stride, &x[0], 1);
+    }
+
+    /** Return the inverse of the matrix of system \a k. **/
+    SymMat<N,double> getInverse(int k) const {
+        checkFactored("getInverse");
+        checkIndex(k, "getInverse");
+        SymMat<N,double> AInv;
+        for (int j=0; j < N; ++j) {
+            Vec<N,double> e(0.); e[j] = 1;
+            Impl::choleskySolvePack<N,Impl::ScalarPack>
+               (&data[k], stride, &e[0], 1);
+            for (int i=j; i < N; ++i)
+                AInv(i,j) = e[i];
+        }
+        return AInv;
+    }
+
+private:
+    void checkIndex(int k, const char* methodName) const {
+        SimTK_INDEXCHECK_ALWAYS(k, numSystems,
+            (std::string("BatchedCholesky::") + methodName).c_str());
+    }
+    void checkFactored(const char* methodName) const {
+        SimTK_APIARGCHECK_ALWAYS(isFactored(), "BatchedCholesky", methodName,
+            "The batch must be factored first.");
+    }
+
+    int                 numSystems;
+    int                 stride;
+    // Lower triangle elements by rows; element e of system k is at
+    // data[e*stride + k]. After factor() the diagonal holds reciprocals.
+    std::vector<double> data;
+    std::vector<char>   isPD;
+    bool                factored;
+};
+
+} // inline namespace SimTK_SIMD_NAMESPACE
+
+} // namespace SimTK
+
+#endif // SimTK_SIMMATRIX_BATCHED_CHOLESKY_H_
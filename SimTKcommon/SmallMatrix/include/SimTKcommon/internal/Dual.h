@@ -0,0 +1,504 @@
+#ifndef SimTK_SIMMATRIX_DUAL_H_
+#define SimTK_SIMMATRIX_DUAL_H_
+
+/* -------------------------------------------------------------------------- *
+ *                       Simbody(tm): SimTKcommon                             *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2018 Stanford University and the Authors.           *
+ * Authors: Simbody developers                                                *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+/**@file
+This file defines Dual, a real scalar that carries its derivatives with
+respect to a fixed number of independent variables along with its value, and
+the NTraits and CNT specializations that let it be used as the element type
+of the small matrix classes. **/
+
+#include "SimTKcommon/internal/common.h"
+#include "SimTKcommon/Scalar.h"
+#include "SimTKcommon/internal/Vec.h"
+#include "SimTKcommon/internal/Row.h"
+#include "SimTKcommon/internal/Mat.h"
+
+#include <cmath>
+#include <iostream>
+
+namespace SimTK {
+
+/** A dual number for forward mode automatic differentiation: a value of
+precision P (float or double) together with its partial derivatives with
+respect to N independent variables. Arithmetic and the elementary functions
+propagate the derivatives by the chain rule, so code written as a template on
+its scalar type produces exact derivatives, at a cost of about N+1 times one
+evaluation, when instantiated on Dual. There is no step size to choose.
+
+To differentiate a function of n variables, make each argument a variable
+with its own direction and evaluate the function once:
+@code
+    template <class T> T f(const Vec<3,T>& y) {return y.norm()*sin(y[0]);}
+
+    Vec<3,Dual<3>> y;
+    for (int i=0; i < 3; ++i) y[i] = Dual<3>::variable(y0[i], i);
+    const Dual<3> fy = f(y);
+    // fy.getValue() is f(y0); fy.getDeriv() is the gradient df/dy at y0.
+@endcode
+With more variables than fit in one Dual, evaluate in several passes of N
+directions each.
+
+The elementary functions (sqrt, exp, log, sin, atan2, pow and so on) are
+found by argument-dependent lookup, so templated code should call them
+unqualified after a using-declaration for the std:: version:
+@code
+    using std::sin; x = sin(x);   // works for double and for Dual
+@endcode
+Calls written as std::sin(x) do not accept a Dual.
+
+Dual is a scalar to the small matrix classes, so Vec, Row, Mat and SymMat
+work with Dual elements, including mixed operations with Real scalars and
+Real matrices. Header-only code templated on the precision, such as the
+inline members of Rotation_ that take cosines and sines, can be instantiated
+too. Members that are compiled into the library only for float and double,
+and the large Matrix_ and Vector_ classes, are not available.
+
+All the comparison operators look at the value only, as a branch in the
+differentiated function would. **/
+template <int N, class P=Real>
+class Dual {
+    static_assert(N >= 1, "Dual<N,P> needs at least one derivative.");
+public:
+    typedef Vec<N,P> Deriv;
+
+    /** Default construction leaves the value and derivatives uninitialized
+    in Release builds and NaN in Debug builds, as for a double. **/
+    Dual() {
+    #ifndef NDEBUG
+        v = NTraits<P>::getNaN();
+    #endif
+    }
+    /** A constant: its derivatives are zero. This is an implicit conversion,
+    so a Real can be used wherever a Dual is expected. **/
+    Dual(const P& value) : v(value), d(P(0)) {}
+    /** Set the value and all the derivatives. **/
+    Dual(const P& value, const Deriv& deriv) : v(value), d(deriv) {}
+
+    /** Return an independent variable with the given value, whose derivative
+    is 1 in direction \a i and 0 in the others. **/
+    static Dual variable(const P& value, int i) {
+        assert(0 <= i && i < N);
+        Dual x(value);
+        x.d[i] = P(1);
+        return x;
+    }
+
+    const P& getValue() const {return v;}
+    P&       updValue()       {return v;}
+    /** Return all N partial derivatives. **/
+    const Deriv& getDeriv() const {return d;}
+    Deriv&       updDeriv()       {return d;}
+    /** Return the partial derivative in direction \a i. **/
+    const P& getDeriv(int i) const {return d[i];}
+    P&       updDeriv(int i)       {return d[i];}
+
+    Dual operator+() const {return *this;}
+    Dual operator-() const {return Dual(-v, -d);}
+
+    Dual& operator+=(const Dual& r) {v += r.v; d += r.d; return *this;}
+    Dual& operator-=(const Dual& r) {v -= r.v; d -= r.d; return *this;}
+    Dual& operator*=(const Dual& r) {d = r.v*d + v*r.d; v *= r.v; return *this;}
+    Dual& operator/=(const Dual& r) {
+        const P inv = 1/r.v;
+        v *= inv;
+        d = (d - v*r.d)*inv;
+        return *this;
+    }
+    Dual& operator+=(const P& r) {v += r; return *this;}
+    Dual& operator-=(const P& r) {v -= r; return *this;}
+    Dual& operator*=(const P& r) {v *= r; d *= r; return *this;}
+    Dual& operator/=(const P& r) {const P inv = 1/r; v *= inv; d *= inv; return *this;}
+
+    // The binary operators and elementary functions are defined as friends
+    // so that they are found only by argument-dependent lookup. Ordinary
+    // unqualified calls like sin(x) on a double in namespace SimTK still find
+    // the C library functions.
+
+    friend Dual operator+(const Dual& l, const Dual& r) {return Dual(l.v+r.v, l.d+r.d);}
+    friend Dual operator+(const Dual& l, const P& r)    {return Dual(l.v+r, l.d);}
+    friend Dual operator+(const P& l, const Dual& r)    {return Dual(l+r.v, r.d);}
+    friend Dual operator-(const Dual& l, const Dual& r) {return Dual(l.v-r.v, l.d-r.d);}
+    friend Dual operator-(const Dual& l, const P& r)    {return Dual(l.v-r, l.d);}
+    friend Dual operator-(const P& l, const Dual& r)    {return Dual(l-r.v, -r.d);}
+    friend Dual operator*(const Dual& l, const Dual& r)
+    {   return Dual(l.v*r.v, r.v*l.d + l.v*r.d); }
+    friend Dual operator*(const Dual& l, const P& r)    {return Dual(l.v*r, r*l.d);}
+    friend Dual operator*(const P& l, const Dual& r)    {return Dual(l*r.v, l*r.d);}
+    friend Dual operator/(const Dual& l, const Dual& r) {Dual q(l); return q /= r;}
+    friend Dual operator/(const Dual& l, const P& r)    {Dual q(l); return q /= r;}
+    friend Dual operator/(const P& l, const Dual& r) {
+        const P inv = 1/r.v, q = l*inv;
+        return Dual(q, (-q*inv)*r.d);
+    }
+
+    friend bool operator==(const Dual& l, const Dual& r) {return l.v == r.v;}
+    friend bool operator==(const Dual& l, const P& r)    {return l.v == r;}
+    friend bool operator==(const P& l, const Dual& r)    {return l == r.v;}
+    friend bool operator!=(const Dual& l, const Dual& r) {return l.v != r.v;}
+    friend bool operator!=(const Dual& l, const P& r)    {return l.v != r;}
+    friend bool operator!=(const P& l, const Dual& r)    {return l != r.v;}
+    friend bool operator< (const Dual& l, const Dual& r) {return l.v <  r.v;}
+    friend bool operator< (const Dual& l, const P& r)    {return l.v <  r;}
+    friend bool operator< (const P& l, const Dual& r)    {return l   <  r.v;}
+    friend bool operator> (const Dual& l, const Dual& r) {return l.v >  r.v;}
+    friend bool operator> (const Dual& l, const P& r)    {return l.v >  r;}
+    friend bool operator> (const P& l, const Dual& r)    {return l   >  r.v;}
+    friend bool operator<=(const Dual& l, const Dual& r) {return l.v <= r.v;}
+    friend bool operator<=(const Dual& l, const P& r)    {return l.v <= r;}
+    friend bool operator<=(const P& l, const Dual& r)    {return l   <= r.v;}
+    friend bool operator>=(const Dual& l, const Dual& r) {return l.v >= r.v;}
+    friend bool operator>=(const Dual& l, const P& r)    {return l.v >= r;}
+    friend bool operator>=(const P& l, const Dual& r)    {return l   >= r.v;}
+
+    // f(x) for a function f with derivative dfdx at x's value.
+    static Dual chain(const P& f, const P& dfdx, const Dual& x)
+    {   return Dual(f, dfdx*x.d); }
+
+    friend Dual abs(const Dual& x)  {return x.v < 0 ? -x : x;}
+    friend Dual fabs(const Dual& x) {return abs(x);}
+    friend Dual sqrt(const Dual& x)
+    {   const P s = std::sqrt(x.v); return chain(s, 1/(2*s), x); }
+    friend Dual cbrt(const Dual& x)
+    {   const P c = std::cbrt(x.v); return chain(c, 1/(3*c*c), x); }
+    friend Dual exp(const Dual& x)
+    {   const P e = std::exp(x.v); return chain(e, e, x); }
+    friend Dual log(const Dual& x) {return chain(std::log(x.v), 1/x.v, x);}
+    friend Dual log10(const Dual& x)
+    {   return chain(std::log10(x.v), 1/(x.v*NTraits<P>::getLn10()), x); }
+    friend Dual sin(const Dual& x) {return chain(std::sin(x.v), std::cos(x.v), x);}
+    friend Dual cos(const Dual& x) {return chain(std::cos(x.v), -std::sin(x.v), x);}
+    friend Dual tan(const Dual& x)
+    {   const P t = std::tan(x.v); return chain(t, 1+t*t, x); }
+    friend Dual asin(const Dual& x)
+    {   return chain(std::asin(x.v), 1/std::sqrt(1-x.v*x.v), x); }
+    friend Dual acos(const Dual& x)
+    {   return chain(std::acos(x.v), -1/std::sqrt(1-x.v*x.v), x); }
+    friend Dual atan(const Dual& x)
+    {   return chain(std::atan(x.v), 1/(1+x.v*x.v), x); }
+    friend Dual sinh(const Dual& x) {return chain(std::sinh(x.v), std::cosh(x.v), x);}
+    friend Dual cosh(const Dual& x) {return chain(std::cosh(x.v), std::sinh(x.v), x);}
+    friend Dual tanh(const Dual& x)
+    {   const P t = std::tanh(x.v); return chain(t, 1-t*t, x); }
+
+    friend Dual atan2(const Dual& y, const Dual& x) {
+        const P inv = 1/(x.v*x.v + y.v*y.v);
+        return Dual(std::atan2(y.v, x.v), (x.v*inv)*y.d - (y.v*inv)*x.d);
+    }
+    friend Dual pow(const Dual& x, const P& a)
+    {   return chain(std::pow(x.v, a), a*std::pow(x.v, a-1), x); }
+    friend Dual pow(const P& a, const Dual& x) {
+        const P p = std::pow(a, x.v);
+        return chain(p, p*std::log(a), x);
+    }
+    // The log(x) term is left out when the exponent is constant, so that a
+    // negative base with a constant exponent still has a derivative.
+    friend Dual pow(const Dual& x, const Dual& y) {
+        const P p = std::pow(x.v, y.v);
+        Dual result(p, (y.v*std::pow(x.v, y.v-1))*x.d);
+        if (y.d != P(0))
+            result.d += (p*std::log(x.v))*y.d;
+        return result;
+    }
+
+    friend Dual square(const Dual& x) {return Dual(x.v*x.v, (2*x.v)*x.d);}
+    friend Dual cube(const Dual& x)
+    {   const P x2 = x.v*x.v; return Dual(x2*x.v, (3*x2)*x.d); }
+    friend int  sign(const Dual& x) {return x.v > 0 ? 1 : (x.v < 0 ? -1 : 0);}
+
+private:
+    P       v;
+    Deriv   d;
+};
+
+/** @addtogroup isNaN **/
+//@{
+/** A Dual is NaN if its value or any of its derivatives is. **/
+template <int N, class P> inline bool
+isNaN(const Dual<N,P>& x) {return isNaN(x.getValue()) || x.getDeriv().isNaN();}
+//@}
+/** @addtogroup isFinite **/
+//@{
+/** A Dual is finite if its value and all its derivatives are. **/
+template <int N, class P> inline bool
+isFinite(const Dual<N,P>& x)
+{   return isFinite(x.getValue()) && x.getDeriv().isFinite(); }
+//@}
+/** @addtogroup isInf **/
+//@{
+/** A Dual is infinite if it is not NaN and its value or a derivative is
+infinite. **/
+template <int N, class P> inline bool
+isInf(const Dual<N,P>& x) {return !isNaN(x) && !isFinite(x);}
+//@}
+
+/** @addtogroup isNumericallyEqual **/
+//@{
+/** Two Duals are numerically equal if their values and each of their
+derivatives are. **/
+template <int N, class P, class Q> inline bool
+isNumericallyEqual(const Dual<N,P>& a, const Dual<N,Q>& b,
+    double tol = RTraits<typename Narrowest<P,Q>::Precision>::getDefaultTolerance())
+{   if (!isNumericallyEqual(a.getValue(), b.getValue(), tol)) return false;
+    for (int i=0; i < N; ++i)
+        if (!isNumericallyEqual(a.getDeriv(i), b.getDeriv(i), tol)) return false;
+    return true; }
+/** A Dual is numerically equal to a constant if its value is and its
+derivatives are zero. **/
+template <int N, class P> inline bool
+isNumericallyEqual(const Dual<N,P>& a, const double& b,
+    double tol = RTraits<P>::getDefaultTolerance())
+{   return isNumericallyEqual(a, Dual<N,double>(b), tol); }
+template <int N, class P> inline bool
+isNumericallyEqual(const double& a, const Dual<N,P>& b,
+    double tol = RTraits<P>::getDefaultTolerance())
+{   return isNumericallyEqual(b, a, tol); }
+template <int N, class P> inline bool
+isNumericallyEqual(const Dual<N,P>& a, const float& b,
+    double tol = RTraits<float>::getDefaultTolerance())
+{   return isNumericallyEqual(a, (double)b, tol); }
+template <int N, class P> inline bool
+isNumericallyEqual(const float& a, const Dual<N,P>& b,
+    double tol = RTraits<float>::getDefaultTolerance())
+{   return isNumericallyEqual(b, (double)a, tol); }
+template <int N, class P> inline bool
+isNumericallyEqual(const Dual<N,P>& a, int b,
+    double tol = RTraits<P>::getDefaultTolerance())
+{   return isNumericallyEqual(a, (double)b, tol); }
+template <int N, class P> inline bool
+isNumericallyEqual(int a, const Dual<N,P>& b,
+    double tol = RTraits<P>::getDefaultTolerance())
+{   return isNumericallyEqual(b, (double)a, tol); }
+//@}
+
+/** Write a Dual as its value followed by its derivatives in brackets, like
+1.5[0,1,0]. **/
+template <int N, class P> inline std::ostream&
+operator<<(std::ostream& o, const Dual<N,P>& x) {
+    o << x.getValue() << '[';
+    for (int i=0; i < N; ++i) o << (i ? "," : "") << x.getDeriv(i);
+    return o << ']';
+}
+
+// Hide from Doxygen.
+/** @cond **/
+namespace Impl {
+// Result types for Dual op P2. A Dual combined with a real number of either
+// precision or another Dual is a Dual; for composite P2 the composite type
+// decides, as for the other scalars.
+template <class D, class P2> struct DualResult {
+    typedef typename CNT<P2>::template Result<D>::Mul Mul;
+    typedef typename CNT<typename CNT<P2>::THerm>::template Result<D>::Mul Dvd;
+    typedef typename CNT<P2>::template Result<D>::Add Add;
+    typedef typename CNT<typename CNT<P2>::TNeg>::template Result<D>::Add Sub;
+};
+template <class D> struct DualResult<D,D>
+{   typedef D Mul; typedef D Dvd; typedef D Add; typedef D Sub; };
+template <class D> struct DualResult<D,float>
+{   typedef D Mul; typedef D Dvd; typedef D Add; typedef D Sub; };
+template <class D> struct DualResult<D,double>
+{   typedef D Mul; typedef D Dvd; typedef D Add; typedef D Sub; };
+}
+/** @endcond **/
+
+/** NTraits for a Dual make it behave like a real number whose precision is
+that of its value. **/
+template <int N, class P> class NTraits< Dual<N,P> > {
+public:
+    typedef Dual<N,P>        T;
+    typedef negator<T>       TNeg;
+    typedef T                TWithoutNegator;
+    typedef T                TReal;
+    typedef T                TImag;
+    typedef T                TComplex;
+    typedef T                THerm;
+    typedef T                TPosTrans;
+    typedef T                TSqHermT;
+    typedef T                TSqTHerm;
+    typedef T                TElement;
+    typedef T                TRow;
+    typedef T                TCol;
+    typedef T                TSqrt;
+    typedef T                TAbs;
+    typedef T                TStandard;
+    typedef T                TInvert;
+    typedef T                TNormalize;
+    typedef T                Scalar;
+    typedef T                ULessScalar;
+    typedef T                Number;
+    typedef T                StdNumber;
+    typedef P                Precision;
+    typedef T                ScalarNormSq;
+
+    template <class P2> struct Result : Impl::DualResult<T,P2> {};
+
+    // Shape-preserving element substitution (easy for scalars!)
+    template <class P2> struct Substitute {
+        typedef P2 Type;
+    };
+
+    enum {
+        NRows               = 1,
+        NCols               = 1,
+        RowSpacing          = 1,
+        ColSpacing          = 1,
+        NPackedElements     = 1,
+        NActualElements     = 1,
+        NActualScalars      = 1,
+        ImagOffset          = 0,
+        RealStrideFactor    = 1,
+        ArgDepth            = SCALAR_DEPTH,
+        IsScalar            = 1,
+        IsULessScalar       = 1,
+        IsNumber            = 1,
+        IsStdNumber         = 1,
+        IsPrecision         = 0,
+        SignInterpretation  = 1
+    };
+
+    static const T* getData(const T& t) {return &t;}
+    static T*       updData(T& t)       {return &t;}
+    static const T& real(const T& t) {return t;}
+    static T&       real(T& t)       {return t;}
+    static const T& imag(const T&)   {return getZero();}
+    static T&       imag(T&)         {assert(false); return *reinterpret_cast<T*>(0);}
+
+    static const TNeg& negate(const T& t) {return reinterpret_cast<const TNeg&>(t);}
+    static       TNeg& negate(T& t)       {return reinterpret_cast<TNeg&>(t);}
+    static const THerm& transpose(const T& t) {return t;}
+    static       THerm& transpose(T& t)       {return t;}
+    static const TPosTrans& positionalTranspose(const T& t) {return t;}
+    static       TPosTrans& positionalTranspose(T& t)       {return t;}
+    static const TWithoutNegator& castAwayNegatorIfAny(const T& t) {return t;}
+    static       TWithoutNegator& updCastAwayNegatorIfAny(T& t)    {return t;}
+
+    static ScalarNormSq scalarNormSqr(const T& t) {return square(t);}
+    static TSqrt        sqrt(const T& t) {return sqrtOf(t);}
+    static TAbs         abs(const T& t) {return t.getValue() < 0 ? -t : t;}
+    static const TStandard& standardize(const T& t) {return t;}
+    static TNormalize normalize(const T& t)
+    {   return TNormalize(NTraits<P>::normalize(t.getValue())); }
+    static TInvert invert(const T& t) {return P(1)/t;}
+
+    static const T& getEps()         {static const T c(NTraits<P>::getEps());         return c;}
+    static const T& getSignificant() {static const T c(NTraits<P>::getSignificant()); return c;}
+    static const T& getNaN()         {static const T c(NTraits<P>::getNaN(),
+                                                       Vec<N,P>(NTraits<P>::getNaN())); return c;}
+    static const T& getInfinity()    {static const T c(NTraits<P>::getInfinity());    return c;}
+
+    static bool isFinite(const T& t) {return SimTK::isFinite(t);}
+    static bool isNaN   (const T& t) {return SimTK::isNaN(t);}
+    static bool isInf   (const T& t) {return SimTK::isInf(t);}
+
+    static double getDefaultTolerance() {return RTraits<P>::getDefaultTolerance();}
+    template <class P2> static bool isNumericallyEqual(const T& a, const P2& b)
+    {   return SimTK::isNumericallyEqual(a,b); }
+    template <class P2> static bool isNumericallyEqual(const T& a, const P2& b, double tol)
+    {   return SimTK::isNumericallyEqual(a,b,tol); }
+
+    // Constants, with zero derivatives.
+    static const T& getZero()         {static const T c(NTraits<P>::getZero());         return c;}
+    static const T& getOne()          {static const T c(NTraits<P>::getOne());          return c;}
+    static const T& getMinusOne()     {static const T c(NTraits<P>::getMinusOne());     return c;}
+    static const T& getTwo()          {static const T c(NTraits<P>::getTwo());          return c;}
+    static const T& getThree()        {static const T c(NTraits<P>::getThree());        return c;}
+    static const T& getOneHalf()      {static const T c(NTraits<P>::getOneHalf());      return c;}
+    static const T& getOneThird()     {static const T c(NTraits<P>::getOneThird());     return c;}
+    static const T& getOneFourth()    {static const T c(NTraits<P>::getOneFourth());    return c;}
+    static const T& getOneFifth()     {static const T c(NTraits<P>::getOneFifth());     return c;}
+    static const T& getOneSixth()     {static const T c(NTraits<P>::getOneSixth());     return c;}
+    static const T& getOneSeventh()   {static const T c(NTraits<P>::getOneSeventh());   return c;}
+    static const T& getOneEighth()    {static const T c(NTraits<P>::getOneEighth());    return c;}
+    static const T& getOneNinth()     {static const T c(NTraits<P>::getOneNinth());     return c;}
+    static const T& getPi()           {static const T c(NTraits<P>::getPi());           return c;}
+    static const T& getOneOverPi()    {static const T c(NTraits<P>::getOneOverPi());    return c;}
+    static const T& getE()            {static const T c(NTraits<P>::getE());            return c;}
+    static const T& getLog2E()        {static const T c(NTraits<P>::getLog2E());        return c;}
+    static const T& getLog10E()       {static const T c(NTraits<P>::getLog10E());       return c;}
+    static const T& getSqrt2()        {static const T c(NTraits<P>::getSqrt2());        return c;}
+    static const T& getOneOverSqrt2() {static const T c(NTraits<P>::getOneOverSqrt2()); return c;}
+    static const T& getSqrt3()        {static const T c(NTraits<P>::getSqrt3());        return c;}
+    static const T& getOneOverSqrt3() {static const T c(NTraits<P>::getOneOverSqrt3()); return c;}
+    static const T& getCubeRoot2()    {static const T c(NTraits<P>::getCubeRoot2());    return c;}
+    static const T& getCubeRoot3()    {static const T c(NTraits<P>::getCubeRoot3());    return c;}
+    static const T& getLn2()          {static const T c(NTraits<P>::getLn2());          return c;}
+    static const T& getLn10()         {static const T c(NTraits<P>::getLn10());         return c;}
+private:
+    // The member sqrt() hides Dual's friend sqrt(); a using-declaration
+    // lets argument-dependent lookup find it again.
+    static T sqrtOf(const T& t) {using std::sqrt; return sqrt(t);}
+};
+
+template <int N, class P> class CNT< Dual<N,P> > : public NTraits< Dual<N,P> > { };
+
+// Real op Dual is a Dual, as Dual op Real is.
+template <int N, class P> struct NTraits<float>::Result< Dual<N,P> >
+{   typedef Dual<N,P> Mul; typedef Mul Dvd; typedef Mul Add; typedef Mul Sub; };
+template <int N, class P> struct NTraits<double>::Result< Dual<N,P> >
+{   typedef Dual<N,P> Mul; typedef Mul Dvd; typedef Mul Add; typedef Mul Sub; };
+
+// Dual scalars times or divided into small matrices with any element type.
+// These follow the pattern of the complex scalar operators in Vec.h, Row.h
+// and Mat.h.
+
+template <int M, class E, int S, int N, class P> inline
+typename Vec<M,E,S>::template Result<Dual<N,P> >::Mul
+operator*(const Vec<M,E,S>& l, const Dual<N,P>& r)
+  { return Vec<M,E,S>::template Result<Dual<N,P> >::MulOp::perform(l,r); }
+template <int M, class E, int S, int N, class P> inline
+typename Vec<M,E,S>::template Result<Dual<N,P> >::Mul
+operator*(const Dual<N,P>& l, const Vec<M,E,S>& r) {return r*l;}
+template <int M, class E, int S, int N, class P> inline
+typename Vec<M,E,S>::template Result<Dual<N,P> >::Dvd
+operator/(const Vec<M,E,S>& l, const Dual<N,P>& r)
+  { return Vec<M,E,S>::template Result<Dual<N,P> >::DvdOp::perform(l,r); }
+
+template <int M, class E, int S, int N, class P> inline
+typename Row<M,E,S>::template Result<Dual<N,P> >::Mul
+operator*(const Row<M,E,S>& l, const Dual<N,P>& r)
+  { return Row<M,E,S>::template Result<Dual<N,P> >::MulOp::perform(l,r); }
+template <int M, class E, int S, int N, class P> inline
+typename Row<M,E,S>::template Result<Dual<N,P> >::Mul
+operator*(const Dual<N,P>& l, const Row<M,E,S>& r) {return r*l;}
+template <int M, class E, int S, int N, class P> inline
+typename Row<M,E,S>::template Result<Dual<N,P> >::Dvd
+operator/(const Row<M,E,S>& l, const Dual<N,P>& r)
+  { return Row<M,E,S>::template Result<Dual<N,P> >::DvdOp::perform(l,r); }
+
+template <int M, int MN, class E, int CS, int RS, int N, class P> inline
+typename Mat<M,MN,E,CS,RS>::template Result<Dual<N,P> >::Mul
+operator*(const Mat<M,MN,E,CS,RS>& l, const Dual<N,P>& r)
+  { return Mat<M,MN,E,CS,RS>::template Result<Dual<N,P> >::MulOp::perform(l,r); }
+template <int M, int MN, class E, int CS, int RS, int N, class P> inline
+typename Mat<M,MN,E,CS,RS>::template Result<Dual<N,P> >::Mul
+operator*(const Dual<N,P>& l, const Mat<M,MN,E,CS,RS>& r) {return r*l;}
+template <int M, int MN, class E, int CS, int RS, int N, class P> inline
+typename Mat<M,MN,E,CS,RS>::template Result<Dual<N,P> >::Dvd
+operator/(const Mat<M,MN,E,CS,RS>& l, const Dual<N,P>& r)
+  { return Mat<M,MN,E,CS,RS>::template Result<Dual<N,P> >::DvdOp::perform(l,r); }
+
+} // namespace SimTK
+
+#endif // SimTK_SIMMATRIX_DUAL_H_
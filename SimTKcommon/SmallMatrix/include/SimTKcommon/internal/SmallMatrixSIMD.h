@@ -0,0 +1,320 @@
+#ifndef SimTK_SIMMATRIX_SMALLMATRIX_SIMD_H_
+#define SimTK_SIMMATRIX_SMALLMATRIX_SIMD_H_
+
+/* -------------------------------------------------------------------------- *
+ *                       Simbody(tm): SimTKcommon                             *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2018 Stanford University and the Authors.           *
+ * Authors: Simbody developers                                                *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+/**@file
+This file contains explicitly vectorized kernels for the handful of 3x3 and
+3-vector operations that dominate multibody computations: 3x3 matrix times
+3-vector (and its transpose), symmetric 3x3 times 3-vector, 3x3 matrix
+products and outer products. Non-template overloads of the ordinary
+Mat/Vec/SymMat operators for packed double-precision arguments are defined
+here so that Rotation and Transform operations, and anything else that
+multiplies these types, pick up the vectorized code automatically through
+normal overload resolution.
+
+The spatial operations are not given kernels of their own. Spatial inertia
+and articulated inertia products and the articulated inertia projection are
+made of the 3x3 products above and get their vectorization from them. Fused
+6-vector kernels for ArticulatedInertia*SpatialVec, and SSE2 versions of the
+spatial vector shifts, measured no faster than the generic code with SSE2 or
+AVX2, and the shifts and ArticulatedInertia::shift() are dominated by cross
+products whose lane shuffles cost more than they save. (See the
+SmallMatrixSIMDTiming adhoc program.)
+
+The instruction set is chosen at compile time from the flags the compiler was
+given (see the BUILD_INST_SET CMake variable); we use AVX/AVX2 if enabled,
+otherwise SSE2, which is always available on x64. If Simbody was built with
+the BUILD_SIMD_KERNELS CMake variable off, SmallMatrixSIMDConfig.h (which is
+generated and installed with the headers) defines SimTK_NO_SIMD; you can also
+define it yourself. Either way these overloads are suppressed and the generic
+templatized code is used everywhere.
+
+Because the kernels are inline, translation units compiled with different
+instruction set flags (or with and without SimTK_NO_SIMD) would otherwise
+contain different definitions of the same functions. To keep that legal, the
+kernels and the operator overloads live in an inline namespace whose name
+identifies the instruction set, so each variant is a distinct entity.
+
+The kernels perform the same operations in the same order as the generic code
+so results agree to roundoff (they are bitwise identical unless the compiler
+chooses to contract multiply-adds differently in the two implementations). **/
+
+#include "SimTKcommon/internal/common.h"
+#include "SimTKcommon/internal/SmallMatrixSIMDConfig.h"
+
+#if !defined(SimTK_NO_SIMD)
+    #if defined(__SSE2__) || defined(_M_X64) \
+        || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+        #define SimTK_SIMD_SSE2 1
+    #endif
+    #if defined(SimTK_SIMD_SSE2) && defined(__AVX__)
+        #define SimTK_SIMD_AVX 1
+    #endif
+    #if defined(SimTK_SIMD_AVX) && defined(__AVX2__)
+        #define SimTK_SIMD_AVX2 1
+    #endif
+#endif
+
+#if defined(SimTK_SIMD_AVX2)
+    #define SimTK_SIMD_NAMESPACE SIMD_AVX2
+#elif defined(SimTK_SIMD_AVX)
+    #define SimTK_SIMD_NAMESPACE SIMD_AVX
+#elif defined(SimTK_SIMD_SSE2)
+    #define SimTK_SIMD_NAMESPACE SIMD_SSE2
+#else
+    #define SimTK_SIMD_NAMESPACE SIMD_None
+#endif
+
+#if defined(SimTK_SIMD_AVX)
+    #include <immintrin.h>
+#elif defined(SimTK_SIMD_SSE2)
+    #include <emmintrin.h>
+#endif
+
+namespace SimTK {
+
+// Hide from Doxygen.
+/** @cond **/
+namespace Impl {
+inline namespace SimTK_SIMD_NAMESPACE {
+
+/* These are the raw kernels. Matrices are packed 3x3 in column order (the
+storage used by Mat33 and Rotation); symmetric matrices are given as separate
+pointers to their diagonal d=(d0,d1,d2) and lower triangle l=(l10,l20,l21),
+matching SymMat33 storage. All inputs are read before any output is written
+so the result may overlap an input vector (but see mat33TimesMat33()). */
+
+// Name of the instruction set the kernels were compiled for.
+inline const char* getSmallMatrixSIMDName() {
+#if defined(SimTK_SIMD_AVX2)
+    return "AVX2";
+#elif defined(SimTK_SIMD_AVX)
+    return "AVX";
+#elif defined(SimTK_SIMD_SSE2)
+    return "SSE2";
+#else
+    return "none";
+#endif
+}
+
+#if defined(SimTK_SIMD_AVX)
+// Load and store a 3-vector in the low three lanes of an AVX register. We
+// avoid the masked load and store instructions here; they are slow and they
+// defeat store-to-load forwarding when the result is used immediately.
+inline __m256d load3(const double* p) {
+    return _mm256_insertf128_pd(_mm256_castpd128_pd256(_mm_loadu_pd(p)),
+                                _mm_load_sd(p+2), 1);
+}
+inline void store3(double* p, __m256d x) {
+    _mm_storeu_pd(p, _mm256_castpd256_pd128(x));
+    _mm_store_sd(p+2, _mm256_extractf128_pd(x, 1));
+}
+#endif
+
+// r = m*v. 15 flops.
+inline void mat33TimesVec3(const double* m, const double* v, double* r) {
+#if defined(SimTK_SIMD_AVX)
+    __m256d acc = _mm256_mul_pd(_mm256_loadu_pd(m), _mm256_broadcast_sd(v));
+    acc = _mm256_add_pd(acc, _mm256_mul_pd(_mm256_loadu_pd(m+3),
+                                           _mm256_broadcast_sd(v+1)));
+    acc = _mm256_add_pd(acc, _mm256_mul_pd(load3(m+6),
+                                           _mm256_broadcast_sd(v+2)));
+    store3(r, acc);
+#elif defined(SimTK_SIMD_SSE2)
+    const __m128d v0 = _mm_set1_pd(v[0]), v1 = _mm_set1_pd(v[1]),
+                  v2 = _mm_set1_pd(v[2]);
+    __m128d acc = _mm_mul_pd(_mm_loadu_pd(m), v0);
+    acc = _mm_add_pd(acc, _mm_mul_pd(_mm_loadu_pd(m+3), v1));
+    acc = _mm_add_pd(acc, _mm_mul_pd(_mm_loadu_pd(m+6), v2));
+    const double r2 = m[2]*v[0] + m[5]*v[1] + m[8]*v[2];
+    _mm_storeu_pd(r, acc); r[2] = r2;
+#else
+    const double r0 = m[0]*v[0] + m[3]*v[1] + m[6]*v[2];
+    const double r1 = m[1]*v[0] + m[4]*v[1] + m[7]*v[2];
+    const double r2 = m[2]*v[0] + m[5]*v[1] + m[8]*v[2];
+    r[0] = r0; r[1] = r1; r[2] = r2;
+#endif
+}
+
+// r = ~m*v, that is, r[j] = dot(m(j),v). 15 flops.
+inline void mat33TransposeTimesVec3(const double* m, const double* v,
+                                    double* r) {
+#if defined(SimTK_SIMD_SSE2)
+    // Pair up columns 0 and 1 so that two dot products proceed together.
+    const __m128d c0 = _mm_loadh_pd(_mm_load_sd(m+0), m+3);
+    const __m128d c1 = _mm_loadh_pd(_mm_load_sd(m+1), m+4);
+    const __m128d c2 = _mm_loadh_pd(_mm_load_sd(m+2), m+5);
+    __m128d acc = _mm_mul_pd(c0, _mm_set1_pd(v[0]));
+    acc = _mm_add_pd(acc, _mm_mul_pd(c1, _mm_set1_pd(v[1])));
+    acc = _mm_add_pd(acc, _mm_mul_pd(c2, _mm_set1_pd(v[2])));
+    const double r2 = m[6]*v[0] + m[7]*v[1] + m[8]*v[2];
+    _mm_storeu_pd(r, acc); r[2] = r2;
+#else
+    const double r0 = m[0]*v[0] + m[1]*v[1] + m[2]*v[2];
+    const double r1 = m[3]*v[0] + m[4]*v[1] + m[5]*v[2];
+    const double r2 = m[6]*v[0] + m[7]*v[1] + m[8]*v[2];
+    r[0] = r0; r[1] = r1; r[2] = r2;
+#endif
+}
+
+// r = s*v where s is symmetric with diagonal d and lower triangle l.
+// 15 flops.
+inline void symMat33TimesVec3(const double* d, const double* l,
+                              const double* v, double* r) {
+#if defined(SimTK_SIMD_SSE2)
+    // Rows 0 and 1; the columns of that 2x3 block are (d0,l10), (l10,d1),
+    // and (l20,l21).
+    const __m128d c0 = _mm_loadh_pd(_mm_load_sd(d+0), l+0);
+    const __m128d c1 = _mm_loadh_pd(_mm_load_sd(l+0), d+1);
+    const __m128d c2 = _mm_loadu_pd(l+1);
+    __m128d acc = _mm_mul_pd(c0, _mm_set1_pd(v[0]));
+    acc = _mm_add_pd(acc, _mm_mul_pd(c1, _mm_set1_pd(v[1])));
+    acc = _mm_add_pd(acc, _mm_mul_pd(c2, _mm_set1_pd(v[2])));
+    const double r2 = l[1]*v[0] + l[2]*v[1] + d[2]*v[2];
+    _mm_storeu_pd(r, acc); r[2] = r2;
+#else
+    const double r0 = d[0]*v[0] + l[0]*v[1] + l[1]*v[2];
+    const double r1 = l[0]*v[0] + d[1]*v[1] + l[2]*v[2];
+    const double r2 = l[1]*v[0] + l[2]*v[1] + d[2]*v[2];
+    r[0] = r0; r[1] = r1; r[2] = r2;
+#endif
+}
+
+// r = a*b, all packed 3x3 column order. r must not overlap a. 45 flops.
+inline void mat33TimesMat33(const double* a, const double* b, double* r) {
+#if defined(SimTK_SIMD_AVX)
+    // Keep the columns of a in registers and produce all three result
+    // columns before storing any of them.
+    const __m256d a0 = _mm256_loadu_pd(a), a1 = _mm256_loadu_pd(a+3),
+                  a2 = load3(a+6);
+    __m256d rc[3];
+    for (int j=0; j < 3; ++j) {
+        const double* bj = b + 3*j;
+        __m256d acc = _mm256_mul_pd(a0, _mm256_broadcast_sd(bj));
+        acc = _mm256_add_pd(acc, _mm256_mul_pd(a1, _mm256_broadcast_sd(bj+1)));
+        acc = _mm256_add_pd(acc, _mm256_mul_pd(a2, _mm256_broadcast_sd(bj+2)));
+        rc[j] = acc;
+    }
+    // The fourth lane of the first two stores is overwritten by the next one.
+    _mm256_storeu_pd(r, rc[0]);
+    _mm256_storeu_pd(r+3, rc[1]);
+    store3(r+6, rc[2]);
+#else
+    double t[9];
+    mat33TimesVec3(a, b,   t);
+    mat33TimesVec3(a, b+3, t+3);
+    mat33TimesVec3(a, b+6, t+6);
+    for (int i=0; i < 9; ++i) r[i] = t[i];
+#endif
+}
+
+// r = ~a*b. r must not overlap a. 45 flops.
+inline void mat33TransposeTimesMat33(const double* a, const double* b,
+                                     double* r) {
+    double t[9];
+    mat33TransposeTimesVec3(a, b,   t);
+    mat33TransposeTimesVec3(a, b+3, t+3);
+    mat33TransposeTimesVec3(a, b+6, t+6);
+    for (int i=0; i < 9; ++i) r[i] = t[i];
+}
+
+// r = v*~w (outer product); column j of r is v*w[j]. 9 flops.
+inline void outerVec3(const double* v, const double* w, double* r) {
+#if defined(SimTK_SIMD_SSE2)
+    const __m128d v01 = _mm_loadu_pd(v); const double v2 = v[2];
+    const double w0 = w[0], w1 = w[1], w2 = w[2];
+    _mm_storeu_pd(r,   _mm_mul_pd(v01, _mm_set1_pd(w0))); r[2] = v2*w0;
+    _mm_storeu_pd(r+3, _mm_mul_pd(v01, _mm_set1_pd(w1))); r[5] = v2*w1;
+    _mm_storeu_pd(r+6, _mm_mul_pd(v01, _mm_set1_pd(w2))); r[8] = v2*w2;
+#else
+    const double v0=v[0], v1=v[1], v2=v[2], w0=w[0], w1=w[1], w2=w[2];
+    r[0]=v0*w0; r[1]=v1*w0; r[2]=v2*w0;
+    r[3]=v0*w1; r[4]=v1*w1; r[5]=v2*w1;
+    r[6]=v0*w2; r[7]=v1*w2; r[8]=v2*w2;
+#endif
+}
+
+} // inline namespace SimTK_SIMD_NAMESPACE
+} // namespace Impl
+/** @endcond **/
+
+#if defined(SimTK_SIMD_SSE2)
+inline namespace SimTK_SIMD_NAMESPACE {
+
+// These overloads are exact matches for packed double-precision arguments so
+// they are preferred over the templatized operators in SmallMatrixMixed.h,
+// including for classes derived from Mat33 like Rotation.
+
+/** Vectorized 3x3 matrix times 3-vector. **/
+inline Vec<3,double> operator*(const Mat<3,3,double>& m,
+                               const Vec<3,double>&   v) {
+    Vec<3,double> r; Impl::mat33TimesVec3(&m(0,0), &v[0], &r[0]);
+    return r;
+}
+
+/** Vectorized transposed 3x3 matrix times 3-vector; this is the type of
+~Mat33 and of an InverseRotation. **/
+inline Vec<3,double> operator*(const Mat<3,3,double,1,3>& m,
+                               const Vec<3,double>&       v) {
+    Vec<3,double> r; Impl::mat33TransposeTimesVec3(&m(0,0), &v[0], &r[0]);
+    return r;
+}
+
+/** Vectorized symmetric 3x3 matrix times 3-vector. **/
+inline Vec<3,double> operator*(const SymMat<3,double>& s,
+                               const Vec<3,double>&    v) {
+    Vec<3,double> r;
+    Impl::symMat33TimesVec3(&s.getDiag()[0], &s.getLower()[0], &v[0], &r[0]);
+    return r;
+}
+
+/** Vectorized 3x3 matrix product. **/
+inline Mat<3,3,double> operator*(const Mat<3,3,double>& a,
+                                 const Mat<3,3,double>& b) {
+    Mat<3,3,double> r; Impl::mat33TimesMat33(&a(0,0), &b(0,0), &r(0,0));
+    return r;
+}
+
+/** Vectorized transposed 3x3 matrix times 3x3 matrix. **/
+inline Mat<3,3,double> operator*(const Mat<3,3,double,1,3>& a,
+                                 const Mat<3,3,double>&     b) {
+    Mat<3,3,double> r;
+    Impl::mat33TransposeTimesMat33(&a(0,0), &b(0,0), &r(0,0));
+    return r;
+}
+
+/** Vectorized outer product of 3-vectors. **/
+inline Mat<3,3,double> operator*(const Vec<3,double>& v,
+                                 const Row<3,double>& w) {
+    Mat<3,3,double> r; Impl::outerVec3(&v[0], &w[0], &r(0,0));
+    return r;
+}
+
+} // inline namespace SimTK_SIMD_NAMESPACE
+#endif // SimTK_SIMD_SSE2
+
+} //namespace SimTK
+
+#endif //SimTK_SIMMATRIX_SMALLMATRIX_SIMD_H_
@@ -33,6 +33,8 @@
 
 #if defined(__cplusplus)
 #include "SimTKcommon/Simmatrix.h"
+#include "SimTKcommon/internal/BatchedCholesky.h"
+#include "SimTKcommon/internal/Dual.h"
 #include "SimTKcommon/internal/State.h"
 #include "SimTKcommon/internal/Measure.h"
 #include "SimTKcommon/internal/MeasureImplementation.h"
@@ -51,6 +53,7 @@
 #include "SimTKcommon/internal/EventHandler.h"
 #include "SimTKcommon/internal/EventReporter.h"
 #include "SimTKcommon/internal/ParallelExecutor.h"
+#include "SimTKcommon/internal/ThreadingPolicy.h"
 #include "SimTKcommon/internal/Parallel2DExecutor.h"
 #include "SimTKcommon/internal/ParallelWorkQueue.h"
 #include "SimTKcommon/internal/Pathname.h"
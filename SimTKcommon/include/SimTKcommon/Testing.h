@@ -26,6 +26,7 @@
 
 #include "SimTKcommon/basics.h"
 #include "SimTKcommon/Simmatrix.h"
+#include "SimTKcommon/internal/Dual.h"
 #include "SimTKcommon/internal/Random.h"
 #include "SimTKcommon/internal/Timing.h"
 
@@ -278,6 +279,11 @@ public:
     static bool numericallyEqual(const conjugate<P>& v1, const negator<std::complex<P> >& v2, int n, double tol=defTol<P>()) {
         return numericallyEqual(-v1, -v2, n, tol); // conjugate, complex
     }
+    template <int N, class P1, class P2>
+    static bool numericallyEqual(const Dual<N,P1>& v1, const Dual<N,P2>& v2, int n, double tol=(defTol2<P1,P2>())) {
+        return numericallyEqual(v1.getValue(), v2.getValue(), n, tol)
+            && numericallyEqual(v1.getDeriv(), v2.getDeriv(), n, tol);
+    }
     template <int M, class E1, int S1, class E2, int S2>
     static bool numericallyEqual(const Vec<M,E1,S1>& v1, const Vec<M,E2,S2>& v2, int n, double tol=(defTol2<E1,E2>())) {
         for (int i=0; i<M; ++i) if (!numericallyEqual(v1[i],v2[i], n, tol)) return false;
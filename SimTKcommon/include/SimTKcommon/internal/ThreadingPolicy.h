@@ -0,0 +1,96 @@
+#ifndef SimTK_SimTKCOMMON_THREADING_POLICY_H_
+#define SimTK_SimTKCOMMON_THREADING_POLICY_H_
+
+/* -------------------------------------------------------------------------- *
+ *                       Simbody(tm): SimTKcommon                             *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2018 Stanford University and the Authors.           *
+ * Authors: Simbody developers                                                *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+#include "SimTKcommon/internal/common.h"
+
+#include <functional>
+
+namespace SimTK {
+
+/** This class holds the library-wide policy that decides whether the dense
+BigMatrix kernels in SimTKcommon (Matrix*Vector and Matrix*Matrix products,
+row and column scaling, and the RMS Vector norms) may split their work across
+multiple threads. It has only static members; the settings apply to the whole
+process.
+
+By default the kernels are single threaded, exactly as they have always been.
+Call setMaxThreads() to allow more threads; the threads come from a shared
+ParallelExecutor that is created the first time it is needed. A kernel is
+split into at most getMaxThreads() chunks, and into no more chunks than will
+give each one at least getMinWorkPerThread() units of work, where a unit is
+roughly one scalar multiply-add. That keeps small matrices, which are by far
+the most common in Simbody, on the calling thread where they are cheapest.
+
+A kernel always runs serially if it is invoked from a ParallelExecutor worker
+thread, or while another thread is already using the shared executor, so
+multithreaded user code does not oversubscribe the machine or deadlock.
+
+Kernels that compute each output element independently (the products and
+scalings) give bitwise identical results for any thread count. The norms add
+up per-chunk partial sums in chunk order, so their results are reproducible
+for a given policy but may differ in the last bits from the single threaded
+result. **/
+class SimTK_SimTKCOMMON_EXPORT ThreadingPolicy {
+public:
+    /** Set the maximum number of threads a single kernel may use. A value of
+    1 (the default) makes all kernels single threaded; 0 means use as many
+    threads as there are processors. **/
+    static void setMaxThreads(int numThreads);
+    /** Get the maximum number of threads a single kernel may use; this is
+    always at least 1. **/
+    static int getMaxThreads();
+
+    /** Set the smallest amount of work, in multiply-adds, that is worth
+    handing to a separate thread. The default is 50000. **/
+    static void setMinWorkPerThread(int minWork);
+    /** Get the smallest amount of work that is worth handing to a separate
+    thread. **/
+    static int getMinWorkPerThread();
+
+    /** Return the number of chunks into which a kernel operating on
+    \a numItems independent items, each costing about \a workPerItem
+    multiply-adds, should be divided under the current policy. The result is
+    1 if the work should be done serially, and is never more than
+    \a numItems. **/
+    static int calcNumChunks(int numItems, double workPerItem);
+
+    /** Divide the items 0..numItems-1 into \a numChunks contiguous ranges of
+    nearly equal size and call <tt>body(chunk, begin, end)</tt> once for each
+    chunk, with the chunks running concurrently if possible. This returns
+    only after all the chunks are done. If the shared executor is not
+    available the chunks are run serially, in order, on the calling thread.
+    The body must not throw. **/
+    static void executeChunks
+       (int numItems, int numChunks,
+        const std::function<void(int chunk, int begin, int end)>& body);
+
+private:
+    ThreadingPolicy() = delete;
+};
+
+} // namespace SimTK
+
+#endif // SimTK_SimTKCOMMON_THREADING_POLICY_H_
@@ -0,0 +1,140 @@
+/* -------------------------------------------------------------------------- *
+ *                       Simbody(tm): SimTKcommon                             *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2018 Stanford University and the Authors.           *
+ * Authors: Simbody developers                                                *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+#include "SimTKcommon/internal/ThreadingPolicy.h"
+#include "SimTKcommon/internal/ParallelExecutor.h"
+#include "SimTKcommon/internal/ExceptionMacros.h"
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <mutex>
+
+using namespace std;
+
+namespace SimTK {
+
+namespace {
+
+// The policy settings are read by every kernel invocation so they are
+// atomics rather than being protected by the mutex.
+atomic<int> maxThreads(1);
+atomic<int> minWorkPerThread(50000);
+
+// The shared executor is created lazily and replaced when the thread count
+// changes. It can only run one task at a time so whoever is using it holds
+// this mutex.
+mutex                       executorMutex;
+unique_ptr<ParallelExecutor> executor;
+
+// Adapts a chunk body to ParallelExecutor's Task interface; task index c
+// handles chunk c.
+class ChunkTask : public ParallelExecutor::Task {
+public:
+    ChunkTask(int numItems, int numChunks,
+              const function<void(int,int,int)>& body)
+    :   numItems(numItems), numChunks(numChunks), body(body) {}
+
+    void execute(int c) override {
+        body(c, chunkBegin(c), chunkBegin(c+1));
+    }
+
+    int chunkBegin(int c) const
+    {   return (int)(((long long)numItems * c) / numChunks); }
+
+private:
+    const int                           numItems, numChunks;
+    const function<void(int,int,int)>&  body;
+};
+
+}
+
+void ThreadingPolicy::setMaxThreads(int numThreads) {
+    SimTK_APIARGCHECK1_ALWAYS(numThreads >= 0, "ThreadingPolicy",
+        "setMaxThreads", "Number of threads must be nonnegative but was %d.",
+        numThreads);
+    if (numThreads == 0)
+        numThreads = std::max(1, ParallelExecutor::getNumProcessors());
+
+    lock_guard<mutex> lock(executorMutex);
+    if (numThreads != maxThreads)
+        executor.reset();
+    maxThreads = numThreads;
+}
+
+int ThreadingPolicy::getMaxThreads() {
+    return maxThreads;
+}
+
+void ThreadingPolicy::setMinWorkPerThread(int minWork) {
+    SimTK_APIARGCHECK1_ALWAYS(minWork >= 1, "ThreadingPolicy",
+        "setMinWorkPerThread", "Minimum work must be positive but was %d.",
+        minWork);
+    minWorkPerThread = minWork;
+}
+
+int ThreadingPolicy::getMinWorkPerThread() {
+    return minWorkPerThread;
+}
+
+int ThreadingPolicy::calcNumChunks(int numItems, double workPerItem) {
+    const int nt = maxThreads.load(memory_order_relaxed);
+    if (nt <= 1 || numItems <= 1 || ParallelExecutor::isWorkerThread())
+        return 1;
+    const double work = numItems * workPerItem;
+    const double byWork =
+        work / minWorkPerThread.load(memory_order_relaxed);
+    if (byWork < 2)
+        return 1;
+    return std::min(numItems, byWork < nt ? (int)byWork : nt);
+}
+
+void ThreadingPolicy::executeChunks
+   (int numItems, int numChunks, const function<void(int,int,int)>& body)
+{
+    SimTK_APIARGCHECK2_ALWAYS(1 <= numChunks && numChunks <= max(numItems,1),
+        "ThreadingPolicy", "executeChunks",
+        "Number of chunks %d must be at least 1 and no more than the number "
+        "of items %d.", numChunks, numItems);
+
+    ChunkTask task(numItems, numChunks, body);
+    if (numChunks == 1) {
+        task.execute(0);
+        return;
+    }
+
+    // If another thread is using the executor, or we are running on one of
+    // its workers, just do the work here rather than waiting.
+    unique_lock<mutex> lock(executorMutex, try_to_lock);
+    if (!lock.owns_lock() || ParallelExecutor::isWorkerThread()) {
+        for (int c=0; c < numChunks; ++c)
+            task.execute(c);
+        return;
+    }
+
+    if (!executor)
+        executor.reset(new ParallelExecutor(maxThreads));
+    executor->execute(task, numChunks);
+}
+
+} // namespace SimTK
@@ -0,0 +1,142 @@
+/* -------------------------------------------------------------------------- *
+ *                       Simbody(tm): SimTKcommon                             *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2018 Stanford University and the Authors.           *
+ * Authors: Simbody developers                                                *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+// Check BatchedCholesky against the ordinary small matrix inverse for every
+// supported size, including batches that don't fill the last SIMD pack.
+
+#include "SimTKcommon.h"
+#include "SimTKcommon/Testing.h"
+
+using namespace SimTK;
+
+static Random::Uniform uni(-1, 1);
+
+// A random symmetric positive definite matrix, not too badly conditioned.
+template <int N>
+static SymMat<N> randSPD() {
+    Mat<N,N> B;
+    for (int i=0; i < N; ++i)
+        for (int j=0; j < N; ++j) B(i,j) = uni.getValue();
+    return SymMat<N>(B*~B + 0.5*Mat<N,N>(1));
+}
+
+template <int N>
+static Vec<N> randVec() {
+    Vec<N> v;
+    for (int i=0; i < N; ++i) v[i] = uni.getValue();
+    return v;
+}
+
+template <int N>
+void testSize() {
+    for (int n : {0, 1, 3, 7, 8, 13}) {
+        Array_<SymMat<N>> A(n);
+        Array_<Vec<N>> b(n), x(n);
+        BatchedCholesky<N> chol(n);
+        SimTK_TEST(chol.getNumSystems() == n);
+        SimTK_TEST(chol.getStride() % BatchedCholesky<N>::Padding == 0);
+        SimTK_TEST(chol.getStride() >= n);
+        for (int k=0; k < n; ++k) {
+            A[k] = randSPD<N>(); b[k] = randVec<N>();
+            chol.setMatrix(k, A[k]);
+        }
+        SimTK_TEST(!chol.isFactored());
+        SimTK_TEST(chol.factor() == 0);
+        SimTK_TEST(chol.isFactored());
+
+        if (n) chol.solve(&b[0], &x[0]);
+        for (int k=0; k < n; ++k) {
+            SimTK_TEST(chol.isPositiveDefinite(k));
+            const Mat<N,N> AInv = Mat<N,N>(A[k]).invert();
+            const Mat<N,N> cholInv(chol.getInverse(k));
+            SimTK_TEST_EQ_TOL(x[k], AInv*b[k], 1e-10);
+            SimTK_TEST_EQ_TOL(cholInv, AInv, 1e-10);
+            // One system at a time gives bitwise the same answer.
+            Vec<N> xk; chol.solve(k, b[k], xk);
+            SimTK_TEST(xk == x[k]);
+        }
+
+        // The structure of arrays interface.
+        Array_<double> soa(N*chol.getStride(), 0.);
+        for (int k=0; k < n; ++k)
+            for (int i=0; i < N; ++i) soa[i*chol.getStride() + k] = b[k][i];
+        if (n) chol.solveInPlace(&soa[0]);
+        for (int k=0; k < n; ++k)
+            for (int i=0; i < N; ++i)
+                SimTK_TEST(soa[i*chol.getStride() + k] == x[k][i]);
+    }
+}
+
+// Filling the elements directly, and flagging singular systems without
+// spoiling the others.
+void testDirectAndFailures() {
+    const int n = 9;
+    BatchedCholesky<3> chol(n);
+    Array_<SymMat33> A(n);
+    for (int k=0; k < n; ++k) A[k] = randSPD<3>();
+    A[2] = SymMat33(1, 1, 1, 0, 0, 0);                // rank 1
+    A[5] = SymMat33(-1, 0, 1, 0, 0, 1);               // indefinite
+    for (int i=0; i < 3; ++i)
+        for (int j=0; j <= i; ++j) {
+            double* Aij = chol.updLowerData(i,j);
+            for (int k=0; k < n; ++k) Aij[k] = A[k](i,j);
+        }
+    SimTK_TEST(chol.factor() == 2);
+    for (int k=0; k < n; ++k) {
+        SimTK_TEST(chol.isPositiveDefinite(k) == (k != 2 && k != 5));
+        if (!chol.isPositiveDefinite(k)) continue;
+        const Vec3 b = randVec<3>();
+        Vec3 x; chol.solve(k, b, x);
+        SimTK_TEST_EQ_TOL(Mat33(A[k])*x, b, 1e-10);
+    }
+
+    // Resizing resets to identity.
+    chol.resize(5);
+    SimTK_TEST(chol.factor() == 0);
+    Vec3 x; chol.solve(4, Vec3(1,2,3), x);
+    SimTK_TEST(x == Vec3(1,2,3));
+}
+
+void testErrors() {
+    BatchedCholesky<2> chol(3);
+    Vec2 x;
+    SimTK_TEST_MUST_THROW(chol.solve(0, Vec2(1), x));
+    SimTK_TEST_MUST_THROW(chol.isPositiveDefinite(0));
+    chol.factor();
+    SimTK_TEST_MUST_THROW(chol.solve(3, Vec2(1), x));
+    SimTK_TEST_MUST_THROW(chol.setMatrix(-1, SymMat22(1,0,1)));
+    SimTK_TEST_MUST_THROW(chol.resize(-1));
+}
+
+int main() {
+    SimTK_START_TEST("TestBatchedCholesky");
+        SimTK_SUBTEST(testSize<1>);
+        SimTK_SUBTEST(testSize<2>);
+        SimTK_SUBTEST(testSize<3>);
+        SimTK_SUBTEST(testSize<4>);
+        SimTK_SUBTEST(testSize<5>);
+        SimTK_SUBTEST(testSize<6>);
+        SimTK_SUBTEST(testDirectAndFailures);
+        SimTK_SUBTEST(testErrors);
+    SimTK_END_TEST();
+}
@@ -104,6 +104,70 @@ void testTransform() {
     SimTK_TEST(~vs*R == -(-~vs*R));
 }
 
+// Check the fused linear combination methods against the equivalent operator
+// expressions, for packed storage, non-contiguous views, composite elements,
+// and with the result aliased to an operand.
+void testFusedLinearCombinations() {
+    const int n = 11;
+    Vector x(n), y(n), z(n), w(n);
+    for (int i=0; i < n; ++i) {
+        x[i] = i+1; y[i] = std::sqrt(Real(i)); z[i] = -3*i; w[i] = 1./(i+1);
+    }
+
+    Vector r(n, Real(1));
+    r.addScaledInPlace(.5, x);
+    SimTK_TEST_EQ(r, Vector(n, Real(1)) + .5*x);
+
+    Vector r2; // resized to fit
+    r2.setToLinearCombination(2, x, -.25, y);
+    SimTK_TEST_EQ(r2, 2*x - .25*y);
+    r2.setToLinearCombination(1, x, 3, y, .125, z);
+    SimTK_TEST_EQ(r2, x + 3*y + .125*z);
+    r2.setToLinearCombination(.1, x, .2, y, .3, z, .4, w);
+    SimTK_TEST_EQ(r2, .1*x + .2*y + .3*z + .4*w);
+
+    // Result is one of the operands (axpby).
+    Vector xcopy(x);
+    xcopy.setToLinearCombination(-2, xcopy, 5, w);
+    SimTK_TEST_EQ(xcopy, -2*x + 5*w);
+
+    // Wrong-size views can't be resized.
+    Vector big(n+1);
+    VectorView tooShort = big(0, n-1);
+    SimTK_TEST_MUST_THROW(tooShort.setToLinearCombination(1, x, 1, y));
+
+    // Mismatched operands are caught in Release builds too.
+    Vector ycopy(y);
+    SimTK_TEST_MUST_THROW(ycopy.addScaledInPlace(2, big));
+    SimTK_TEST_MUST_THROW(ycopy.setToLinearCombination(1, x, 1, big));
+    SimTK_TEST_MUST_THROW(ycopy.setToLinearCombination(1, x, 1, y, 1, big));
+    SimTK_TEST_MUST_THROW(
+        ycopy.setToLinearCombination(1, x, 1, y, 1, w, 1, big));
+
+    // Non-contiguous operands and result.
+    Array_<int> evens;
+    for (int i=0; i < n; i += 2) evens.push_back(i);
+    Vector xe = x(evens), ye = y(evens);
+    Vector target(n, Real(0));
+    VectorView te = target(evens);
+    te.setToLinearCombination(3, x(evens), -1, y(evens));
+    SimTK_TEST_EQ(te, 3*xe - ye);
+    te.addScaledInPlace(2, y(evens));
+    SimTK_TEST_EQ(te, 3*xe + ye);
+    SimTK_TEST(target[1] == 0);
+
+    // Composite elements.
+    Vector_<Vec3> a(4), b(4);
+    for (int i=0; i < 4; ++i) {
+        a[i] = Vec3(i, 2*i, 3*i); b[i] = Vec3(1, -i, .5);
+    }
+    Vector_<Vec3> c;
+    c.setToLinearCombination(1, a, .5, b);
+    SimTK_TEST_EQ(c, a + .5*b);
+    c.addScaledInPlace(-2, a);
+    SimTK_TEST_EQ(c, .5*b - a);
+}
+
 // Make sure we can instantiate all of these successfully.
 namespace SimTK {
 template class MatrixBase<double>;
@@ -303,6 +367,8 @@ int main() {
         SimTK_TEST(rv1.ncol() == 0);
         SimTK_TEST(rv1.nelt() == 0);
 
+        testFusedLinearCombinations();
+
     } catch(const std::exception& e) {
         cout << "exception: " << e.what() << endl;
         return 1;
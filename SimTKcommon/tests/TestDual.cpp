@@ -0,0 +1,192 @@
+/* -------------------------------------------------------------------------- *
+ *                       Simbody(tm): SimTKcommon                             *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2018 Stanford University and the Authors.           *
+ * Authors: Simbody developers                                                *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+// Check the derivatives carried by Dual against analytic ones and against
+// central differences of the same templated code evaluated on Real.
+
+#include "SimTKcommon.h"
+#include "SimTKcommon/Testing.h"
+
+using namespace SimTK;
+
+typedef Dual<1> D1;
+typedef Dual<3> D3;
+typedef Mat<3,3,D1> Mat33D1;
+typedef Mat<3,3,D3> Mat33D3;
+typedef Vec<3,D1> Vec3D1;
+typedef Vec<3,D3> Vec3D3;
+
+// Derivative of f at x by central differences, for checking.
+template <class F>
+static Real centralDiff(F f, Real x) {
+    const Real h = 1e-6;
+    return (f(x+h) - f(x-h))/(2*h);
+}
+
+void testArithmetic() {
+    const D3 x = D3::variable(2, 0), y = D3::variable(3, 1);
+    SimTK_TEST(x.getValue() == 2 && x.getDeriv() == Vec3(1,0,0));
+    const D3 c(5);
+    SimTK_TEST(c.getDeriv() == Vec3(0));
+
+    SimTK_TEST_EQ(x+y, D3(5, Vec3(1,1,0)));
+    SimTK_TEST_EQ(x-y, D3(-1, Vec3(1,-1,0)));
+    SimTK_TEST_EQ(x*y, D3(6, Vec3(3,2,0)));
+    SimTK_TEST_EQ(x/y, D3(2./3, Vec3(1./3,-2./9,0)));
+    SimTK_TEST_EQ(-x, D3(-2, Vec3(-1,0,0)));
+    SimTK_TEST_EQ(1/x, D3(0.5, Vec3(-0.25,0,0)));
+    SimTK_TEST_EQ(3*x + 1, D3(7, Vec3(3,0,0)));
+    SimTK_TEST_EQ(x - 1.5, D3(0.5, Vec3(1,0,0)));
+
+    D3 z = x;
+    z *= y; z += x; z -= 2; z /= y;     // (x*y + x - 2)/y
+    SimTK_TEST_EQ(z, (x*y + x - 2)/y);
+
+    // Comparisons use only the value.
+    SimTK_TEST(x < y && y > x && x <= 2 && 2 >= x && x == 2 && x != y);
+    SimTK_TEST(x == D3(2));
+}
+
+void testFunctions() {
+    using std::sin; using std::cos; using std::tan; using std::exp;
+    using std::log; using std::sqrt; using std::asin; using std::acos;
+    using std::atan; using std::sinh; using std::cosh; using std::tanh;
+    using std::atan2; using std::pow; using std::abs; using std::log10;
+    using std::cbrt;
+
+    // Each function of x evaluated on a Dual agrees with a central
+    // difference of the same code on a Real.
+    const Real x0 = 0.3;
+    const D1 x = D1::variable(x0, 0);
+    #define CHECK_FUNC(expr) {                                              \
+        auto f = [](Real x) {return expr;};                                 \
+        const D1 fx = [](const D1& x) {return expr;}(x);                    \
+        SimTK_TEST_EQ(fx.getValue(), f(x0));                                \
+        SimTK_TEST_EQ_TOL(fx.getDeriv(0), centralDiff(f, x0), 1e-8); }
+    CHECK_FUNC(sin(x)); CHECK_FUNC(cos(x)); CHECK_FUNC(tan(x));
+    CHECK_FUNC(exp(x)); CHECK_FUNC(log(x)); CHECK_FUNC(log10(x));
+    CHECK_FUNC(sqrt(x)); CHECK_FUNC(cbrt(x));
+    CHECK_FUNC(asin(x)); CHECK_FUNC(acos(x)); CHECK_FUNC(atan(x));
+    CHECK_FUNC(sinh(x)); CHECK_FUNC(cosh(x)); CHECK_FUNC(tanh(x));
+    CHECK_FUNC(abs(x - 1)); CHECK_FUNC(square(x)); CHECK_FUNC(cube(x));
+    CHECK_FUNC(pow(x, 2.5)); CHECK_FUNC(pow(2.5, x)); CHECK_FUNC(pow(x, x));
+    CHECK_FUNC(atan2(x, 0.7)); CHECK_FUNC(atan2(-0.7, x));
+    CHECK_FUNC(exp(sin(x))*sqrt(1 + x*x)/(2 - x));
+    #undef CHECK_FUNC
+
+    SimTK_TEST(sign(x) == 1 && sign(-x) == -1);
+    SimTK_TEST(!isNaN(x) && isFinite(x) && !isInf(x));
+    SimTK_TEST(isNaN(sqrt(D1(-1))));
+    SimTK_TEST(isInf(D1(Infinity)));
+
+    // Powers at a zero base and with a constant exponent on a negative base.
+    const D1 root0 = pow(D1::variable(0, 0), Real(0.5));
+    SimTK_TEST(root0.getValue() == 0 && isInf(root0.getDeriv(0)));
+    const D1 sq = pow(D1::variable(-2, 0), D1(2));
+    SimTK_TEST_EQ(sq.getValue(), 4);
+    SimTK_TEST_EQ(sq.getDeriv(0), -4);
+}
+
+// Some templated code of the kind a user might write.
+template <class T>
+T potential(const Vec<3,T>& p) {
+    using std::exp;
+    const Vec<3,T> c(1, 2, 3);
+    const Vec<3,T> r = p - c;
+    return dot(r, r)*exp(-p.norm()) + cross(p, c)[2];
+}
+
+void testSmallMatrices() {
+    const Vec3 p0(0.4, -0.2, 0.9);
+    Vec3D3 p;
+    for (int i=0; i < 3; ++i) p[i] = D3::variable(p0[i], i);
+    const D3 e = potential(p);
+    SimTK_TEST_EQ(e.getValue(), potential(p0));
+    for (int i=0; i < 3; ++i) {
+        auto f = [&](Real pi) {Vec3 q = p0; q[i] = pi; return potential(q);};
+        SimTK_TEST_EQ_TOL(e.getDeriv(i), centralDiff(f, p0[i]), 1e-8);
+    }
+
+    // Mixed Real and Dual operands.
+    const Mat33 A(1,2,3, 4,5,6, 7,8,10);
+    const Vec3D3 Ap = A*p;
+    for (int i=0; i < 3; ++i) {
+        SimTK_TEST_EQ(Ap[i].getValue(), (A*p0)[i]);
+        SimTK_TEST_EQ(Ap[i].getDeriv(), ~A[i]);
+    }
+    const D3 s = D3::variable(2, 0);
+    SimTK_TEST_EQ((s*p0)[1], D3(-0.4, Vec3(-0.2,0,0)));
+    SimTK_TEST_EQ((p0*s)[1], (s*p0)[1]);
+    SimTK_TEST_EQ((p/s)[2].getValue(), 0.45);
+    SimTK_TEST_EQ((~p*s)[0], p[0]*s);
+    SimTK_TEST_EQ((A*s)(2,2), 10*s);
+    SimTK_TEST_EQ((Mat33D3(A)/s)(0,1), 2/s);
+    SimTK_TEST_EQ(2*p, p + p);
+    SimTK_TEST_EQ(p - p, Vec3D3(0));
+    SimTK_TEST_EQ(-p + p, Vec3D3(0));
+
+    // d/dp |p| = p/|p|
+    const D3 n = p.norm();
+    SimTK_TEST_EQ(n.getDeriv(), p0/p0.norm());
+    const Vec3D3 u = p.normalize();
+    SimTK_TEST_EQ(u.norm().getValue(), 1);
+    SimTK_TEST_EQ(u.norm().getDeriv(), Vec3(0));
+
+    // Symmetric matrix times vector; d/dp (~p*S*p) = 2*S*p.
+    const SymMat33 S(2, 1,3, 0,1,4);
+    const D3 q = ~p*(S*p);
+    SimTK_TEST_EQ(q.getDeriv(), 2*(S*p0));
+
+    // Mat inverse.
+    Mat<2,2,D1> M(D1::variable(2,0), D1(1), D1(0), D1(3));
+    const Mat<2,2,D1> Minv = M.invert();
+    SimTK_TEST_EQ(Minv(0,0), 1/M(0,0));
+    SimTK_TEST_EQ(Minv(0,1), -1/(M(0,0)*3));
+}
+
+// Derivative of a rotated vector with respect to the rotation angle.
+void testRotation() {
+    using std::sin; using std::cos;
+    const Real a0 = 0.7;
+    const D1 a = D1::variable(a0, 0);
+    Rotation_<D1> R;
+    R.setRotationFromAngleAboutZ(cos(a), sin(a));
+    const Vec3D1 v = R*Vec3D1(1, 2, 3);
+    // d/da R_z(a)*v = [-sin -cos 0; cos -sin 0; 0 0 0]*v
+    SimTK_TEST_EQ(v[0], D1(cos(a0) - 2*sin(a0), Vec1(-sin(a0) - 2*cos(a0))));
+    SimTK_TEST_EQ(v[1], D1(sin(a0) + 2*cos(a0), Vec1(cos(a0) - 2*sin(a0))));
+    SimTK_TEST_EQ(v[2], D1(3));
+
+    // ~R*R is the identity, with zero derivatives.
+    const Mat33D1 I = (~R)*R;
+    SimTK_TEST_EQ(I, Mat33D1(1));
+}
+
+int main() {
+    SimTK_START_TEST("TestDual");
+        SimTK_SUBTEST(testArithmetic);
+        SimTK_SUBTEST(testFunctions);
+        SimTK_SUBTEST(testSmallMatrices);
+        SimTK_SUBTEST(testRotation);
+    SimTK_END_TEST();
+}
@@ -0,0 +1,142 @@
+/* -------------------------------------------------------------------------- *
+ *                       Simbody(tm): SimTKcommon                             *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2018 Stanford University and the Authors.           *
+ * Authors: Simbody developers                                                *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+#include "SimTKcommon.h"
+#include "SimTKcommon/Testing.h"
+
+#include <iostream>
+using std::cout;
+using std::endl;
+
+using namespace SimTK;
+
+// Check the vectorized small matrix kernels (see SmallMatrixSIMD.h) against
+// the same computations written out element by element. These tests pass
+// whether or not the kernels were compiled with SIMD instructions.
+
+static Random::Uniform uni(-2, 2);
+
+static Mat33 randMat33() {
+    Mat33 m;
+    for (int i=0; i<3; ++i) for (int j=0; j<3; ++j) m(i,j) = uni.getValue();
+    return m;
+}
+static Vec3 randVec3() {
+    return Vec3(uni.getValue(), uni.getValue(), uni.getValue());
+}
+static SymMat33 randSymMat33() {
+    return SymMat33(uni.getValue(),
+                    uni.getValue(), uni.getValue(),
+                    uni.getValue(), uni.getValue(), uni.getValue());
+}
+
+// Reference implementations.
+static Vec3 refMatVec(const Mat33& m, const Vec3& v) {
+    Vec3 r;
+    for (int i=0; i<3; ++i)
+        r[i] = m(i,0)*v[0] + m(i,1)*v[1] + m(i,2)*v[2];
+    return r;
+}
+static Mat33 refMatMat(const Mat33& a, const Mat33& b) {
+    Mat33 r;
+    for (int i=0; i<3; ++i) for (int j=0; j<3; ++j)
+        r(i,j) = a(i,0)*b(0,j) + a(i,1)*b(1,j) + a(i,2)*b(2,j);
+    return r;
+}
+static Mat33 refTranspose(const Mat33& m) {
+    Mat33 r;
+    for (int i=0; i<3; ++i) for (int j=0; j<3; ++j) r(i,j) = m(j,i);
+    return r;
+}
+static Vec3 refCross(const Vec3& a, const Vec3& b) {
+    return Vec3(a[1]*b[2]-a[2]*b[1], a[2]*b[0]-a[0]*b[2], a[0]*b[1]-a[1]*b[0]);
+}
+
+void testKernels() {
+    cout << "SIMD instruction set: " << Impl::getSmallMatrixSIMDName() << endl;
+    for (int trial=0; trial < 100; ++trial) {
+        const Mat33 a = randMat33(), b = randMat33();
+        const Vec3  v = randVec3(),  w = randVec3();
+        const SymMat33 s = randSymMat33();
+
+        SimTK_TEST_EQ(a*v, refMatVec(a,v));
+        SimTK_TEST_EQ(~a*v, refMatVec(refTranspose(a),v));
+        SimTK_TEST_EQ(s*v, refMatVec(Mat33(s),v));
+        SimTK_TEST_EQ(a*b, refMatMat(a,b));
+        SimTK_TEST_EQ(~a*b, refMatMat(refTranspose(a),b));
+        SimTK_TEST_EQ(v*~w, Mat33(w[0]*v, w[1]*v, w[2]*v));
+
+        // Result overlapping the input vector.
+        Vec3 x = v;
+        Impl::mat33TimesVec3(&a(0,0), &x[0], &x[0]);
+        SimTK_TEST_EQ(x, refMatVec(a,v));
+    }
+}
+
+void testMechanics() {
+    for (int trial=0; trial < 100; ++trial) {
+        const Rotation R1(uni.getValue(), randVec3()),
+                       R2(uni.getValue(), randVec3());
+        const Vec3 v = randVec3(), p1 = randVec3(), p2 = randVec3();
+        const Mat33 m1 = R1.asMat33(), m2 = R2.asMat33();
+
+        SimTK_TEST_EQ(R1*v, refMatVec(m1,v));
+        SimTK_TEST_EQ(~R1*v, refMatVec(refTranspose(m1),v));
+        SimTK_TEST_EQ((R1*R2).asMat33(), refMatMat(m1,m2));
+        SimTK_TEST_EQ((~R1*R2).asMat33(), refMatMat(refTranspose(m1),m2));
+
+        const Transform X1(R1,p1), X2(R2,p2);
+        const Transform X12 = X1*X2;
+        SimTK_TEST_EQ(X12.R().asMat33(), refMatMat(m1,m2));
+        SimTK_TEST_EQ(X12.p(), p1 + refMatVec(m1,p2));
+
+        const SpatialVec V(randVec3(), randVec3());
+        SimTK_TEST_EQ(shiftVelocityBy(V,v),
+                      SpatialVec(V[0], V[1] + refCross(V[0],v)));
+        SimTK_TEST_EQ(shiftForceBy(V,v),
+                      SpatialVec(V[0] - refCross(v,V[1]), V[1]));
+
+        // Spatial matrices use the 3x3 kernels block by block.
+        const SpatialMat M(randMat33(), randMat33(), randMat33(), randMat33());
+        const SpatialVec MV = M*V;
+        SimTK_TEST_EQ(MV[0], refMatVec(M(0,0),V[0]) + refMatVec(M(0,1),V[1]));
+        SimTK_TEST_EQ(MV[1], refMatVec(M(1,0),V[0]) + refMatVec(M(1,1),V[1]));
+
+        const SpatialInertia SI(1.5, randVec3(), UnitInertia(1,2,3,.1,.2,.3));
+        SimTK_TEST_EQ(SI*V, SI.toSpatialMat()*V);
+
+        const ArticulatedInertia P(randSymMat33(), randMat33(), randSymMat33());
+        SimTK_TEST_EQ(P*V, P.toSpatialMat()*V);
+        const PhiMatrix phi(v);
+        SimTK_TEST_EQ(P.shift(v).toSpatialMat(),
+                      phi.toSpatialMat()*P.toSpatialMat()
+                                        *phi.toSpatialMat().transpose());
+    }
+}
+
+int main() {
+    SimTK_START_TEST("TestSmallMatrixSIMD");
+        SimTK_SUBTEST(testKernels);
+        SimTK_SUBTEST(testMechanics);
+    SimTK_END_TEST();
+}
@@ -0,0 +1,167 @@
+/* -------------------------------------------------------------------------- *
+ *                       Simbody(tm): SimTKcommon                             *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2018 Stanford University and the Authors.           *
+ * Authors: Simbody developers                                                *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+#include "SimTKcommon.h"
+#include "SimTKcommon/Testing.h"
+
+#include <atomic>
+
+using namespace SimTK;
+
+// Restore the default single threaded policy when a subtest is done.
+class PolicySaver {
+public:
+    PolicySaver() : threads(ThreadingPolicy::getMaxThreads()),
+                    minWork(ThreadingPolicy::getMinWorkPerThread()) {}
+    ~PolicySaver() {
+        ThreadingPolicy::setMaxThreads(threads);
+        ThreadingPolicy::setMinWorkPerThread(minWork);
+    }
+private:
+    int threads, minWork;
+};
+
+void testPolicy() {
+    PolicySaver saver;
+    SimTK_TEST(ThreadingPolicy::getMaxThreads() == 1);
+    SimTK_TEST(ThreadingPolicy::calcNumChunks(1000000, 1000) == 1);
+
+    ThreadingPolicy::setMaxThreads(4);
+    ThreadingPolicy::setMinWorkPerThread(1000);
+    SimTK_TEST(ThreadingPolicy::getMaxThreads() == 4);
+    SimTK_TEST(ThreadingPolicy::getMinWorkPerThread() == 1000);
+    SimTK_TEST(ThreadingPolicy::calcNumChunks(10, 10) == 1);   // too small
+    SimTK_TEST(ThreadingPolicy::calcNumChunks(10, 250) == 2);
+    SimTK_TEST(ThreadingPolicy::calcNumChunks(1000, 1000) == 4);
+    SimTK_TEST(ThreadingPolicy::calcNumChunks(3, 1e6) == 3);   // one per item
+
+    ThreadingPolicy::setMaxThreads(0);
+    SimTK_TEST(ThreadingPolicy::getMaxThreads() >= 1);
+
+    SimTK_TEST_MUST_THROW(ThreadingPolicy::setMaxThreads(-1));
+    SimTK_TEST_MUST_THROW(ThreadingPolicy::setMinWorkPerThread(0));
+}
+
+// Every item must be visited exactly once, in contiguous chunks.
+void testExecuteChunks() {
+    PolicySaver saver;
+    ThreadingPolicy::setMaxThreads(3);
+    const int n = 100, nChunks = 3;
+    Array_<int> visits(n, 0), chunkOf(n, -1);
+    std::atomic<int> calls(0);
+    ThreadingPolicy::executeChunks(n, nChunks,
+        [&](int c, int begin, int end) {
+            ++calls;
+            for (int i=begin; i < end; ++i) {
+                ++visits[i]; chunkOf[i] = c;
+            }
+        });
+    SimTK_TEST(calls == nChunks);
+    for (int i=0; i < n; ++i) {
+        SimTK_TEST(visits[i] == 1);
+        if (i > 0) SimTK_TEST(chunkOf[i] >= chunkOf[i-1]);
+    }
+    SimTK_TEST(chunkOf[0] == 0 && chunkOf[n-1] == nChunks-1);
+
+    SimTK_TEST_MUST_THROW(ThreadingPolicy::executeChunks(2, 3,
+                                        [](int, int, int) {}));
+}
+
+static bool isIdentical(const Matrix& a, const Matrix& b) {
+    if (a.nrow() != b.nrow() || a.ncol() != b.ncol()) return false;
+    for (int j=0; j < a.ncol(); ++j)
+        for (int i=0; i < a.nrow(); ++i)
+            if (a(i,j) != b(i,j)) return false;
+    return true;
+}
+
+// The products and scalings must give bitwise the same answers with any
+// number of threads; the norms must agree to roundoff.
+void testKernels() {
+    PolicySaver saver;
+    Random::Uniform rand(-1, 1);
+    const int m = 57, n = 43, k = 31;
+    Matrix A(m, n), B(n, k);
+    Vector x(n), r(m), c(n), big(20000);
+    for (int j=0; j < n; ++j)
+        for (int i=0; i < m; ++i) A(i,j) = rand.getValue();
+    for (int j=0; j < k; ++j)
+        for (int i=0; i < n; ++i) B(i,j) = rand.getValue();
+    for (int i=0; i < n; ++i) { x[i] = rand.getValue(); c[i] = rand.getValue(); }
+    for (int i=0; i < m; ++i) r[i] = rand.getValue();
+    for (int i=0; i < big.size(); ++i) big[i] = rand.getValue();
+    big[12345] = 10; // make sure the largest element is in an interior chunk
+
+    const Vector Ax = A*x;
+    const Matrix AB = A*B, AtA = ~A*A;
+    const Matrix rA = A.rowScale(r), Ac = A.colScale(c);
+    Matrix rAin = A; rAin.rowScaleInPlace(r);
+    Matrix Acin = A; Acin.colScaleInPlace(c);
+    int worst, worstW;
+    const Real rms = big.normRMS(&worst);
+    const Real wrms = big.weightedNormRMS(Vector(big.size(), 2.), &worstW);
+
+    ThreadingPolicy::setMaxThreads(4);
+    ThreadingPolicy::setMinWorkPerThread(10);
+
+    SimTK_TEST(ThreadingPolicy::calcNumChunks(m, n) == 4);
+    SimTK_TEST(isIdentical(A*x, Ax));
+    SimTK_TEST(isIdentical(A*B, AB));
+    SimTK_TEST(isIdentical(~A*A, AtA));
+    SimTK_TEST(isIdentical(A.rowScale(r), rA));
+    SimTK_TEST(isIdentical(A.colScale(c), Ac));
+    Matrix rAin2 = A; rAin2.rowScaleInPlace(r);
+    Matrix Acin2 = A; Acin2.colScaleInPlace(c);
+    SimTK_TEST(isIdentical(rAin2, rAin));
+    SimTK_TEST(isIdentical(Acin2, Acin));
+
+    int worst2, worstW2;
+    SimTK_TEST_EQ(big.normRMS(&worst2), rms);
+    SimTK_TEST_EQ(big.weightedNormRMS(Vector(big.size(), 2.), &worstW2), wrms);
+    SimTK_TEST(worst2 == worst && worst2 == 12345);
+    SimTK_TEST(worstW2 == worstW);
+
+    // Kernels called from within a parallel task run serially.
+    ParallelExecutor executor(2);
+    class ProductTask : public ParallelExecutor::Task {
+    public:
+        ProductTask(const Matrix& A, const Vector& x, Vector* results)
+        :   A(A), x(x), results(results) {}
+        void execute(int i) override { results[i] = A*x; }
+    private:
+        const Matrix& A; const Vector& x; Vector* results;
+    };
+    Vector results[4];
+    ProductTask task(A, x, results);
+    executor.execute(task, 4);
+    for (int i=0; i < 4; ++i)
+        SimTK_TEST(isIdentical(results[i], Ax));
+}
+
+int main() {
+    SimTK_START_TEST("TestThreadingPolicy");
+        SimTK_SUBTEST(testPolicy);
+        SimTK_SUBTEST(testExecuteChunks);
+        SimTK_SUBTEST(testKernels);
+    SimTK_END_TEST();
+}
@@ -0,0 +1,108 @@
+/* -------------------------------------------------------------------------- *
+ *                       Simbody(tm): SimTKcommon                             *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2018 Stanford University and the Authors.           *
+ * Authors: Simbody developers                                                *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+/* Compare factoring and solving a batch of small SPD systems one at a time
+with Mat::invert() against doing them all at once with BatchedCholesky, for
+each supported size. Build with different BUILD_INST_SET values (or with
+-DSimTK_NO_SIMD) to see how the batched code scales with the SIMD width. */
+
+#include "SimTKcommon.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <vector>
+
+using namespace SimTK;
+
+static const int NSystems = 1000;
+static const int NReps = 2000;
+
+template <int N>
+static void timeSize() {
+    Random::Uniform uni(-1, 1);
+    std::vector<SymMat<N>> A(NSystems);
+    std::vector<Vec<N>>    b(NSystems), x(NSystems);
+    for (int k=0; k < NSystems; ++k) {
+        Mat<N,N> B;
+        for (int i=0; i < N; ++i) {
+            b[k][i] = uni.getValue();
+            for (int j=0; j < N; ++j) B(i,j) = uni.getValue();
+        }
+        A[k] = SymMat<N>(B*~B + Mat<N,N>(1));
+    }
+
+    Real checksum = 0;
+    double start = realTime();
+    for (int rep=0; rep < NReps; ++rep)
+        for (int k=0; k < NSystems; ++k) {
+            x[k] = Mat<N,N>(A[k]).invert() * b[k];
+            checksum += x[k][0];
+        }
+    const double oneAtATime = (realTime() - start)/(double(NReps)*NSystems);
+
+    BatchedCholesky<N> chol(NSystems);
+    start = realTime();
+    for (int rep=0; rep < NReps; ++rep) {
+        for (int k=0; k < NSystems; ++k) chol.setMatrix(k, A[k]);
+        chol.factor();
+        chol.solve(&b[0], &x[0]);
+        checksum += x[0][0];
+    }
+    const double batched = (realTime() - start)/(double(NReps)*NSystems);
+
+    // Same thing with the data already in structure of arrays form, as it
+    // would be if the matrices were computed directly into the batch.
+    std::vector<double> Asoa(N*(N+1)/2*chol.getStride()),
+                        bsoa(N*chol.getStride());
+    for (int k=0; k < NSystems; ++k)
+        for (int i=0, e=0; i < N; ++i) {
+            bsoa[i*chol.getStride() + k] = b[k][i];
+            for (int j=0; j <= i; ++j, ++e)
+                Asoa[e*chol.getStride() + k] = A[k](i,j);
+        }
+    std::vector<double> xsoa(bsoa.size());
+    start = realTime();
+    for (int rep=0; rep < NReps; ++rep) {
+        for (int i=0, e=0; i < N; ++i)
+            for (int j=0; j <= i; ++j, ++e)
+                std::copy_n(&Asoa[e*chol.getStride()], NSystems,
+                            chol.updLowerData(i,j));
+        chol.factor();
+        xsoa = bsoa;
+        chol.solveInPlace(&xsoa[0]);
+        checksum += xsoa[0];
+    }
+    const double soa = (realTime() - start)/(double(NReps)*NSystems);
+
+    printf("N=%d  invert %7.2f ns  batched %7.2f ns (%5.2fx)"
+           "  SoA %7.2f ns (%5.2fx)  (checksum %g)\n", N, 1e9*oneAtATime,
+           1e9*batched, oneAtATime/batched, 1e9*soa, oneAtATime/soa,
+           checksum);
+}
+
+int main() {
+    printf("BatchedCholesky, SIMD kernels: %s\n\n",
+           Impl::getSmallMatrixSIMDName());
+    timeSize<1>(); timeSize<2>(); timeSize<3>();
+    timeSize<4>(); timeSize<5>(); timeSize<6>();
+}
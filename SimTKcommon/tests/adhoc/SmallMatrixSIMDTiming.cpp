@@ -0,0 +1,114 @@
+/* -------------------------------------------------------------------------- *
+ *                       Simbody(tm): SimTKcommon                             *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2018 Stanford University and the Authors.           *
+ * Authors: Simbody developers                                                *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+/* Micro-benchmarks for the small matrix operations that dominate a multibody
+tree sweep. Build once normally and once with BUILD_SIMD_KERNELS off (or
+-DSimTK_NO_SIMD) to compare the vectorized kernels in SmallMatrixSIMD.h with
+the generic templatized code; use BUILD_INST_SET (e.g. avx2) to select the
+instruction set. Each benchmark works through an array of operands large
+enough to defeat constant folding but small enough to stay in cache. */
+
+#include "SimTKcommon.h"
+
+#include <cstdio>
+#include <vector>
+
+using namespace SimTK;
+
+static const int NData = 1000;
+static const int NReps = 10000;
+
+// Run the given operation over the whole data set NReps times and report
+// nanoseconds per operation. The checksum keeps the optimizer honest.
+template <class Op>
+static void timeIt(const char* name, Op op) {
+    Real checksum = 0;
+    const double start = realTime();
+    for (int rep=0; rep < NReps; ++rep)
+        for (int i=0; i < NData; ++i)
+            checksum += op(i);
+    const double elapsed = realTime() - start;
+    printf("%-36s %8.2f ns/op  (checksum %g)\n", name,
+           1e9*elapsed/(double(NReps)*NData), checksum);
+}
+
+int main() {
+    printf("Small matrix SIMD kernels: %s\n\n", Impl::getSmallMatrixSIMDName());
+
+    Random::Uniform uni(-1, 1);
+    std::vector<Rotation>            R(NData);
+    std::vector<Transform>           X(NData);
+    std::vector<Vec3>                v(NData);
+    std::vector<SpatialVec>          V(NData);
+    std::vector<SpatialMat>          M(NData);
+    std::vector<SpatialInertia>      SI(NData);
+    std::vector<ArticulatedInertia>  P(NData);
+    std::vector<Mat<2,2,Vec3>>       H(NData);
+
+    for (int i=0; i < NData; ++i) {
+        const Vec3 a(uni.getValue(), uni.getValue(), uni.getValue());
+        const Vec3 b(uni.getValue(), uni.getValue(), uni.getValue());
+        R[i].setRotationFromAngleAboutNonUnitVector(uni.getValue(), a);
+        X[i] = Transform(R[i], b);
+        v[i] = a - b;
+        V[i] = SpatialVec(a, b);
+        M[i] = SpatialMat(Mat33(R[i]), crossMat(a), crossMat(b), Mat33(R[i]));
+        SI[i] = SpatialInertia(1+uni.getValue()*uni.getValue(), a/10,
+                               UnitInertia(1,1,1));
+        P[i] = ArticulatedInertia(SI[i]);
+        H[i] = Mat<2,2,Vec3>(a, b, b, a);
+    }
+
+    timeIt("Rotation*Vec3", [&](int i)
+    {   return (R[i]*v[i])[2]; });
+    timeIt("~Rotation*Vec3", [&](int i)
+    {   return (~R[i]*v[i])[2]; });
+    timeIt("Rotation*Rotation", [&](int i)
+    {   return (R[i]*R[(i+1)%NData]).asMat33()(2,2); });
+    timeIt("Transform*Transform", [&](int i)
+    {   return (X[i]*X[(i+1)%NData]).p()[2]; });
+    timeIt("shiftVelocityBy", [&](int i)
+    {   return shiftVelocityBy(V[i], v[i])[1][2]; });
+    timeIt("shiftForceBy", [&](int i)
+    {   return shiftForceBy(V[i], v[i])[0][2]; });
+    timeIt("PhiMatrix*SpatialVec", [&](int i)
+    {   return (PhiMatrix(v[i])*V[i])[0][2]; });
+    timeIt("SpatialMat*SpatialVec", [&](int i)
+    {   return (M[i]*V[i])[1][2]; });
+    timeIt("SpatialInertia*SpatialVec", [&](int i)
+    {   return (SI[i]*V[i])[1][2]; });
+    timeIt("ArticulatedInertia*SpatialVec", [&](int i)
+    {   return (P[i]*V[i])[1][2]; });
+    timeIt("ArticulatedInertia::shift", [&](int i)
+    {   return P[i].shift(v[i]).getInertia()(2,2); });
+    // This is the rank-2 projection P - G*~PH done for a 2-dof mobilizer
+    // during the articulated body inertia calculation.
+    timeIt("ArticulatedInertia projection", [&](int i) -> Real
+    {   const Mat<2,2,Vec3> PH = P[i]*H[i];
+        const Mat33 massMoment = H[i].row(0)*~PH.row(1);
+        const Mat33 mass       = H[i].row(1)*~PH.row(1);
+        const Mat33 inertia    = H[i].row(0)*~PH.row(0);
+        return massMoment(2,2) + mass(1,1) + inertia(0,0); });
+
+    return 0;
+}
@@ -30,12 +30,6 @@
 #include "simmath/internal/BicubicSurface.h"
 #include "simmath/internal/ParticleConSurfaceSystem.h"
 #include "simmath/Differentiator.h"
-#include "simmath/RungeKutta3Integrator.h"
-#include "simmath/RungeKuttaMersonIntegrator.h"
-#include "simmath/RungeKuttaFeldbergIntegrator.h"
-#include "simmath/VerletIntegrator.h"
-#include "simmath/CPodesIntegrator.h"
-#include "simmath/TimeStepper.h"
 #include "simmath/internal/ContactGeometry.h"
 #include "simmath/internal/GeodesicIntegrator.h"
 
@@ -54,8 +48,6 @@ using std::set;
 using std::string;
 using std::cout; using std::endl;
 
-#define USE_NEW_INTEGRATOR
-
 //==============================================================================
 //                            CONTACT GEOMETRY
 //==============================================================================
@@ -819,14 +811,16 @@ void ContactGeometry::
 shootGeodesicInDirectionUntilLengthReached(const Vec3& xP, const UnitVec3& tP,
         const Real& terminatingLength, const GeodesicOptions& options,
         Geodesic& geod) const {
-    getImpl().shootGeodesicInDirection(xP, tP, terminatingLength, options, geod);
+    getImpl().shootGeodesicInDirection(xP, tP, terminatingLength, 0,
+                                       options, geod);
 }
 
 void ContactGeometry::
 calcGeodesicReverseSensitivity(Geodesic& geodesic, const Vec2& initSensitivity)
     const
 {
-    getImpl().calcGeodesicReverseSensitivity(geodesic, initSensitivity);
+    getImpl().calcGeodesicReverseSensitivity(geodesic, initSensitivity,
+                                             Vec2(1,0));
 }
 
 
@@ -1368,115 +1362,61 @@ makeStraightLineGeodesic(const Vec3& xP, const Vec3& xQ,
 // then renormalizing.
 static const Real IntegratorAccuracy = Real(1e-6); // TODO: how to choose?
 static const Real IntegratorConstraintTol = Real(1e-10);
-void ContactGeometryImpl::
-shootGeodesicInDirection(const Vec3& P, const UnitVec3& tP,
-        const Real& finalTime, const GeodesicOptions& options,
-        Geodesic& geod) const {
-
-    // integrator settings
-    const Real startTime = 0;
-
-    ++numGeodesicsShot;
 
-    // Initialize state
-    State sysState = ptOnSurfSys->getDefaultState();
-    sysState.setTime(startTime);
-    Vector& q = sysState.updQ();
-    Vector& u = sysState.updU();
-    q[0] = P[0]; q[1] = P[1]; q[2] = P[2];
-    u[0] = tP[0]; u[1] = tP[1]; u[2] = tP[2];
-
-    // Jacobi field states
-    q[3] = 0; 
-    u[3] = 1;
-
-    // Setup integrator to integrate until terminatingLength
-    //RungeKutta3Integrator integ(*ptOnSurfSys);
-    RungeKuttaMersonIntegrator integ(*ptOnSurfSys);
-    //RungeKuttaFeldbergIntegrator integ(*ptOnSurfSys);
-    integ.setAccuracy(IntegratorAccuracy);
-    integ.setConstraintTolerance(IntegratorConstraintTol);
-    integ.setFinalTime(finalTime);
-    integ.setReturnEveryInternalStep(true); // save geodesic knot points
-
-    // Setup timestepper in order to handle event when geodesic hits the plane
-    TimeStepper ts(*ptOnSurfSys, integ);
-    ts.setReportAllSignificantStates(true);
-    ts.initialize(sysState);
-
-    // Simulate it, and record geodesic knot points after each step
-    // Terminate when geodesic hits the plane
-    Integrator::SuccessfulStepStatus status;
-    int stepcnt = 0;
-    geod.setIsConvex(true); // Set false if we see negative curvature anywhere.
-    while (true) {
-        // Final time is already reported by the time we see end of simulation;
-        // don't duplicate the last step.
-        if ((status=ts.stepTo(Infinity)) == Integrator::EndOfSimulation)
+// The integrator's last step, which began at arc length s0 in state y0 where
+// the signed distance to the plane was d0, ended on the other side of the
+// plane. Back up and re-take that step with shorter lengths, chosen by the
+// Illinois variant of regula falsi, until it ends on the plane. The integrator
+// is left at the first point found past the plane, as a TimeStepper would
+// leave it after localizing a triggered event. dLo and dHi are the weighted
+// values used for the secant; distHi is the actual distance of the high end
+// from the plane, which is what has to be within tolerance.
+typedef GeodesicIntegrator<GeodesicOnImplicitSurface> GeodIntegrator;
+static void localizePlaneHit(GeodIntegrator& integ,
+                             const GeodesicOnImplicitSurface& eqns,
+                             const Plane& plane, Real s0,
+                             const Vec<GeodesicOnImplicitSurface::N>& y0,
+                             Real d0) {
+    const int MaxIterations = 50;
+    Real sLo = s0, dLo = d0;
+    Vec<GeodesicOnImplicitSurface::N> yLo = y0, yHi = integ.getY();
+    Real sHi = integ.getTime(), distHi = plane.getDistance(eqns.getP(yHi));
+    Real dHi = distHi;
+    bool atHi = true; // is the integrator sitting at (sHi,yHi)?
+    int lastMoved = 0; // -1 for lo end, +1 for hi end
+    for (int i=0; i < MaxIterations; ++i) {
+        if (std::abs(distHi) <= IntegratorConstraintTol
+            || sHi-sLo <= SignificantReal*std::max(Real(1), sHi))
             break;
-
-        // If we stopped just for a report, don't add that to the geodesic;
-        // that may happen if a visualization reporter has been hung on this
-        // system for watching the geodesic grow.
-        if (status == Integrator::ReachedReportTime)
-            continue;
-
-        // Careful -- integrator has its own internal copies of the state and
-        // the one returned won't always be the same one so you need to get a
-        // fresh reference each time.
-        const State& state = integ.getState();
-        const Real s = state.getTime();
-        geod.addArcLength(s);
-
-        const Vec3& pt = Vec3::getAs(&state.getQ()[0]);
-        const UnitVec3 n = calcSurfaceUnitNormal(pt);
-        const Vec3& tangent = Vec3::getAs(&state.getU()[0]);
-        // Rotation will orthogonalize so x direction we get may not be
-        // exactly the same as what we supply here.
-        const Transform frenetFrame(Rotation(n, ZAxis, tangent, YAxis), pt);
-        geod.addFrenetFrame(frenetFrame);
-        geod.addDirectionalSensitivityPtoQ(Vec2(state.getQ()[3],
-                                                state.getU()[3]));
-        geod.addPositionalSensitivityPtoQ(Vec2(NaN,NaN)); // XXX
-        const Real kappa = calcSurfaceCurvatureInDirection(pt, frenetFrame.y());
-        geod.addCurvature(kappa);
-        if (kappa < 0) 
-            geod.setIsConvex(false);
-
-        ++stepcnt;
+        Real sTry = (sLo*dHi - sHi*dLo) / (dHi - dLo);
+        if (!(sLo < sTry && sTry < sHi))
+            sTry = (sLo + sHi) / 2;
+        if (!(sLo < sTry && sTry < sHi))
+            break; // no representable arc length left between them
+
+        integ.setTimeAndState(sLo, yLo);
+        integ.setNextStepSizeToTry(sTry - sLo);
+        do {integ.takeOneStep(sTry);} while (integ.getTime() < sTry);
+
+        const Real d = plane.getDistance(eqns.getP(integ.getY()));
+        if (d != 0 && (d < 0) == (dLo < 0)) {
+            sLo = sTry; dLo = d; yLo = integ.getY(); atHi = false;
+            if (lastMoved == -1) dHi /= 2;
+            lastMoved = -1;
+        } else {
+            sHi = sTry; distHi = dHi = d; yHi = integ.getY(); atHi = true;
+            if (lastMoved == 1) dLo /= 2;
+            lastMoved = 1;
+        }
     }
-
-    geod.setBinormalCurvatureAtP(
-        calcSurfaceCurvatureInDirection(geod.getPointP(),geod.getBinormalP()));
-    geod.setBinormalCurvatureAtQ(
-        calcSurfaceCurvatureInDirection(geod.getPointQ(),geod.getBinormalQ()));
-
-    //TODO: numerical torsion estimate for now
-    const Array_<Transform>& frenet = geod.getFrenetFrames();
-    const Array_<Real>& arcLen = geod.getArcLengths();
-    const int last = geod.getNumPoints()-1;
-    const Real lFirst = arcLen[1];
-    const Real lLast  = arcLen[last] - arcLen[last-1];
-    const Real tauP = lFirst==0 ? Real(0)
-        : -dot(frenet[0].z(), 
-              (frenet[1].x()-frenet[0].x())) / lFirst; // dbP/ds
-    const Real tauQ = lLast==0 ? Real(0)
-        : -dot(frenet[last].z(), 
-              (frenet[last].x()-frenet[last-1].x())) / lLast;
-
-    geod.setTorsionAtP(tauP); geod.setTorsionAtQ(tauQ);
-
-    geod.setIsShortest(false); // TODO
-    geod.setAchievedAccuracy(IntegratorAccuracy); // TODO: accuracy of length?
-    // TODO: better to use something like the second-to-last step, or average
-    // excluding initial and last steps, so that we don't have to start small.
-    geod.setInitialStepSizeHint(integ.getActualInitialStepSizeTaken());
+    if (!atHi)
+        integ.setTimeAndState(sHi, yHi);
 }
 
 void ContactGeometryImpl::
-shootGeodesicInDirection2(const Vec3& P, const UnitVec3& tP,
-        const Real& finalArcLength, const GeodesicOptions& options,
-        Geodesic& geod) const {
+shootGeodesicInDirection(const Vec3& P, const UnitVec3& tP,
+        const Real& finalArcLength, const Plane* terminatingPlane,
+        const GeodesicOptions& options, Geodesic& geod) const {
 
     // integrator settings
     const Real startArcLength = 0;
@@ -1493,6 +1433,12 @@ shootGeodesicInDirection2(const Vec3& P, const UnitVec3& tP,
     const Vec<N>& y = integ.getY();
     const Real&   s = integ.getTime();  // arc length
 
+    // Signed distance of the starting point from the terminating plane, if
+    // any; the geodesic ends when this changes sign.
+    Real dist = terminatingPlane ? terminatingPlane->getDistance(eqns.getP(y))
+                                 : Real(1);
+    bool hitPlane = false;
+
     // Simulate it, and record geodesic knot points after each step
     int stepcnt = 0;
     geod.setIsConvex(true); // Set false if we see negative curvature anywhere.
@@ -1514,11 +1460,24 @@ shootGeodesicInDirection2(const Vec3& P, const UnitVec3& tP,
         geod.addCurvature(kappa);
         if (kappa < 0) geod.setIsConvex(false);
 
-        if (s == finalArcLength)
+        if (s == finalArcLength || hitPlane)
             break;
 
+        const Real sPrev = s;
+        const Vec<N> yPrev = y;
         integ.takeOneStep(finalArcLength);
         ++stepcnt;
+
+        if (terminatingPlane) {
+            const Real d = terminatingPlane->getDistance(eqns.getP(y));
+            if (d == 0 || (d < 0) != (dist < 0)) {
+                if (d != 0)
+                    localizePlaneHit(integ, eqns, *terminatingPlane,
+                                     sPrev, yPrev, dist);
+                hitPlane = true;
+            }
+            dist = d;
+        }
     }
 
     //printf("RKM acc=%g tol=%g: %d/%d steps, errtest=%d projfail=%d\n",
@@ -1560,71 +1519,7 @@ shootGeodesicInDirection2(const Vec3& P, const UnitVec3& tP,
 // After a geodesic has been calculated, this method integrates backwards
 // to fill in the missing reverse Jacobi term.
 void ContactGeometryImpl::
-calcGeodesicReverseSensitivity(Geodesic& geod, const Vec2& initJacobi) const {
-    
-    // Don't look for a plane.
-    geodHitPlaneEvent->setEnabled(false);
-
-    // integrator settings
-
-    //RungeKutta3Integrator integ(ptOnSurfSys);
-    RungeKuttaMersonIntegrator integ(*ptOnSurfSys);
-    integ.setAccuracy(IntegratorAccuracy);
-    integ.setConstraintTolerance(IntegratorConstraintTol);
-    State sysState = ptOnSurfSys->getDefaultState();
-    Vector& q = sysState.updQ();
-    Vector& u = sysState.updU();
-
-    // Initial Jacobi field states.
-    q[3] = initJacobi[0]; 
-    u[3] = initJacobi[1];
-
-    Array_<Vec2>& jQ = geod.updDirectionalSensitivityQtoP();
-    jQ.resize(geod.getNumPoints());
-    jQ.back() = initJacobi;
-
-    for (int step=geod.getNumPoints()-1; step >= 1; --step) {
-        // Curve goes from P to Q. We have to integrate backwards from Q to P.
-        const Transform& QFrenet = geod.getFrenetFrames()[step];
-        const Transform& PFrenet = geod.getFrenetFrames()[step-1];
-        const Real sQ = geod.getArcLengths()[step];
-        const Real sP = geod.getArcLengths()[step-1];
-        const Vec3&      Q = QFrenet.p();
-        const UnitVec3&  tQ = QFrenet.x(); // we'll reverse this
-        const Vec3&      P = PFrenet.p();
-        const UnitVec3&  tP = PFrenet.x();
-
-        // Initialize state
-        sysState.setTime(0);
-        q[0] = Q[0]; q[1] = Q[1]; q[2] = Q[2];
-        u[0] = -tQ[0]; u[1] = -tQ[1]; u[2] = -tQ[2];
-        q[3] = jQ[step][0]; 
-        u[3] = jQ[step][1];
-
-        const Real arcLength = sQ-sP; // how far to integrate
-
-        integ.initialize(sysState);
-
-        Integrator::SuccessfulStepStatus status;
-        do {
-            status = integ.stepTo(arcLength);
-            if (status == Integrator::StartOfContinuousInterval)
-                continue;
-            if (integ.getTime() < arcLength) {
-                printf("integ to %g returned early at %g with status=%s\n",
-                    arcLength, integ.getTime(),
-                    Integrator::getSuccessfulStepStatusString(status).c_str());
-            }
-        } while (integ.getTime() < arcLength);
-
-        // Save Jacobi field value.
-        const State& state = integ.getState();
-        jQ[step-1] = Vec2(state.getQ()[3],state.getU()[3]);
-    }
-}
-
-void ContactGeometryImpl::
-calcGeodesicReverseSensitivity2
+calcGeodesicReverseSensitivity
    (Geodesic& geod, const Vec2& initJRot, const Vec2& initJTrans) const {
 
     GeodesicOnImplicitSurface eqns(*this);
@@ -1697,11 +1592,10 @@ void ContactGeometryImpl::
 shootGeodesicInDirectionUntilPlaneHit(const Vec3& xP, const UnitVec3& tP,
         const Plane& terminatingPlane, const GeodesicOptions& options,
         Geodesic& geod) const {
-    geodHitPlaneEvent->setEnabled(true);
-    geodHitPlaneEvent->setPlane(terminatingPlane);
     // TODO: need a reasonable max length
     const Real MaxLength = /*Infinity*/100;
-    shootGeodesicInDirection(xP, tP, MaxLength, options, geod);
+    shootGeodesicInDirection(xP, tP, MaxLength, &terminatingPlane,
+                             options, geod);
 }
 
 
@@ -1712,12 +1606,7 @@ void ContactGeometryImpl::
 shootGeodesicInDirectionUntilLengthReached(const Vec3& xP, const UnitVec3& tP,
         const Real& terminatingLength, const GeodesicOptions& options,
         Geodesic& geod) const {
-    geodHitPlaneEvent->setEnabled(false);
-#ifdef USE_NEW_INTEGRATOR
-    shootGeodesicInDirection2(xP, tP, terminatingLength, options, geod);
-#else
-    shootGeodesicInDirection(xP, tP, terminatingLength, options, geod);
-#endif
+    shootGeodesicInDirection(xP, tP, terminatingLength, 0, options, geod);
 }
 
 
@@ -1763,7 +1652,7 @@ void ContactGeometryImpl::calcGeodesic(const Vec3& xP, const Vec3& xQ,
     // calculate plane bisecting P and Q, and use as termination condition for integrator
     UnitVec3 normal(xQ - xP);
     Real offset = (~(xP+xQ)*normal)/2 ;
-    geodHitPlaneEvent->setPlane(Plane(normal, offset));
+    geodPlane = Plane(normal, offset);
 
     Mat22 J;
     Vec2 x, xold, dx, Fx;
@@ -1829,9 +1718,11 @@ void ContactGeometryImpl::calcGeodesic(const Vec3& xP, const Vec3& xQ,
 
     // Finish each geodesic with reverse Jacobi field.
     calcGeodesicReverseSensitivity(geodP,
-        geodQ.getDirectionalSensitivityPtoQ().back());
+        geodQ.getDirectionalSensitivityPtoQ().back(),
+        geodQ.getPositionalSensitivityPtoQ().back());
     calcGeodesicReverseSensitivity(geodQ,
-        geodP.getDirectionalSensitivityPtoQ().back());
+        geodP.getDirectionalSensitivityPtoQ().back(),
+        geodP.getPositionalSensitivityPtoQ().back());
 
     mergeGeodesics(geodP, geodQ, geod);
 }
@@ -2025,11 +1916,7 @@ void ContactGeometryImpl::calcGeodesicUsingOrthogonalMethod
                     << MaxIterations << " iterations with err=" << f << std::endl;
 
     // Finish each geodesic with reverse Jacobi field.
-#ifdef USE_NEW_INTEGRATOR
-    calcGeodesicReverseSensitivity2(geod, Vec2(0,1), Vec2(1,0));
-#else
-    calcGeodesicReverseSensitivity(geod, Vec2(0,1));
-#endif
+    calcGeodesicReverseSensitivity(geod, Vec2(0,1), Vec2(1,0));
 
 }
 
@@ -2076,15 +1963,17 @@ calcSplitGeodError(const Vec3& xP, const Vec3& xQ,
 
     GeodesicOptions opts;
     shootGeodesicInDirectionUntilPlaneHit(xP, tP,
-            geodHitPlaneEvent->getPlane(), opts, geodP);
+            geodPlane, opts, geodP);
     shootGeodesicInDirectionUntilPlaneHit(xQ, tQ,
-            geodHitPlaneEvent->getPlane(), opts, geodQ);
+            geodPlane, opts, geodQ);
 
     // Finish each geodesic with reverse Jacobi field.
     calcGeodesicReverseSensitivity(geodP,
-        geodQ.getDirectionalSensitivityPtoQ().back());
+        geodQ.getDirectionalSensitivityPtoQ().back(),
+        geodQ.getPositionalSensitivityPtoQ().back());
     calcGeodesicReverseSensitivity(geodQ,
-        geodP.getDirectionalSensitivityPtoQ().back());
+        geodP.getDirectionalSensitivityPtoQ().back(),
+        geodP.getPositionalSensitivityPtoQ().back());
 
     if (geodesic)
         mergeGeodesics(geodP, geodQ, *geodesic);
@@ -2137,15 +2026,17 @@ calcSplitGeodErrorAnalytical(const Vec3& xP, const Vec3& xQ,
 
     GeodesicOptions opts;
     shootGeodesicInDirectionUntilPlaneHitAnalytical(xP, tP,
-            geodHitPlaneEvent->getPlane(), opts, geodP);
+            geodPlane, opts, geodP);
     shootGeodesicInDirectionUntilPlaneHitAnalytical(xQ, tQ,
-            geodHitPlaneEvent->getPlane(), opts, geodQ);
+            geodPlane, opts, geodQ);
 
     // Finish each geodesic with reverse Jacobi field.
     calcGeodesicReverseSensitivity(geodP,
-        geodQ.getDirectionalSensitivityPtoQ().back());
+        geodQ.getDirectionalSensitivityPtoQ().back(),
+        geodQ.getPositionalSensitivityPtoQ().back());
     calcGeodesicReverseSensitivity(geodQ,
-        geodP.getDirectionalSensitivityPtoQ().back());
+        geodP.getDirectionalSensitivityPtoQ().back(),
+        geodP.getPositionalSensitivityPtoQ().back());
 
     if (geodesic)
         mergeGeodesics(geodP, geodQ, *geodesic);
@@ -2168,9 +2059,9 @@ calcSplitGeodErrorJacobian(const Vec3& xP, const Vec3& xQ,
 //
 //    GeodesicOptions opts;
 //    shootGeodesicInDirectionUntilPlaneHit(xP, tP,
-//            geodHitPlaneEvent->getPlane(), opts, geodP);
+//            geodPlane, opts, geodP);
 //    shootGeodesicInDirectionUntilPlaneHit(xQ, tQ,
-//            geodHitPlaneEvent->getPlane(), opts, geodQ);
+//            geodPlane, opts, geodQ);
 
     GeodesicOptions opts;
 
@@ -2201,7 +2092,7 @@ calcSplitGeodErrorJacobian(const Vec3& xP, const Vec3& xQ,
     // positive perturb
     tP = calcUnitTangentVec(thetaP+h, R_SP);
     shootGeodesicInDirectionUntilPlaneHit(xP, tP,
-            geodHitPlaneEvent->getPlane(), opts, geodPtmp);
+            geodPlane, opts, geodPtmp);
     fyptmp = calcError(geodPtmp, geodQ);
 
     if (order==1) {
@@ -2211,7 +2102,7 @@ calcSplitGeodErrorJacobian(const Vec3& xP, const Vec3& xQ,
         geodPtmp.clear();
         tP = calcUnitTangentVec(thetaP-h, R_SP);
         shootGeodesicInDirectionUntilPlaneHit(xP, tP,
-                geodHitPlaneEvent->getPlane(), opts, geodPtmp);
+                geodPlane, opts, geodPtmp);
         fymtmp = calcError(geodPtmp, geodQ);
 
         dfdy(0) = (fyptmp-fymtmp)/(2*h);
@@ -2224,7 +2115,7 @@ calcSplitGeodErrorJacobian(const Vec3& xP, const Vec3& xQ,
     // positive perturb
     tQ = calcUnitTangentVec(thetaQ+h, R_SQ);
     shootGeodesicInDirectionUntilPlaneHit(xQ, tQ,
-            geodHitPlaneEvent->getPlane(), opts, geodQtmp);
+            geodPlane, opts, geodQtmp);
     fyptmp = calcError(geodP, geodQtmp);
 
     if (order==1) {
@@ -2234,7 +2125,7 @@ calcSplitGeodErrorJacobian(const Vec3& xP, const Vec3& xQ,
         geodQtmp.clear();
         tQ = calcUnitTangentVec(thetaQ-h, R_SQ);
         shootGeodesicInDirectionUntilPlaneHit(xQ, tQ,
-                geodHitPlaneEvent->getPlane(), opts, geodQtmp);
+                geodPlane, opts, geodQtmp);
         fymtmp = calcError(geodP, geodQtmp);
 
         dfdy(1) = (fyptmp-fymtmp)/(2*h);
@@ -46,13 +46,11 @@ class SplitGeodesicError;
 class SimTK_SIMMATH_EXPORT ContactGeometryImpl {
 public:
     ContactGeometryImpl() 
-    :   myHandle(0), ptOnSurfSys(0), geodHitPlaneEvent(0), vizReporter(0),
+    :   myHandle(0), ptOnSurfSys(0), vizReporter(0),
         splitGeodErr(0), numGeodesicsShot(0)
-    {
-        createParticleOnSurfaceSystem();
-    }
+    {}
     ContactGeometryImpl(const ContactGeometryImpl& source)
-    :   myHandle(0), ptOnSurfSys(0), geodHitPlaneEvent(0), vizReporter(0),
+    :   myHandle(0), ptOnSurfSys(0), vizReporter(0),
         splitGeodErr(0), numGeodesicsShot(0) 
     {}
 
@@ -317,19 +315,16 @@ public:
 
 
     // Utility method to used by calcGeodesicInDirectionUntilPlaneHit
-    //  and calcGeodesicInDirectionUntilLengthReached
+    //  and calcGeodesicInDirectionUntilLengthReached. If a terminating plane
+    //  is given, the geodesic ends where it first crosses that plane, or at
+    //  finalTime if it never does.
     void shootGeodesicInDirection(const Vec3& P, const UnitVec3& tP,
-            const Real& finalTime, const GeodesicOptions& options,
-            Geodesic& geod) const;
-    void shootGeodesicInDirection2(const Vec3& P, const UnitVec3& tP,
-            const Real& finalTime, const GeodesicOptions& options,
-            Geodesic& geod) const;
+            const Real& finalTime, const Plane* terminatingPlane,
+            const GeodesicOptions& options, Geodesic& geod) const;
 
     // Utility method to integrate geodesic backwards to fill in the Q to P
-    // directional sensitivity.
+    // directional and positional sensitivities.
     void calcGeodesicReverseSensitivity
-       (Geodesic& geod, const Vec2& initJacobi) const;
-    void calcGeodesicReverseSensitivity2
        (Geodesic& geod, const Vec2& initJRot, const Vec2& initJTrans) const;
 
     // Utility method to calculate the "geodesic error" between one geodesic
@@ -366,14 +361,14 @@ public:
         return R_GS;
     }
 
-    // Get the plane associated with the geodesic hit plane event handler
+    // Get the plane at which the split geodesic halves terminate
     const Plane& getPlane() const {
-        return geodHitPlaneEvent->getPlane();
+        return geodPlane;
     }
 
-    // Set the plane associated with the geodesic hit plane event handler
+    // Set the plane at which the split geodesic halves terminate
     void setPlane(const Plane& plane) const {
-        return geodHitPlaneEvent->setPlane(plane);
+        geodPlane = plane;
     }
 
 
@@ -391,7 +386,12 @@ public:
         return numGeodesicsShot;
     }
 
+    // Geodesics are shot with a GeodesicIntegrator; the particle-on-surface
+    // System exists only to give a visualization reporter something to
+    // report on, so we don't create it until one is added.
     void addVizReporter(ScheduledEventReporter* reporter) const {
+        if (!ptOnSurfSys)
+            ptOnSurfSys = new ParticleConSurfaceSystem(*this);
         vizReporter = reporter;
         ptOnSurfSys->addEventReporter(vizReporter); // takes ownership
         ptOnSurfSys->realizeTopology();
@@ -402,17 +402,10 @@ public:
     class OrthoGeodesicError; // local class
     friend class OrthoGeodesicError;
 
-    void createParticleOnSurfaceSystem() {
-        ptOnSurfSys = new ParticleConSurfaceSystem(*this);
-        geodHitPlaneEvent = new GeodHitPlaneEvent();
-        ptOnSurfSys->addEventHandler(geodHitPlaneEvent); // takes ownership
-        ptOnSurfSys->realizeTopology();
-    }
-
     void clearParticleOnSurfaceSystem() {
         delete ptOnSurfSys;
         ptOnSurfSys = 0;
-        geodHitPlaneEvent = 0; // was deleted by the system
+        vizReporter = 0; // was deleted by the system
     }
 
     ContactGeometry* getMyHandle() {return myHandle;}
@@ -422,9 +415,9 @@ protected:
     ContactGeometry*        myHandle;
     OBBTree                 obbTree;
 
-    ParticleConSurfaceSystem* ptOnSurfSys;
-    GeodHitPlaneEvent* geodHitPlaneEvent; // don't delete this
+    mutable ParticleConSurfaceSystem* ptOnSurfSys;
     mutable ScheduledEventReporter* vizReporter; // don't delete this
+    mutable Plane geodPlane;
     mutable SplitGeodesicError* splitGeodErr;
 
     // temporary objects
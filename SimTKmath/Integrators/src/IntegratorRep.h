@@ -309,7 +309,7 @@ public:
         const Real cy1 = d*d*(3-2*d), cy0 = 1-cy1;
         const Real hdd1 = h*d*(d-1), cf1=hdd1*d, cf0=cf1-hdd1;
 
-        yt = cy0*y0 + cy1*y1 + cf0*f0 + cf1*f1; // + O(h^4)
+        yt.setToLinearCombination(cy0,y0, cy1,y1, cf0,f0, cf1,f1); // + O(h^4)
     }
 
     // We have bracketed a zero crossing for some function f(t)
@@ -96,13 +96,16 @@ bool RungeKutta3IntegratorRep::attemptODEStep
             ytmp[i].resize(y0.size());
     Vector& f1    = ytmp[0]; // rename temps
     Vector& f2    = ytmp[1];
+    Vector& ystage = ytmp[2];
 
     const Real h = t1-t0;
 
-    setAdvancedStateAndRealizeDerivatives(t0+h/2, y0 + (h/2)*f0);
+    ystage.setToLinearCombination(1, y0, h/2, f0);
+    setAdvancedStateAndRealizeDerivatives(t0+h/2, ystage);
     f1 = getAdvancedState().getYDot();
 
-    setAdvancedStateAndRealizeDerivatives(t1,     y0 + h*(2*f1-f0));
+    ystage.setToLinearCombination(1, y0, 2*h, f1, -h, f0);
+    setAdvancedStateAndRealizeDerivatives(t1, ystage);
     f2 = getAdvancedState().getYDot();
 
     // Final value. This is the 3rd order accurate estimate for 
@@ -110,7 +113,8 @@ bool RungeKutta3IntegratorRep::attemptODEStep
     // Evaluate through kinematics only; it is a waste of a stage to 
     // evaluate derivatives here since the caller will muck with this before
     // the end of the step.
-    setAdvancedStateAndRealizeKinematics(t1,      y0 + (h/6)*(f0 + 4*f1 + f2));
+    ystage.setToLinearCombination(1, y0, h/6, f0, 2*h/3, f1, h/6, f2);
+    setAdvancedStateAndRealizeKinematics(t1, ystage);
     // YErr is valid now
 
     // This is an embedded 2nd-order estimate y1hat=y(t1)+O(h^3), with
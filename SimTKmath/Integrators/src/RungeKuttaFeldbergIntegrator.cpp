@@ -113,42 +113,53 @@ bool RungeKuttaFeldbergIntegratorRep::attemptODEStep
     Vector& ysave = ytmp[0]; // rename temps
     Vector& fa    = ytmp[1];
     Vector& fb    = ytmp[2];
+    Vector& ystage = ytmp[5];
 
     const Real h = t1-t0;
 
-    // Calculate the intermediate states.
+    // Calculate the intermediate states. These are formed in place with
+    // fused linear combinations (summed in the same order as the formulas)
+    // to avoid allocating temporaries.
     
-    setAdvancedStateAndRealizeDerivatives(t0 + h*C21, 
-        y0 + h*C22*f0);
+    ystage.setToLinearCombination(1, y0, h*C22, f0);
+    setAdvancedStateAndRealizeDerivatives(t0 + h*C21, ystage);
     ytmp[0] = getAdvancedState().getYDot();
 
-    setAdvancedStateAndRealizeDerivatives(t0 + h*C31, 
-        y0 + h*C32*f0 + h*C33*ytmp[0]);
+    ystage.setToLinearCombination(1, y0, h*C32, f0, h*C33, ytmp[0]);
+    setAdvancedStateAndRealizeDerivatives(t0 + h*C31, ystage);
     ytmp[1] = getAdvancedState().getYDot();
 
-    setAdvancedStateAndRealizeDerivatives(t0 + h*C41, 
-        y0 + h*C42*f0 + h*C43*ytmp[0] + h*C44*ytmp[1]);
+    ystage.setToLinearCombination(1, y0, h*C42, f0, h*C43, ytmp[0], 
+                                  h*C44, ytmp[1]);
+    setAdvancedStateAndRealizeDerivatives(t0 + h*C41, ystage);
     ytmp[2] = getAdvancedState().getYDot();
 
-    setAdvancedStateAndRealizeDerivatives(t0 + h*C51, 
-        y0 + h*C52*f0 + h*C53*ytmp[0] + h*C54*ytmp[1] + h*C55*ytmp[2]);
+    ystage.setToLinearCombination(1, y0, h*C52, f0, h*C53, ytmp[0], 
+                                  h*C54, ytmp[1])
+          .addScaledInPlace(h*C55, ytmp[2]);
+    setAdvancedStateAndRealizeDerivatives(t0 + h*C51, ystage);
     ytmp[3] = getAdvancedState().getYDot();
 
-    setAdvancedStateAndRealizeDerivatives(t0 + h*C61, 
-        y0 + h*C62*f0 + h*C63*ytmp[0] + h*C64*ytmp[1] + h*C65*ytmp[2] 
-           + h*C66*ytmp[3]);
+    ystage.setToLinearCombination(1, y0, h*C62, f0, h*C63, ytmp[0], 
+                                  h*C64, ytmp[1])
+          .addScaledInPlace(h*C65, ytmp[2])
+          .addScaledInPlace(h*C66, ytmp[3]);
+    setAdvancedStateAndRealizeDerivatives(t0 + h*C61, ystage);
     ytmp[4] = getAdvancedState().getYDot();
     
     // Calculate the final state but don't evaluate the derivatives. That
     // would be a wasted stage since the caller will muck with the state before
     // the end of the step.
-    setAdvancedStateAndRealizeKinematics(t1, 
-        y0 + h*CY1*f0 + h*CY2*ytmp[1] + h*CY3*ytmp[2] + h*CY4*ytmp[3]);
+    ystage.setToLinearCombination(1, y0, h*CY1, f0, h*CY2, ytmp[1], 
+                                  h*CY3, ytmp[2])
+          .addScaledInPlace(h*CY4, ytmp[3]);
+    setAdvancedStateAndRealizeKinematics(t1, ystage);
     // YErr is valid now, but not YDot.
     
     // Calculate the error estimate.
-    y1err = h*CE1*f0 + h*CE2*ytmp[1] + h*CE3*ytmp[2] + h*CE4*ytmp[3] 
-                     + h*CE5*ytmp[4];
+    y1err.setToLinearCombination(h*CE1, f0, h*CE2, ytmp[1], h*CE3, ytmp[2], 
+                                 h*CE4, ytmp[3])
+         .addScaledInPlace(h*CE5, ytmp[4]);
 
     return true;
 }
@@ -99,20 +99,27 @@ bool RungeKuttaMersonIntegratorRep::attemptODEStep
     Vector& ysave = ytmp[0]; // rename temps
     Vector& fa    = ytmp[1];
     Vector& fb    = ytmp[2];
+    Vector& ystage = ytmp[3];
 
     const Real h = t1-t0;
 
-    setAdvancedStateAndRealizeDerivatives(t0+h/3, y0 + (h/3)*f0);
+    // The stage states are formed in place with fused linear combinations
+    // to avoid allocating temporaries.
+
+    ystage.setToLinearCombination(1, y0, h/3, f0);
+    setAdvancedStateAndRealizeDerivatives(t0+h/3, ystage);
     fa = getAdvancedState().getYDot(); // fa=f1
 
-    setAdvancedStateAndRealizeDerivatives(t0+h/3, y0 + (h/6)*(f0+fa)); // f0+f1
+    ystage.setToLinearCombination(1, y0, h/6, f0, h/6, fa); // f0+f1
+    setAdvancedStateAndRealizeDerivatives(t0+h/3, ystage);
     fa = getAdvancedState().getYDot(); // fa=f2
 
-    setAdvancedStateAndRealizeDerivatives(t0+h/2, y0 + (h/8)*(f0 + 3*fa)); // f0+3f2
+    ystage.setToLinearCombination(1, y0, h/8, f0, 3*h/8, fa); // f0+3f2
+    setAdvancedStateAndRealizeDerivatives(t0+h/2, ystage);
     fb = getAdvancedState().getYDot(); // fb=f3
 
     // We'll need this for error estimation.
-    ysave = y0 + (h/2)*(f0 - 3*fa + 4*fb); // f0-3f2+4f3
+    ysave.setToLinearCombination(1, y0, h/2, f0, -3*h/2, fa, 2*h, fb); // f0-3f2+4f3
     setAdvancedStateAndRealizeDerivatives(t1, ysave);
     fa = getAdvancedState().getYDot(); // fa=f4
 
@@ -121,7 +128,8 @@ bool RungeKuttaMersonIntegratorRep::attemptODEStep
     // Evaluate through kinematics only; it is a waste of a stage to 
     // evaluate derivatives here since the caller will muck with this before
     // the end of the step.
-    setAdvancedStateAndRealizeKinematics(t1, y0 + (h/6)*(f0 + 4*fb + fa));
+    ystage.setToLinearCombination(1, y0, h/6, f0, 2*h/3, fb, h/6, fa);
+    setAdvancedStateAndRealizeKinematics(t1, ystage);
     // YErr is valid now
 
     // This is an embedded 3rd-order estimate y1hat=y(t0+h)+O(h^4). (Apparently
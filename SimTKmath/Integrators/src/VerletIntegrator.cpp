@@ -101,7 +101,7 @@ bool VerletIntegratorRep::attemptDAEStep
     
     // These are final values (the q's will get projected, though).
     advanced.updTime() = t1;
-    advanced.updQ()    = q0 + h*qdot0 + (h*h/2)*qdotdot0;
+    advanced.updQ().setToLinearCombination(1, q0, h, qdot0, h*h/2, qdotdot0);
 
     // Now make an initial estimate of first-order variable u and z.
     const Vector u1_est = u0 + h*udot0;
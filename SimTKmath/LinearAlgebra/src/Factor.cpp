@@ -90,8 +90,15 @@ FactorLU::FactorLU( const Matrix_<ELT>& m ) {
 
 template < class ELT >
 void FactorLU::factor( const Matrix_<ELT>& m ) {
-    delete rep;
-    rep = new FactorLURep<typename CNT<ELT>::StdNumber>(m);
+    // Refactor in place if the current rep has the right element type so
+    // that its storage gets reused.
+    typedef FactorLURep<typename CNT<ELT>::StdNumber> Rep;
+    Rep* r = dynamic_cast<Rep*>(rep);
+    if (!r) {
+        delete rep;
+        rep = r = new Rep();
+    }
+    r->refactor(m);
 }
 
 template < typename ELT >
@@ -147,13 +154,21 @@ int FactorLU::getSingularIndex () const {
 template <typename T >
     template < typename ELT >
 FactorLURep<T>::FactorLURep( const Matrix_<ELT>& mat ) 
-      : nRow( mat.nrow() ),
-        nCol( mat.ncol() ),
-        mn( (mat.nrow() < mat.ncol()) ? mat.nrow() : mat.ncol() ),
-        singularIndex(0),
-        pivots(mat.ncol()),             
-        lu( mat.nrow()*mat.ncol() )
+      : FactorLURep()
 { 
+    refactor( mat );
+}
+// Size the buffers for this matrix and factor it. The buffers only grow, so
+// refactoring a matrix that is no bigger than the last one doesn't allocate.
+template <typename T >
+    template < typename ELT >
+void FactorLURep<T>::refactor( const Matrix_<ELT>& mat ) {
+    nRow = mat.nrow();
+    nCol = mat.ncol();
+    mn   = std::min(nRow, nCol);
+    singularIndex = 0;
+    pivots.resize(nCol);
+    lu.resize(nRow*nCol);
     FactorLURep<T>::factor( mat );
 }
 template <typename T >
@@ -0,0 +1,438 @@
+/* -------------------------------------------------------------------------- *
+ *                        Simbody(tm): SimTKmath                              *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2018 Stanford University and the Authors.           *
+ * Authors: Simbody developers                                                *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+/**@file
+ *
+ * Cholesky factorization of symmetric positive definite matrices.
+ */
+
+#include "SimTKcommon.h"
+
+#include "simmath/internal/common.h"
+#include "simmath/LinearAlgebra.h"
+
+#include "LapackInterface.h"
+#include "FactorCholeskyRep.h"
+#include "WorkSpace.h"
+#include "LATraits.h"
+#include "LapackConvert.h"
+
+#include <iostream>
+#include <cmath>
+
+
+namespace SimTK {
+
+   ///////////////////////////
+   // FactorCholeskyDefault //
+   ///////////////////////////
+FactorCholeskyDefault::FactorCholeskyDefault() {
+    isFactored = false;
+}
+FactorCholeskyRepBase* FactorCholeskyDefault::clone() const {
+    return( new FactorCholeskyDefault(*this));
+}
+
+   ////////////////////
+   // FactorCholesky //
+   ////////////////////
+FactorCholesky::~FactorCholesky() {
+    delete rep;
+}
+// default constructor
+FactorCholesky::FactorCholesky() {
+    rep = new FactorCholeskyDefault();
+}
+// copy constructor
+FactorCholesky::FactorCholesky( const FactorCholesky& c ) {
+    rep = c.rep->clone();
+}
+// copy assignment operator
+FactorCholesky& FactorCholesky::operator=(const FactorCholesky& rhs) {
+    if (&rhs != this) {
+        delete rep;
+        rep = rhs.rep->clone();
+    }
+    return *this;
+}
+
+template < class ELT >
+FactorCholesky::FactorCholesky( const Matrix_<ELT>& m ) {
+    rep = new FactorCholeskyRep<typename CNT<ELT>::StdNumber>(m);
+}
+template < class ELT >
+void FactorCholesky::factor( const Matrix_<ELT>& m ) {
+    // Refactor in place if the current rep has the right element type so
+    // that its storage gets reused.
+    typedef FactorCholeskyRep<typename CNT<ELT>::StdNumber> Rep;
+    Rep* r = dynamic_cast<Rep*>(rep);
+    if (!r) {
+        delete rep;
+        rep = r = new Rep();
+    }
+    r->refactor(m);
+}
+template < class ELT >
+void FactorCholesky::solve( const Vector_<ELT>& b, Vector_<ELT>& x ) const {
+    rep->solve( b, x );
+}
+template < class ELT >
+void FactorCholesky::solve( const Matrix_<ELT>& b, Matrix_<ELT>& x ) const {
+    rep->solve( b, x );
+}
+template < class ELT >
+void FactorCholesky::getL( Matrix_<ELT>& l ) const {
+    rep->getL( l );
+}
+template < class ELT >
+void FactorCholesky::inverse( Matrix_<ELT>& inverse ) const {
+    rep->inverse( inverse );
+}
+bool FactorCholesky::isPositiveDefinite() const {
+    return rep->isFactored && rep->notPositiveDefiniteIndex == 0;
+}
+int FactorCholesky::getNotPositiveDefiniteIndex() const {
+    return rep->notPositiveDefiniteIndex;
+}
+double FactorCholesky::getRCondEstimate() const {
+    return rep->actualRCond;
+}
+template < class ELT >
+void FactorCholesky::update( const Matrix_<ELT>& v ) {
+    rep->update( v, false );
+}
+template < class ELT >
+void FactorCholesky::update( const Vector_<ELT>& v ) {
+    Matrix_<ELT> vm(v.size(), 1); vm(0) = v;
+    rep->update( vm, false );
+}
+template < class ELT >
+void FactorCholesky::downdate( const Matrix_<ELT>& v ) {
+    rep->update( v, true );
+}
+template < class ELT >
+void FactorCholesky::downdate( const Vector_<ELT>& v ) {
+    Matrix_<ELT> vm(v.size(), 1); vm(0) = v;
+    rep->update( vm, true );
+}
+template < class ELT >
+void FactorCholesky::appendRowCol( const Vector_<ELT>& a ) {
+    rep->appendRowCol( a );
+}
+void FactorCholesky::removeRowCol( int k ) {
+    rep->removeRowCol( k );
+}
+
+   ///////////////////////
+   // FactorCholeskyRep //
+   ///////////////////////
+template <typename T >
+FactorCholeskyRep<T>::FactorCholeskyRep()
+:   n(0), chol(0), lowerA(0), work(0), iwork(0) {}
+
+template <typename T >
+    template < typename ELT >
+FactorCholeskyRep<T>::FactorCholeskyRep( const Matrix_<ELT>& mat )
+:   FactorCholeskyRep()
+{
+    refactor( mat );
+}
+
+// Size the buffers for this matrix and factor it. The buffers only grow, so
+// refactoring a matrix that is no bigger than the last one doesn't allocate.
+template <typename T >
+    template < typename ELT >
+void FactorCholeskyRep<T>::refactor( const Matrix_<ELT>& mat ) {
+    isFactored = false;
+    n = mat.nrow();
+    chol.resize(mat.nrow()*mat.ncol());
+    lowerA.resize(mat.nrow()*mat.ncol());
+    work.resize(3*n);
+    iwork.resize(n);
+    FactorCholeskyRep<T>::factor( mat );
+    isFactored = true;
+}
+
+template <typename T >
+FactorCholeskyRep<T>::~FactorCholeskyRep() {}
+
+template <typename T >
+FactorCholeskyRepBase* FactorCholeskyRep<T>::clone() const {
+    return( new FactorCholeskyRep<T>(*this) );
+}
+
+template <typename T >
+void FactorCholeskyRep<T>::checkIfPositiveDefinite(const char* where) const {
+    SimTK_APIARGCHECK1_ALWAYS(notPositiveDefiniteIndex==0,
+        "FactorCholesky", where,
+        "The matrix was not positive definite (leading minor %d failed); "
+        "use FactorLDLT, FactorQTZ or FactorLU instead. \n",
+        notPositiveDefiniteIndex);
+}
+
+template < class T >
+void FactorCholeskyRep<T>::solve( const Vector_<T>& b, Vector_<T>& x ) const {
+    checkIfPositiveDefinite("solve");
+    SimTK_APIARGCHECK2_ALWAYS(b.size()==n,"FactorCholesky","solve",
+       "number of rows in right hand side=%d does not match number of rows in original matrix=%d \n",
+        b.size(), n );
+
+    x.copyAssign(b);
+    LapackInterface::potrs<T>( 'L', n, 1, chol.data, &x(0) );
+}
+
+template < class T >
+void FactorCholeskyRep<T>::solve( const Matrix_<T>& b, Matrix_<T>& x ) const {
+    checkIfPositiveDefinite("solve");
+    SimTK_APIARGCHECK2_ALWAYS(b.nrow()==n,"FactorCholesky","solve",
+       "number of rows in right hand side=%d does not match number of rows in original matrix=%d \n",
+        b.nrow(), n );
+
+    x.copyAssign(b);
+    if (x.ncol() == 0) return;
+    LapackInterface::potrs<T>( 'L', n, b.ncol(), chol.data, &x(0,0) );
+}
+
+template < class T >
+void FactorCholeskyRep<T>::getL( Matrix_<T>& l ) const {
+    l.resize(n, n);
+    for (int j=0; j < n; ++j) {
+        for (int i=0; i < j; ++i) l(i,j) = 0;
+        for (int i=j; i < n; ++i) l(i,j) = chol.data[j*n+i];
+    }
+}
+
+template < class T >
+void FactorCholeskyRep<T>::inverse( Matrix_<T>& inverse ) const {
+    Matrix_<T> iden(n,n);
+    iden = 1.0;
+    solve( iden, inverse );
+}
+
+template <class T>
+    template<typename ELT>
+void FactorCholeskyRep<T>::factor( const Matrix_<ELT>& mat ) {
+    SimTK_APIARGCHECK2_ALWAYS(mat.nelt() > 0,"FactorCholesky","factor",
+       "Can't factor a matrix that has a zero dimension -- got %d X %d.",
+       (int)mat.nrow(), (int)mat.ncol());
+    SimTK_APIARGCHECK2_ALWAYS(mat.nrow()==mat.ncol(),"FactorCholesky","factor",
+       "Can't factor a matrix that is not square -- got %d X %d.",
+       (int)mat.nrow(), (int)mat.ncol());
+
+    // converts (negated etc.) to LAPACK format
+    LapackConvert::convertMatrixToLapack( chol.data, mat );
+    // keep the original for the condition estimate and later updates
+    for (int i=0; i < n*n; ++i) lowerA.data[i] = chol.data[i];
+
+    int info;
+    LapackInterface::potrf<T>( 'L', n, chol.data, n, info );
+    if (info > 0) {
+        notPositiveDefiniteIndex = info;
+        actualRCond = 0;
+        return;
+    }
+    notPositiveDefiniteIndex = 0;
+    estimateRCond();
+}
+
+template <class T>
+void FactorCholeskyRep<T>::estimateRCond() {
+    // The condition estimator needs the 1-norm of the original matrix. Since
+    // only the lower triangle is supposed to be meaningful we compute it
+    // from that rather than using lange() on the full matrix.
+    typedef typename CNT<T>::TReal RealType;
+    const T* const a = lowerA.data;
+    RealType anorm = 0;
+    for (int j=0; j < n; ++j) {
+        RealType colSum = 0;
+        for (int i=0; i < j; ++i) colSum += CNT<T>::abs(a[i*n+j]);
+        for (int i=j; i < n; ++i) colSum += CNT<T>::abs(a[j*n+i]);
+        anorm = std::max(anorm, colSum);
+    }
+
+    int info;
+    RealType rcond;
+    LapackInterface::pocon<T>( 'L', n, chol.data, n, anorm, rcond,
+                               work.data, iwork.data, info );
+    actualRCond = (double)rcond;
+}
+
+// Update L in place so that L*~L becomes L*~L + x*~x (or - x*~x for a
+// downdate), touching only rows and columns k0 and up; x is zero above k0
+// and is overwritten. This is the usual sequence of plane rotations (hyperbolic
+// ones for a downdate), O(n^2). Returns false, with L partly updated, if a
+// downdate would leave the matrix not positive definite.
+template <class T>
+bool FactorCholeskyRep<T>::rankOneUpdate( int k0, T* x, bool downdate ) {
+    T* const L = chol.data;
+    const T sign = downdate ? T(-1) : T(1);
+    for (int k=k0; k < n; ++k) {
+        const T lkk = L[k*n+k];
+        const T r2 = lkk*lkk + sign*x[k]*x[k];
+        if (!(r2 > 0)) {
+            notPositiveDefiniteIndex = k+1;
+            return false;
+        }
+        const T r = std::sqrt(r2), c = r/lkk, s = x[k]/lkk;
+        L[k*n+k] = r;
+        for (int i=k+1; i < n; ++i) {
+            T& lik = L[k*n+i];
+            lik  = (lik + sign*s*x[i]) / c;
+            x[i] = c*x[i] - s*lik;
+        }
+    }
+    return true;
+}
+
+template <class T>
+void FactorCholeskyRep<T>::update( const Matrix_<T>& v, bool downdate ) {
+    const char* where = downdate ? "downdate" : "update";
+    checkIfPositiveDefinite(where);
+    SimTK_APIARGCHECK2_ALWAYS(v.nrow()==n,"FactorCholesky",where,
+       "number of rows in update=%d does not match number of rows in original matrix=%d \n",
+        v.nrow(), n );
+
+    const T sign = downdate ? T(-1) : T(1);
+    for (int c=0; c < v.ncol(); ++c) {
+        for (int j=0; j < n; ++j)
+            for (int i=j; i < n; ++i)
+                lowerA.data[j*n+i] += sign*v(i,c)*v(j,c);
+        for (int i=0; i < n; ++i) work.data[i] = v(i,c);
+        if (!rankOneUpdate(0, work.data, downdate)) {
+            actualRCond = 0;
+            return;
+        }
+    }
+    estimateRCond();
+}
+
+template <class T>
+void FactorCholeskyRep<T>::appendRowCol( const Vector_<T>& a ) {
+    checkIfPositiveDefinite("appendRowCol");
+    SimTK_APIARGCHECK2_ALWAYS(a.size()==n+1,"FactorCholesky","appendRowCol",
+       "new row has %d elements but should have %d \n", a.size(), n+1 );
+
+    // Spread the columns out for leading dimension n+1, working from the
+    // end so nothing is overwritten before it is moved.
+    const int m = n+1;
+    chol.resizeKeep(m*m); lowerA.resizeKeep(m*m);
+    for (int j=n-1; j >= 0; --j)
+        for (int i=n-1; i >= j; --i) {
+            chol.data[j*m+i]   = chol.data[j*n+i];
+            lowerA.data[j*m+i] = lowerA.data[j*n+i];
+        }
+
+    // The new row of L is l = L^-1 a(0:n-1) and the new diagonal element is
+    // sqrt(a(n) - ~l*l).
+    T* const L = chol.data;
+    T d = a[n];
+    for (int j=0; j < n; ++j) {
+        T lj = a[j];
+        for (int i=0; i < j; ++i) lj -= L[i*m+n]*L[i*m+j];
+        lj /= L[j*m+j];
+        L[j*m+n] = lj;
+        d -= lj*lj;
+        lowerA.data[j*m+n] = a[j];
+    }
+    lowerA.data[n*m+n] = a[n];
+    n = m;
+    work.resize(3*n); iwork.resize(n);
+
+    if (!(d > 0)) {
+        notPositiveDefiniteIndex = n;
+        actualRCond = 0;
+        return;
+    }
+    L[(n-1)*n+(n-1)] = std::sqrt(d);
+    estimateRCond();
+}
+
+template <class T>
+void FactorCholeskyRep<T>::removeRowCol( int k ) {
+    checkIfPositiveDefinite("removeRowCol");
+    SimTK_APIARGCHECK2_ALWAYS(0<=k && k<n && n>1,"FactorCholesky","removeRowCol",
+       "can't remove row and column %d from a matrix of order %d \n", k, n );
+
+    // Removing row k leaves the trailing block of L short by the outer
+    // product of column k below the diagonal; save that column, squeeze out
+    // row and column k (every element moves toward the front so this can be
+    // done in place), and put it back with a rank one update.
+    const int m = n-1;
+    T* const L = chol.data;
+    for (int i=k+1; i < n; ++i) work.data[i-1] = L[k*n+i];
+    for (int j=0; j < m; ++j) {
+        const int jo = j < k ? j : j+1;
+        for (int i=j; i < m; ++i) {
+            const int io = i < k ? i : i+1;
+            L[j*m+i]           = L[jo*n+io];
+            lowerA.data[j*m+i] = lowerA.data[jo*n+io];
+        }
+    }
+    n = m;
+    rankOneUpdate(k, work.data, false);
+    estimateRCond();
+}
+
+// instantiate
+template SimTK_SIMMATH_EXPORT FactorCholesky::FactorCholesky( const Matrix_<double>& m );
+template SimTK_SIMMATH_EXPORT FactorCholesky::FactorCholesky( const Matrix_<float>& m );
+template SimTK_SIMMATH_EXPORT FactorCholesky::FactorCholesky( const Matrix_<negator< double> >& m );
+template SimTK_SIMMATH_EXPORT FactorCholesky::FactorCholesky( const Matrix_<negator< float> >& m );
+
+template SimTK_SIMMATH_EXPORT void FactorCholesky::factor( const Matrix_<double>& m );
+template SimTK_SIMMATH_EXPORT void FactorCholesky::factor( const Matrix_<float>& m );
+template SimTK_SIMMATH_EXPORT void FactorCholesky::factor( const Matrix_<negator< double> >& m );
+template SimTK_SIMMATH_EXPORT void FactorCholesky::factor( const Matrix_<negator< float> >& m );
+
+template class FactorCholeskyRep<double>;
+template FactorCholeskyRep<double>::FactorCholeskyRep( const Matrix_<double>& m );
+template FactorCholeskyRep<double>::FactorCholeskyRep( const Matrix_<negator<double> >& m );
+template void FactorCholeskyRep<double>::factor( const Matrix_<double>& m );
+template void FactorCholeskyRep<double>::factor( const Matrix_<negator<double> >& m );
+
+template class FactorCholeskyRep<float>;
+template FactorCholeskyRep<float>::FactorCholeskyRep( const Matrix_<float>& m );
+template FactorCholeskyRep<float>::FactorCholeskyRep( const Matrix_<negator<float> >& m );
+template void FactorCholeskyRep<float>::factor( const Matrix_<float>& m );
+template void FactorCholeskyRep<float>::factor( const Matrix_<negator<float> >& m );
+
+template SimTK_SIMMATH_EXPORT void FactorCholesky::solve<float>(const Vector_<float>&, Vector_<float>&) const;
+template SimTK_SIMMATH_EXPORT void FactorCholesky::solve<double>(const Vector_<double>&, Vector_<double>&) const;
+template SimTK_SIMMATH_EXPORT void FactorCholesky::solve<float>(const Matrix_<float>&, Matrix_<float>&) const;
+template SimTK_SIMMATH_EXPORT void FactorCholesky::solve<double>(const Matrix_<double>&, Matrix_<double>&) const;
+template SimTK_SIMMATH_EXPORT void FactorCholesky::getL<float>(Matrix_<float>&) const;
+template SimTK_SIMMATH_EXPORT void FactorCholesky::getL<double>(Matrix_<double>&) const;
+template SimTK_SIMMATH_EXPORT void FactorCholesky::inverse<float>(Matrix_<float>&) const;
+template SimTK_SIMMATH_EXPORT void FactorCholesky::inverse<double>(Matrix_<double>&) const;
+template SimTK_SIMMATH_EXPORT void FactorCholesky::update<float>(const Matrix_<float>&);
+template SimTK_SIMMATH_EXPORT void FactorCholesky::update<double>(const Matrix_<double>&);
+template SimTK_SIMMATH_EXPORT void FactorCholesky::update<float>(const Vector_<float>&);
+template SimTK_SIMMATH_EXPORT void FactorCholesky::update<double>(const Vector_<double>&);
+template SimTK_SIMMATH_EXPORT void FactorCholesky::downdate<float>(const Matrix_<float>&);
+template SimTK_SIMMATH_EXPORT void FactorCholesky::downdate<double>(const Matrix_<double>&);
+template SimTK_SIMMATH_EXPORT void FactorCholesky::downdate<float>(const Vector_<float>&);
+template SimTK_SIMMATH_EXPORT void FactorCholesky::downdate<double>(const Vector_<double>&);
+template SimTK_SIMMATH_EXPORT void FactorCholesky::appendRowCol<float>(const Vector_<float>&);
+template SimTK_SIMMATH_EXPORT void FactorCholesky::appendRowCol<double>(const Vector_<double>&);
+
+} // namespace SimTK
@@ -0,0 +1,159 @@
+#ifndef SimTK_SIMMATH_FACTOR_CHOLESKY_REP_H_
+#define SimTK_SIMMATH_FACTOR_CHOLESKY_REP_H_
+
+/* -------------------------------------------------------------------------- *
+ *                        Simbody(tm): SimTKmath                              *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2018 Stanford University and the Authors.           *
+ * Authors: Simbody developers                                                *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+#include "SimTKmath.h"
+#include "WorkSpace.h"
+
+namespace SimTK {
+
+class FactorCholeskyRepBase {
+public:
+    FactorCholeskyRepBase()
+    :   isFactored(false), notPositiveDefiniteIndex(0), actualRCond(0) {}
+
+    virtual ~FactorCholeskyRepBase(){};
+
+    virtual FactorCholeskyRepBase* clone() const { return 0; };
+
+    virtual void solve( const Vector_<float>& b, Vector_<float>& x ) const {
+        checkIfFactored("solve");
+        SimTK_APIARGCHECK_ALWAYS(false,"FactorCholesky","solve",
+        "solve called with rhs of type <float>  which does not match type of original linear system \n");
+    }
+    virtual void solve( const Vector_<double>& b, Vector_<double>& x ) const {
+        checkIfFactored("solve");
+        SimTK_APIARGCHECK_ALWAYS(false,"FactorCholesky","solve",
+        "solve called with rhs of type <double>  which does not match type of original linear system \n");
+    }
+    virtual void solve( const Matrix_<float>& b, Matrix_<float>& x ) const {
+        checkIfFactored("solve");
+        SimTK_APIARGCHECK_ALWAYS(false,"FactorCholesky","solve",
+        "solve called with rhs of type <float>  which does not match type of original linear system \n");
+    }
+    virtual void solve( const Matrix_<double>& b, Matrix_<double>& x ) const {
+        checkIfFactored("solve");
+        SimTK_APIARGCHECK_ALWAYS(false,"FactorCholesky","solve",
+        "solve called with rhs of type <double>  which does not match type of original linear system \n");
+    }
+    virtual void getL( Matrix_<float>& l ) const {
+        checkIfFactored("getL");
+        SimTK_APIARGCHECK_ALWAYS(false,"FactorCholesky","getL",
+        "getL called with L of type <float> which does not match type of original linear system \n");
+    }
+    virtual void getL( Matrix_<double>& l ) const {
+        checkIfFactored("getL");
+        SimTK_APIARGCHECK_ALWAYS(false,"FactorCholesky","getL",
+        "getL called with L of type <double> which does not match type of original linear system \n");
+    }
+    virtual void inverse( Matrix_<float>& inverse ) const {
+        checkIfFactored("inverse");
+        SimTK_APIARGCHECK_ALWAYS(false,"FactorCholesky","inverse",
+        "inverse( <float> ) called with type that is inconsistent with the original matrix  \n");
+    }
+    virtual void inverse( Matrix_<double>& inverse ) const {
+        checkIfFactored("inverse");
+        SimTK_APIARGCHECK_ALWAYS(false,"FactorCholesky","inverse",
+        "inverse( <double> ) called with type that is inconsistent with the original matrix  \n");
+    }
+
+    virtual void update( const Matrix_<float>& v, bool downdate ) {
+        checkIfFactored("update");
+        SimTK_APIARGCHECK_ALWAYS(false,"FactorCholesky","update",
+        "update called with argument of type <float> which does not match type of original linear system \n");
+    }
+    virtual void update( const Matrix_<double>& v, bool downdate ) {
+        checkIfFactored("update");
+        SimTK_APIARGCHECK_ALWAYS(false,"FactorCholesky","update",
+        "update called with argument of type <double> which does not match type of original linear system \n");
+    }
+    virtual void appendRowCol( const Vector_<float>& a ) {
+        checkIfFactored("appendRowCol");
+        SimTK_APIARGCHECK_ALWAYS(false,"FactorCholesky","appendRowCol",
+        "appendRowCol called with argument of type <float> which does not match type of original linear system \n");
+    }
+    virtual void appendRowCol( const Vector_<double>& a ) {
+        checkIfFactored("appendRowCol");
+        SimTK_APIARGCHECK_ALWAYS(false,"FactorCholesky","appendRowCol",
+        "appendRowCol called with argument of type <double> which does not match type of original linear system \n");
+    }
+    virtual void removeRowCol( int k ) {
+        checkIfFactored("removeRowCol");
+    }
+
+    bool   isFactored;
+    int    notPositiveDefiniteIndex; // 1-based leading minor that failed
+    double actualRCond;              // estimated 1/cond of original matrix
+
+    void checkIfFactored(const char* where) const {
+        SimTK_APIARGCHECK_ALWAYS(isFactored,"FactorCholesky",where,
+        "No matrix was passed to FactorCholesky. \n");
+    }
+
+}; // class FactorCholeskyRepBase
+
+class FactorCholeskyDefault : public FactorCholeskyRepBase {
+public:
+    FactorCholeskyDefault();
+    FactorCholeskyRepBase* clone() const override;
+};
+
+template <typename T>
+class FactorCholeskyRep : public FactorCholeskyRepBase {
+public:
+    template <class ELT> FactorCholeskyRep( const Matrix_<ELT>& );
+    FactorCholeskyRep();
+
+    ~FactorCholeskyRep();
+
+    template <class ELT> void factor( const Matrix_<ELT>& );
+    template <class ELT> void refactor( const Matrix_<ELT>& );
+    void solve( const Vector_<T>& b, Vector_<T>& x ) const override;
+    void solve( const Matrix_<T>& b, Matrix_<T>& x ) const override;
+    void getL( Matrix_<T>& l ) const override;
+    void inverse( Matrix_<T>& ) const override;
+
+    void update( const Matrix_<T>& v, bool downdate ) override;
+    void appendRowCol( const Vector_<T>& a ) override;
+    void removeRowCol( int k ) override;
+
+    FactorCholeskyRepBase* clone() const override;
+
+private:
+    void checkIfPositiveDefinite(const char* where) const;
+    bool rankOneUpdate( int k0, T* x, bool downdate );
+    void estimateRCond();
+
+    int                 n;      // dimension of the (square) matrix
+    TypedWorkSpace<T>   chol;   // factored matrix; L in lower triangle
+    TypedWorkSpace<T>   lowerA; // lower triangle of the matrix that L factors
+    TypedWorkSpace<T>   work;   // condition estimator work space (3n)
+    TypedWorkSpace<int> iwork;  //   "                             (n)
+
+}; // end class FactorCholeskyRep
+
+} // namespace SimTK
+
+#endif   // SimTK_SIMMATH_FACTOR_CHOLESKY_REP_H_
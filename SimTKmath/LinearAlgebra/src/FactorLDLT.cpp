@@ -0,0 +1,458 @@
+/* -------------------------------------------------------------------------- *
+ *                        Simbody(tm): SimTKmath                              *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2018 Stanford University and the Authors.           *
+ * Authors: Simbody developers                                                *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+/**@file
+ *
+ * Symmetrically pivoted LDL' factorization with 1x1 and 2x2 pivots and rank
+ * detection.
+ */
+
+#include "SimTKcommon.h"
+
+#include "simmath/internal/common.h"
+#include "simmath/LinearAlgebra.h"
+
+#include "FactorLDLTRep.h"
+#include "WorkSpace.h"
+#include "LATraits.h"
+#include "LapackConvert.h"
+
+#include <iostream>
+#include <cmath>
+#include <utility>
+
+
+namespace SimTK {
+
+   ///////////////////////
+   // FactorLDLTDefault //
+   ///////////////////////
+FactorLDLTDefault::FactorLDLTDefault() {
+    isFactored = false;
+}
+FactorLDLTRepBase* FactorLDLTDefault::clone() const {
+    return( new FactorLDLTDefault(*this));
+}
+
+   ////////////////
+   // FactorLDLT //
+   ////////////////
+FactorLDLT::~FactorLDLT() {
+    delete rep;
+}
+// default constructor
+FactorLDLT::FactorLDLT() {
+    rep = new FactorLDLTDefault();
+}
+// copy constructor
+FactorLDLT::FactorLDLT( const FactorLDLT& c ) {
+    rep = c.rep->clone();
+}
+// copy assignment operator
+FactorLDLT& FactorLDLT::operator=(const FactorLDLT& rhs) {
+    if (&rhs != this) {
+        delete rep;
+        rep = rhs.rep->clone();
+    }
+    return *this;
+}
+
+// If the user does not supply rcond we use n*eps^(7/8), the same default
+// as FactorQTZ.
+template < class ELT >
+FactorLDLT::FactorLDLT( const Matrix_<ELT>& m ) {
+    rep = new FactorLDLTRep<typename CNT<ELT>::StdNumber>
+        (m, m.nrow()*NTraits<typename CNT<ELT>::Precision>::getSignificant());
+}
+template < class ELT >
+FactorLDLT::FactorLDLT( const Matrix_<ELT>& m, double rcond ) {
+    rep = new FactorLDLTRep<typename CNT<ELT>::StdNumber>
+        (m, (typename CNT<ELT>::Precision)rcond);
+}
+template < class ELT >
+void FactorLDLT::factor( const Matrix_<ELT>& m ) {
+    factor(m, m.nrow()*NTraits<typename CNT<ELT>::Precision>::getSignificant());
+}
+template < class ELT >
+void FactorLDLT::factor( const Matrix_<ELT>& m, double rcond ) {
+    // Refactor in place if the current rep has the right element type so
+    // that its storage gets reused.
+    typedef FactorLDLTRep<typename CNT<ELT>::StdNumber> Rep;
+    Rep* r = dynamic_cast<Rep*>(rep);
+    if (!r) {
+        delete rep;
+        rep = r = new Rep();
+    }
+    r->refactor(m, (typename CNT<ELT>::Precision)rcond);
+}
+template < class ELT >
+void FactorLDLT::solve( const Vector_<ELT>& b, Vector_<ELT>& x ) const {
+    rep->solve( b, x );
+}
+template < class ELT >
+void FactorLDLT::solve( const Matrix_<ELT>& b, Matrix_<ELT>& x ) const {
+    rep->solve( b, x );
+}
+template < class ELT >
+void FactorLDLT::inverse( Matrix_<ELT>& inverse ) const {
+    rep->inverse( inverse );
+}
+template < class ELT >
+void FactorLDLT::getL( Matrix_<ELT>& l ) const {
+    rep->getL( l );
+}
+template < class ELT >
+void FactorLDLT::getD( Vector_<ELT>& d ) const {
+    rep->getD( d );
+}
+template < class ELT >
+void FactorLDLT::getDSubdiagonal( Vector_<ELT>& e ) const {
+    rep->getDSubdiagonal( e );
+}
+void FactorLDLT::getPivots( Array_<int>& pivots ) const {
+    rep->checkIfFactored("getPivots");
+    pivots = rep->pivots;
+}
+int FactorLDLT::getRank() const {
+    return rep->rank;
+}
+bool FactorLDLT::isPositiveDefinite() const {
+    return rep->positiveDefinite;
+}
+double FactorLDLT::getRCondEstimate() const {
+    return rep->actualRCond;
+}
+
+   ///////////////////
+   // FactorLDLTRep //
+   ///////////////////
+template <typename T >
+FactorLDLTRep<T>::FactorLDLTRep()
+:   n(0), rcond(NTraits<typename CNT<T>::Precision>::getSignificant()),
+    ldlt(0) {}
+
+template <typename T >
+    template < typename ELT >
+FactorLDLTRep<T>::FactorLDLTRep( const Matrix_<ELT>& mat,
+                                 typename CNT<T>::TReal rc )
+:   FactorLDLTRep()
+{
+    refactor( mat, rc );
+}
+
+// Size the buffers for this matrix and factor it. The buffers only grow, so
+// refactoring a matrix that is no bigger than the last one doesn't allocate.
+template <typename T >
+    template < typename ELT >
+void FactorLDLTRep<T>::refactor( const Matrix_<ELT>& mat,
+                                 typename CNT<T>::TReal rc ) {
+    isFactored = false;
+    n = mat.nrow();
+    rcond = rc;
+    ldlt.resize(mat.nrow()*mat.ncol());
+    FactorLDLTRep<T>::factor( mat );
+    isFactored = true;
+}
+
+template <typename T >
+FactorLDLTRep<T>::~FactorLDLTRep() {}
+
+template <typename T >
+FactorLDLTRepBase* FactorLDLTRep<T>::clone() const {
+    return( new FactorLDLTRep<T>(*this) );
+}
+
+// Right-looking factorization working on the lower triangle only (column
+// major, leading dimension n), using the complete pivoting strategy of Bunch
+// and Parlett. At step k let mu1 be the largest remaining diagonal magnitude
+// and mu0 the largest remaining off-diagonal magnitude. If mu1 >= alpha*mu0
+// we bring the largest diagonal element to position k with a symmetric row
+// and column swap and take a 1x1 pivot. Otherwise we bring the largest
+// off-diagonal element to position (k+1,k) and take the 2x2 pivot block
+// containing it, which is then necessarily indefinite. alpha=(1+sqrt(17))/8
+// bounds the growth of the trailing elements.
+//
+// The trailing matrix is negligible once its largest element is, so we stop
+// there; that is what makes this rank revealing for indefinite matrices like
+// [0 1;1 0] that have no usable diagonal pivots. For a positive semidefinite
+// matrix no off-diagonal element exceeds the largest diagonal so only 1x1
+// pivots are taken, in nonincreasing order.
+//
+// For a 2x2 pivot the off-diagonal element of D is kept in A(k+1,k), where a
+// 1x1 pivot would have had L(k+1,k); L(k+1,k) is zero in that case.
+template <class T>
+    template<typename ELT>
+void FactorLDLTRep<T>::factor( const Matrix_<ELT>& mat ) {
+    SimTK_APIARGCHECK2_ALWAYS(mat.nelt() > 0,"FactorLDLT","factor",
+       "Can't factor a matrix that has a zero dimension -- got %d X %d.",
+       (int)mat.nrow(), (int)mat.ncol());
+    SimTK_APIARGCHECK2_ALWAYS(mat.nrow()==mat.ncol(),"FactorLDLT","factor",
+       "Can't factor a matrix that is not square -- got %d X %d.",
+       (int)mat.nrow(), (int)mat.ncol());
+
+    typedef typename CNT<T>::TReal RealType;
+    const RealType alpha = RealType((1 + std::sqrt(17.)) / 8);
+
+    // converts (negated etc.) to LAPACK format
+    LapackConvert::convertMatrixToLapack( ldlt.data, mat );
+    T* const a = ldlt.data;
+    #define A(i,j) a[(j)*n+(i)]
+
+    pivots.resize(n);
+    for (int i=0; i < n; ++i) pivots[i] = i;
+    blockStart.assign(n, false);
+
+    // Symmetric interchange of rows and columns k and p>k, touching only the
+    // lower triangle (including already-computed L columns).
+    auto swapRowsAndCols = [&](int k, int p) {
+        if (p == k) return;
+        std::swap(pivots[k], pivots[p]);
+        for (int j=0; j < k; ++j)   std::swap(A(k,j), A(p,j));
+        std::swap(A(k,k), A(p,p));
+        for (int i=k+1; i < p; ++i) std::swap(A(i,k), A(p,i));
+        for (int i=p+1; i < n; ++i) std::swap(A(i,k), A(i,p));
+    };
+
+    RealType maxElt = 0, maxPivot = 0, minPivot = 0;
+    positiveDefinite = true;
+    rank = n;
+    int k = 0;
+    while (k < n) {
+        int p = k; RealType mu1 = std::abs(A(k,k));
+        for (int i=k+1; i < n; ++i)
+            if (std::abs(A(i,i)) > mu1) {p = i; mu1 = std::abs(A(i,i));}
+        int r = k, c = k; RealType mu0 = 0;
+        for (int j=k; j < n; ++j)
+            for (int i=j+1; i < n; ++i)
+                if (std::abs(A(i,j)) > mu0) {r = i; c = j; mu0 = std::abs(A(i,j));}
+
+        const RealType mu = std::max(mu0, mu1);
+        if (k == 0) maxElt = mu;
+        if (mu == 0 || mu <= rcond*maxElt) {rank = k; break;}
+
+        if (mu1 >= alpha*mu0) {
+            // 1x1 pivot.
+            swapRowsAndCols(k, p);
+            const T d = A(k,k);
+            if (d < 0) positiveDefinite = false;
+            if (k == 0) maxPivot = minPivot = mu1;
+            maxPivot = std::max(maxPivot, mu1);
+            minPivot = std::min(minPivot, mu1);
+            const T dinv = T(1)/d;
+
+            // Trailing update A22 -= l*d*~l, using column k before scaling
+            // (that is d*l) to save a multiply.
+            for (int j=k+1; j < n; ++j) {
+                const T dlj = A(j,k);
+                if (dlj == 0) continue;
+                const T lj = dlj*dinv;
+                for (int i=j; i < n; ++i)
+                    A(i,j) -= A(i,k)*lj;
+            }
+            for (int i=k+1; i < n; ++i)
+                A(i,k) *= dinv;
+            k += 1;
+            continue;
+        }
+
+        // 2x2 pivot; c < r so moving c first leaves r where it was.
+        swapRowsAndCols(k, c);
+        swapRowsAndCols(k+1, r);
+        blockStart[k] = true;
+        positiveDefinite = false;
+        const T e00 = A(k,k), e10 = A(k+1,k), e11 = A(k+1,k+1);
+        const T det = e00*e11 - e10*e10; // negative
+        // Eigenvalue magnitudes of the block, for the rcond estimate.
+        const RealType half = std::abs(e00+e11)/2,
+                       rad  = std::sqrt(square((e00-e11)/2) + e10*e10);
+        if (k == 0) maxPivot = minPivot = rad+half;
+        maxPivot = std::max(maxPivot, rad+half);
+        minPivot = std::min(minPivot, rad-half);
+
+        // With C the two pivot columns below the block, the trailing update
+        // is A22 -= C*E^-1*~C and L = C*E^-1.
+        for (int j=k+2; j < n; ++j) {
+            const T cj0 = A(j,k), cj1 = A(j,k+1);
+            if (cj0 == 0 && cj1 == 0) continue;
+            const T lj0 = (cj0*e11 - cj1*e10)/det,
+                    lj1 = (cj1*e00 - cj0*e10)/det;
+            for (int i=j; i < n; ++i)
+                A(i,j) -= A(i,k)*lj0 + A(i,k+1)*lj1;
+        }
+        for (int i=k+2; i < n; ++i) {
+            const T ci0 = A(i,k), ci1 = A(i,k+1);
+            A(i,k)   = (ci0*e11 - ci1*e10)/det;
+            A(i,k+1) = (ci1*e00 - ci0*e10)/det;
+        }
+        k += 2;
+    }
+    #undef A
+
+    if (rank < n) positiveDefinite = false;
+    actualRCond = rank ? double(minPivot/maxPivot) : 0.;
+}
+
+// Forward substitution with unit lower triangular L11, solve with the block
+// diagonal D1, back substitution with ~L11, then zero the components that
+// correspond to dropped pivots. L(j+1,j) is not stored (it is zero) when
+// j starts a 2x2 block; that slot holds D(j+1,j) instead.
+template <class T>
+void FactorLDLTRep<T>::doSolve( T* b, int nrhs, int ldb ) const {
+    const T* const a = ldlt.data;
+    for (int c=0; c < nrhs; ++c) {
+        T* y = b + c*ldb;
+        for (int j=0; j < rank; ++j) {
+            const T yj = y[j];
+            if (yj == 0) continue;
+            const T* lcol = a + j*n;
+            for (int i=j+1+blockStart[j]; i < rank; ++i)
+                y[i] -= lcol[i]*yj;
+        }
+        for (int j=0; j < rank; ++j) {
+            if (!blockStart[j]) {y[j] /= a[j*n+j]; continue;}
+            const T e00 = a[j*n+j], e10 = a[j*n+j+1], e11 = a[(j+1)*n+j+1];
+            const T det = e00*e11 - e10*e10;
+            const T y0 = y[j], y1 = y[j+1];
+            y[j]   = (e11*y0 - e10*y1)/det;
+            y[j+1] = (e00*y1 - e10*y0)/det;
+            ++j;
+        }
+        for (int j=rank-1; j >= 0; --j) {
+            const T* lcol = a + j*n;
+            T sum = y[j];
+            for (int i=j+1+blockStart[j]; i < rank; ++i)
+                sum -= lcol[i]*y[i];
+            y[j] = sum;
+        }
+        for (int i=rank; i < n; ++i)
+            y[i] = 0;
+    }
+}
+
+template < class T >
+void FactorLDLTRep<T>::solve( const Vector_<T>& b, Vector_<T>& x ) const {
+    checkIfFactored("solve");
+    SimTK_APIARGCHECK2_ALWAYS(b.size()==n,"FactorLDLT","solve",
+       "number of rows in right hand side=%d does not match number of rows in original matrix=%d \n",
+        b.size(), n );
+
+    TypedWorkSpace<T> y(n);
+    for (int i=0; i < n; ++i) y.data[i] = b[pivots[i]];
+    doSolve(y.data, 1, n);
+    x.resize(n);
+    for (int i=0; i < n; ++i) x[pivots[i]] = y.data[i];
+}
+
+template < class T >
+void FactorLDLTRep<T>::solve( const Matrix_<T>& b, Matrix_<T>& x ) const {
+    checkIfFactored("solve");
+    SimTK_APIARGCHECK2_ALWAYS(b.nrow()==n,"FactorLDLT","solve",
+       "number of rows in right hand side=%d does not match number of rows in original matrix=%d \n",
+        b.nrow(), n );
+
+    const int nrhs = b.ncol();
+    TypedWorkSpace<T> y(n*nrhs);
+    for (int j=0; j < nrhs; ++j)
+        for (int i=0; i < n; ++i) y.data[j*n+i] = b(pivots[i],j);
+    doSolve(y.data, nrhs, n);
+    x.resize(n, nrhs);
+    for (int j=0; j < nrhs; ++j)
+        for (int i=0; i < n; ++i) x(pivots[i],j) = y.data[j*n+i];
+}
+
+template < class T >
+void FactorLDLTRep<T>::inverse( Matrix_<T>& inverse ) const {
+    Matrix_<T> iden(n,n);
+    iden = 1.0;
+    solve( iden, inverse );
+}
+
+template < class T >
+void FactorLDLTRep<T>::getL( Matrix_<T>& l ) const {
+    l.resize(n, rank);
+    for (int j=0; j < rank; ++j) {
+        for (int i=0; i < j; ++i) l(i,j) = 0;
+        l(j,j) = 1;
+        for (int i=j+1; i < n; ++i) l(i,j) = ldlt.data[j*n+i];
+        if (blockStart[j]) l(j+1,j) = 0;
+    }
+}
+
+template < class T >
+void FactorLDLTRep<T>::getD( Vector_<T>& d ) const {
+    d.resize(rank);
+    for (int i=0; i < rank; ++i) d[i] = ldlt.data[i*n+i];
+}
+
+template < class T >
+void FactorLDLTRep<T>::getDSubdiagonal( Vector_<T>& e ) const {
+    e.resize(std::max(rank-1, 0));
+    for (int i=0; i < rank-1; ++i)
+        e[i] = blockStart[i] ? ldlt.data[i*n+i+1] : T(0);
+}
+
+// instantiate
+template SimTK_SIMMATH_EXPORT FactorLDLT::FactorLDLT( const Matrix_<double>& m );
+template SimTK_SIMMATH_EXPORT FactorLDLT::FactorLDLT( const Matrix_<float>& m );
+template SimTK_SIMMATH_EXPORT FactorLDLT::FactorLDLT( const Matrix_<negator< double> >& m );
+template SimTK_SIMMATH_EXPORT FactorLDLT::FactorLDLT( const Matrix_<negator< float> >& m );
+template SimTK_SIMMATH_EXPORT FactorLDLT::FactorLDLT( const Matrix_<double>& m, double rcond );
+template SimTK_SIMMATH_EXPORT FactorLDLT::FactorLDLT( const Matrix_<float>& m, double rcond );
+template SimTK_SIMMATH_EXPORT FactorLDLT::FactorLDLT( const Matrix_<negator< double> >& m, double rcond );
+template SimTK_SIMMATH_EXPORT FactorLDLT::FactorLDLT( const Matrix_<negator< float> >& m, double rcond );
+
+template SimTK_SIMMATH_EXPORT void FactorLDLT::factor( const Matrix_<double>& m );
+template SimTK_SIMMATH_EXPORT void FactorLDLT::factor( const Matrix_<float>& m );
+template SimTK_SIMMATH_EXPORT void FactorLDLT::factor( const Matrix_<negator< double> >& m );
+template SimTK_SIMMATH_EXPORT void FactorLDLT::factor( const Matrix_<negator< float> >& m );
+template SimTK_SIMMATH_EXPORT void FactorLDLT::factor( const Matrix_<double>& m, double rcond );
+template SimTK_SIMMATH_EXPORT void FactorLDLT::factor( const Matrix_<float>& m, double rcond );
+template SimTK_SIMMATH_EXPORT void FactorLDLT::factor( const Matrix_<negator< double> >& m, double rcond );
+template SimTK_SIMMATH_EXPORT void FactorLDLT::factor( const Matrix_<negator< float> >& m, double rcond );
+
+template class FactorLDLTRep<double>;
+template FactorLDLTRep<double>::FactorLDLTRep( const Matrix_<double>& m, double rcond );
+template FactorLDLTRep<double>::FactorLDLTRep( const Matrix_<negator<double> >& m, double rcond );
+template void FactorLDLTRep<double>::factor( const Matrix_<double>& m );
+template void FactorLDLTRep<double>::factor( const Matrix_<negator<double> >& m );
+
+template class FactorLDLTRep<float>;
+template FactorLDLTRep<float>::FactorLDLTRep( const Matrix_<float>& m, float rcond );
+template FactorLDLTRep<float>::FactorLDLTRep( const Matrix_<negator<float> >& m, float rcond );
+template void FactorLDLTRep<float>::factor( const Matrix_<float>& m );
+template void FactorLDLTRep<float>::factor( const Matrix_<negator<float> >& m );
+
+template SimTK_SIMMATH_EXPORT void FactorLDLT::solve<float>(const Vector_<float>&, Vector_<float>&) const;
+template SimTK_SIMMATH_EXPORT void FactorLDLT::solve<double>(const Vector_<double>&, Vector_<double>&) const;
+template SimTK_SIMMATH_EXPORT void FactorLDLT::solve<float>(const Matrix_<float>&, Matrix_<float>&) const;
+template SimTK_SIMMATH_EXPORT void FactorLDLT::solve<double>(const Matrix_<double>&, Matrix_<double>&) const;
+template SimTK_SIMMATH_EXPORT void FactorLDLT::inverse<float>(Matrix_<float>&) const;
+template SimTK_SIMMATH_EXPORT void FactorLDLT::inverse<double>(Matrix_<double>&) const;
+template SimTK_SIMMATH_EXPORT void FactorLDLT::getL<float>(Matrix_<float>&) const;
+template SimTK_SIMMATH_EXPORT void FactorLDLT::getL<double>(Matrix_<double>&) const;
+template SimTK_SIMMATH_EXPORT void FactorLDLT::getD<float>(Vector_<float>&) const;
+template SimTK_SIMMATH_EXPORT void FactorLDLT::getD<double>(Vector_<double>&) const;
+template SimTK_SIMMATH_EXPORT void FactorLDLT::getDSubdiagonal<float>(Vector_<float>&) const;
+template SimTK_SIMMATH_EXPORT void FactorLDLT::getDSubdiagonal<double>(Vector_<double>&) const;
+
+} // namespace SimTK
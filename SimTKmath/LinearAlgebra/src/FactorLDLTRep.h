@@ -0,0 +1,155 @@
+#ifndef SimTK_SIMMATH_FACTOR_LDLT_REP_H_
+#define SimTK_SIMMATH_FACTOR_LDLT_REP_H_
+
+/* -------------------------------------------------------------------------- *
+ *                        Simbody(tm): SimTKmath                              *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2018 Stanford University and the Authors.           *
+ * Authors: Simbody developers                                                *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+#include "SimTKmath.h"
+#include "WorkSpace.h"
+
+namespace SimTK {
+
+class FactorLDLTRepBase {
+public:
+    FactorLDLTRepBase()
+    :   isFactored(false), rank(0), positiveDefinite(false), actualRCond(0) {}
+
+    virtual ~FactorLDLTRepBase(){};
+
+    virtual FactorLDLTRepBase* clone() const { return 0; };
+
+    virtual void solve( const Vector_<float>& b, Vector_<float>& x ) const {
+        checkIfFactored("solve");
+        SimTK_APIARGCHECK_ALWAYS(false,"FactorLDLT","solve",
+        "solve called with rhs of type <float>  which does not match type of original linear system \n");
+    }
+    virtual void solve( const Vector_<double>& b, Vector_<double>& x ) const {
+        checkIfFactored("solve");
+        SimTK_APIARGCHECK_ALWAYS(false,"FactorLDLT","solve",
+        "solve called with rhs of type <double>  which does not match type of original linear system \n");
+    }
+    virtual void solve( const Matrix_<float>& b, Matrix_<float>& x ) const {
+        checkIfFactored("solve");
+        SimTK_APIARGCHECK_ALWAYS(false,"FactorLDLT","solve",
+        "solve called with rhs of type <float>  which does not match type of original linear system \n");
+    }
+    virtual void solve( const Matrix_<double>& b, Matrix_<double>& x ) const {
+        checkIfFactored("solve");
+        SimTK_APIARGCHECK_ALWAYS(false,"FactorLDLT","solve",
+        "solve called with rhs of type <double>  which does not match type of original linear system \n");
+    }
+    virtual void getL( Matrix_<float>& l ) const {
+        checkIfFactored("getL");
+        SimTK_APIARGCHECK_ALWAYS(false,"FactorLDLT","getL",
+        "getL called with L of type <float> which does not match type of original linear system \n");
+    }
+    virtual void getL( Matrix_<double>& l ) const {
+        checkIfFactored("getL");
+        SimTK_APIARGCHECK_ALWAYS(false,"FactorLDLT","getL",
+        "getL called with L of type <double> which does not match type of original linear system \n");
+    }
+    virtual void getD( Vector_<float>& d ) const {
+        checkIfFactored("getD");
+        SimTK_APIARGCHECK_ALWAYS(false,"FactorLDLT","getD",
+        "getD called with D of type <float> which does not match type of original linear system \n");
+    }
+    virtual void getD( Vector_<double>& d ) const {
+        checkIfFactored("getD");
+        SimTK_APIARGCHECK_ALWAYS(false,"FactorLDLT","getD",
+        "getD called with D of type <double> which does not match type of original linear system \n");
+    }
+    virtual void getDSubdiagonal( Vector_<float>& e ) const {
+        checkIfFactored("getDSubdiagonal");
+        SimTK_APIARGCHECK_ALWAYS(false,"FactorLDLT","getDSubdiagonal",
+        "getDSubdiagonal called with e of type <float> which does not match type of original linear system \n");
+    }
+    virtual void getDSubdiagonal( Vector_<double>& e ) const {
+        checkIfFactored("getDSubdiagonal");
+        SimTK_APIARGCHECK_ALWAYS(false,"FactorLDLT","getDSubdiagonal",
+        "getDSubdiagonal called with e of type <double> which does not match type of original linear system \n");
+    }
+    virtual void inverse( Matrix_<float>& inverse ) const {
+        checkIfFactored("inverse");
+        SimTK_APIARGCHECK_ALWAYS(false,"FactorLDLT","inverse",
+        "inverse( <float> ) called with type that is inconsistent with the original matrix  \n");
+    }
+    virtual void inverse( Matrix_<double>& inverse ) const {
+        checkIfFactored("inverse");
+        SimTK_APIARGCHECK_ALWAYS(false,"FactorLDLT","inverse",
+        "inverse( <double> ) called with type that is inconsistent with the original matrix  \n");
+    }
+
+    bool        isFactored;
+    int         rank;             // number of pivots retained
+    bool        positiveDefinite; // full rank with all 1x1 pivots > 0
+    double      actualRCond;      // min/max retained pivot magnitude
+    Array_<int>  pivots;          // row i of P*A*~P is row pivots[i] of A
+    Array_<bool> blockStart;      // true where a 2x2 pivot block starts
+
+    void checkIfFactored(const char* where) const {
+        SimTK_APIARGCHECK_ALWAYS(isFactored,"FactorLDLT",where,
+        "No matrix was passed to FactorLDLT. \n");
+    }
+
+}; // class FactorLDLTRepBase
+
+class FactorLDLTDefault : public FactorLDLTRepBase {
+public:
+    FactorLDLTDefault();
+    FactorLDLTRepBase* clone() const override;
+};
+
+template <typename T>
+class FactorLDLTRep : public FactorLDLTRepBase {
+public:
+    template <class ELT> FactorLDLTRep( const Matrix_<ELT>&, typename CNT<T>::TReal );
+    FactorLDLTRep();
+
+    ~FactorLDLTRep();
+
+    template <class ELT> void factor( const Matrix_<ELT>& );
+    template <class ELT> void refactor( const Matrix_<ELT>&,
+                                        typename CNT<T>::TReal rcond );
+    void solve( const Vector_<T>& b, Vector_<T>& x ) const override;
+    void solve( const Matrix_<T>& b, Matrix_<T>& x ) const override;
+    void getL( Matrix_<T>& l ) const override;
+    void getD( Vector_<T>& d ) const override;
+    void getDSubdiagonal( Vector_<T>& e ) const override;
+    void inverse( Matrix_<T>& ) const override;
+
+    FactorLDLTRepBase* clone() const override;
+
+private:
+    // Solve in place with b already permuted; b has n rows.
+    void doSolve( T* b, int nrhs, int ldb ) const;
+
+    int                         n;      // dimension of the (square) matrix
+    typename CNT<T>::TReal      rcond;  // pivots smaller than rcond*max drop
+    TypedWorkSpace<T>           ldlt;   // L below diagonal, D on diagonal
+                                        //   (and subdiagonal of 2x2 blocks)
+
+}; // end class FactorLDLTRep
+
+} // namespace SimTK
+
+#endif   // SimTK_SIMMATH_FACTOR_LDLT_REP_H_
@@ -79,23 +79,34 @@ template <typename ELT>
 void FactorQTZ::inverse( Matrix_<ELT>& inverse ) const {
     rep->inverse( inverse );
 }
+// Return the current rep if it is a FactorQTZRep for this element type, so
+// that its storage can be reused; otherwise replace it with an empty one.
+template < class T >
+static FactorQTZRep<T>* updRepForRefactor( FactorQTZRepBase*& rep ) {
+    FactorQTZRep<T>* r = dynamic_cast<FactorQTZRep<T>*>(rep);
+    if (!r) {
+        delete rep;
+        rep = r = new FactorQTZRep<T>();
+    }
+    return r;
+}
+
 template < class ELT >
 void FactorQTZ::factor( const Matrix_<ELT>& m ){
-    delete rep;
-  
     // if user does not supply rcond set it to max(nRow,nCol)*(eps)^7/8 (similar to matlab)
     int mnmax = (m.nrow() > m.ncol()) ? m.nrow() : m.ncol();
-    rep = new FactorQTZRep<typename CNT<ELT>::StdNumber>(m, mnmax*NTraits<typename CNT<ELT>::Precision>::getSignificant());
+    updRepForRefactor<typename CNT<ELT>::StdNumber>(rep)->refactor
+        (m, mnmax*NTraits<typename CNT<ELT>::Precision>::getSignificant());
 }
 template < class ELT >
 void FactorQTZ::factor( const Matrix_<ELT>& m, double rcond ){
-    delete rep;
-    rep = new FactorQTZRep<typename CNT<ELT>::StdNumber>(m, rcond );
+    typedef typename CNT<ELT>::StdNumber T;
+    updRepForRefactor<T>(rep)->refactor(m, (typename CNT<T>::TReal)rcond);
 }
 template < class ELT >
 void FactorQTZ::factor( const Matrix_<ELT>& m, float rcond ){
-    delete rep;
-    rep = new FactorQTZRep<typename CNT<ELT>::StdNumber>(m, rcond );
+    typedef typename CNT<ELT>::StdNumber T;
+    updRepForRefactor<T>(rep)->refactor(m, (typename CNT<T>::TReal)rcond);
 }
 template < class ELT >
 FactorQTZ::FactorQTZ( const Matrix_<ELT>& m ) {
@@ -146,28 +157,45 @@ FactorQTZRep<T>::FactorQTZRep()
     pivots(0),
     qtz(0),
     tauGEQP3(0),
-    tauORMQR(0)
+    tauORMQR(0),
+    workRows(-1),
+    workCols(-1)
 { 
 } 
 
 template <typename T >
     template < typename ELT >
 FactorQTZRep<T>::FactorQTZRep( const Matrix_<ELT>& mat, typename CNT<T>::TReal rc) 
-:   mn( (mat.nrow() < mat.ncol()) ? mat.nrow() : mat.ncol() ),
-    maxmn( (mat.nrow() > mat.ncol()) ? mat.nrow() : mat.ncol() ),
-    nRow( mat.nrow() ),
-    nCol( mat.ncol() ),
-    scaleLinSys(false),
-    linSysScaleF(NTraits<typename CNT<T>::Precision>::getNaN()),
-    anrm(NTraits<typename CNT<T>::Precision>::getNaN()),
-    rcond(rc),
-    pivots(mat.ncol()),
-    qtz( mat.nrow()*mat.ncol() ),
-    tauGEQP3(mn),
-    tauORMQR(mn)    
+:   FactorQTZRep()
 { 
-    for(int i=0; i<mat.ncol(); ++i) 
+    refactor( mat, rc );
+}
+
+// Size the buffers for this matrix and factor it. The buffers only grow, so
+// refactoring a matrix that is no bigger than the last one doesn't allocate.
+template <typename T >
+    template < typename ELT >
+void FactorQTZRep<T>::refactor( const Matrix_<ELT>& mat, typename CNT<T>::TReal rc) {
+    nRow  = mat.nrow();
+    nCol  = mat.ncol();
+    mn    = std::min(nRow, nCol);
+    maxmn = std::max(nRow, nCol);
+    rcond = rc;
+    scaleLinSys  = false;
+    linSysScaleF = NTraits<typename CNT<T>::Precision>::getNaN();
+    rank = 0;
+    actualRCond = 0;
+    isFactored = false;
+
+    pivots.resize(nCol);
+    for(int i=0; i<nCol; ++i) 
         pivots.data[i] = 0;
+    qtz.resize(nRow*nCol);
+    tauGEQP3.resize(mn);
+    tauORMQR.resize(mn);
+    xSmall.resize(mn);
+    xLarge.resize(mn);
+
     FactorQTZRep<T>::factor( mat );
     isFactored = true;
 }
@@ -340,16 +368,20 @@ void FactorQTZRep<T>::factor(const Matrix_<ELT>&mat )  {
 
     // Compute optimal size for work space for dtzrzf and dgepq3. The
     // arguments here should match the calls below, although we'll use maxRank
-    // rather than rank since we don't know the rank yet.
-    T workSz;
-    const int maxRank = std::min(nRow, nCol);
-    LapackInterface::tzrzf<T>(maxRank, nCol, 0, nRow, 0, &workSz, -1, info);
-    const int lwork1 = (int)NTraits<T>::real(workSz);
-
-    LapackInterface::geqp3<T>(nRow, nCol, 0, nRow, 0, 0, &workSz, -1, info);
-    const int lwork2 = (int)NTraits<T>::real(workSz);
+    // rather than rank since we don't know the rank yet. The answer depends
+    // only on the dimensions so we ask only when they change.
+    if (nRow != workRows || nCol != workCols) {
+        T workSz;
+        const int maxRank = std::min(nRow, nCol);
+        LapackInterface::tzrzf<T>(maxRank, nCol, 0, nRow, 0, &workSz, -1, info);
+        const int lwork1 = (int)NTraits<T>::real(workSz);
+
+        LapackInterface::geqp3<T>(nRow, nCol, 0, nRow, 0, 0, &workSz, -1, info);
+        const int lwork2 = (int)NTraits<T>::real(workSz);
    
-    TypedWorkSpace<T> work(std::max(lwork1, lwork2));
+        work.resize(std::max(lwork1, lwork2));
+        workRows = nRow; workCols = nCol;
+    }
 
     LapackInterface::getMachinePrecision<RealType>( smlnum, bignum);
 
@@ -388,26 +420,26 @@ void FactorQTZRep<T>::factor(const Matrix_<ELT>&mat )  {
             RealType smaxpr,sminpr;
 
             // Determine rank using incremental condition estimate
-            Array_<T> xSmall(mn), xLarge(mn); // temporaries
-            xSmall[0] = xLarge[0] = 1;
+            T* const xs = xSmall.data; T* const xl = xLarge.data;
+            xs[0] = xl[0] = 1;
             for (rank=1,smaxpr=0.0,sminpr=1.0; 
                  rank<mn && smaxpr*rcond < sminpr; ) 
             {
                 LapackInterface::laic1<T>(smallestSingularValue, rank, 
-                    xSmall.begin(), smin, &qtz.data[rank*nRow], 
+                    xs, smin, &qtz.data[rank*nRow], 
                     qtz.data[(rank*nRow)+rank], sminpr, s1, c1);
 
                 LapackInterface::laic1<T>(largestSingularValue, rank, 
-                    xLarge.begin(), smax, &qtz.data[rank*nRow], 
+                    xl, smax, &qtz.data[rank*nRow], 
                     qtz.data[(rank*nRow)+rank], smaxpr, s2, c2);
 
                 if (smaxpr*rcond < sminpr) {
                     for(int i=0; i<rank; i++) {
-                         xSmall[i] *= s1;
-                         xLarge[i] *= s2;
+                         xs[i] *= s1;
+                         xl[i] *= s2;
                     }
-                    xSmall[rank] = c1;
-                    xLarge[rank] = c2;
+                    xs[rank] = c1;
+                    xl[rank] = c2;
                     smin = sminpr;
                     smax = smaxpr;
                     actualRCond = (double)(smin/smax);
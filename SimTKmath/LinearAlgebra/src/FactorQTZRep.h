@@ -123,6 +123,7 @@ public:
    ~FactorQTZRep();
 
    template < class ELT > void factor(const Matrix_<ELT>& ); 
+   template < class ELT > void refactor(const Matrix_<ELT>&, typename CNT<T>::TReal );
    void inverse( Matrix_<T>& ) const override; 
    void solve( const Vector_<T>& b, Vector_<T>& x ) const override;
    void solve( const Matrix_<T>& b, Matrix_<T>& x ) const override;
@@ -145,6 +146,12 @@ private:
    TypedWorkSpace<T>        tauGEQP3;
    TypedWorkSpace<T>        tauORMQR;
 
+   // Work space kept between factorizations; work is sized for a
+   // workRows x workCols matrix.
+   TypedWorkSpace<T>        work;
+   int                      workRows, workCols;
+   TypedWorkSpace<T>        xSmall, xLarge; // rank estimation
+
 }; // end class FactorQTZRep
 
 } // namespace SimTK
@@ -109,24 +109,34 @@ FactorSVD::FactorSVD( const Matrix_<ELT>& m, float rcond ) {
     rep = new FactorSVDRep<typename CNT<ELT>::StdNumber>(m, rcond);
 }
 
+// Refactor in place if the current rep has the right element type so that
+// its storage gets reused; otherwise replace it.
+template < class T, class ELT >
+static void refactorSVD( FactorSVDRepBase*& rep, const Matrix_<ELT>& m,
+                         typename CNT<T>::TReal rcond ) {
+    FactorSVDRep<T>* r = dynamic_cast<FactorSVDRep<T>*>(rep);
+    if (r) {
+        r->refactor(m, rcond);
+    } else {
+        delete rep;
+        rep = new FactorSVDRep<T>(m, rcond);
+    }
+}
+
 template < class ELT >
 void FactorSVD::factor( const Matrix_<ELT>& m ) {
-    delete rep;
-
     // if user does not supply rcond set it to max(nRow,nCol)*(eps)^7/8 (similar to matlab)
     int mnmax = (m.nrow() > m.ncol()) ? m.nrow() : m.ncol();
-    rep = new FactorSVDRep<typename CNT<ELT>::StdNumber>(m, mnmax*NTraits<typename CNT<ELT>::Precision>::getSignificant()); 
+    refactorSVD<typename CNT<ELT>::StdNumber>(rep, m, mnmax*NTraits<typename CNT<ELT>::Precision>::getSignificant()); 
 }
 
 template < class ELT >
 void FactorSVD::factor( const Matrix_<ELT>& m, double rcond ){
-    delete rep;
-    rep = new FactorSVDRep<typename CNT<ELT>::StdNumber>(m, rcond );
+    refactorSVD<typename CNT<ELT>::StdNumber>(rep, m, rcond );
 }
 template < class ELT >
 void FactorSVD::factor( const Matrix_<ELT>& m, float rcond ){
-    delete rep;
-    rep = new FactorSVDRep<typename CNT<ELT>::StdNumber>(m, rcond );
+    refactorSVD<typename CNT<ELT>::StdNumber>(rep, m, rcond );
 }
 
 template <class T> 
@@ -165,6 +175,22 @@ FactorSVDRep<T>::FactorSVDRep( const Matrix_<ELT>& mat, typename CNT<T>::TReal r
     isFactored = true;
         
 }
+// Reuse this rep for a new matrix; the buffers only grow.
+template <typename T >
+    template < typename ELT >
+void FactorSVDRep<T>::refactor( const Matrix_<ELT>& mat, typename CNT<T>::TReal rc) {
+    nCol  = mat.ncol();
+    nRow  = mat.nrow();
+    mn    = std::min(nRow, nCol);
+    maxmn = std::max(nRow, nCol);
+    rank  = 0;
+    rcond = rc;
+    structure = mat.getMatrixCharacter().getStructure();
+    singularValues.resize(mn);
+    inputMatrix.resize(nCol*nRow);
+    LapackConvert::convertMatrixToLapack( inputMatrix.data, mat );
+    isFactored = true;
+}
 template <typename T >
 int FactorSVDRep<T>::getRank() {
 
@@ -159,6 +159,7 @@ template <typename T>
 class FactorSVDRep : public FactorSVDRepBase {
    public:
    template <class ELT> FactorSVDRep( const Matrix_<ELT>&, typename CNT<T>::TReal  );
+   template <class ELT> void refactor( const Matrix_<ELT>&, typename CNT<T>::TReal  );
 
     ~FactorSVDRep();
     FactorSVDRepBase* clone() const override;
@@ -0,0 +1,635 @@
+/* -------------------------------------------------------------------------- *
+ *                        Simbody(tm): SimTKmath                              *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2018 Stanford University and the Authors.           *
+ * Authors: Simbody developers                                                *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+/**@file
+ *
+ * Fill-reducing ordering and sparse direct factorizations of SparseMatrix.
+ */
+
+#include "SimTKcommon.h"
+
+#include "simmath/internal/common.h"
+#include "simmath/SparseMatrix.h"
+
+#include "FactorSparseRep.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+#include <set>
+#include <utility>
+#include <vector>
+
+
+namespace SimTK {
+
+//==============================================================================
+//                       MINIMUM DEGREE ORDERING
+//==============================================================================
+// Classic minimum degree on the explicit elimination graph: repeatedly
+// eliminate a node of least degree and turn its neighbors into a clique.
+// This is simpler than the quotient graph and approximate degrees used by
+// AMD and produces orderings of similar quality; it is slower on very large
+// problems with a lot of fill, but the matrices we see are modest in size.
+void calcMinimumDegreeOrdering(const SparseMatrix& A, Array_<int>& perm) {
+    SimTK_APIARGCHECK2_ALWAYS(A.nrow() == A.ncol(),
+        "SimTK", "calcMinimumDegreeOrdering",
+        "Matrix must be square but was %d x %d.", A.nrow(), A.ncol());
+
+    const int n = A.ncol();
+    const SparseMatrix S = A.plusTranspose();
+    const Array_<int>& Sp = S.getColumnStarts();
+    const Array_<int>& Si = S.getRowIndices();
+
+    // Sorted adjacency lists without the diagonal.
+    std::vector<std::vector<int> > adj(n);
+    for (int j=0; j < n; ++j) {
+        adj[j].reserve(Sp[j+1]-Sp[j]);
+        for (int p=Sp[j]; p < Sp[j+1]; ++p)
+            if (Si[p] != j) adj[j].push_back(Si[p]);
+    }
+
+    // Ordered by (degree, index) so ties go to the lowest index.
+    std::set<std::pair<int,int> > queue;
+    for (int j=0; j < n; ++j)
+        queue.insert(std::make_pair((int)adj[j].size(), j));
+
+    perm.clear();
+    perm.reserve(n);
+    std::vector<int> merged;
+    while (!queue.empty()) {
+        const int v = queue.begin()->second;
+        queue.erase(queue.begin());
+        perm.push_back(v);
+
+        const std::vector<int>& nv = adj[v];
+        for (int u : nv) {
+            queue.erase(std::make_pair((int)adj[u].size(), u));
+            merged.clear();
+            std::set_union(adj[u].begin(), adj[u].end(), nv.begin(), nv.end(),
+                           std::back_inserter(merged));
+            merged.erase(std::remove_if(merged.begin(), merged.end(),
+                                        [u,v](int w) {return w==u || w==v;}),
+                         merged.end());
+            adj[u].swap(merged);
+            queue.insert(std::make_pair((int)adj[u].size(), u));
+        }
+        std::vector<int>().swap(adj[v]);
+    }
+}
+
+// Return the pattern of ~A*A (values are all zero), used for ordering the
+// columns of an unsymmetric matrix that will be factored with partial
+// pivoting.
+static SparseMatrix calcAtAPattern(const SparseMatrix& A) {
+    const int n = A.ncol();
+    const SparseMatrix At = A.transpose();
+    const Array_<int>& Ap  = A.getColumnStarts();
+    const Array_<int>& Ai  = A.getRowIndices();
+    const Array_<int>& Atp = At.getColumnStarts();
+    const Array_<int>& Ati = At.getRowIndices();
+
+    Array_<int> colStart(n+1, 0), rowIndex;
+    Array_<int> mark(n, -1);
+    for (int j=0; j < n; ++j) {
+        colStart[j] = (int)rowIndex.size();
+        const int first = (int)rowIndex.size();
+        for (int p=Ap[j]; p < Ap[j+1]; ++p) {
+            const int i = Ai[p];
+            for (int q=Atp[i]; q < Atp[i+1]; ++q) {
+                const int k = Ati[q];
+                if (mark[k] != j) {mark[k] = j; rowIndex.push_back(k);}
+            }
+        }
+        std::sort(rowIndex.begin()+first, rowIndex.end());
+    }
+    colStart[n] = (int)rowIndex.size();
+    return SparseMatrix(n, n, colStart, rowIndex,
+                        Array_<Real>(rowIndex.size(), Real(0)));
+}
+
+static void calcOrdering(const SparseMatrix& A, SparseOrdering ordering,
+                         Array_<int>& perm) {
+    if (ordering == SparseOrderingMinimumDegree)
+        calcMinimumDegreeOrdering(A, perm);
+    else {
+        perm.resize(A.ncol());
+        for (int k=0; k < A.ncol(); ++k) perm[k] = k;
+    }
+}
+
+
+
+//==============================================================================
+//                          SPARSE CHOLESKY REP
+//==============================================================================
+
+// Nonzero pattern of row k of L, which is the set of nodes reachable in the
+// elimination tree from the nonzeros above the diagonal in column k of C.
+// The pattern is returned in s[top..n-1] in topological order. Entries of w
+// equal to k mark nodes already visited for this row.
+static int ereach(const Array_<int>& Cp, const Array_<int>& Ci, int k,
+                  const Array_<int>& parent, Array_<int>& s, Array_<int>& w)
+{
+    const int n = (int)parent.size();
+    int top = n;
+    w[k] = k;
+    for (int p=Cp[k]; p < Cp[k+1]; ++p) {
+        int i = Ci[p];
+        if (i > k) continue;
+        int len = 0;
+        for (; w[i] != k; i = parent[i]) {
+            s[len++] = i;
+            w[i] = k;
+        }
+        while (len > 0) s[--top] = s[--len];
+    }
+    return top;
+}
+
+void FactorSparseCholeskyRep::
+analyze(const SparseMatrix& A, SparseOrdering ordering) {
+    SimTK_APIARGCHECK2_ALWAYS(A.nrow() == A.ncol(),
+        "FactorSparseCholesky", "factor",
+        "Matrix must be square but was %d x %d.", A.nrow(), A.ncol());
+
+    n = A.ncol();
+    nnzA = A.getNumNonzeros();
+    isFactored = positiveDefinite = false;
+
+    // Keep the pattern so refactor() can check that it hasn't changed.
+    Ap = A.getColumnStarts();
+    Ai = A.getRowIndices();
+
+    calcOrdering(A, ordering, perm);
+    pinv.resize(n);
+    for (int k=0; k < n; ++k) pinv[perm[k]] = k;
+
+    // Map the lower triangle of A to the upper triangle of C = P*A*~P.
+    Cp.assign(n+1, 0);
+    Cmap.assign(nnzA, -1);
+    for (int j=0; j < n; ++j)
+        for (int p=Ap[j]; p < Ap[j+1]; ++p) {
+            const int i = Ai[p];
+            if (i < j) continue;
+            ++Cp[std::max(pinv[i], pinv[j]) + 1];
+        }
+    for (int k=0; k < n; ++k) Cp[k+1] += Cp[k];
+    Ci.resize(Cp[n]);
+    Array_<int> next(Cp.begin(), Cp.end()-1);
+    for (int j=0; j < n; ++j)
+        for (int p=Ap[j]; p < Ap[j+1]; ++p) {
+            const int i = Ai[p];
+            if (i < j) continue;
+            const int pi = pinv[i], pj = pinv[j];
+            const int q = next[std::max(pi,pj)]++;
+            Ci[q] = std::min(pi,pj);
+            Cmap[p] = q;
+        }
+
+    // Elimination tree, with path compression through "ancestor".
+    parent.assign(n, -1);
+    Array_<int> ancestor(n, -1);
+    for (int k=0; k < n; ++k)
+        for (int p=Cp[k]; p < Cp[k+1]; ++p) {
+            int i = Ci[p];
+            while (i != -1 && i < k) {
+                const int inext = ancestor[i];
+                ancestor[i] = k;
+                if (inext == -1) parent[i] = k;
+                i = inext;
+            }
+        }
+
+    // Column counts of L from the row patterns. Each node in the pattern of
+    // row k gets an off-diagonal entry in its column.
+    Array_<int> count(n, 1), s(n), w(n, -1);
+    for (int k=0; k < n; ++k)
+        for (int top = ereach(Cp, Ci, k, parent, s, w); top < n; ++top)
+            ++count[s[top]];
+
+    Lp.resize(n+1);
+    Lp[0] = 0;
+    for (int k=0; k < n; ++k) Lp[k+1] = Lp[k] + count[k];
+    Li.resize(Lp[n]);
+    Lx.resize(Lp[n]);
+}
+
+void FactorSparseCholeskyRep::factorNumeric(const SparseMatrix& A) {
+    SimTK_APIARGCHECK4_ALWAYS(A.ncol() == n && A.nrow() == n
+                              && A.getNumNonzeros() == nnzA,
+        "FactorSparseCholesky", "refactor",
+        "Matrix is %d x %d with %d nonzeros; doesn't match the analyzed "
+        "pattern with dimension %d.", A.nrow(), A.ncol(),
+        A.getNumNonzeros(), n);
+    SimTK_APIARGCHECK_ALWAYS(A.getColumnStarts() == Ap
+                             && A.getRowIndices() == Ai,
+        "FactorSparseCholesky", "refactor",
+        "Matrix has the same number of nonzeros as the analyzed one but a "
+        "different sparsity pattern; use factor() instead. \n");
+
+    isFactored = true;
+    positiveDefinite = false;
+
+    const Array_<Real>& Ax = A.getValues();
+    Array_<Real> Cx(Ci.size());
+    for (int p=0; p < nnzA; ++p)
+        if (Cmap[p] >= 0) Cx[Cmap[p]] = Ax[p];
+
+    Array_<int>  c(Lp.begin(), Lp.end()-1);   // next free slot per column
+    Array_<int>  s(n), w(n, -1);
+    Array_<Real> x(n, Real(0));
+
+    for (int k=0; k < n; ++k) {
+        // Scatter column k of the upper triangle of C into x.
+        int top = ereach(Cp, Ci, k, parent, s, w);
+        x[k] = 0;
+        for (int p=Cp[k]; p < Cp[k+1]; ++p)
+            x[Ci[p]] += Cx[p];
+        Real d = x[k];
+        x[k] = 0;
+
+        // Solve L(0:k-1,0:k-1) * y = C(0:k-1,k) over the row pattern.
+        for (; top < n; ++top) {
+            const int i = s[top];
+            const Real lki = x[i] / Lx[Lp[i]];
+            x[i] = 0;
+            for (int p=Lp[i]+1; p < c[i]; ++p)
+                x[Li[p]] -= Lx[p]*lki;
+            d -= lki*lki;
+            const int p = c[i]++;
+            Li[p] = k;
+            Lx[p] = lki;
+        }
+
+        if (d <= 0) return; // not positive definite
+        const int p = c[k]++;
+        Li[p] = k;
+        Lx[p] = std::sqrt(d);
+    }
+    positiveDefinite = true;
+}
+
+void FactorSparseCholeskyRep::solveInPlace(Real* x) const {
+    for (int j=0; j < n; ++j) {
+        x[j] /= Lx[Lp[j]];
+        for (int p=Lp[j]+1; p < Lp[j+1]; ++p)
+            x[Li[p]] -= Lx[p]*x[j];
+    }
+    for (int j=n-1; j >= 0; --j) {
+        for (int p=Lp[j]+1; p < Lp[j+1]; ++p)
+            x[j] -= Lx[p]*x[Li[p]];
+        x[j] /= Lx[Lp[j]];
+    }
+}
+
+void FactorSparseCholeskyRep::solve(const Vector& b, Vector& x) const {
+    checkIfFactored("solve");
+    SimTK_APIARGCHECK_ALWAYS(positiveDefinite,"FactorSparseCholesky","solve",
+        "The matrix was not positive definite. \n");
+    SimTK_APIARGCHECK2_ALWAYS(b.size()==n,"FactorSparseCholesky","solve",
+       "number of rows in right hand side=%d does not match number of rows in original matrix=%d \n",
+        b.size(), n );
+
+    Array_<Real> y(n);
+    for (int k=0; k < n; ++k) y[k] = b[perm[k]];
+    solveInPlace(y.begin());
+    x.resize(n);
+    for (int k=0; k < n; ++k) x[perm[k]] = y[k];
+}
+
+void FactorSparseCholeskyRep::solve(const Matrix& b, Matrix& x) const {
+    checkIfFactored("solve");
+    SimTK_APIARGCHECK_ALWAYS(positiveDefinite,"FactorSparseCholesky","solve",
+        "The matrix was not positive definite. \n");
+    SimTK_APIARGCHECK2_ALWAYS(b.nrow()==n,"FactorSparseCholesky","solve",
+       "number of rows in right hand side=%d does not match number of rows in original matrix=%d \n",
+        b.nrow(), n );
+
+    x.resize(n, b.ncol());
+    Array_<Real> y(n);
+    for (int c=0; c < b.ncol(); ++c) {
+        for (int k=0; k < n; ++k) y[k] = b(perm[k], c);
+        solveInPlace(y.begin());
+        for (int k=0; k < n; ++k) x(perm[k], c) = y[k];
+    }
+}
+
+
+
+//==============================================================================
+//                             SPARSE LU REP
+//==============================================================================
+
+// Find the nonzero pattern of x = L \ A(:,col) by depth-first search in the
+// graph of the columns of L computed so far. Rows of L are in the original
+// (unpivoted) numbering; pinv[i] gives the column of L whose diagonal is in
+// row i, or -1 if row i hasn't been pivotal yet. The pattern is returned in
+// xi[top..n-1] in topological order.
+static int reach(const Array_<int>& Lp, const Array_<int>& Li,
+                 const Array_<int>& pinv,
+                 const Array_<int>& Ap, const Array_<int>& Ai, int col,
+                 Array_<int>& xi, Array_<int>& stack, Array_<int>& pstack,
+                 Array_<bool>& marked)
+{
+    const int n = (int)pinv.size();
+    int top = n;
+    for (int p=Ap[col]; p < Ap[col+1]; ++p) {
+        if (marked[Ai[p]]) continue;
+        int head = 0;
+        stack[0] = Ai[p];
+        while (head >= 0) {
+            const int j = stack[head];
+            const int jnew = pinv[j];
+            if (!marked[j]) {
+                marked[j] = true;
+                pstack[head] = (jnew < 0) ? 0 : Lp[jnew];
+            }
+            bool done = true;
+            const int pend = (jnew < 0) ? 0 : Lp[jnew+1];
+            for (int q=pstack[head]; q < pend; ++q) {
+                const int i = Li[q];
+                if (marked[i]) continue;
+                pstack[head] = q;
+                stack[++head] = i;
+                done = false;
+                break;
+            }
+            if (done) {--head; xi[--top] = j;}
+        }
+    }
+    for (int p=top; p < n; ++p) marked[xi[p]] = false;
+    return top;
+}
+
+void FactorSparseLURep::factor(const SparseMatrix& A, SparseOrdering ordering,
+                               Real pivotTol) {
+    SimTK_APIARGCHECK2_ALWAYS(A.nrow() == A.ncol(),
+        "FactorSparseLU", "factor",
+        "Matrix must be square but was %d x %d.", A.nrow(), A.ncol());
+    SimTK_APIARGCHECK1_ALWAYS(0 <= pivotTol && pivotTol <= 1,
+        "FactorSparseLU", "factor",
+        "Pivot tolerance must be between 0 and 1 but was %g.", pivotTol);
+
+    n = A.ncol();
+    singularIndex = 0;
+    isFactored = true;
+
+    if (ordering == SparseOrderingMinimumDegree)
+        calcMinimumDegreeOrdering(calcAtAPattern(A), q);
+    else
+        calcOrdering(A, ordering, q);
+
+    const Array_<int>&  Ap = A.getColumnStarts();
+    const Array_<int>&  Ai = A.getRowIndices();
+    const Array_<Real>& Ax = A.getValues();
+
+    pinv.assign(n, -1);
+    Lp.assign(n+1, 0); Up.assign(n+1, 0);
+    Li.clear(); Lx.clear(); Ui.clear(); Ux.clear();
+    const int guess = 4*A.getNumNonzeros() + n;
+    Li.reserve(guess); Lx.reserve(guess); Ui.reserve(guess); Ux.reserve(guess);
+
+    Array_<int>  xi(n), stack(n), pstack(n);
+    Array_<bool> marked(n, false);
+    Array_<Real> x(n, Real(0));
+
+    for (int k=0; k < n; ++k) {
+        Lp[k] = (int)Li.size();
+        Up[k] = (int)Ui.size();
+        const int col = q[k];
+
+        // x = L \ A(:,col), sparse.
+        const int top = reach(Lp, Li, pinv, Ap, Ai, col, xi, stack, pstack,
+                              marked);
+        for (int p=top; p < n; ++p) x[xi[p]] = 0;
+        for (int p=Ap[col]; p < Ap[col+1]; ++p) x[Ai[p]] = Ax[p];
+        for (int px=top; px < n; ++px) {
+            const int j = xi[px];
+            const int J = pinv[j];
+            if (J < 0) continue;
+            // Diagonal of L is 1 and stored first.
+            for (int p=Lp[J]+1; p < Lp[J+1]; ++p)
+                x[Li[p]] -= Lx[p]*x[j];
+        }
+
+        // Entries in already-pivotal rows go to U; choose the largest of
+        // the rest as pivot, unless the diagonal is good enough.
+        int ipiv = -1; Real amax = -1;
+        for (int p=top; p < n; ++p) {
+            const int i = xi[p];
+            if (pinv[i] < 0) {
+                const Real a = std::abs(x[i]);
+                if (a > amax) {amax = a; ipiv = i;}
+            } else {
+                Ui.push_back(pinv[i]);
+                Ux.push_back(x[i]);
+            }
+        }
+        if (ipiv == -1 || amax <= 0) {
+            singularIndex = k+1;
+            isFactored = false;
+            return;
+        }
+        // The diagonal must be nonzero even if pivotTol is 0.
+        if (pinv[col] < 0 && x[col] != 0 && std::abs(x[col]) >= amax*pivotTol)
+            ipiv = col;
+
+        const Real pivot = x[ipiv];
+        Ui.push_back(k);
+        Ux.push_back(pivot);
+        pinv[ipiv] = k;
+        Li.push_back(ipiv);
+        Lx.push_back(1);
+        for (int p=top; p < n; ++p) {
+            const int i = xi[p];
+            if (pinv[i] < 0) {
+                Li.push_back(i);
+                Lx.push_back(x[i]/pivot);
+            }
+            x[i] = 0;
+        }
+    }
+    Lp[n] = (int)Li.size();
+    Up[n] = (int)Ui.size();
+
+    // Renumber the rows of L to the pivoted order.
+    for (int p=0; p < Lp[n]; ++p) Li[p] = pinv[Li[p]];
+}
+
+// x is the permuted right hand side on entry and the solution in the column
+// ordering on return.
+void FactorSparseLURep::solveInPlace(Real* x) const {
+    for (int j=0; j < n; ++j)
+        for (int p=Lp[j]+1; p < Lp[j+1]; ++p)
+            x[Li[p]] -= Lx[p]*x[j];
+    for (int j=n-1; j >= 0; --j) {
+        x[j] /= Ux[Up[j+1]-1];
+        for (int p=Up[j]; p < Up[j+1]-1; ++p)
+            x[Ui[p]] -= Ux[p]*x[j];
+    }
+}
+
+void FactorSparseLURep::solve(const Vector& b, Vector& x) const {
+    checkIfFactored("solve");
+    SimTK_APIARGCHECK2_ALWAYS(b.size()==n,"FactorSparseLU","solve",
+       "number of rows in right hand side=%d does not match number of rows in original matrix=%d \n",
+        b.size(), n );
+
+    Array_<Real> y(n);
+    for (int i=0; i < n; ++i) y[pinv[i]] = b[i];
+    solveInPlace(y.begin());
+    x.resize(n);
+    for (int k=0; k < n; ++k) x[q[k]] = y[k];
+}
+
+void FactorSparseLURep::solve(const Matrix& b, Matrix& x) const {
+    checkIfFactored("solve");
+    SimTK_APIARGCHECK2_ALWAYS(b.nrow()==n,"FactorSparseLU","solve",
+       "number of rows in right hand side=%d does not match number of rows in original matrix=%d \n",
+        b.nrow(), n );
+
+    x.resize(n, b.ncol());
+    Array_<Real> y(n);
+    for (int c=0; c < b.ncol(); ++c) {
+        for (int i=0; i < n; ++i) y[pinv[i]] = b(i,c);
+        solveInPlace(y.begin());
+        for (int k=0; k < n; ++k) x(q[k],c) = y[k];
+    }
+}
+
+
+
+//==============================================================================
+//                          FACTOR SPARSE CHOLESKY
+//==============================================================================
+FactorSparseCholesky::~FactorSparseCholesky() {
+    delete rep;
+}
+FactorSparseCholesky::FactorSparseCholesky() {
+    rep = new FactorSparseCholeskyRep();
+}
+FactorSparseCholesky::FactorSparseCholesky( const FactorSparseCholesky& c ) {
+    rep = c.rep->clone();
+}
+FactorSparseCholesky& FactorSparseCholesky::
+operator=(const FactorSparseCholesky& rhs) {
+    if (&rhs != this) {
+        delete rep;
+        rep = rhs.rep->clone();
+    }
+    return *this;
+}
+FactorSparseCholesky::FactorSparseCholesky( const SparseMatrix& m,
+                                            SparseOrdering ordering ) {
+    rep = new FactorSparseCholeskyRep();
+    factor(m, ordering);
+}
+void FactorSparseCholesky::factor( const SparseMatrix& m,
+                                   SparseOrdering ordering ) {
+    rep->analyze(m, ordering);
+    rep->factorNumeric(m);
+}
+void FactorSparseCholesky::refactor( const SparseMatrix& m ) {
+    SimTK_APIARGCHECK_ALWAYS(rep->Lp.size() > 0,
+        "FactorSparseCholesky", "refactor",
+        "refactor() called before factor(). \n");
+    rep->factorNumeric(m);
+}
+void FactorSparseCholesky::solve( const Vector& b, Vector& x ) const {
+    rep->solve(b, x);
+}
+void FactorSparseCholesky::solve( const Matrix& b, Matrix& x ) const {
+    rep->solve(b, x);
+}
+bool FactorSparseCholesky::isPositiveDefinite() const {
+    return rep->positiveDefinite;
+}
+int FactorSparseCholesky::getNumNonzerosInFactor() const {
+    return rep->Lp.empty() ? 0 : rep->Lp.back();
+}
+void FactorSparseCholesky::getPermutation( Array_<int>& perm ) const {
+    rep->checkIfFactored("getPermutation");
+    perm = rep->perm;
+}
+void FactorSparseCholesky::getL( SparseMatrix& l ) const {
+    rep->checkIfFactored("getL");
+    SimTK_APIARGCHECK_ALWAYS(rep->positiveDefinite,
+        "FactorSparseCholesky","getL",
+        "The matrix was not positive definite. \n");
+    l = SparseMatrix(rep->n, rep->n, rep->Lp, rep->Li, rep->Lx);
+}
+
+
+
+//==============================================================================
+//                            FACTOR SPARSE LU
+//==============================================================================
+FactorSparseLU::~FactorSparseLU() {
+    delete rep;
+}
+FactorSparseLU::FactorSparseLU() {
+    rep = new FactorSparseLURep();
+}
+FactorSparseLU::FactorSparseLU( const FactorSparseLU& c ) {
+    rep = c.rep->clone();
+}
+FactorSparseLU& FactorSparseLU::operator=(const FactorSparseLU& rhs) {
+    if (&rhs != this) {
+        delete rep;
+        rep = rhs.rep->clone();
+    }
+    return *this;
+}
+FactorSparseLU::FactorSparseLU( const SparseMatrix& m,
+                                SparseOrdering ordering, Real pivotTol ) {
+    rep = new FactorSparseLURep();
+    rep->factor(m, ordering, pivotTol);
+}
+void FactorSparseLU::factor( const SparseMatrix& m,
+                             SparseOrdering ordering, Real pivotTol ) {
+    rep->factor(m, ordering, pivotTol);
+}
+void FactorSparseLU::solve( const Vector& b, Vector& x ) const {
+    SimTK_APIARGCHECK1_ALWAYS(rep->singularIndex == 0,
+        "FactorSparseLU", "solve",
+        "The matrix was singular (found at step %d). \n", rep->singularIndex);
+    rep->solve(b, x);
+}
+void FactorSparseLU::solve( const Matrix& b, Matrix& x ) const {
+    SimTK_APIARGCHECK1_ALWAYS(rep->singularIndex == 0,
+        "FactorSparseLU", "solve",
+        "The matrix was singular (found at step %d). \n", rep->singularIndex);
+    rep->solve(b, x);
+}
+bool FactorSparseLU::isSingular() const {
+    return rep->singularIndex > 0;
+}
+int FactorSparseLU::getSingularIndex() const {
+    return rep->singularIndex;
+}
+int FactorSparseLU::getNumNonzerosInFactors() const {
+    return (int)(rep->Li.size() + rep->Ui.size());
+}
+
+} // namespace SimTK
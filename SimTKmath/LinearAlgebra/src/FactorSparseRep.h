@@ -0,0 +1,109 @@
+#ifndef SimTK_SIMMATH_FACTOR_SPARSE_REP_H_
+#define SimTK_SIMMATH_FACTOR_SPARSE_REP_H_
+
+/* -------------------------------------------------------------------------- *
+ *                        Simbody(tm): SimTKmath                              *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2018 Stanford University and the Authors.           *
+ * Authors: Simbody developers                                                *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+#include "SimTKcommon.h"
+#include "simmath/SparseMatrix.h"
+
+namespace SimTK {
+
+// Sparse Cholesky factorization using the up-looking algorithm: row k of L
+// is computed by a sparse triangular solve whose nonzero pattern is the
+// "row subtree" of the elimination tree (see Davis, Direct Methods for
+// Sparse Linear Systems, SIAM 2006, ch. 4). L is stored by columns with the
+// diagonal first.
+class FactorSparseCholeskyRep {
+public:
+    FactorSparseCholeskyRep()
+    :   n(0), nnzA(0), isFactored(false), positiveDefinite(false) {}
+
+    FactorSparseCholeskyRep* clone() const
+    {   return new FactorSparseCholeskyRep(*this); }
+
+    // Symbolic analysis: ordering, elimination tree, column counts, and the
+    // map from the lower triangle of A into the upper triangle of P*A*~P.
+    void analyze(const SparseMatrix& A, SparseOrdering ordering);
+    // Numeric factorization of a matrix with the analyzed pattern.
+    void factorNumeric(const SparseMatrix& A);
+    // Overwrite x with (L*~L)^-1 x, in the permuted ordering.
+    void solveInPlace(Real* x) const;
+
+    void solve(const Vector& b, Vector& x) const;
+    void solve(const Matrix& b, Matrix& x) const;
+
+    void checkIfFactored(const char* where) const {
+        SimTK_APIARGCHECK_ALWAYS(isFactored,"FactorSparseCholesky",where,
+        "No matrix was passed to FactorSparseCholesky. \n");
+    }
+
+    int         n;
+    int         nnzA;           // nonzeros in the analyzed matrix
+    bool        isFactored;
+    bool        positiveDefinite;
+
+    Array_<int> Ap, Ai;         // pattern of the analyzed A
+    Array_<int> perm, pinv;     // row/col k of P*A*~P is perm[k] of A
+    Array_<int> parent;         // elimination tree
+    Array_<int> Cp, Ci, Cmap;   // upper triangle of P*A*~P; A entry -> C
+    Array_<int> Lp, Li;         // pattern of L
+    Array_<Real> Lx;            // values of L
+};
+
+// Sparse LU factorization by the left-looking Gilbert-Peierls algorithm:
+// each column of L and U comes from a sparse triangular solve whose pattern
+// is found by depth-first search in the graph of L. Rows are chosen by
+// threshold partial pivoting. L is unit lower triangular with the diagonal
+// stored first; U has its diagonal stored last in each column.
+class FactorSparseLURep {
+public:
+    FactorSparseLURep() : n(0), singularIndex(0), isFactored(false) {}
+
+    FactorSparseLURep* clone() const {return new FactorSparseLURep(*this);}
+
+    void factor(const SparseMatrix& A, SparseOrdering ordering,
+                Real pivotTol);
+    void solveInPlace(Real* x) const;
+
+    void solve(const Vector& b, Vector& x) const;
+    void solve(const Matrix& b, Matrix& x) const;
+
+    void checkIfFactored(const char* where) const {
+        SimTK_APIARGCHECK_ALWAYS(isFactored,"FactorSparseLU",where,
+        "No matrix was passed to FactorSparseLU. \n");
+    }
+
+    int          n;
+    int          singularIndex;
+    bool         isFactored;
+
+    Array_<int>  q;             // column k of P*A*Q is column q[k] of A
+    Array_<int>  pinv;          // row i of A is row pinv[i] of P*A*Q
+    Array_<int>  Lp, Li, Up, Ui;
+    Array_<Real> Lx, Ux;
+};
+
+} // namespace SimTK
+
+#endif   // SimTK_SIMMATH_FACTOR_SPARSE_REP_H_
@@ -0,0 +1,265 @@
+/* -------------------------------------------------------------------------- *
+ *                        Simbody(tm): SimTKmath                              *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2018 Stanford University and the Authors.           *
+ * Authors: Simbody developers                                                *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+/**@file
+ *
+ * Implementation of the Krylov subspace solvers in IterativeSolver.
+ */
+
+#include "SimTKcommon.h"
+
+#include "simmath/internal/common.h"
+#include "simmath/IterativeSolver.h"
+
+#include <algorithm>
+#include <cmath>
+
+
+namespace SimTK {
+
+DiagonalPreconditioner::DiagonalPreconditioner(const Vector& diagA)
+:   invDiag(diagA.size()) {
+    for (int i=0; i < diagA.size(); ++i)
+        invDiag[i] = diagA[i] == 0 ? Real(1) : 1/diagA[i];
+}
+
+void DiagonalPreconditioner::apply(const Vector& x, Vector& y) const {
+    y.resize(x.size());
+    for (int i=0; i < x.size(); ++i) y[i] = invDiag[i]*x[i];
+}
+
+void IterativeSolver::setTolerance(Real relTol) {
+    SimTK_APIARGCHECK1_ALWAYS(relTol > 0, "IterativeSolver", "setTolerance",
+        "The tolerance must be positive but was %g.", relTol);
+    tol = relTol;
+}
+
+void IterativeSolver::setRestart(int m) {
+    SimTK_APIARGCHECK1_ALWAYS(m >= 1, "IterativeSolver", "setRestart",
+        "The restart length must be at least 1 but was %d.", m);
+    restart = m;
+}
+
+bool IterativeSolver::solve(const LinearOperator& A, const Vector& b,
+                            Vector& x) {
+    const int n = A.size();
+    SimTK_APIARGCHECK2_ALWAYS(b.size()==n, "IterativeSolver", "solve",
+        "Right hand side has %d elements but the operator is %d X %d.",
+        b.size(), n);
+    SimTK_APIARGCHECK2_ALWAYS(!preconditioner || preconditioner->size()==n,
+        "IterativeSolver", "solve",
+        "Preconditioner has dimension %d but the operator's is %d.",
+        preconditioner ? preconditioner->size() : 0, n);
+
+    if (x.size() != n) {x.resize(n); x = 0;}
+    numIters = 0;
+
+    const Real bnorm = b.norm();
+    if (bnorm == 0) {
+        x = 0; residualNorm = 0;
+        return converged = true;
+    }
+    const Real target = tol*bnorm;
+    const int maxIt = maxIters >= 0 ? maxIters
+        : (method == GMRES && n <= restart ? n : 10*n);
+
+    switch (method) {
+    case ConjugateGradient: converged = solveCG(A, b, x, maxIt, target); break;
+    case MINRES:        converged = solveMINRES(A, b, x, maxIt, target); break;
+    case GMRES:         converged = solveGMRES(A, b, x, maxIt, target); break;
+    default: SimTK_APIARGCHECK1_ALWAYS(false, "IterativeSolver", "solve",
+                 "Unrecognized method %d.", (int)method);
+    }
+
+    // Report the true residual; the recurrences only track an estimate.
+    Vector r;
+    A.apply(x, r);
+    r.setToLinearCombination(1, b, -1, r);
+    residualNorm = r.norm();
+    return converged;
+}
+
+// Preconditioned conjugate gradients (Hestenes and Stiefel).
+bool IterativeSolver::solveCG(const LinearOperator& A, const Vector& b,
+                              Vector& x, int maxIt, Real target) {
+    const int n = b.size();
+    Vector r(n), z(n), p(n), q(n);
+    A.apply(x, q); ++numIters;
+    r.setToLinearCombination(1, b, -1, q);
+    if (r.norm() <= target) return true;
+
+    if (preconditioner) preconditioner->apply(r, z); else z = r;
+    p = z;
+    Real rz = ~r*z;
+    while (numIters < maxIt) {
+        A.apply(p, q); ++numIters;
+        const Real pq = ~p*q;
+        if (!(pq > 0)) return false; // A is not positive definite
+        const Real alpha = rz/pq;
+        x.addScaledInPlace(alpha, p);
+        r.addScaledInPlace(-alpha, q);
+        if (r.norm() <= target) return true;
+        if (preconditioner) preconditioner->apply(r, z); else z = r;
+        const Real rzNew = ~r*z;
+        p.setToLinearCombination(1, z, rzNew/rz, p);
+        rz = rzNew;
+    }
+    return false;
+}
+
+// Preconditioned MINRES, following Paige and Saunders (1975). The
+// preconditioned Lanczos process generates the basis and a QR factorization
+// of the tridiagonal Lanczos matrix, updated one Givens rotation at a time,
+// gives the minimum residual iterate with a three-term recurrence.
+bool IterativeSolver::solveMINRES(const LinearOperator& A, const Vector& b,
+                                  Vector& x, int maxIt, Real target) {
+    const int n = b.size();
+    Vector r1(n), r2(n), y(n), v(n), w(n, Real(0)), w1(n), w2(n, Real(0));
+    A.apply(x, y); ++numIters;
+    r1.setToLinearCombination(1, b, -1, y);
+    if (r1.norm() <= target) return true;
+
+    if (preconditioner) preconditioner->apply(r1, y); else y = r1;
+    Real beta1 = ~r1*y;
+    SimTK_ERRCHK_ALWAYS(beta1 > 0, "IterativeSolver::solve()",
+        "MINRES preconditioner is not positive definite.");
+    beta1 = std::sqrt(beta1);
+
+    // With a preconditioner the residual norm we can track is the one in
+    // the M norm, so scale the target to match the initial residual.
+    const Real mtarget = preconditioner ? target*beta1/r1.norm() : target;
+
+    r2 = r1;
+    Real oldb = 0, beta = beta1, dbar = 0, epsln = 0, phibar = beta1;
+    Real cs = -1, sn = 0;
+    for (int k=0; numIters < maxIt; ++k) {
+        v = y; v /= beta;
+        A.apply(v, y); ++numIters;
+        if (k > 0) y.addScaledInPlace(-beta/oldb, r1);
+        const Real alfa = ~v*y;
+        y.addScaledInPlace(-alfa/beta, r2);
+        r1 = r2; r2 = y;
+        if (preconditioner) preconditioner->apply(r2, y); else y = r2;
+        oldb = beta;
+        beta = ~r2*y;
+        SimTK_ERRCHK_ALWAYS(beta >= 0, "IterativeSolver::solve()",
+            "MINRES preconditioner is not positive definite.");
+        beta = std::sqrt(beta);
+
+        // Apply the previous rotation, then compute and apply a new one to
+        // eliminate beta from the tridiagonal column.
+        const Real oldeps = epsln;
+        const Real delta = cs*dbar + sn*alfa;
+        const Real gbar  = sn*dbar - cs*alfa;
+        epsln = sn*beta;
+        dbar  = -cs*beta;
+        const Real gamma = std::max(std::sqrt(gbar*gbar + beta*beta),
+                                    NTraits<Real>::getEps());
+        cs = gbar/gamma; sn = beta/gamma;
+        const Real phi = cs*phibar;
+        phibar *= sn;
+
+        // Update the search direction and the solution.
+        w1 = w2; w2 = w;
+        w.setToLinearCombination(1/gamma, v, -oldeps/gamma, w1,
+                                 -delta/gamma, w2);
+        x.addScaledInPlace(phi, w);
+
+        if (phibar <= mtarget) return true;
+        if (beta == 0) return false; // invariant subspace; A is singular
+    }
+    return false;
+}
+
+// Restarted GMRES with right preconditioning, so that the residual the
+// iteration monitors is the true one. The Arnoldi basis is orthogonalized
+// with modified Gram-Schmidt and the Hessenberg least squares problem is
+// kept triangular with Givens rotations.
+bool IterativeSolver::solveGMRES(const LinearOperator& A, const Vector& b,
+                                 Vector& x, int maxIt, Real target) {
+    const int n = b.size(), m = restart;
+    Matrix V(n, m+1), H(m+1, m);
+    Vector cs(m), sn(m), g(m+1), r(n), z(n), w(n);
+
+    while (true) {
+        A.apply(x, w); ++numIters;
+        r.setToLinearCombination(1, b, -1, w);
+        const Real beta = r.norm();
+        if (beta <= target) return true;
+        if (numIters >= maxIt) return false;
+
+        V(0) = r/beta;
+        g = 0; g[0] = beta;
+        int k = 0; // number of basis vectors used in this cycle
+        bool done = false;
+        for (int j=0; j < m && numIters < maxIt; ++j) {
+            if (preconditioner) {
+                w = V(j);
+                preconditioner->apply(w, z);
+            } else
+                z = V(j);
+            A.apply(z, w); ++numIters;
+            for (int i=0; i <= j; ++i) {
+                H(i,j) = ~w*V(i);
+                w.addScaledInPlace(-H(i,j), V(i));
+            }
+            const Real hnext = w.norm();
+
+            for (int i=0; i < j; ++i) {
+                const Real t = cs[i]*H(i,j) + sn[i]*H(i+1,j);
+                H(i+1,j) = -sn[i]*H(i,j) + cs[i]*H(i+1,j);
+                H(i,j) = t;
+            }
+            const Real d = std::sqrt(H(j,j)*H(j,j) + hnext*hnext);
+            k = j+1;
+            if (d == 0) {done = true; break;} // singular; give up
+            cs[j] = H(j,j)/d; sn[j] = hnext/d;
+            H(j,j) = d;
+            g[j+1] = -sn[j]*g[j];
+            g[j]   =  cs[j]*g[j];
+
+            if (std::abs(g[j+1]) <= target || hnext == 0) break;
+            V(j+1) = w/hnext;
+        }
+
+        // Solve the k X k triangular system H*y = g and update
+        // x += M^-1 * V*y.
+        Vector yk(k);
+        for (int i=k-1; i >= 0; --i) {
+            Real s = g[i];
+            for (int l=i+1; l < k; ++l) s -= H(i,l)*yk[l];
+            yk[i] = H(i,i) != 0 ? s/H(i,i) : Real(0);
+        }
+        w = 0;
+        for (int i=0; i < k; ++i) w.addScaledInPlace(yk[i], V(i));
+        if (preconditioner) {
+            preconditioner->apply(w, z);
+            x += z;
+        } else
+            x += w;
+
+        if (done) return false;
+    }
+}
+
+} // namespace SimTK
@@ -0,0 +1,239 @@
+/* -------------------------------------------------------------------------- *
+ *                        Simbody(tm): SimTKmath                              *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2018 Stanford University and the Authors.           *
+ * Authors: Simbody developers                                                *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+/**@file
+ *
+ * Implementation of LanczosEigenSolver.
+ */
+
+#include "SimTKcommon.h"
+
+#include "simmath/internal/common.h"
+#include "simmath/LanczosEigenSolver.h"
+
+#include "LapackInterface.h"
+
+#include <algorithm>
+#include <cmath>
+
+
+namespace SimTK {
+
+LanczosEigenSolver::LanczosEigenSolver(const LinearOperator& K,
+                                       const LinearOperator* M)
+:   K(K), M(M), shiftInverse(nullptr), shift(0), tol(1e-10),
+    numLanczosVectors(0), maxRestarts(300), numConverged(0), numIters(0) {
+    SimTK_APIARGCHECK2_ALWAYS(!M || M->size()==K.size(),
+        "LanczosEigenSolver", "LanczosEigenSolver",
+        "M has dimension %d but K's is %d.", M ? M->size() : 0, K.size());
+}
+
+void LanczosEigenSolver::setTolerance(Real relTol) {
+    SimTK_APIARGCHECK1_ALWAYS(relTol > 0, "LanczosEigenSolver",
+        "setTolerance", "The tolerance must be positive but was %g.", relTol);
+    tol = relTol;
+}
+
+void LanczosEigenSolver::setNumLanczosVectors(int ncv) {
+    SimTK_APIARGCHECK1_ALWAYS(ncv >= 0, "LanczosEigenSolver",
+        "setNumLanczosVectors",
+        "The number of Lanczos vectors must be nonnegative but was %d.", ncv);
+    numLanczosVectors = ncv;
+}
+
+void LanczosEigenSolver::setMaxRestarts(int n) {
+    SimTK_APIARGCHECK1_ALWAYS(n >= 0, "LanczosEigenSolver", "setMaxRestarts",
+        "The number of restarts must be nonnegative but was %d.", n);
+    maxRestarts = n;
+}
+
+// y = (K - shift*M)^-1 * Mx.
+void LanczosEigenSolver::applyOp(const Vector& Mx, Vector& y) const {
+    if (shiftInverse) {
+        shiftInverse->apply(Mx, y);
+        return;
+    }
+    const int n = K.size();
+    const Real sigma = shift;
+    const LinearOperator* const Mop = M;
+    const LinearOperator& Kop = K;
+    FunctionOperator A(n, [&](const Vector& x, Vector& Ax) {
+        Kop.apply(x, Ax);
+        if (sigma == 0) return;
+        if (Mop) {
+            Vector Mx; Mop->apply(x, Mx);
+            Ax.addScaledInPlace(-sigma, Mx);
+        } else
+            Ax.addScaledInPlace(-sigma, x);
+    });
+    IterativeSolver minres(IterativeSolver::MINRES);
+    minres.setTolerance(std::max(1e-2*tol, 1e-14));
+    y.clear();
+    // An inaccurate solve would quietly give wrong Ritz pairs, so give up
+    // instead; this usually means the shift is (nearly) an eigenvalue.
+    SimTK_ERRCHK2_ALWAYS(minres.solve(A, Mx, y),
+        "LanczosEigenSolver::calcEigenvaluesAndVectors()",
+        "MINRES failed to apply (K - shift*M)^-1 after %d iterations "
+        "(residual %g); the shift may be too close to an eigenvalue.",
+        minres.getNumIterations(), minres.getResidualNorm());
+}
+
+namespace {
+// Make w M-orthogonal to columns 0..j of V, doing classical Gram-Schmidt
+// twice, which is enough to keep the basis orthogonal to working precision.
+// The coefficients removed are added to h, which must have j+1 elements.
+void orthogonalize(const Matrix& V, const Matrix& MV, int j, Vector& w,
+                   Vector& h) {
+    h = 0;
+    for (int pass=0; pass < 2; ++pass)
+        for (int i=0; i <= j; ++i) {
+            const Real c = ~MV(i)*w;
+            w.addScaledInPlace(-c, V(i));
+            h[i] += c;
+        }
+}
+}
+
+bool LanczosEigenSolver::calcEigenvaluesAndVectors
+   (int nev, Vector& values, Matrix& vectors) {
+    const int n = K.size();
+    SimTK_APIARGCHECK2_ALWAYS(1 <= nev && nev <= n, "LanczosEigenSolver",
+        "calcEigenvaluesAndVectors",
+        "Asked for %d eigenvalues of a problem of dimension %d.", nev, n);
+    const int ncv = std::min(n, numLanczosVectors > 0 ? numLanczosVectors
+                                 : std::max(2*nev+1, 20));
+    SimTK_APIARGCHECK2_ALWAYS(ncv > nev || ncv == n, "LanczosEigenSolver",
+        "calcEigenvaluesAndVectors",
+        "Need more than %d Lanczos vectors to find %d eigenvalues.", nev, nev);
+
+    numIters = numConverged = 0;
+    auto applyM = [&](const Vector& x, Vector& y) {
+        if (M) M->apply(x, y); else y = x;
+    };
+
+    // V holds the M-orthonormal basis and MV = M*V; column ncv is the next
+    // basis vector. T is the projection ~V*M*Op*V of the operator
+    // Op = (K - shift*M)^-1 * M, which is symmetric in the M inner product;
+    // only its upper triangle is filled in.
+    Matrix V(n, ncv+1), MV(n, ncv+1), T(ncv, ncv, Real(0)), S;
+    Vector w(n), Mw(n), h(ncv), theta(ncv);
+    Random::Uniform rand(-1, 1);
+    rand.setSeed(1);
+
+    // Start from Op applied to a random vector, which purges components in
+    // any null space of M.
+    for (int i=0; i < n; ++i) w[i] = rand.getValue();
+    applyM(w, Mw);
+    applyOp(Mw, w); ++numIters;
+    applyM(w, Mw);
+    Real beta = std::sqrt(std::max(~w*Mw, Real(0)));
+    SimTK_ERRCHK_ALWAYS(beta > 0, "LanczosEigenSolver::calcEigenvaluesAndVectors()",
+        "The shift-inverted operator annihilated the starting vector.");
+    V(0) = w/beta; MV(0) = Mw/beta;
+
+    Array_<int> order(ncv);
+    int kept = 0; // number of Ritz vectors kept from the last cycle
+    Real tnorm = 0;
+    for (int restart=0; ; ++restart) {
+        // Extend the basis to ncv vectors.
+        for (int j=kept; j < ncv; ++j) {
+            Vector Mvj = MV(j);
+            applyOp(Mvj, w); ++numIters;
+            orthogonalize(V, MV, j, w, h);
+            for (int i=0; i <= j; ++i) T(i,j) = h[i];
+            applyM(w, Mw);
+            beta = std::sqrt(std::max(~w*Mw, Real(0)));
+            tnorm = std::max(tnorm, std::abs(T(j,j)) + beta);
+
+            if (beta <= 1000*NTraits<Real>::getEps()*tnorm) {
+                // The basis spans an invariant subspace. Continue with a
+                // random vector orthogonal to it; it is decoupled from the
+                // ones we have so the residuals of their Ritz pairs are 0.
+                beta = 0;
+                if (j+1 == n) {V(j+1) = 0; MV(j+1) = 0; continue;}
+                for (int i=0; i < n; ++i) w[i] = rand.getValue();
+                orthogonalize(V, MV, j, w, h);
+                applyM(w, Mw);
+                const Real nrm = std::sqrt(std::max(~w*Mw, Real(0)));
+                V(j+1) = w/nrm; MV(j+1) = Mw/nrm;
+            } else {
+                V(j+1) = w/beta; MV(j+1) = Mw/beta;
+            }
+        }
+
+        // Ritz values and vectors of the projected matrix, in order of
+        // decreasing magnitude, which is the order of increasing distance
+        // of lambda = shift + 1/theta from the shift.
+        S = T;
+        int info;
+        LapackInterface::syev<Real>('V', 'U', ncv, &S(0,0), ncv,
+                                    &theta[0], info);
+        SimTK_ERRCHK1_ALWAYS(info == 0,
+            "LanczosEigenSolver::calcEigenvaluesAndVectors()",
+            "Eigenvalues of the Lanczos matrix failed to converge (info=%d).",
+            info);
+        for (int i=0; i < ncv; ++i) order[i] = i;
+        std::stable_sort(order.begin(), order.end(), [&](int a, int b)
+            {return std::abs(theta[a]) > std::abs(theta[b]);});
+
+        // The residual of Ritz pair i is beta times the last element of its
+        // eigenvector of T.
+        numConverged = 0;
+        while (numConverged < nev) {
+            const int i = order[numConverged];
+            if (theta[i] == 0
+                || beta*std::abs(S(ncv-1,i)) > tol*std::abs(theta[i]))
+                break;
+            ++numConverged;
+        }
+        if (numConverged == nev || restart >= maxRestarts || ncv == n)
+            break;
+
+        // Thick restart: keep the best Ritz vectors, which diagonalize T,
+        // followed by the residual direction.
+        kept = std::min(nev + (ncv-nev)/2, ncv-1);
+        Matrix Sk(ncv, kept);
+        for (int i=0; i < kept; ++i) Sk(i) = S(order[i]);
+        const Matrix Vk  = V(0,0,n,ncv)*Sk;
+        const Matrix MVk = MV(0,0,n,ncv)*Sk;
+        V(kept) = V(ncv); MV(kept) = MV(ncv);
+        V.updBlock(0,0,n,kept) = Vk; MV.updBlock(0,0,n,kept) = MVk;
+        T = 0;
+        for (int i=0; i < kept; ++i) T(i,i) = theta[order[i]];
+    }
+
+    // Return the converged pairs in ascending order of lambda.
+    Array_<int> found(order.begin(), order.begin()+numConverged);
+    std::sort(found.begin(), found.end(), [&](int a, int b)
+        {return shift + 1/theta[a] < shift + 1/theta[b];});
+    values.resize(numConverged);
+    vectors.resize(n, numConverged);
+    for (int k=0; k < numConverged; ++k) {
+        const int i = found[k];
+        values[k] = shift + 1/theta[i];
+        vectors(k) = V(0,0,n,ncv)*S(i);
+    }
+    return numConverged == nev;
+}
+
+} // namespace SimTK
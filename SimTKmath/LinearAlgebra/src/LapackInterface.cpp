@@ -866,6 +866,12 @@ void LapackInterface::lascl<std::complex<double> >( const char& type, const int&
 }
 
 
+// LAPACK's xLANGE reads its work array only for the infinity norm, so don't
+// allocate one otherwise; FactorQTZ calls lange() with 'M' on every factor().
+static int langeWorkSize(char norm, int m) {
+    return (norm == 'I' || norm == 'i') ? m : 0;
+}
+
 template <> 
 double LapackInterface::lange<float>( const char& norm, const int& m, const int& n, const float* a, const int& lda){
 /*
@@ -888,7 +894,7 @@ double LapackInterface::lange<float>( const char& norm, const int& m, const int&
  
 template <> 
 double LapackInterface::lange<double>( const char& norm, const int& m, const int& n, const double* a, const int& lda ){
-     TypedWorkSpace<double> work(m);
+     TypedWorkSpace<double> work(langeWorkSize(norm, m));
      return( dlange_( norm, m, n, a, lda, work.data, 1 ) ); 
 }
  
@@ -914,7 +920,7 @@ double LapackInterface::lange<std::complex<float> >( const char& norm, const int
  
 template <> 
 double LapackInterface::lange<std::complex<double> >( const char& norm, const int& m, const int& n, const std::complex<double>* a, const int& lda) {
-     TypedWorkSpace<double> work(m);
+     TypedWorkSpace<double> work(langeWorkSize(norm, m));
      return( zlange_( norm, m, n, a, lda, work.data, 1 ) );
 }
  
@@ -1138,6 +1144,28 @@ void LapackInterface::potrf<std::complex<float> >( const char& uplo, const int n
         SimTK_THROW2( SimTK::Exception::IllegalLapackArg, "cpotrf", info );
     }
 
+    return;
+ }
+template <>
+void LapackInterface::pocon<double>( const char& uplo, const int n, const double* a, const int lda, const double& anorm, double& rcond, double* work, int* iwork, int& info ) { 
+
+    // work must have room for 3*n elements and iwork for n.
+    dpocon_(uplo, n, a, lda, anorm, rcond, work, iwork, info, 1);
+    if( info < 0 ) {
+        SimTK_THROW2( SimTK::Exception::IllegalLapackArg, "dpocon", info );
+    }
+
+    return;
+ }
+template <>
+void LapackInterface::pocon<float>( const char& uplo, const int n, const float* a, const int lda, const float& anorm, float& rcond, float* work, int* iwork, int& info ) { 
+
+    // work must have room for 3*n elements and iwork for n.
+    spocon_(uplo, n, a, lda, anorm, rcond, work, iwork, info, 1);
+    if( info < 0 ) {
+        SimTK_THROW2( SimTK::Exception::IllegalLapackArg, "spocon", info );
+    }
+
     return;
  }
 template <> 
@@ -97,6 +97,9 @@ void gbtrf( const int m, const int n, const int kl, const int ku, T* lu, const i
 template <class T> static 
 void potrf( const char& uplo, const int n,  T* lu, const int lda, int& info );
 
+template <class T> static 
+void pocon( const char& uplo, const int n, const T* a, const int lda, const typename CNT<T>::TReal& anorm, typename CNT<T>::TReal& rcond, T* work, int* iwork, int& info );
+
 template <class T> static 
 void sytrf( const char& uplo, const int n, T* a,  const int lda, int* pivots, T* work, const int lwork, int& info );
 
@@ -0,0 +1,301 @@
+/* -------------------------------------------------------------------------- *
+ *                        Simbody(tm): SimTKmath                              *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2018 Stanford University and the Authors.           *
+ * Authors: Simbody developers                                                *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+/**@file
+ *
+ * Implementation of SparseMatrix_, the compressed sparse column matrix.
+ */
+
+#include "SimTKcommon.h"
+
+#include "simmath/internal/common.h"
+#include "simmath/SparseMatrix.h"
+
+#include <algorithm>
+#include <cmath>
+
+
+namespace SimTK {
+
+template <class T>
+SparseMatrix_<T>::SparseMatrix_(int nrow, int ncol)
+:   m_nrow(nrow), m_ncol(ncol), m_colStart(ncol+1, 0) {
+    SimTK_APIARGCHECK2_ALWAYS(nrow >= 0 && ncol >= 0,
+        "SparseMatrix_", "SparseMatrix_",
+        "Illegal dimensions %d x %d.", nrow, ncol);
+}
+
+// Counting sort of the triplets into columns, then sort each column by row
+// and merge duplicates in place.
+template <class T>
+SparseMatrix_<T>::SparseMatrix_(const SparseMatrixBuilder_<T>& builder)
+:   m_nrow(builder.nrow()), m_ncol(builder.ncol()),
+    m_colStart(builder.ncol()+1, 0)
+{
+    const Array_<int>& rows = builder.getRowIndices();
+    const Array_<int>& cols = builder.getColumnIndices();
+    const Array_<T>&   vals = builder.getValues();
+    const int nent = builder.getNumEntries();
+
+    for (int k=0; k < nent; ++k)
+        ++m_colStart[cols[k]+1];
+    for (int j=0; j < m_ncol; ++j)
+        m_colStart[j+1] += m_colStart[j];
+
+    Array_<int> next(m_colStart.begin(), m_colStart.end()-1);
+    Array_<std::pair<int,T> > entries(nent);
+    for (int k=0; k < nent; ++k)
+        entries[next[cols[k]]++] = std::make_pair(rows[k], vals[k]);
+
+    m_rowIndex.reserve(nent);
+    m_values.reserve(nent);
+    int colBegin = 0;
+    for (int j=0; j < m_ncol; ++j) {
+        const int colEnd = m_colStart[j+1];
+        std::stable_sort(entries.begin()+colBegin, entries.begin()+colEnd,
+            [](const std::pair<int,T>& a, const std::pair<int,T>& b)
+            {   return a.first < b.first; });
+        m_colStart[j] = (int)m_rowIndex.size();
+        for (int k=colBegin; k < colEnd; ++k) {
+            if (k > colBegin && entries[k].first == m_rowIndex.back())
+                m_values.back() += entries[k].second;
+            else {
+                m_rowIndex.push_back(entries[k].first);
+                m_values.push_back(entries[k].second);
+            }
+        }
+        colBegin = colEnd;
+    }
+    m_colStart[m_ncol] = (int)m_rowIndex.size();
+}
+
+template <class T>
+SparseMatrix_<T>::SparseMatrix_(const Matrix_<T>& dense,
+                                typename CNT<T>::TReal dropTol)
+:   m_nrow(dense.nrow()), m_ncol(dense.ncol()), m_colStart(dense.ncol()+1, 0)
+{
+    for (int j=0; j < m_ncol; ++j) {
+        m_colStart[j] = (int)m_rowIndex.size();
+        for (int i=0; i < m_nrow; ++i) {
+            const T& aij = dense(i,j);
+            if (std::abs(aij) > dropTol) {
+                m_rowIndex.push_back(i);
+                m_values.push_back(aij);
+            }
+        }
+    }
+    m_colStart[m_ncol] = (int)m_rowIndex.size();
+}
+
+template <class T>
+SparseMatrix_<T>::SparseMatrix_(int nrow, int ncol,
+                                const Array_<int>& colStart,
+                                const Array_<int>& rowIndex,
+                                const Array_<T>& values)
+:   m_nrow(nrow), m_ncol(ncol), m_colStart(colStart), m_rowIndex(rowIndex),
+    m_values(values)
+{
+    SimTK_APIARGCHECK2_ALWAYS(nrow >= 0 && ncol >= 0,
+        "SparseMatrix_", "SparseMatrix_",
+        "Illegal dimensions %d x %d.", nrow, ncol);
+    SimTK_APIARGCHECK2_ALWAYS((int)colStart.size() == ncol+1,
+        "SparseMatrix_", "SparseMatrix_",
+        "Expected %d column starts but got %d.", ncol+1, (int)colStart.size());
+    SimTK_APIARGCHECK2_ALWAYS(colStart[0] == 0
+        && colStart[ncol] == (int)rowIndex.size()
+        && rowIndex.size() == values.size(),
+        "SparseMatrix_", "SparseMatrix_",
+        "Inconsistent sizes: %d row indices and %d values.",
+        (int)rowIndex.size(), (int)values.size());
+    for (int j=0; j < ncol; ++j) {
+        SimTK_APIARGCHECK1_ALWAYS(colStart[j] <= colStart[j+1],
+            "SparseMatrix_", "SparseMatrix_",
+            "Column starts must be nondecreasing (column %d).", j);
+        for (int p=colStart[j]; p < colStart[j+1]; ++p)
+            SimTK_APIARGCHECK2_ALWAYS(0 <= rowIndex[p] && rowIndex[p] < nrow
+                && (p == colStart[j] || rowIndex[p-1] < rowIndex[p]),
+                "SparseMatrix_", "SparseMatrix_",
+                "Row indices in column %d must be increasing and less than "
+                "%d.", j, nrow);
+    }
+}
+
+template <class T>
+T SparseMatrix_<T>::getElt(int i, int j) const {
+    SimTK_INDEXCHECK(i, m_nrow, "SparseMatrix_::getElt()");
+    SimTK_INDEXCHECK(j, m_ncol, "SparseMatrix_::getElt()");
+    const int* begin = m_rowIndex.cbegin() + m_colStart[j];
+    const int* end   = m_rowIndex.cbegin() + m_colStart[j+1];
+    const int* p = std::lower_bound(begin, end, i);
+    return (p != end && *p == i) ? m_values[int(p - m_rowIndex.cbegin())]
+                                 : T(0);
+}
+
+template <class T>
+void SparseMatrix_<T>::multiplyAndAdd(const T& alpha, const Vector_<T>& x,
+                                      const T& beta, Vector_<T>& y) const {
+    SimTK_APIARGCHECK2_ALWAYS(x.size() == m_ncol,
+        "SparseMatrix_", "multiplyAndAdd",
+        "x has length %d but matrix has %d columns.", x.size(), m_ncol);
+    if (beta == T(0)) {
+        y.resize(m_nrow);
+        y.setToZero();
+    } else {
+        SimTK_APIARGCHECK2_ALWAYS(y.size() == m_nrow,
+            "SparseMatrix_", "multiplyAndAdd",
+            "y has length %d but matrix has %d rows.", y.size(), m_nrow);
+        if (beta != T(1)) y *= beta;
+    }
+    // Column-oriented saxpy; each column scatters into y.
+    for (int j=0; j < m_ncol; ++j) {
+        const T axj = alpha*x[j];
+        if (axj == T(0)) continue;
+        for (int p=m_colStart[j]; p < m_colStart[j+1]; ++p)
+            y[m_rowIndex[p]] += m_values[p]*axj;
+    }
+}
+
+template <class T>
+void SparseMatrix_<T>::multiplyByTransposeAndAdd
+   (const T& alpha, const Vector_<T>& x, const T& beta, Vector_<T>& y) const {
+    SimTK_APIARGCHECK2_ALWAYS(x.size() == m_nrow,
+        "SparseMatrix_", "multiplyByTransposeAndAdd",
+        "x has length %d but matrix has %d rows.", x.size(), m_nrow);
+    if (beta == T(0))
+        y.resize(m_ncol);
+    else
+        SimTK_APIARGCHECK2_ALWAYS(y.size() == m_ncol,
+            "SparseMatrix_", "multiplyByTransposeAndAdd",
+            "y has length %d but matrix has %d columns.", y.size(), m_ncol);
+    // Each column of A is a row of ~A, so this is a series of sparse dot
+    // products that gather from x.
+    for (int j=0; j < m_ncol; ++j) {
+        T sum(0);
+        for (int p=m_colStart[j]; p < m_colStart[j+1]; ++p)
+            sum += m_values[p]*x[m_rowIndex[p]];
+        y[j] = (beta == T(0) ? alpha*sum : alpha*sum + beta*y[j]);
+    }
+}
+
+template <class T>
+void SparseMatrix_<T>::multiply(const Matrix_<T>& X, Matrix_<T>& Y) const {
+    SimTK_APIARGCHECK2_ALWAYS(X.nrow() == m_ncol,
+        "SparseMatrix_", "multiply",
+        "X has %d rows but matrix has %d columns.", X.nrow(), m_ncol);
+    Y.resize(m_nrow, X.ncol());
+    Vector_<T> y;
+    for (int c=0; c < X.ncol(); ++c) {
+        multiply(Vector_<T>(X(c)), y);
+        Y(c) = y;
+    }
+}
+
+template <class T>
+void SparseMatrix_<T>::multiplyByTranspose(const Matrix_<T>& X,
+                                           Matrix_<T>& Y) const {
+    SimTK_APIARGCHECK2_ALWAYS(X.nrow() == m_nrow,
+        "SparseMatrix_", "multiplyByTranspose",
+        "X has %d rows but matrix has %d rows.", X.nrow(), m_nrow);
+    Y.resize(m_ncol, X.ncol());
+    Vector_<T> y;
+    for (int c=0; c < X.ncol(); ++c) {
+        multiplyByTranspose(Vector_<T>(X(c)), y);
+        Y(c) = y;
+    }
+}
+
+// Standard two-pass CSC transpose; row indices come out sorted because we
+// visit the columns of A in order.
+template <class T>
+SparseMatrix_<T> SparseMatrix_<T>::transpose() const {
+    SparseMatrix_<T> At;
+    At.m_nrow = m_ncol; At.m_ncol = m_nrow;
+    At.m_colStart.assign(m_nrow+1, 0);
+    const int nnz = getNumNonzeros();
+    At.m_rowIndex.resize(nnz);
+    At.m_values.resize(nnz);
+
+    for (int p=0; p < nnz; ++p)
+        ++At.m_colStart[m_rowIndex[p]+1];
+    for (int i=0; i < m_nrow; ++i)
+        At.m_colStart[i+1] += At.m_colStart[i];
+
+    Array_<int> next(At.m_colStart.begin(), At.m_colStart.end()-1);
+    for (int j=0; j < m_ncol; ++j)
+        for (int p=m_colStart[j]; p < m_colStart[j+1]; ++p) {
+            const int q = next[m_rowIndex[p]]++;
+            At.m_rowIndex[q] = j;
+            At.m_values[q]   = m_values[p];
+        }
+    return At;
+}
+
+template <class T>
+SparseMatrix_<T> SparseMatrix_<T>::plusTranspose() const {
+    SimTK_APIARGCHECK2_ALWAYS(m_nrow == m_ncol,
+        "SparseMatrix_", "plusTranspose",
+        "Matrix must be square but was %d x %d.", m_nrow, m_ncol);
+    const SparseMatrix_<T> At = transpose();
+    SparseMatrix_<T> S;
+    S.m_nrow = S.m_ncol = m_ncol;
+    S.m_colStart.assign(m_ncol+1, 0);
+    S.m_rowIndex.reserve(2*getNumNonzeros());
+    S.m_values.reserve(2*getNumNonzeros());
+    // Merge the sorted columns of A and ~A.
+    for (int j=0; j < m_ncol; ++j) {
+        S.m_colStart[j] = (int)S.m_rowIndex.size();
+        int p = m_colStart[j], q = At.m_colStart[j];
+        const int pe = m_colStart[j+1], qe = At.m_colStart[j+1];
+        while (p < pe || q < qe) {
+            const int ip = p < pe ? m_rowIndex[p]    : m_nrow;
+            const int iq = q < qe ? At.m_rowIndex[q] : m_nrow;
+            if (ip == iq) {
+                S.m_rowIndex.push_back(ip);
+                S.m_values.push_back(m_values[p++] + At.m_values[q++]);
+            } else if (ip < iq) {
+                S.m_rowIndex.push_back(ip);
+                S.m_values.push_back(m_values[p++]);
+            } else {
+                S.m_rowIndex.push_back(iq);
+                S.m_values.push_back(At.m_values[q++]);
+            }
+        }
+    }
+    S.m_colStart[m_ncol] = (int)S.m_rowIndex.size();
+    return S;
+}
+
+template <class T>
+Matrix_<T> SparseMatrix_<T>::toMatrix() const {
+    Matrix_<T> dense(m_nrow, m_ncol, T(0));
+    for (int j=0; j < m_ncol; ++j)
+        for (int p=m_colStart[j]; p < m_colStart[j+1]; ++p)
+            dense(m_rowIndex[p], j) = m_values[p];
+    return dense;
+}
+
+// instantiate
+template class SparseMatrix_<float>;
+template class SparseMatrix_<double>;
+
+} // namespace SimTK
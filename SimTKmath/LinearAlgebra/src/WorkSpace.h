@@ -33,13 +33,18 @@
 
 namespace SimTK {
 
+// A simple array of T used for LAPACK work space and factored matrices.
+// resize() reallocates only when the new size exceeds the current capacity,
+// so a factorization object that is refactored repeatedly with matrices of
+// the same (or smaller) size doesn't touch the heap. The contents are not
+// preserved by resize().
 template <typename T>
 class TypedWorkSpace {
     public:
 
     // copy constructor
     TypedWorkSpace( const TypedWorkSpace& c ) {
-        size = c.size;
+        size = capacity = c.size;
 
         if( size == 0 ) {
              data = 0;
@@ -53,35 +58,45 @@ class TypedWorkSpace {
         if (&rhs == this)
             return *this;
 
-        delete [] data;
-        data = 0;
-        size = rhs.size;
-
-        if( size > 0) {
-             data = new T[size];
-             for(int i=0;i<size;i++) data[i] = rhs.data[i];
-        }
+        resize(rhs.size);
+        for(int i=0;i<size;i++) data[i] = rhs.data[i];
         return *this;
     }
 
     explicit TypedWorkSpace( int n ) {
-        size = n;
+        size = capacity = n;
         data = (n==0 ? 0 : new T[n]);
     }
 
-    TypedWorkSpace() : size(0), data(0) { }
+    TypedWorkSpace() : size(0), capacity(0), data(0) { }
 
     ~TypedWorkSpace() {
         delete [] data;
     }
     
     void resize( int n ) {
-        delete [] data;
+        if (n > capacity) {
+            delete [] data;
+            data = new T[n];
+            capacity = n;
+        }
+        size = n;
+    }
+
+    // Like resize() but keeps the first min(size,n) elements.
+    void resizeKeep( int n ) {
+        if (n > capacity) {
+            T* newData = new T[n];
+            for(int i=0;i<size;i++) newData[i] = data[i];
+            delete [] data;
+            data = newData;
+            capacity = n;
+        }
         size = n;
-        data = (n==0 ? 0 : new T[n]);
     }
 
     int size;
+    int capacity;
     T* data; 
 };
 
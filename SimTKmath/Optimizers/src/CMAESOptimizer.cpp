@@ -22,6 +22,7 @@
  * -------------------------------------------------------------------------- */
 
 #include "CMAESOptimizer.h"
+#include "OptimizerCheckpoint.h"
 
 #include <bitset>
 
@@ -49,7 +50,57 @@ Optimizer::OptimizerRep* CMAESOptimizer::clone() const {
     return new CMAESOptimizer(*this);
 }
 
+// Pass everything in evo that changes as the optimization proceeds to
+// ar.io(). The settings in evo.sp are not included since they are
+// recalculated from the options on resuming, nor is the timing of the
+// eigendecomposition, which isn't repeatable anyway.
+template <class Archive>
+static void transferState(cmaes_t& evo, Archive& ar) {
+    const int N = evo.sp.N, lambda = evo.sp.lambda;
+    cmaes_random_t& rand = evo.rand;
+    ar.io(rand.startseed); ar.io(rand.aktseed); ar.io(rand.aktrand);
+    ar.io(rand.rgrand, 32); ar.io(rand.flgstored); ar.io(rand.hold);
+
+    ar.io(evo.sigma);
+    ar.io(evo.rgxmean, N+1);
+    ar.io(evo.rgxbestever, N+2);
+    for (int i = 0; i < lambda; i++) {
+        ar.io(evo.rgrgx[i], N+1);
+    }
+    ar.io(evo.index, lambda);
+    ar.io(evo.arFuncValueHist, (int)evo.arFuncValueHist[-1]);
+    ar.io(evo.flgIniphase); ar.io(evo.flgStop);
+    ar.io(evo.chiN);
+    for (int i = 0; i < N; i++) {
+        ar.io(evo.C[i], i+1);
+        ar.io(evo.B[i], N);
+    }
+    ar.io(evo.rgD, N);
+    ar.io(evo.rgpc, N); ar.io(evo.rgps, N);
+    ar.io(evo.rgxold, N+1); ar.io(evo.rgout, N+1);
+    ar.io(evo.rgBDz, N); ar.io(evo.rgdTmp, N+1);
+    ar.io(evo.rgFuncValue, lambda);
+    ar.io(evo.publicFitness, lambda);
+    ar.io(evo.gen); ar.io(evo.countevals); ar.io(evo.state);
+    ar.io(evo.maxdiagC); ar.io(evo.mindiagC);
+    ar.io(evo.maxEW); ar.io(evo.minEW);
+    ar.io(evo.flgEigensysIsUptodate); ar.io(evo.flgCheckEigen);
+    ar.io(evo.genOfEigensysUpdate);
+    ar.io(evo.dMaxSignifKond); ar.io(evo.dLastMinEWgroesserNull);
+    ar.io(evo.flgresumedone);
+}
+
 Real CMAESOptimizer::optimize(SimTK::Vector& results)
+{
+    return run(results, false);
+}
+
+Real CMAESOptimizer::resume(SimTK::Vector& results)
+{
+    return run(results, true);
+}
+
+Real CMAESOptimizer::run(SimTK::Vector& results, bool resuming)
 { 
     const OptimizerSystem& sys = getOptimizerSystem();
     int n = sys.getNumParameters();
@@ -75,14 +126,47 @@ Real CMAESOptimizer::optimize(SimTK::Vector& results)
 
     }
 
-    // Check that the initial point is feasible.
-    // =========================================
-    checkInitialPointIsFeasible(results);
+    // Checkpoints, if requested.
+    std::string checkpointFile;
+    int checkpointInterval = 1;
+    const bool checkpointing =
+        getAdvancedStrOption("checkpoint_file", checkpointFile);
+    getAdvancedIntOption("checkpoint_interval", checkpointInterval);
+    SimTK_VALUECHECK_ALWAYS(1, checkpointInterval, INT_MAX,
+            "checkpoint_interval", "CMAESOptimizer::optimize");
+    SimTK_APIARGCHECK_ALWAYS(!resuming || checkpointing,
+            "Optimizer", "resume", "The checkpoint_file option isn't set.");
+
+    // Check that the initial point is feasible. When resuming, the starting
+    // point is replaced by the state in the checkpoint.
+    // ======================================================================
+    if (resuming) {
+        results.resize(n);
+        results.setToZero();
+    } else {
+        checkInitialPointIsFeasible(results);
+    }
     
     // Initialize cmaes.
     // =================
     double* funvals = init(evo, results);
     SimTK_CMAES_PRINT(diagnosticsLevel, printf("%s\n", cmaes_SayHello(&evo)));
+    if (resuming) {
+        try {
+            CheckpointReader checkpoint(checkpointFile, CMAES, n);
+            int lambda;
+            checkpoint.io(lambda);
+            SimTK_ERRCHK2_ALWAYS(lambda == evo.sp.lambda, "Optimizer::resume",
+                    "The checkpoint has popsize %d but the options give %d.",
+                    lambda, evo.sp.lambda);
+            transferState(evo, checkpoint);
+            checkpoint.finish();
+        } catch (...) {
+            cmaes_exit(&evo);
+            throw;
+        }
+        numIterations = (int)evo.gen;
+    }
     
     // Optimize.
     // =========
@@ -98,11 +182,32 @@ Real CMAESOptimizer::optimize(SimTK::Vector& results)
 
         // Evaluate the objective function on the samples.
         // ===============================================
-        evaluateObjectiveFunctionOnPopulation(evo, pop, funvals, executor.get());
+        try {
+            evaluateObjectiveFunctionOnPopulation(evo, pop, funvals, 
+                                                  executor.get());
+        } catch (...) {
+            cmaes_exit(&evo);
+            throw;
+        }
         
         // Update the distribution (mean, covariance, etc.).
         // =================================================
         cmaes_UpdateDistribution(&evo, funvals);
+        try {
+            countIteration(cmaes_Get(&evo, "fbestever"));
+        } catch (...) {
+            cmaes_exit(&evo);
+            throw;
+        }
+
+        // Save the state for resuming.
+        // ============================
+        if (checkpointing && (long)evo.gen % checkpointInterval == 0) {
+            CheckpointWriter checkpoint(CMAES, n);
+            checkpoint.io(evo.sp.lambda);
+            transferState(evo, checkpoint);
+            checkpoint.save(checkpointFile);
+        }
     }
 
     // Wrap up.
@@ -314,19 +419,59 @@ void CMAESOptimizer::evaluateObjectiveFunctionOnPopulation(
         ParallelExecutor* executor)
 {
     const OptimizerSystem& sys = getOptimizerSystem();
+    const int n = sys.getNumParameters();
+    const int popsize = (int)cmaes_Get(&evo, "popsize");
 
     // Execute in parallel.
     if (executor) {
-        Task task(*this, sys.getNumParameters(), pop, funvals);
-        executor->execute(task, (int)cmaes_Get(&evo, "popsize"));
+        numObjectiveEvals += popsize;
+        Timer timer(timeInUserFunctions);
+        Array_<int> status(popsize, 0);
+        Task task(*this, n, pop, funvals, status.begin());
+        executor->execute(task, popsize);
+        for (int i = 0; i < popsize; i++) {
+            checkObjectiveStatus(status[i]);
+        }
+        return;
     }
-    // Execute normally.
-    else {
-        for (int i = 0; i < cmaes_Get(&evo, "popsize"); i++) {
-            objectiveFuncWrapper(sys.getNumParameters(),
-                    pop[i], true, &funvals[i], this);
+
+    // Hand the whole generation to the system at once if it can evaluate a
+    // batch of points.
+    if (!batchUnavailable) {
+        Matrix x(n, popsize);
+        for (int i = 0; i < popsize; i++) {
+            x(i) = Vector(n, pop[i], true);
+        }
+        Vector f(popsize);
+        int status = 0;
+        try {
+            Timer timer(timeInUserFunctions);
+            status = sys.objectiveFuncBatch(x, f);
+        } catch (const Exception::UnimplementedVirtualMethod&) {
+            batchUnavailable = true;
+        }
+        if (!batchUnavailable) {
+            numObjectiveEvals += popsize;
+            checkObjectiveStatus(status);
+            for (int i = 0; i < popsize; i++) {
+                funvals[i] = f[i];
+            }
+            return;
         }
     }
+
+    // Execute normally.
+    for (int i = 0; i < popsize; i++) {
+        // The wrapper returns 1 for success.
+        const int ok = objectiveFuncWrapper(n, pop[i], true, &funvals[i], this);
+        checkObjectiveStatus(ok ? 0 : -1);
+    }
+}
+
+void CMAESOptimizer::checkObjectiveStatus(int status) {
+    SimTK_ERRCHK1_ALWAYS(status == 0, "CMAESOptimizer",
+        "The objective function returned nonzero status %d for a member of "
+        "the population.", status);
 }
 
 #undef SimTK_CMAES_PRINT
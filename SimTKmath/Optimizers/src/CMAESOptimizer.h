@@ -37,10 +37,14 @@ public:
     CMAESOptimizer(const OptimizerSystem& sys);
     OptimizerRep* clone() const override;
     Real optimize(SimTK::Vector& results) override;
+    Real resume(SimTK::Vector& results) override;
     OptimizerAlgorithm getAlgorithm() const override { return CMAES; }
 
 private:
 
+    // Optimize from results, or from the checkpoint file if resuming.
+    Real run(SimTK::Vector& results, bool resuming);
+
     void checkInitialPointIsFeasible(const SimTK::Vector& x) const;
 
     // Wrapper around cmaes_init.
@@ -50,24 +54,35 @@ private:
 
     void resampleToObeyLimits(cmaes_t& evo, double*const* pop);
 
-    // May use threading or MPI.
+    // May use threading, or the system's batch objective function. Throws
+    // if the objective function fails for any member of the population.
     void evaluateObjectiveFunctionOnPopulation(
             cmaes_t& evo, double*const* pop, double* funvals,
             ParallelExecutor* executor);
 
+    static void checkObjectiveStatus(int status);
+
     class Task : public SimTK::ParallelExecutor::Task {
     public:
-        Task(CMAESOptimizer& rep, int n, double*const* pop, double* funvals)
-            :   rep(rep), n(n), pop(pop), funvals(funvals) {}
+        Task(CMAESOptimizer& rep, int n, double*const* pop, double* funvals,
+             int* status)
+            :   rep(rep), n(n), pop(pop), funvals(funvals), status(status) {}
+        // This calls the system directly rather than through
+        // objectiveFuncWrapper(), whose statistics aren't threadsafe.
         void execute(int i) override
-        { rep.objectiveFuncWrapper(n, pop[i], true, &funvals[i], &rep); }
+        {   status[i] = rep.getOptimizerSystem().objectiveFunc(
+                            Vector(n, pop[i], true), true, funvals[i]); }
     private:
         CMAESOptimizer& rep;
         int n;
         double*const* pop;
         double* funvals;
+        int* status;
     };
 
+    // Set once the system is found not to override objectiveFuncBatch().
+    bool batchUnavailable = false;
+
 };
 
 } // namespace SimTK
@@ -121,6 +121,7 @@ InteriorPointOptimizer::InteriorPointOptimizer( const OptimizerSystem& sys )
         IpoptProblem nlp = CreateIpoptProblem(n, x_L, x_U, m, g_L, g_U, nele_jac, 
                            nele_hess, index_style, objectiveFuncWrapper, constraintFuncWrapper, 
                            gradientFuncWrapper, constraintJacobianWrapper, hessianWrapper);
+        SetIntermediateCallback(nlp, intermediateCallback);
 
         // If you want to verify which options are getting set in the optimizer, you can create a file ipopt.opt
         // with "print_user_options yes", and set print_level to (at least 1).  It will then print the options to the screen.
@@ -245,6 +246,7 @@ InteriorPointOptimizer::InteriorPointOptimizer( const OptimizerSystem& sys )
 
         SimTK::Real obj;
 
+        callbackException = nullptr;
         int status = IpoptSolve(nlp, x, NULL, &obj, mult_g, mult_x_L, mult_x_U, (void *)this );
 
         FreeIpoptProblem(nlp); 
@@ -255,6 +257,9 @@ InteriorPointOptimizer::InteriorPointOptimizer( const OptimizerSystem& sys )
            delete [] x_L;
         }
 
+        if (callbackException)
+            std::rethrow_exception(callbackException);
+
         if(status == Solved_To_Acceptable_Level) {
             std::cout << "Ipopt: Solved to acceptable level" << std::endl;
         } else if (status != Solve_Succeeded) {
@@ -270,5 +275,24 @@ InteriorPointOptimizer::InteriorPointOptimizer( const OptimizerSystem& sys )
         return(obj);
     }
 
+    int InteriorPointOptimizer::intermediateCallback(int algMode, int iteration,
+            Real f, Real infPr, Real infDu, Real mu, Real dNorm,
+            Real regularization, Real alphaDu, Real alphaPr, int lsTrials,
+            void* vrep)
+    {
+        InteriorPointOptimizer* rep =
+            static_cast<InteriorPointOptimizer*>(vrep);
+        // Ipopt also calls this for the starting point, which isn't counted
+        // as an iteration.
+        if (iteration == 0)
+            return 1;
+        try {
+            rep->countIteration(f);
+        } catch (...) {
+            rep->callbackException = std::current_exception();
+            return 0; // stop
+        }
+        return 1;
+    }
 
 } // namespace SimTK
@@ -33,6 +33,8 @@
 #include "simmath/Optimizer.h"
 #include "simmath/internal/OptimizerRep.h"
 
+#include <exception>
+
 namespace SimTK {
 
 
@@ -55,6 +57,14 @@ public:
     {   return InteriorPoint; }
 
 private:
+    // Called by Ipopt after each iteration. Ipopt swallows exceptions, so
+    // one thrown by the iteration callback is kept and rethrown once
+    // IpoptSolve() returns.
+    static int intermediateCallback(int algMode, int iteration, Real f,
+            Real infPr, Real infDu, Real mu, Real dNorm, Real regularization,
+            Real alphaDu, Real alphaPr, int lsTrials, void* vrep);
+    std::exception_ptr callbackException;
+
     Real         *mult_x_L;
     Real         *mult_x_U;
     Real         *mult_g;
@@ -27,6 +27,7 @@ struct IpoptProblemInfo
   Eval_Grad_F_CB eval_grad_f;
   Eval_Jac_G_CB eval_jac_g;
   Eval_H_CB eval_h;
+  Intermediate_CB intermediate_cb;
   SimTKIpopt::SmartPtr<SimTKIpopt::IpoptApplication> app;
 };
 
@@ -89,12 +90,20 @@ IpoptProblem CreateIpoptProblem(
   retval->eval_grad_f = eval_grad_f;
   retval->eval_jac_g = eval_jac_g;
   retval->eval_h = eval_h;
+  retval->intermediate_cb = NULL;
 
   retval->app = new SimTKIpopt::IpoptApplication();
 
   return retval;
 }
 
+Bool SetIntermediateCallback(IpoptProblem ipopt_problem,
+                             Intermediate_CB intermediate_cb)
+{
+  ipopt_problem->intermediate_cb = intermediate_cb;
+  return (Bool)true;
+}
+
 void FreeIpoptProblem(IpoptProblem ipopt_problem)
 {
   delete [] ipopt_problem->x_L;
@@ -195,6 +204,7 @@ enum ApplicationReturnStatus IpoptSolve(
                                 ipopt_problem->eval_grad_f,
                                 ipopt_problem->eval_jac_g,
                                 ipopt_problem->eval_h,
+                                ipopt_problem->intermediate_cb,
                                 x, mult_x_L, mult_x_U, g, mult_g,
                                 obj_val, user_data);
   }
@@ -27,6 +27,7 @@ namespace SimTKIpopt
                                      Eval_Grad_F_CB eval_grad_f,
                                      Eval_Jac_G_CB eval_jac_g,
                                      Eval_H_CB eval_h,
+                                     Intermediate_CB intermediate_cb,
                                      Number* x_sol,
                                      Number* z_L_sol,
                                      Number* z_U_sol,
@@ -54,6 +55,7 @@ namespace SimTKIpopt
       eval_grad_f_(eval_grad_f),
       eval_jac_g_(eval_jac_g),
       eval_h_(eval_h),
+      intermediate_cb_(intermediate_cb),
       user_data_(user_data),
       non_const_x_(NULL),
       x_sol_(x_sol),
@@ -297,6 +299,25 @@ namespace SimTKIpopt
     // don't need to store the status, we get the status from the OptimizeTNLP method
   }
 
+  bool StdInterfaceTNLP::intermediate_callback(AlgorithmMode mode,
+      Index iter, Number obj_value,
+      Number inf_pr, Number inf_du,
+      Number mu, Number d_norm,
+      Number regularization_size,
+      Number alpha_du, Number alpha_pr,
+      Index ls_trials,
+      const IpoptData* ip_data,
+      IpoptCalculatedQuantities* ip_cq)
+  {
+    Bool retval = 1;
+    if (intermediate_cb_) {
+      retval = (*intermediate_cb_)((Index)mode, iter, obj_value, inf_pr, inf_du,
+                                   mu, d_norm, regularization_size, alpha_du,
+                                   alpha_pr, ls_trials, user_data_);
+    }
+    return (retval!=0);
+  }
+
   void StdInterfaceTNLP::apply_new_x(bool new_x, Index n, const Number* x)
   {
     if (new_x) {
@@ -52,6 +52,7 @@ namespace SimTKIpopt
                      Eval_Grad_F_CB eval_grad_f,
                      Eval_Jac_G_CB eval_jac_g,
                      Eval_H_CB eval_h,
+                     Intermediate_CB intermediate_cb,
                      Number* x_sol,
                      Number* z_L_sol,
                      Number* z_U_sol,
@@ -114,6 +115,17 @@ namespace SimTKIpopt
                                    Index n, const Number* x, const Number* z_L, const Number* z_U,
                                    Index m, const Number* g, const Number* lambda,
                                    Number obj_value) override;
+
+    /** Intermediate callback method for the user.  Overloaded from TNLP */
+    virtual bool intermediate_callback(AlgorithmMode mode,
+                                       Index iter, Number obj_value,
+                                       Number inf_pr, Number inf_du,
+                                       Number mu, Number d_norm,
+                                       Number regularization_size,
+                                       Number alpha_du, Number alpha_pr,
+                                       Index ls_trials,
+                                       const IpoptData* ip_data,
+                                       IpoptCalculatedQuantities* ip_cq) override;
     //@}
 
   private:
@@ -162,6 +174,8 @@ namespace SimTKIpopt
     Eval_Jac_G_CB eval_jac_g_;
     /** Pointer to callback function evaluating Hessian of Lagrangian */
     Eval_H_CB eval_h_;
+    /** Pointer to intermediate callback function giving control to user */
+    Intermediate_CB intermediate_cb_;
     /** Pointer to user data */
     UserDataPtr user_data_;
     //@}
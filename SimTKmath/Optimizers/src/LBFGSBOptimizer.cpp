@@ -24,6 +24,7 @@
 #include "SimTKcommon.h"
 #include "simmath/internal/common.h"
 #include "LBFGSBOptimizer.h"
+#include "OptimizerCheckpoint.h"
 #include <cstring>
 
 using std::cout;
@@ -59,7 +60,30 @@ LBFGSBOptimizer::LBFGSBOptimizer( const OptimizerSystem& sys )
         nbd[i] = -1;
 } 
 
+// Pass everything setulb_() keeps between calls, with the current point and
+// its objective and gradient, to ar.io(). Restoring these and carrying on
+// calling setulb_() continues exactly where the checkpoint was written.
+template <class Archive>
+static void transferState(Archive& ar, int n, int nwa, int& numIterations,
+                          Real* x, Real& f, Real* gradient, Real* wa, int* iwa,
+                          char* task, char* csave, bool* lsave, int* isave,
+                          Real* dsave) {
+    ar.io(numIterations);
+    ar.io(x, n); ar.io(f); ar.io(gradient, n);
+    ar.io(wa, nwa); ar.io(iwa, 3*n);
+    ar.io(task, 61); ar.io(csave, 61);
+    ar.io(lsave, 4); ar.io(isave, 44); ar.io(dsave, 29);
+}
+
 Real LBFGSBOptimizer::optimize(  Vector &results ) {
+    return run(results, false);
+}
+
+Real LBFGSBOptimizer::resume( Vector& results ) {
+    return run(results, true);
+}
+
+Real LBFGSBOptimizer::run( Vector& results, bool resuming ) {
     int run_optimizer = 1;
     char task[61];
     Real f;
@@ -94,8 +118,9 @@ Real LBFGSBOptimizer::optimize(  Vector &results ) {
             nbd[i] = 0;          // unbounded
     }
 
+    const int nwa = (2*m + 4)*n + 12*m*m + 12*m;
     iwa = new int[3*n];
-    wa = new Real[((2*m + 4)*n + 12*m*m + 12*m)];
+    wa = new Real[nwa];
  
     Real factor;
     if( getAdvancedRealOption("factr", factor ) ) {
@@ -103,7 +128,39 @@ Real LBFGSBOptimizer::optimize(  Vector &results ) {
                                  "factr must be positive \n");
         factr = factor;
     }
-    strcpy( task, "START" );
+
+    // Checkpoints are written after every checkpoint_interval iterations.
+    std::string checkpointFile;
+    int checkpointInterval = 1;
+    const bool checkpointing = 
+        getAdvancedStrOption("checkpoint_file", checkpointFile);
+    getAdvancedIntOption("checkpoint_interval", checkpointInterval);
+    SimTK_VALUECHECK_ALWAYS(1, checkpointInterval, INT_MAX,
+            "checkpoint_interval", "LBFGSBOptimizer::optimize");
+    SimTK_APIARGCHECK_ALWAYS(!resuming || checkpointing,
+            "Optimizer", "resume", "The checkpoint_file option isn't set.");
+
+    if( resuming ) {
+        results.resize(n);
+        try {
+            CheckpointReader checkpoint(checkpointFile, LBFGSB, n);
+            int savedM;
+            checkpoint.io(savedM);
+            SimTK_ERRCHK2_ALWAYS(savedM == m, "Optimizer::resume",
+                "The checkpoint has limited memory history %d but the "
+                "Optimizer has %d.", savedM, m);
+            transferState(checkpoint, n, nwa, numIterations, &results[0], f,
+                          gradient, wa, iwa, task, csave, lsave, isave, dsave);
+            checkpoint.finish();
+        } catch (...) {
+            delete[] gradient;
+            delete[] iwa;
+            delete[] wa;
+            throw;
+        }
+    } else {
+        strcpy( task, "START" );
+    }
     while( run_optimizer ) { 
         setulb_(&n, &m, &results[0], lowerLimits,
                 upperLimits, nbd, &f, gradient,
@@ -115,6 +172,21 @@ Real LBFGSBOptimizer::optimize(  Vector &results ) {
             gradientFuncWrapper( n,  &results[0],  false, gradient, this);
         } else if( strncmp( task, "NEW_X", 5) == 0 ){
             //objectiveFuncWrapper( n, &results[0],  true, &f, (void*)this );
+            try {
+                countIteration(f);
+            } catch (...) {
+                delete[] gradient;
+                delete[] iwa;
+                delete[] wa;
+                throw;
+            }
+            if( checkpointing && numIterations % checkpointInterval == 0 ) {
+                CheckpointWriter checkpoint(LBFGSB, n);
+                checkpoint.io(m);
+                transferState(checkpoint, n, nwa, numIterations, &results[0], f,
+                              gradient, wa, iwa, task, csave, lsave, isave, dsave);
+                checkpoint.save(checkpointFile);
+            }
         } else {
             run_optimizer = 0;
             if( strncmp( task, "CONV", 4) != 0 ){
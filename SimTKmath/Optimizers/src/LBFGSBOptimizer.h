@@ -38,6 +38,7 @@ public:
     LBFGSBOptimizer(const OptimizerSystem& sys); 
 
     Real optimize(  Vector &results ) override;
+    Real resume( Vector& results ) override;
     OptimizerRep* clone() const override;
 
     OptimizerAlgorithm getAlgorithm() const override
@@ -50,6 +51,9 @@ public:
         int *isave, Real *dsave, long task_len, long csave_len);
 
 private:
+    // Optimize from results, or from the checkpoint file if resuming.
+    Real run( Vector& results, bool resuming );
+
     Real        factr;
     int         iprint[3];
     int         *nbd;
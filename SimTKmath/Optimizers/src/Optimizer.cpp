@@ -77,16 +77,20 @@ Optimizer::getOptimizerSystem() const {
 
 // copy constructor
 Optimizer::Optimizer( const Optimizer& c ) : rep(0) {
-    if (c.rep)
+    if (c.rep) {
         rep = c.rep->clone();
+        rep->setMyHandle(*this);
+    }
 }
 
 // copy assignment operator
 Optimizer& Optimizer::operator=(const Optimizer& rhs) {
     if (&rhs != this) {
         delete rep; rep = 0;
-        if (rhs.rep)
+        if (rhs.rep) {
             rep = rhs.rep->clone();
+            rep->setMyHandle(*this);
+        }
     }
     return *this;
 }
@@ -195,9 +199,48 @@ bool Optimizer::setAdvancedVectorOption( const char *option, const Vector value
 }
 
 Real Optimizer::optimize(SimTK::Vector   &results) {
-    return updRep().optimize(results);
+    OptimizerRep& r = updRep();
+    r.resetAllStatistics();
+    OptimizerRep::Timer timer(r.totalTime);
+    return r.optimize(results);
+}
+
+Real Optimizer::resume(SimTK::Vector& results) {
+    OptimizerRep& r = updRep();
+    r.resetAllStatistics();
+    OptimizerRep::Timer timer(r.totalTime);
+    return r.resume(results);
 }
 
+void Optimizer::setIterationCallback(const IterationCallback& callback) {
+    updRep().setIterationCallback(callback);
+}
+
+int Optimizer::getNumIterations() const 
+{   return getRep().getNumIterations(); }
+int Optimizer::getNumObjectiveEvals() const 
+{   return getRep().getNumObjectiveEvals(); }
+int Optimizer::getNumGradientEvals() const 
+{   return getRep().getNumGradientEvals(); }
+int Optimizer::getNumNumericalGradientEvals() const 
+{   return getRep().getNumNumericalGradientEvals(); }
+int Optimizer::getNumObjectiveEvalsForGradients() const 
+{   return getRep().getNumObjectiveEvalsForGradients(); }
+int Optimizer::getNumConstraintEvals() const 
+{   return getRep().getNumConstraintEvals(); }
+int Optimizer::getNumConstraintJacobianEvals() const 
+{   return getRep().getNumConstraintJacobianEvals(); }
+int Optimizer::getNumNumericalConstraintJacobianEvals() const 
+{   return getRep().getNumNumericalConstraintJacobianEvals(); }
+int Optimizer::getNumConstraintEvalsForJacobians() const 
+{   return getRep().getNumConstraintEvalsForJacobians(); }
+int Optimizer::getNumHessianEvals() const 
+{   return getRep().getNumHessianEvals(); }
+double Optimizer::getTimeInUserFunctions() const 
+{   return getRep().getTimeInUserFunctions(); }
+double Optimizer::getTimeInOptimizer() const 
+{   return getRep().getTimeInOptimizer(); }
+
 bool Optimizer::isUsingNumericalGradient() const {
     return getRep().isUsingNumericalGradient();
 }
@@ -0,0 +1,103 @@
+/* -------------------------------------------------------------------------- *
+ *                        Simbody(tm): SimTKmath                              *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2018 Stanford University and the Authors.           *
+ * Authors: Simbody developers                                                *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+#include "SimTKcommon.h"
+#include "OptimizerCheckpoint.h"
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+namespace SimTK {
+
+// Identifies the file type and layout; change the version if the layout of
+// any optimizer's state changes.
+static const char   CheckpointMagic[8] = {'S','i','m','T','K','O','p','t'};
+static const int    CheckpointVersion  = 1;
+
+CheckpointWriter::CheckpointWriter(OptimizerAlgorithm algorithm,
+                                   int numParameters) {
+    io(CheckpointMagic, 8);
+    io(CheckpointVersion);
+    io(int(algorithm));
+    io(numParameters);
+}
+
+void CheckpointWriter::save(const std::string& filename) const {
+    const std::string tmpname = filename + ".tmp";
+    {   std::ofstream out(tmpname.c_str(), std::ios::binary|std::ios::trunc);
+        out.write(buffer.data(), buffer.size());
+        SimTK_ERRCHK1_ALWAYS(out.good(), "Optimizer",
+            "Couldn't write optimizer checkpoint file '%s'.", tmpname.c_str());
+    }
+    #ifdef _WIN32
+        std::remove(filename.c_str()); // rename() won't replace on Windows
+    #endif
+    SimTK_ERRCHK2_ALWAYS(std::rename(tmpname.c_str(), filename.c_str()) == 0,
+        "Optimizer", "Couldn't rename optimizer checkpoint file '%s' to '%s'.",
+        tmpname.c_str(), filename.c_str());
+}
+
+CheckpointReader::CheckpointReader(const std::string& filename,
+                                   OptimizerAlgorithm algorithm,
+                                   int numParameters)
+:   filename(filename), pos(0) {
+    std::ifstream in(filename.c_str(), std::ios::binary);
+    SimTK_ERRCHK1_ALWAYS(in.good(), "Optimizer::resume",
+        "Couldn't open optimizer checkpoint file '%s'.", filename.c_str());
+    buffer.assign(std::istreambuf_iterator<char>(in),
+                  std::istreambuf_iterator<char>());
+
+    char magic[8]; int version, alg, n;
+    io(magic, 8);
+    SimTK_ERRCHK1_ALWAYS(std::memcmp(magic, CheckpointMagic, 8) == 0,
+        "Optimizer::resume",
+        "'%s' is not an optimizer checkpoint file.", filename.c_str());
+    io(version); io(alg); io(n);
+    SimTK_ERRCHK3_ALWAYS(version == CheckpointVersion, "Optimizer::resume",
+        "Checkpoint file '%s' has version %d; expected %d.",
+        filename.c_str(), version, CheckpointVersion);
+    SimTK_ERRCHK3_ALWAYS(alg == int(algorithm), "Optimizer::resume",
+        "Checkpoint file '%s' was written by algorithm %d, not %d.",
+        filename.c_str(), alg, int(algorithm));
+    SimTK_ERRCHK3_ALWAYS(n == numParameters, "Optimizer::resume",
+        "Checkpoint file '%s' is for %d parameters, not %d.",
+        filename.c_str(), n, numParameters);
+}
+
+void CheckpointReader::read(char* p, size_t nbytes) {
+    SimTK_ERRCHK1_ALWAYS(pos + nbytes <= buffer.size(), "Optimizer::resume",
+        "Checkpoint file '%s' is truncated or doesn't match the current "
+        "optimizer settings.", filename.c_str());
+    std::memcpy(p, buffer.data() + pos, nbytes);
+    pos += nbytes;
+}
+
+void CheckpointReader::finish() const {
+    SimTK_ERRCHK1_ALWAYS(pos == buffer.size(), "Optimizer::resume",
+        "Checkpoint file '%s' is longer than expected; it doesn't match the "
+        "current optimizer settings.", filename.c_str());
+}
+
+} // namespace SimTK
@@ -0,0 +1,79 @@
+#ifndef SimTK_SIMMATH_OPTIMIZER_CHECKPOINT_H_
+#define SimTK_SIMMATH_OPTIMIZER_CHECKPOINT_H_
+
+/* -------------------------------------------------------------------------- *
+ *                        Simbody(tm): SimTKmath                              *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2018 Stanford University and the Authors.           *
+ * Authors: Simbody developers                                                *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+#include "simmath/Optimizer.h"
+
+#include <string>
+
+namespace SimTK {
+
+/* Binary checkpoint files for the optimizers that can resume. A checkpoint is
+a short header identifying the algorithm and the number of parameters,
+followed by the raw bytes of the optimizer's state. The files are only meant
+to be read back on the same platform by the same build.
+
+An optimizer writes and reads its state with a single templated function
+that passes each field to io(), instantiated once with a CheckpointWriter and
+once with a CheckpointReader, so the two can't get out of step. */
+class CheckpointWriter {
+public:
+    CheckpointWriter(OptimizerAlgorithm algorithm, int numParameters);
+
+    template <class T> void io(const T* p, int count)
+    {   buffer.append(reinterpret_cast<const char*>(p), count*sizeof(T)); }
+    template <class T> void io(const T& v) {io(&v, 1);}
+
+    // Write the file under a temporary name and then rename it, so that an
+    // earlier checkpoint survives if we're killed while writing.
+    void save(const std::string& filename) const;
+private:
+    std::string buffer;
+};
+
+class CheckpointReader {
+public:
+    // Read the whole file, throwing if it can't be read or was written by a
+    // different algorithm or for a different number of parameters.
+    CheckpointReader(const std::string& filename,
+                     OptimizerAlgorithm algorithm, int numParameters);
+
+    template <class T> void io(T* p, int count)
+    {   read(reinterpret_cast<char*>(p), count*sizeof(T)); }
+    template <class T> void io(T& v) {io(&v, 1);}
+
+    // Throw unless everything in the file has been read.
+    void finish() const;
+private:
+    void read(char* p, size_t nbytes);
+
+    std::string filename;
+    std::string buffer;
+    size_t      pos;
+};
+
+} // namespace SimTK
+
+#endif // SimTK_SIMMATH_OPTIMIZER_CHECKPOINT_H_
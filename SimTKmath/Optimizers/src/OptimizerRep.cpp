@@ -53,6 +53,34 @@ Optimizer::OptimizerRep::~OptimizerRep() {
     delete of;
 }
 
+void Optimizer::OptimizerRep::resetAllStatistics() {
+    numIterations                       = 0;
+    numObjectiveEvals                   = 0;
+    numGradientEvals                    = 0;
+    numNumericalGradientEvals           = 0;
+    numObjectiveEvalsForGradients       = 0;
+    numConstraintEvals                  = 0;
+    numConstraintJacobianEvals          = 0;
+    numNumericalConstraintJacobianEvals = 0;
+    numConstraintEvalsForJacobians      = 0;
+    numHessianEvals                     = 0;
+    timeInUserFunctions                 = 0;
+    totalTime                           = 0;
+}
+
+void Optimizer::OptimizerRep::countIteration(Real f) const {
+    ++numIterations;
+    if (iterationCallback)
+        iterationCallback(*myHandle, numIterations, f);
+}
+
+Real Optimizer::OptimizerRep::resume(Vector& results) {
+    SimTK_APIARGCHECK1_ALWAYS(false, "Optimizer", "resume",
+        "Optimizer algorithm %d can't resume from a checkpoint; only CMAES "
+        "and LBFGSB can.", (int)getAlgorithm());
+    return NaN;
+}
+
 void Optimizer::OptimizerRep::setConvergenceTolerance(Real accuracy ) {
    convergenceTolerance = accuracy;
 }
@@ -163,6 +191,8 @@ int Optimizer::OptimizerRep::objectiveFuncWrapper
     const bool      isNewParam  = (newX==1);
     Real&           frep        = *f;
 
+    ++rep->numObjectiveEvals;
+    Timer timer(rep->timeInUserFunctions);
     return (rep->getOptimizerSystem().objectiveFunc(params, isNewParam, frep)==0) 
             ? 1 : 0;
 }
@@ -181,12 +211,19 @@ int Optimizer::OptimizerRep::gradientFuncWrapper
 
     const OptimizerSystem&  osys = rep->getOptimizerSystem();
 
+    Timer timer(rep->timeInUserFunctions);
     if( rep->isUsingNumericalGradient() ) {
+        const Differentiator& diff = rep->getGradientDifferentiator();
+        const int callsBefore = diff.getNumCallsToUserFunction();
         osys.objectiveFunc(params, true, fy0);
-        rep->getGradientDifferentiator().calcGradient(params, fy0, grad_vec);
+        diff.calcGradient(params, fy0, grad_vec);
+        ++rep->numNumericalGradientEvals;
+        rep->numObjectiveEvalsForGradients += 
+            1 + diff.getNumCallsToUserFunction() - callsBefore;
         return 1;
     }
 
+    ++rep->numGradientEvals;
     return (osys.gradientFunc(params, isNewParam, grad_vec)==0)
             ? 1 : 0;
 }
@@ -202,6 +239,8 @@ int Optimizer::OptimizerRep::constraintFuncWrapper
     Vector          constraints(m, g, true);
     const bool      isNewParam = (newX==1);
 
+    ++rep->numConstraintEvals;
+    Timer timer(rep->timeInUserFunctions);
     return (rep->getOptimizerSystem().constraintFunc(params, isNewParam, constraints)==0)
             ? 1 : 0;
 }
@@ -234,12 +273,20 @@ int Optimizer::OptimizerRep::constraintJacobianWrapper
     Matrix          jac(m,n);           // This is a new local temporary. TODO: get rid of this
 
     int status = -1;
-    if( rep->isUsingNumericalJacobian() ) {
-        Vector sfy0(m);            
-        status = rep->getOptimizerSystem().constraintFunc(params, true, sfy0);
-        rep->getJacobianDifferentiator().calcJacobian( params, sfy0, jac);
-    } else {
-        status = rep->getOptimizerSystem().constraintJacobian(params, isNewParam, jac);
+    {   Timer timer(rep->timeInUserFunctions);
+        if( rep->isUsingNumericalJacobian() ) {
+            const Differentiator& diff = rep->getJacobianDifferentiator();
+            const int callsBefore = diff.getNumCallsToUserFunction();
+            Vector sfy0(m);            
+            status = rep->getOptimizerSystem().constraintFunc(params, true, sfy0);
+            diff.calcJacobian( params, sfy0, jac);
+            ++rep->numNumericalConstraintJacobianEvals;
+            rep->numConstraintEvalsForJacobians += 
+                1 + diff.getNumCallsToUserFunction() - callsBefore;
+        } else {
+            ++rep->numConstraintJacobianEvals;
+            status = rep->getOptimizerSystem().constraintJacobian(params, isNewParam, jac);
+        }
     }
 
     // Transpose the jacobian because Ipopt indexes in Row major format.
@@ -266,6 +313,8 @@ int Optimizer::OptimizerRep::hessianWrapper
     Vector hess(n*n,values,true); 
     const bool isNewParam = (newX==1);
 
+    ++rep->numHessianEvals;
+    Timer timer(rep->timeInUserFunctions);
     return rep->getOptimizerSystem().hessian(coeff, isNewParam, hess)==0
             ? 1 : 0;
 }
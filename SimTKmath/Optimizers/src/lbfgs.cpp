@@ -532,6 +532,15 @@ void SimTK::LBFGSOptimizer::lbfgs_
         }
         converged = (gnorm <= *eps);
 
+        try {
+            countIteration(*f);
+        } catch (...) {
+            delete [] diag;
+            delete [] gradient;
+            delete [] w;
+            throw;
+        }
+
         if (iprint[0] > 0)
             lb1_(iprint, &iter, &nfun, &gnorm, &n, &m, 
                  x, f, gradient, &stp, &converged);
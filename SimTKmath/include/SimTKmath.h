@@ -48,6 +48,9 @@
 #include "simmath/internal/CollisionDetectionAlgorithm.h"
 
 #include "simmath/LinearAlgebra.h"
+#include "simmath/SparseMatrix.h"
+#include "simmath/IterativeSolver.h"
+#include "simmath/LanczosEigenSolver.h"
 #include "simmath/Differentiator.h"
 #include "simmath/Optimizer.h"
 #include "simmath/MultibodyGraphMaker.h"
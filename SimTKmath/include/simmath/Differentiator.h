@@ -31,6 +31,7 @@
 
 #include "SimTKcommon.h"
 #include "simmath/internal/common.h"
+#include "simmath/SparseMatrix.h"
 
 namespace SimTK {
 
@@ -73,6 +74,30 @@ namespace SimTK {
  * Then the derivative, gradient element, or Jacobian column is computed 
  * as df/dy=[f(x+h)-f(x)]/h (1st order) or df/dy=[f(x+h)-f(x-h)]/(2h) 
  * (2nd order).
+ *
+ * @par Multithreading
+ *
+ * The gradient elements and Jacobian columns are independent of one another,
+ * so they can be evaluated concurrently; see setNumberOfThreads(). That is
+ * only done for a function that either declares that its f() may be called
+ * from several threads at once (Function::setIsThreadSafe()) or can make
+ * independent copies of itself, one per thread (by overriding
+ * GradientFunction::cloneForThread() or JacobianFunction::cloneForThread()).
+ * Each element or column is computed exactly as it would be serially, so
+ * the results are bitwise identical to the single threaded ones provided
+ * the function itself gives the same result for the same argument.
+ *
+ * @par Sparse Jacobians
+ *
+ * If a JacobianFunction is given a sparsity pattern (see
+ * JacobianFunction::setSparsityPattern()), its columns are partitioned into
+ * groups in which no two columns have a nonzero in the same row, using the
+ * greedy column coloring of Curtis, Powell and Reid (1974). All the
+ * parameters of a group are perturbed together, so a Jacobian costs one
+ * function evaluation per group (two for central differences) instead of one
+ * per parameter. The number of groups is at least the largest number of
+ * nonzeros in a row and is often close to it. Elements outside the pattern
+ * are returned as zero, and can be returned as a SparseMatrix.
  */
 class SimTK_SIMMATH_EXPORT Differentiator {
 public:
@@ -115,6 +140,10 @@ public:
                         Method=UnspecifiedMethod) const;
     void calcJacobian  (const Vector& y0, const Vector& fy0, Matrix& dfdy,
                         Method=UnspecifiedMethod) const;
+    /** Calculate a Jacobian in sparse form; the function must have a
+    sparsity pattern, and \a dfdy gets that pattern. **/
+    void calcJacobian  (const Vector& y0, const Vector& fy0,
+                        SparseMatrix& dfdy, Method=UnspecifiedMethod) const;
 
     // These provide a simpler though less efficient interface. They will
     // do some heap allocation, and will make an initial unperturbed call
@@ -123,6 +152,15 @@ public:
     Vector calcGradient  (const Vector& y0, Method=UnspecifiedMethod) const;
     Matrix calcJacobian  (const Vector& y0, Method=UnspecifiedMethod) const;
 
+    /** Set the number of threads used to evaluate the elements of a
+    gradient or the columns of a Jacobian. The default is 1, meaning they are
+    evaluated one after another on the calling thread; 0 means use as many
+    threads as there are processors. Functions that are neither thread safe
+    nor cloneable are always evaluated serially. **/
+    Differentiator& setNumberOfThreads(int numThreads);
+    /** Get the number of threads used to evaluate gradients and Jacobians. **/
+    int getNumberOfThreads() const;
+
     // Statistics (mutable)
     void resetAllStatistics();                 // reset all stats to zero
     int getNumDifferentiations() const;        // total # calls of calcWhatever
@@ -154,11 +192,16 @@ public:
     Function& setNumFunctions(int);
     Function& setNumParameters(int);
     Function& setEstimatedAccuracy(Real);
+    /** Declare that f() may be called concurrently from several threads on
+    this one object, so that a multithreaded Differentiator can share it
+    between its threads. The default is false. **/
+    Function& setIsThreadSafe(bool);
 
     // These values are fixed after construction.
     int  getNumFunctions()  const;
     int  getNumParameters() const;
     Real getEstimatedAccuracy() const; // approx. "roundoff" in f calculation
+    bool isThreadSafe() const;
 
     // Statistics (mutable)
     void resetAllStatistics();
@@ -169,7 +212,7 @@ public:
     class FunctionRep;
 protected:
     Function();
-    ~Function();
+    virtual ~Function();
 
     // opaque implementation for binary compatibility
     FunctionRep* rep;
@@ -209,6 +252,23 @@ class SimTK_SIMMATH_EXPORT Differentiator::GradientFunction : public Differentia
 public:
     virtual int f(const Vector& y, Real& fy) const=0;
 
+    /** Evaluate the function at each column of \a y, putting the values in
+    \a fy (resized to y.ncol()); return 0 when successful. Override this if
+    you can evaluate several points faster together than one at a time. When
+    a gradient is evaluated on a single thread, the Differentiator then
+    passes the perturbed points to it in batches of at most 64 columns. If
+    you don't override it, the Differentiator calls f() on each perturbed
+    point in turn. **/
+    virtual int fBatch(const Matrix& y, Vector& fy) const;
+
+    /** Override this to let a multithreaded Differentiator use a function
+    that is not thread safe. It must return a new heap-allocated object that
+    computes the same function, with the same dimensions, and that can be
+    evaluated concurrently with this one and with any other clones. Clones
+    are made at the start of each multithreaded differentiation and deleted
+    at its end. The default returns null, meaning no clone is available. **/
+    virtual GradientFunction* cloneForThread() const {return nullptr;}
+
 protected:
     explicit GradientFunction(int ny=-1, Real acc=-1);
     virtual ~GradientFunction() { }
@@ -228,6 +288,31 @@ class SimTK_SIMMATH_EXPORT Differentiator::JacobianFunction : public Differentia
 public:
     virtual int f(const Vector& y, Vector& fy) const=0;
 
+    /** Declare which elements of the Jacobian can be nonzero: the pattern
+    must be getNumFunctions() x getNumParameters() and have an entry at (i,j)
+    if f[i] can depend on y[j]; its values are not used. Differentiators then
+    perturb structurally independent parameters together (see
+    Differentiator). **/
+    void setSparsityPattern(const SparseMatrix& pattern);
+    /** Go back to treating the Jacobian as dense. **/
+    void clearSparsityPattern();
+    bool hasSparsityPattern() const;
+    /** Return the sparsity pattern; only valid if hasSparsityPattern(). **/
+    const SparseMatrix& getSparsityPattern() const;
+    /** Return the number of groups of structurally independent columns
+    found for the sparsity pattern, which is the number of function
+    evaluations a forward difference Jacobian needs (not counting the
+    unperturbed one). Without a pattern this is getNumParameters(). **/
+    int getNumColumnGroups() const;
+
+    /** Override this to let a multithreaded Differentiator use a function
+    that is not thread safe. It must return a new heap-allocated object that
+    computes the same function, with the same dimensions, and that can be
+    evaluated concurrently with this one and with any other clones. Clones
+    are made at the start of each multithreaded differentiation and deleted
+    at its end. The default returns null, meaning no clone is available. **/
+    virtual JacobianFunction* cloneForThread() const {return nullptr;}
+
 protected:
     explicit JacobianFunction(int nf=-1, int ny=-1, Real acc=-1); 
     virtual ~JacobianFunction() { }
@@ -0,0 +1,221 @@
+#ifndef SimTK_SIMMATH_ITERATIVE_SOLVER_H_
+#define SimTK_SIMMATH_ITERATIVE_SOLVER_H_
+
+/* -------------------------------------------------------------------------- *
+ *                        Simbody(tm): SimTKmath                              *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2018 Stanford University and the Authors.           *
+ * Authors: Simbody developers                                                *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+/** @file
+ * Matrix-free linear operators and the Krylov subspace solvers that use them.
+ */
+
+#include "SimTKcommon.h"
+#include "simmath/internal/common.h"
+#include "simmath/SparseMatrix.h"
+
+#include <functional>
+
+namespace SimTK {
+
+//==============================================================================
+//                            LINEAR OPERATOR
+//==============================================================================
+/** Abstract square linear operator y = A*x on Real vectors. The iterative
+solvers see a matrix only through this interface, so A never has to be formed;
+it can be anything that can be multiplied by a vector, for example a
+composition of Simbody's O(n) operators like
+SimbodyMatterSubsystem::multiplyByMInv() and multiplyByG(). The same
+interface is used for preconditioners, which apply an approximation to A^-1.
+**/
+class SimTK_SIMMATH_EXPORT LinearOperator {
+public:
+    virtual ~LinearOperator() {}
+    /** Return the dimension n of this n X n operator. **/
+    virtual int size() const = 0;
+    /** Calculate y = A*x. x has size() elements; y must be resized if
+    necessary. x and y are never the same object. **/
+    virtual void apply(const Vector& x, Vector& y) const = 0;
+};
+
+/** A LinearOperator that forwards to a function or lambda; this is the most
+convenient way to wrap a matrix-free product. **/
+class SimTK_SIMMATH_EXPORT FunctionOperator : public LinearOperator {
+public:
+    typedef std::function<void(const Vector& x, Vector& y)> Function;
+    /** Make an n X n operator whose apply() calls `f`. **/
+    FunctionOperator(int n, const Function& f) : n(n), f(f) {}
+    int size() const override {return n;}
+    void apply(const Vector& x, Vector& y) const override {f(x, y);}
+private:
+    int      n;
+    Function f;
+};
+
+/** A LinearOperator that multiplies by a dense square Matrix, which is
+referenced, not copied, and must outlive the operator. **/
+class SimTK_SIMMATH_EXPORT MatrixOperator : public LinearOperator {
+public:
+    explicit MatrixOperator(const Matrix& A) : A(A) {
+        SimTK_APIARGCHECK2_ALWAYS(A.nrow()==A.ncol(), "MatrixOperator",
+            "MatrixOperator", "Matrix must be square but was %d X %d.",
+            A.nrow(), A.ncol());
+    }
+    int size() const override {return A.nrow();}
+    void apply(const Vector& x, Vector& y) const override {y = A*x;}
+private:
+    const Matrix& A;
+};
+
+/** A LinearOperator that multiplies by a square SparseMatrix, which is
+referenced, not copied, and must outlive the operator. **/
+class SimTK_SIMMATH_EXPORT SparseMatrixOperator : public LinearOperator {
+public:
+    explicit SparseMatrixOperator(const SparseMatrix& A) : A(A) {
+        SimTK_APIARGCHECK2_ALWAYS(A.nrow()==A.ncol(), "SparseMatrixOperator",
+            "SparseMatrixOperator", "Matrix must be square but was %d X %d.",
+            A.nrow(), A.ncol());
+    }
+    int size() const override {return A.nrow();}
+    void apply(const Vector& x, Vector& y) const override {A.multiply(x, y);}
+private:
+    const SparseMatrix& A;
+};
+
+/** The Jacobi (diagonal) preconditioner: multiplies by the inverse of the
+given diagonal of A. Zero diagonal elements are treated as 1. **/
+class SimTK_SIMMATH_EXPORT DiagonalPreconditioner : public LinearOperator {
+public:
+    explicit DiagonalPreconditioner(const Vector& diagA);
+    int size() const override {return invDiag.size();}
+    void apply(const Vector& x, Vector& y) const override;
+private:
+    Vector invDiag;
+};
+
+//==============================================================================
+//                            ITERATIVE SOLVER
+//==============================================================================
+/** Krylov subspace solvers for A*x = b, where A is given only as a
+LinearOperator. Memory use is a few vectors of length n (plus the Krylov
+basis for GMRES), and iteration stops as soon as the residual is small
+enough, so these are suited to large systems that are expensive or
+impossible to form and factor.
+
+Choose the method according to what is known about A:
+  - ConjugateGradient: A symmetric positive definite. The preconditioner
+    must be symmetric positive definite too.
+  - MINRES: A symmetric, possibly indefinite or singular (for example a
+    saddle point system). The preconditioner must be symmetric positive
+    definite.
+  - GMRES: any nonsingular A. This is restarted GMRES with right
+    preconditioning; see setRestart().
+
+The iteration stops when the residual norm |b - A*x| is no more than
+getTolerance()*|b|, or after getMaxIterations() operator applications.
+(MINRES with a preconditioner measures the residual in the norm defined by
+the preconditioner, which is what it minimizes; the true residual is still
+what getResidualNorm() reports afterwards.)
+
+Example:
+@code
+    FunctionOperator A(n, [&](const Vector& x, Vector& y) {
+        matter.multiplyByMInv(state, x, y); });
+    IterativeSolver cg(IterativeSolver::ConjugateGradient);
+    cg.setTolerance(1e-10);
+    Vector x;
+    if (!cg.solve(A, b, x)) { ... }
+@endcode **/
+class SimTK_SIMMATH_EXPORT IterativeSolver {
+public:
+    enum Method {
+        ConjugateGradient = 0,
+        MINRES            = 1,
+        GMRES             = 2
+    };
+
+    explicit IterativeSolver(Method method = ConjugateGradient)
+    :   method(method), tol(1e-8), maxIters(-1), restart(30),
+        preconditioner(nullptr), numIters(0), residualNorm(NaN),
+        converged(false) {}
+
+    Method getMethod() const {return method;}
+    void setMethod(Method m) {method = m;}
+
+    /** Set the relative residual tolerance; the default is 1e-8. **/
+    void setTolerance(Real relTol);
+    Real getTolerance() const {return tol;}
+
+    /** Set the maximum number of iterations, each of which applies the
+    operator once. A negative value (the default) means 10*n, or n for GMRES
+    when n is no more than the restart length. **/
+    void setMaxIterations(int maxIterations) {maxIters = maxIterations;}
+    int getMaxIterations() const {return maxIters;}
+
+    /** Set the number of GMRES iterations between restarts, which is also
+    the number of basis vectors GMRES keeps; the default is 30. **/
+    void setRestart(int m);
+    int getRestart() const {return restart;}
+
+    /** Supply a preconditioner M^-1, an approximate inverse of A that is
+    cheap to apply, or null for none. The operator is referenced, not copied,
+    and must stay alive while it is in use here. **/
+    void setPreconditioner(const LinearOperator* M) {preconditioner = M;}
+    const LinearOperator* getPreconditioner() const {return preconditioner;}
+
+    /** Solve A*x = b. If x has the right size on entry it is used as the
+    initial guess; otherwise the guess is zero. Returns true if the
+    tolerance was met. On a false return x is the best iterate found; this
+    happens when the iteration limit is reached or the method breaks down,
+    for example when ConjugateGradient meets a direction of nonpositive
+    curvature because A is not positive definite. **/
+    bool solve(const LinearOperator& A, const Vector& b, Vector& x);
+
+    /** Return the number of operator applications done by the last solve(),
+    not counting the extra one used to compute the final residual. **/
+    int getNumIterations() const {return numIters;}
+    /** Return |b - A*x| for the solution returned by the last solve(). **/
+    Real getResidualNorm() const {return residualNorm;}
+    /** Return the value returned by the last solve(). **/
+    bool isConverged() const {return converged;}
+
+private:
+    bool solveCG(const LinearOperator& A, const Vector& b, Vector& x,
+                 int maxIt, Real target);
+    bool solveMINRES(const LinearOperator& A, const Vector& b, Vector& x,
+                     int maxIt, Real target);
+    bool solveGMRES(const LinearOperator& A, const Vector& b, Vector& x,
+                    int maxIt, Real target);
+
+    Method                  method;
+    Real                    tol;
+    int                     maxIters;
+    int                     restart;
+    const LinearOperator*   preconditioner;
+
+    int                     numIters;
+    Real                    residualNorm;
+    bool                    converged;
+};
+
+} // namespace SimTK
+
+#endif // SimTK_SIMMATH_ITERATIVE_SOLVER_H_
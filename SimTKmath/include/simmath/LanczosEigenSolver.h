@@ -0,0 +1,132 @@
+#ifndef SimTK_SIMMATH_LANCZOS_EIGEN_SOLVER_H_
+#define SimTK_SIMMATH_LANCZOS_EIGEN_SOLVER_H_
+
+/* -------------------------------------------------------------------------- *
+ *                        Simbody(tm): SimTKmath                              *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2018 Stanford University and the Authors.           *
+ * Authors: Simbody developers                                                *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+/** @file
+ * A shift-invert Lanczos eigensolver for large symmetric problems given as
+ * linear operators.
+ */
+
+#include "SimTKcommon.h"
+#include "simmath/internal/common.h"
+#include "simmath/IterativeSolver.h"
+
+namespace SimTK {
+
+/** Computes a few eigenvalues and eigenvectors of the symmetric generalized
+problem K*x = lambda*M*x, with K symmetric and M symmetric positive definite,
+when K and M are available only as LinearOperator objects. This is the
+problem of modal analysis: K is a stiffness matrix and M a mass matrix (which
+for a multibody system can be applied in O(n) time by
+SimbodyMatterSubsystem::multiplyByM()). If no M is given the standard problem
+K*x = lambda*x is solved. Unlike Eigen, neither matrix is ever formed, so
+memory use is O(n) times the number of Lanczos vectors kept.
+
+The eigenvalues found are the ones nearest a shift sigma (default 0, which
+gives the lowest modes of a positive definite K). They are computed by
+Lanczos iteration, in the M inner product, on the shift-inverted operator
+(K - sigma*M)^-1 * M, whose largest eigenvalues 1/(lambda - sigma) correspond
+to the wanted ones and converge fastest. The basis is kept fully
+M-orthogonal, and when it reaches getNumLanczosVectors() it is restarted
+keeping the best Ritz vectors (thick restart).
+
+Applying (K - sigma*M)^-1 is up to you when you can do it cheaply, for example
+with a sparse factorization; supply it with setShiftInverseOperator().
+Otherwise each application is done by MINRES iteration on K - sigma*M, which
+needs no factorization at all but costs many K and M products.
+
+Example:
+@code
+    FunctionOperator K(n, [&](const Vector& x, Vector& y) {...});
+    FunctionOperator M(n, [&](const Vector& x, Vector& y) {
+        matter.multiplyByM(state, x, y); });
+    LanczosEigenSolver modes(K, &M);
+    Vector lambda; Matrix phi;
+    modes.calcEigenvaluesAndVectors(10, lambda, phi); // 10 lowest modes
+@endcode **/
+class SimTK_SIMMATH_EXPORT LanczosEigenSolver {
+public:
+    /** Solve K*x = lambda*M*x, or K*x = lambda*x if M is null. The operators
+    are referenced, not copied, and must outlive this object. **/
+    explicit LanczosEigenSolver(const LinearOperator& K,
+                                const LinearOperator* M = nullptr);
+
+    /** Set the shift sigma; the eigenvalues nearest sigma are found. It must
+    not be an eigenvalue. The default is 0. **/
+    void setShift(Real sigma) {shift = sigma;}
+    Real getShift() const {return shift;}
+
+    /** Supply an operator that applies (K - sigma*M)^-1 for the current
+    shift, or null (the default) to have it done iteratively. It is
+    referenced, not copied. **/
+    void setShiftInverseOperator(const LinearOperator* op) {shiftInverse = op;}
+
+    /** Set the relative accuracy required of the eigenvalues; the default
+    is 1e-10. **/
+    void setTolerance(Real relTol);
+    Real getTolerance() const {return tol;}
+
+    /** Set the number of Lanczos vectors kept between restarts, which must
+    exceed the number of eigenvalues requested. The default of 0 means
+    max(2*nev+1, 20), limited to the problem size. **/
+    void setNumLanczosVectors(int ncv);
+    int getNumLanczosVectors() const {return numLanczosVectors;}
+
+    /** Set the maximum number of restarts; the default is 300. **/
+    void setMaxRestarts(int maxRestarts);
+    int getMaxRestarts() const {return maxRestarts;}
+
+    /** Compute the `nev` eigenvalues nearest the shift and their eigenvectors.
+    On return `values` holds them in ascending order and column i of
+    `vectors` is the eigenvector for values[i], normalized so that
+    ~x*M*x = 1. Returns true if all of them converged; if not, the ones that
+    did are returned, and getNumConverged() says how many. Throws if
+    (K - sigma*M)^-1 is applied by MINRES and that fails to converge. **/
+    bool calcEigenvaluesAndVectors(int nev, Vector& values, Matrix& vectors);
+
+    /** Return the number of eigenvalues that converged in the last call. **/
+    int getNumConverged() const {return numConverged;}
+    /** Return the number of times the shift-inverted operator was applied in
+    the last call. **/
+    int getNumIterations() const {return numIters;}
+
+private:
+    void applyOp(const Vector& Mx, Vector& y) const;
+
+    const LinearOperator&   K;
+    const LinearOperator*   M;
+    const LinearOperator*   shiftInverse;
+    Real                    shift;
+    Real                    tol;
+    int                     numLanczosVectors;
+    int                     maxRestarts;
+
+    int                     numConverged;
+    int                     numIters;
+};
+
+} // namespace SimTK
+
+#endif // SimTK_SIMMATH_LANCZOS_EIGEN_SOLVER_H_
@@ -45,6 +45,13 @@ static const double DefaultRecpCondition = 1e-12;
 
 /**
  * Base class for the various matrix factorizations. 
+ *
+ * Calling factor() again on an existing factorization object reuses the
+ * storage it already has when the new matrix has the same element type and is
+ * no bigger than the largest one it has seen, so a long-lived object that is
+ * refactored repeatedly (say once per time step) doesn't allocate memory
+ * after the first time. FactorQTZ also remembers the LAPACK work space size
+ * it needs for the current dimensions.
  */
 class SimTK_SIMMATH_EXPORT Factor {
 public:
@@ -140,6 +147,150 @@ class SimTK_SIMMATH_EXPORT FactorQTZ: public Factor {
     protected:
     class FactorQTZRepBase *rep;
 }; // class FactorQTZ
+
+
+class FactorCholeskyRepBase;
+/**
+ * Class for performing Cholesky factorizations A = L*~L of symmetric,
+ * positive definite matrices. Only the lower triangle of A is used. This is
+ * about twice as fast as FactorLU and is the method of choice for matrices
+ * that are known to be positive definite, such as mass matrices or
+ * G*M^-1*~G. Use isPositiveDefinite() after factoring to find out whether
+ * that assumption held; if not, use FactorLDLT, FactorQTZ or FactorLU instead.
+ * Only real (float or double) matrices are supported.
+ */
+class SimTK_SIMMATH_EXPORT FactorCholesky: public Factor {
+    public:
+
+    ~FactorCholesky();
+
+    FactorCholesky();
+    FactorCholesky( const FactorCholesky& c );
+    FactorCholesky& operator=(const FactorCholesky& rhs);
+
+    /// do Cholesky factorization of a symmetric positive definite matrix
+    template <class ELT> FactorCholesky( const Matrix_<ELT>& m );
+    /// do Cholesky factorization of a symmetric positive definite matrix
+    template <class ELT> void factor( const Matrix_<ELT>& m );
+    /// solves a single right hand side
+    template <class ELT> void solve( const Vector_<ELT>& b, Vector_<ELT>& x ) const;
+    /// solves multiple right hand sides
+    template <class ELT> void solve( const Matrix_<ELT>& b, Matrix_<ELT>& x ) const;
+
+    /// returns the lower triangular Cholesky factor L
+    template <class ELT> void getL( Matrix_<ELT>& l ) const;
+    /// returns the inverse of the matrix using the Cholesky factorization
+    template <class ELT> void inverse( Matrix_<ELT>& m ) const;
+
+    /// returns true if the factorization succeeded, meaning the matrix was
+    /// numerically positive definite
+    bool isPositiveDefinite() const;
+    /// returns the order (1-based) of the leading minor that was found not
+    /// to be positive definite, or 0 if the factorization succeeded
+    int getNotPositiveDefiniteIndex() const;
+    /// returns an estimate of the reciprocal of the 1-norm condition number,
+    /// or 0 if the matrix was not positive definite
+    double getRCondEstimate() const;
+
+    /// @name Updating the factorization
+    /// These modify the factorization of a positive definite matrix A in
+    /// O(n^2) operations each, much cheaper than the O(n^3) needed to factor
+    /// the modified matrix from scratch. That is useful in active set
+    /// methods where constraints come and go one at a time. The rank-k
+    /// forms apply the columns of V one at a time. If the modified matrix
+    /// is not positive definite, isPositiveDefinite() returns false
+    /// afterwards and the object must be refactored before it can be used.
+    /// The condition estimate is recomputed each time.
+    //@{
+    /// replaces A by A + V*~V
+    template <class ELT> void update( const Matrix_<ELT>& V );
+    /// replaces A by A + v*~v
+    template <class ELT> void update( const Vector_<ELT>& v );
+    /// replaces A by A - V*~V
+    template <class ELT> void downdate( const Matrix_<ELT>& V );
+    /// replaces A by A - v*~v
+    template <class ELT> void downdate( const Vector_<ELT>& v );
+    /// grows A by one row and column: the new last row of A is \a a, which
+    /// has n+1 elements, the last being the new diagonal element
+    template <class ELT> void appendRowCol( const Vector_<ELT>& a );
+    /// shrinks A by deleting row and column \a k (0-based)
+    void removeRowCol( int k );
+    //@}
+
+    protected:
+    class FactorCholeskyRepBase *rep;
+}; // class FactorCholesky
+
+
+class FactorLDLTRepBase;
+/**
+ * Class for performing symmetrically pivoted L*D*~L factorizations
+ * P*A*~P = L*D*~L of symmetric matrices, where P is a permutation, L is
+ * unit lower triangular and D is block diagonal with 1x1 and 2x2 blocks.
+ * Pivots are chosen by the complete pivoting strategy of Bunch and Parlett:
+ * the largest remaining diagonal element is used as a 1x1 pivot unless some
+ * off-diagonal element is much larger, in which case the 2x2 block containing
+ * that element is used. For a positive semidefinite matrix only 1x1 pivots
+ * are taken, in nonincreasing order, and D is diagonal; 2x2 blocks are
+ * needed for indefinite matrices like [0 1;1 0] that have small or zero
+ * diagonal elements. Factorization stops when every element of the remaining
+ * matrix is smaller than rcond times the largest element of A, which reveals
+ * the rank. Solves of a rank deficient system return a basic solution in
+ * which the elements corresponding to the dropped pivots are zero. This is a
+ * cheaper alternative to FactorQTZ for symmetric matrices with redundancy,
+ * although the pivot search makes it somewhat more expensive than an
+ * unpivoted factorization. Only the lower triangle of A is used and only real
+ * (float or double) matrices are supported.
+ */
+class SimTK_SIMMATH_EXPORT FactorLDLT: public Factor {
+    public:
+
+    ~FactorLDLT();
+
+    FactorLDLT();
+    FactorLDLT( const FactorLDLT& c );
+    FactorLDLT& operator=(const FactorLDLT& rhs);
+
+    /// do pivoted LDLT factorization of a symmetric matrix
+    template <class ELT> FactorLDLT( const Matrix_<ELT>& m );
+    /// do pivoted LDLT factorization of a symmetric matrix using the given
+    /// reciprocal condition number to determine the rank
+    template <class ELT> FactorLDLT( const Matrix_<ELT>& m, double rcond );
+    /// do pivoted LDLT factorization of a symmetric matrix
+    template <class ELT> void factor( const Matrix_<ELT>& m );
+    /// do pivoted LDLT factorization of a symmetric matrix using the given
+    /// reciprocal condition number to determine the rank
+    template <class ELT> void factor( const Matrix_<ELT>& m, double rcond );
+    /// solves a single right hand side
+    template <class ELT> void solve( const Vector_<ELT>& b, Vector_<ELT>& x ) const;
+    /// solves multiple right hand sides
+    template <class ELT> void solve( const Matrix_<ELT>& b, Matrix_<ELT>& x ) const;
+
+    /// returns the (pseudo) inverse of the matrix using the factorization
+    template <class ELT> void inverse( Matrix_<ELT>& m ) const;
+    /// returns the unit lower triangular factor L (rank columns)
+    template <class ELT> void getL( Matrix_<ELT>& l ) const;
+    /// returns the diagonal of D (rank elements)
+    template <class ELT> void getD( Vector_<ELT>& d ) const;
+    /// returns the subdiagonal of D (rank-1 elements); element i is nonzero
+    /// only if rows i and i+1 form a 2x2 pivot block
+    template <class ELT> void getDSubdiagonal( Vector_<ELT>& e ) const;
+    /// returns the permutation; row i of P*A*~P is row getPivots()[i] of A
+    void getPivots( Array_<int>& pivots ) const;
+
+    /// returns the rank of the matrix
+    int getRank() const;
+    /// returns true if the matrix is full rank and D is diagonal with
+    /// positive elements
+    bool isPositiveDefinite() const;
+    /// returns the ratio of the smallest to the largest pivot magnitude that
+    /// was retained, where the magnitudes of a 2x2 block are those of its
+    /// eigenvalues
+    double getRCondEstimate() const;
+
+    protected:
+    class FactorLDLTRepBase *rep;
+}; // class FactorLDLT
 /**
  * Class to compute Eigen values and Eigen vectors of a matrix
  */
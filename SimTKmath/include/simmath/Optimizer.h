@@ -29,6 +29,8 @@
 #include "simmath/internal/common.h"
 #include "simmath/Differentiator.h"
 
+#include <functional>
+
 namespace SimTK {
 
 /**
@@ -99,7 +101,19 @@ public:
                                  bool new_parameters, Real& f ) const {
                                  SimTK_THROW2(SimTK::Exception::UnimplementedVirtualMethod , "OptimizerSystem", "objectiveFunc" );
                                  return -1; }
-  
+
+    /// Evaluates the objective function at several points at once; return 0
+    /// when successful. Column j of \a parameters is a parameter vector and
+    /// \a f must be resized to hold one value per column. If you override
+    /// this, optimizers call it wherever they have a set of independent
+    /// points to evaluate (a CMAES generation, or the perturbed points of a
+    /// numerical gradient), so you can vectorize the evaluation or
+    /// distribute it yourself. Otherwise they call objectiveFunc() on each
+    /// point.
+    virtual int objectiveFuncBatch ( const Matrix& parameters, Vector& f ) const {
+                                 SimTK_THROW2(SimTK::Exception::UnimplementedVirtualMethod , "OptimizerSystem", "objectiveFuncBatch" );
+                                 return -1; }
+
     /// Computes the gradient of the objective function; return 0 when successful.
     /// This method does not have to be supplied if a numerical gradient is used.
     virtual int gradientFunc       ( const Vector &parameters, 
@@ -407,6 +421,11 @@ private:
  *   "multithreading", this is the number of threads to use (by default, this
  *   is the number of processors/threads on the machine).
  *
+ * Without the <b>parallel</b> option, each generation is evaluated with a
+ * single call to OptimizerSystem::objectiveFuncBatch() if you override it,
+ * so you can evaluate the population your own way. A nonzero status from
+ * the objective function for any member of the population is an error.
+ *
  * If you want to generate identical results with repeated optimizations,
  * you can set the <b>seed</b> option. In addition, you *must* set the
  * <b>maxTimeFractionForEigendecomposition</b> option to be greater than or
@@ -417,6 +436,52 @@ private:
  * opt.setAdvancedRealOption("maxTimeFractionForEigendecomposition", 1);
  * @endcode
  *
+ * <h3> Checkpoints </h3>
+ *
+ * The CMAES and LBFGSB algorithms can save their complete internal state
+ * periodically, so that a long optimization that is killed can be continued
+ * with Optimizer::resume(). These advanced options control it:
+ *
+ * - <b>checkpoint_file</b> (str) Binary file to which the state is written.
+ *   Each checkpoint replaces the previous one. No checkpoints are written
+ *   unless this is set.
+ * - <b>checkpoint_interval</b> (int; default: 1) Number of iterations (for
+ *   CMAES, generations) between checkpoints.
+ *
+ * To resume, set up the Optimizer as for the original run, with the same
+ * OptimizerSystem, algorithm and options, and call resume() instead of
+ * optimize(). The optimization then continues exactly as it would have
+ * without the interruption, and gives a bitwise identical result.
+ * The CMAES state includes its random number generator. For CMAES this
+ * needs the same <b>maxTimeFractionForEigendecomposition</b> setting as
+ * described above for repeatable results. A checkpoint can only be read by
+ * the same build on the same platform.
+ *
+ * @code
+ * opt.setAdvancedStrOption("checkpoint_file", "fit.ckpt");
+ * opt.setAdvancedIntOption("checkpoint_interval", 10);
+ * f = opt.optimize(x); // killed; restart the program and then:
+ * f = opt.resume(x);
+ * @endcode
+ *
+ * <h3> Statistics </h3>
+ *
+ * After optimize() or resume() returns (or throws), methods like
+ * getNumIterations() and getNumObjectiveEvals() report how much work the
+ * optimization did, and getTimeInUserFunctions() and getTimeInOptimizer()
+ * show whether the time went into your OptimizerSystem or into the algorithm
+ * itself. Each call to optimize() or resume() starts the counts from zero,
+ * except that after resume() the iteration count includes the iterations
+ * before the checkpoint. To watch an optimization while it runs, set an
+ * IterationCallback:
+ *
+ * @code
+ * opt.setIterationCallback(
+ *     [](const Optimizer& o, int iter, Real f)
+ *     {   std::cout << iter << " " << f << " "
+ *                   << o.getNumObjectiveEvals() << std::endl; });
+ * @endcode
+ *
  */
 class SimTK_SIMMATH_EXPORT Optimizer {
 public:
@@ -516,6 +581,14 @@ public:
     /// Compute optimization.
     Real optimize(Vector&);
 
+    /// Continue an optimization from the checkpoint file named by the
+    /// <b>checkpoint_file</b> advanced option, as if it had never been
+    /// interrupted; see "Checkpoints" above. The contents of \a results on
+    /// entry are ignored. Only CMAES and LBFGSB can resume; other algorithms
+    /// throw an exception, as does a checkpoint that doesn't match this
+    /// problem.
+    Real resume(Vector& results);
+
     /// Return a reference to the OptimizerSystem currently associated with this Optimizer.
     const OptimizerSystem& getOptimizerSystem() const;
 
@@ -528,6 +601,58 @@ public:
     /// Return the estimated accuracy last specified in useNumericalJacobian().
     Real getEstimatedAccuracyOfConstraints() const;
 
+    /// A function called at the end of each iteration of the optimizer's
+    /// outer loop with the number of iterations so far and the current
+    /// objective value (for CMAES, once per generation with the best value
+    /// found so far). Iterations are counted as in setMaxIterations(). It is
+    /// not called by CFSQP.
+    typedef std::function<void(const Optimizer& optimizer,
+                               int iteration, Real objective)>
+        IterationCallback;
+
+    /// Set the function to be called after each iteration; pass an empty
+    /// function to remove it. The callback may query this Optimizer's
+    /// statistics, and may throw to abandon the optimization.
+    void setIterationCallback(const IterationCallback& callback);
+
+    /// @name                    Statistics
+    /// These report on the most recent call to optimize() or resume(), and
+    /// are reset at the start of each. Evaluations made by the optimizer's
+    /// numerical differentiation are counted separately from those the
+    /// algorithm makes directly.
+    /// @{
+    /// Number of iterations of the outer loop (CMAES: generations),
+    /// including those before the checkpoint if resume() was called.
+    int getNumIterations() const;
+    /// Number of objective evaluations requested directly by the algorithm,
+    /// not counting those made to compute numerical gradients.
+    int getNumObjectiveEvals() const;
+    /// Number of calls to OptimizerSystem::gradientFunc().
+    int getNumGradientEvals() const;
+    /// Number of gradients computed numerically; see useNumericalGradient().
+    int getNumNumericalGradientEvals() const;
+    /// Number of objective evaluations used by the numerical gradients.
+    int getNumObjectiveEvalsForGradients() const;
+    /// Number of constraint evaluations requested directly by the algorithm,
+    /// not counting those made to compute numerical Jacobians.
+    int getNumConstraintEvals() const;
+    /// Number of calls to OptimizerSystem::constraintJacobian().
+    int getNumConstraintJacobianEvals() const;
+    /// Number of constraint Jacobians computed numerically; see
+    /// useNumericalJacobian().
+    int getNumNumericalConstraintJacobianEvals() const;
+    /// Number of constraint evaluations used by the numerical Jacobians.
+    int getNumConstraintEvalsForJacobians() const;
+    /// Number of calls to OptimizerSystem::hessian().
+    int getNumHessianEvals() const;
+    /// Wall clock time in seconds spent in the OptimizerSystem's functions,
+    /// including numerical differentiation of them.
+    double getTimeInUserFunctions() const;
+    /// Wall clock time in seconds spent in optimize() or resume() other than
+    /// in the OptimizerSystem's functions.
+    double getTimeInOptimizer() const;
+    /// @}
+
     // This is a local class.
     class OptimizerRep;
 private:
@@ -0,0 +1,308 @@
+#ifndef SimTK_SIMMATH_SPARSE_MATRIX_H_
+#define SimTK_SIMMATH_SPARSE_MATRIX_H_
+
+/* -------------------------------------------------------------------------- *
+ *                        Simbody(tm): SimTKmath                              *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2018 Stanford University and the Authors.           *
+ * Authors: Simbody developers                                                *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+/** @file
+ * Compressed sparse column matrices, and sparse direct factorizations that
+ * operate on them.
+ */
+
+#include "SimTKcommon.h"
+#include "simmath/internal/common.h"
+
+namespace SimTK {
+
+template <class T> class SparseMatrix_;
+
+//==============================================================================
+//                          SPARSE MATRIX BUILDER
+//==============================================================================
+/** Collects the nonzero entries of a sparse matrix as (row, column, value)
+triplets in any order, for conversion to a SparseMatrix_. Entries that are
+given more than once for the same (row, column) are summed during conversion,
+which is convenient for finite element style assembly. **/
+template <class T>
+class SparseMatrixBuilder_ {
+public:
+    /** Create an empty builder for a 0x0 matrix. **/
+    SparseMatrixBuilder_() : m_nrow(0), m_ncol(0) {}
+    /** Create an empty builder for an `nrow` by `ncol` matrix. **/
+    SparseMatrixBuilder_(int nrow, int ncol) : m_nrow(0), m_ncol(0)
+    {   resize(nrow, ncol); }
+
+    /** Change the matrix dimensions; this also removes all entries. **/
+    void resize(int nrow, int ncol) {
+        SimTK_APIARGCHECK2_ALWAYS(nrow >= 0 && ncol >= 0,
+            "SparseMatrixBuilder_", "resize",
+            "Illegal dimensions %d x %d.", nrow, ncol);
+        m_nrow = nrow; m_ncol = ncol;
+        clear();
+    }
+    /** Remove all entries but keep the dimensions. **/
+    void clear() {m_rows.clear(); m_cols.clear(); m_values.clear();}
+    /** Preallocate space for `n` entries. **/
+    void reserve(int n) {m_rows.reserve(n); m_cols.reserve(n); m_values.reserve(n);}
+
+    /** Add `value` to element (i,j). **/
+    void addEntry(int i, int j, const T& value) {
+        SimTK_INDEXCHECK(i, m_nrow, "SparseMatrixBuilder_::addEntry()");
+        SimTK_INDEXCHECK(j, m_ncol, "SparseMatrixBuilder_::addEntry()");
+        m_rows.push_back(i); m_cols.push_back(j); m_values.push_back(value);
+    }
+    /** Add all the elements of a dense block whose upper left corner goes
+    at (i,j). Elements that happen to be zero are added too, so that the
+    sparsity pattern depends only on where blocks are placed and not on
+    their current values. **/
+    void addBlock(int i, int j, const Matrix_<T>& block) {
+        for (int c=0; c < block.ncol(); ++c)
+            for (int r=0; r < block.nrow(); ++r)
+                addEntry(i+r, j+c, block(r,c));
+    }
+
+    int nrow() const {return m_nrow;}
+    int ncol() const {return m_ncol;}
+    /** Number of triplets added so far, including duplicates. **/
+    int getNumEntries() const {return (int)m_values.size();}
+    const Array_<int>& getRowIndices()    const {return m_rows;}
+    const Array_<int>& getColumnIndices() const {return m_cols;}
+    const Array_<T>&   getValues()        const {return m_values;}
+
+private:
+    int         m_nrow, m_ncol;
+    Array_<int> m_rows, m_cols;
+    Array_<T>   m_values;
+};
+
+
+
+//==============================================================================
+//                              SPARSE MATRIX
+//==============================================================================
+/** A matrix stored in compressed sparse column (CSC) format. Column j's
+nonzeros are stored in positions getColumnStarts()[j] up to (but not
+including) getColumnStarts()[j+1] of the getRowIndices() and getValues()
+arrays, with row indices increasing and no duplicates. Matrices are created
+from a SparseMatrixBuilder_, from a dense Matrix_, or directly from CSC
+arrays; after that the sparsity pattern is fixed but the values may be
+changed in place with updValues().
+
+Matrix-vector products work with the ordinary dense Vector_ and Matrix_
+types. Instantiated for float and double. See FactorSparseCholesky and
+FactorSparseLU for solving linear systems. **/
+template <class T>
+class SimTK_SIMMATH_EXPORT SparseMatrix_ {
+public:
+    /** Create a 0x0 matrix. **/
+    SparseMatrix_() : m_nrow(0), m_ncol(0), m_colStart(1, 0) {}
+    /** Create an `nrow` by `ncol` matrix of all zeroes. **/
+    SparseMatrix_(int nrow, int ncol);
+    /** Create a matrix from triplets; duplicate entries are summed. Entries
+    that sum to exactly zero are kept, so that the sparsity pattern depends
+    only on the positions that were supplied. **/
+    explicit SparseMatrix_(const SparseMatrixBuilder_<T>& builder);
+    /** Create a sparse matrix holding the elements of a dense one whose
+    magnitude exceeds `dropTol`; by default only exact zeroes are dropped. **/
+    explicit SparseMatrix_(const Matrix_<T>& dense,
+                           typename CNT<T>::TReal dropTol = 0);
+    /** Create a matrix directly from compressed sparse column arrays, which
+    are checked for consistency. **/
+    SparseMatrix_(int nrow, int ncol, const Array_<int>& colStart,
+                  const Array_<int>& rowIndex, const Array_<T>& values);
+
+    int nrow() const {return m_nrow;}
+    int ncol() const {return m_ncol;}
+    /** Number of stored elements (including any explicitly stored zeroes). **/
+    int getNumNonzeros() const {return (int)m_values.size();}
+
+    const Array_<int>& getColumnStarts() const {return m_colStart;}
+    const Array_<int>& getRowIndices()   const {return m_rowIndex;}
+    const Array_<T>&   getValues()       const {return m_values;}
+    /** Writable access to the stored values; the pattern can't be changed. **/
+    Array_<T>&         updValues()             {return m_values;}
+
+    /** Return element (i,j), which is zero if it is not stored. Cost is
+    logarithmic in the number of nonzeros in column j. **/
+    T getElt(int i, int j) const;
+
+    /** Calculate y = alpha*A*x + beta*y. If beta is zero y need not be
+    initialized and will be resized if necessary. **/
+    void multiplyAndAdd(const T& alpha, const Vector_<T>& x,
+                        const T& beta, Vector_<T>& y) const;
+    /** Calculate y = alpha*~A*x + beta*y. If beta is zero y need not be
+    initialized and will be resized if necessary. **/
+    void multiplyByTransposeAndAdd(const T& alpha, const Vector_<T>& x,
+                                   const T& beta, Vector_<T>& y) const;
+
+    /** Calculate y = A*x. **/
+    void multiply(const Vector_<T>& x, Vector_<T>& y) const
+    {   multiplyAndAdd(T(1), x, T(0), y); }
+    /** Calculate y = ~A*x without forming the transpose. **/
+    void multiplyByTranspose(const Vector_<T>& x, Vector_<T>& y) const
+    {   multiplyByTransposeAndAdd(T(1), x, T(0), y); }
+    /** Calculate Y = A*X for a dense matrix X. **/
+    void multiply(const Matrix_<T>& X, Matrix_<T>& Y) const;
+    /** Calculate Y = ~A*X for a dense matrix X. **/
+    void multiplyByTranspose(const Matrix_<T>& X, Matrix_<T>& Y) const;
+
+    /** Return the transpose as a new sparse matrix. **/
+    SparseMatrix_ transpose() const;
+    /** Return the sum of this matrix and its transpose, which must be
+    square. This is handy for symmetrizing patterns. **/
+    SparseMatrix_ plusTranspose() const;
+    /** Return a dense copy of this matrix. **/
+    Matrix_<T> toMatrix() const;
+
+private:
+    int         m_nrow, m_ncol;
+    Array_<int> m_colStart;   // ncol+1 entries
+    Array_<int> m_rowIndex;   // nnz entries
+    Array_<T>   m_values;     // nnz entries
+};
+
+/** Sparse matrix-dense vector product. @relates SparseMatrix_ **/
+template <class T> inline Vector_<T>
+operator*(const SparseMatrix_<T>& A, const Vector_<T>& x) {
+    Vector_<T> y; A.multiply(x, y); return y;
+}
+
+typedef SparseMatrix_<Real>        SparseMatrix;
+typedef SparseMatrixBuilder_<Real> SparseMatrixBuilder;
+
+
+
+//==============================================================================
+//                        SPARSE FACTORIZATIONS
+//==============================================================================
+
+/** Choice of fill-reducing ordering for the sparse factorizations. With
+MinimumDegree the rows and columns are reordered by a minimum degree
+heuristic applied to the graph of the matrix (for Cholesky) or of ~A*A (for
+LU), which typically reduces the number of nonzeros in the factors by a
+large factor for mechanical system matrices. **/
+enum SparseOrdering {
+    SparseOrderingNatural       = 0, ///< use the matrix as given
+    SparseOrderingMinimumDegree = 1  ///< minimum degree reordering
+};
+
+/** Compute a minimum degree ordering of the symmetric pattern of the given
+square matrix (that is, of A+~A; the diagonal is ignored). On return,
+`perm[k]` is the index of the row and column of A that should be eliminated
+k'th. Ties are broken by index so the result is deterministic. **/
+SimTK_SIMMATH_EXPORT void
+calcMinimumDegreeOrdering(const SparseMatrix& A, Array_<int>& perm);
+
+class FactorSparseCholeskyRep;
+/**
+ * Class for performing sparse Cholesky factorizations P*A*~P = L*~L of
+ * symmetric positive definite SparseMatrix objects. Only the lower triangle
+ * (elements with row >= column) is used. The symbolic analysis is saved so
+ * that a matrix with the same sparsity pattern can be refactored cheaply
+ * with refactor().
+ */
+class SimTK_SIMMATH_EXPORT FactorSparseCholesky {
+public:
+    ~FactorSparseCholesky();
+
+    FactorSparseCholesky();
+    FactorSparseCholesky( const FactorSparseCholesky& c );
+    FactorSparseCholesky& operator=(const FactorSparseCholesky& rhs);
+
+    /// do symbolic analysis and Cholesky factorization of a matrix
+    explicit FactorSparseCholesky( const SparseMatrix& m,
+                          SparseOrdering ordering=SparseOrderingMinimumDegree );
+    /// do symbolic analysis and Cholesky factorization of a matrix
+    void factor( const SparseMatrix& m,
+                 SparseOrdering ordering=SparseOrderingMinimumDegree );
+    /// numeric factorization of a matrix with the same pattern as the one
+    /// most recently passed to factor(); the ordering and analysis are reused.
+    /// It is an error if the pattern differs.
+    void refactor( const SparseMatrix& m );
+
+    /// solves a single right hand side
+    void solve( const Vector& b, Vector& x ) const;
+    /// solves multiple right hand sides
+    void solve( const Matrix& b, Matrix& x ) const;
+
+    /// returns true if the factorization succeeded
+    bool isPositiveDefinite() const;
+    /// returns the number of nonzeros in L, including the diagonal
+    int getNumNonzerosInFactor() const;
+    /// returns the ordering; row and column k of P*A*~P is row and column
+    /// perm[k] of A
+    void getPermutation( Array_<int>& perm ) const;
+    /// returns the Cholesky factor L of the permuted matrix
+    void getL( SparseMatrix& l ) const;
+
+protected:
+    class FactorSparseCholeskyRep *rep;
+}; // class FactorSparseCholesky
+
+class FactorSparseLURep;
+/**
+ * Class for performing sparse LU factorizations P*A*Q = L*U of square
+ * SparseMatrix objects, where Q is a fill-reducing column ordering and P is
+ * chosen by threshold partial pivoting. A candidate pivot on the diagonal is
+ * preferred whenever it is nonzero and its magnitude is at least `pivotTol`
+ * times the largest in its column; pivotTol=1 (the default) gives ordinary
+ * partial pivoting.
+ */
+class SimTK_SIMMATH_EXPORT FactorSparseLU {
+public:
+    ~FactorSparseLU();
+
+    FactorSparseLU();
+    FactorSparseLU( const FactorSparseLU& c );
+    FactorSparseLU& operator=(const FactorSparseLU& rhs);
+
+    /// do LU factorization of a matrix
+    explicit FactorSparseLU( const SparseMatrix& m,
+                          SparseOrdering ordering=SparseOrderingMinimumDegree,
+                          Real pivotTol=1 );
+    /// do LU factorization of a matrix
+    void factor( const SparseMatrix& m,
+                 SparseOrdering ordering=SparseOrderingMinimumDegree,
+                 Real pivotTol=1 );
+
+    /// solves a single right hand side
+    void solve( const Vector& b, Vector& x ) const;
+    /// solves multiple right hand sides
+    void solve( const Matrix& b, Matrix& x ) const;
+
+    /// returns true if no usable pivot was found for some column
+    bool isSingular() const;
+    /// returns the (1-based) step at which the matrix was found to be
+    /// singular, or 0 if it was not
+    int getSingularIndex() const;
+    /// returns the number of nonzeros in L and U together, with the unit
+    /// diagonal of L counted
+    int getNumNonzerosInFactors() const;
+
+protected:
+    class FactorSparseLURep *rep;
+}; // class FactorSparseLU
+
+} // namespace SimTK
+
+#endif // SimTK_SIMMATH_SPARSE_MATRIX_H_
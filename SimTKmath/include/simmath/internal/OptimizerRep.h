@@ -42,6 +42,10 @@ public:
     int f(const Vector& y, Real& fy) const override  {
          return(sysp->objectiveFunc(y, true, fy));   // class user's objectiveFunc
     }
+    // Numerical gradients evaluate all their perturbed points at once.
+    int fBatch(const Matrix& y, Vector& fy) const override {
+         return(sysp->objectiveFuncBatch(y, fy));
+    }
     const OptimizerSystem* sysp;
 };
 
@@ -82,6 +86,7 @@ public:
          numericalJacobian(false)
 
     {
+        resetAllStatistics();
     }
     OptimizerRep()
        : sysp(0), 
@@ -101,12 +106,16 @@ public:
          numericalGradient(false), 
          numericalJacobian(false)
     {
+        resetAllStatistics();
     }
 
     virtual OptimizerRep* clone() const { return 0; };
     static bool isAvailable() { return true; }
 
     virtual Real optimize(  Vector &results ) =  0;
+    // Continue from the checkpoint file given by the "checkpoint_file"
+    // option. The default throws; only some algorithms can resume.
+    virtual Real resume( Vector& results );
 
     const OptimizerSystem& getOptimizerSystem() const {return *sysp;}
 
@@ -159,6 +168,30 @@ public:
         return UnknownOptimizerAlgorithm;
     }
 
+    // Statistics; see Optimizer for their meanings.
+    void resetAllStatistics();
+    int getNumIterations() const {return numIterations;}
+    int getNumObjectiveEvals() const {return numObjectiveEvals;}
+    int getNumGradientEvals() const {return numGradientEvals;}
+    int getNumNumericalGradientEvals() const 
+    {   return numNumericalGradientEvals; }
+    int getNumObjectiveEvalsForGradients() const 
+    {   return numObjectiveEvalsForGradients; }
+    int getNumConstraintEvals() const {return numConstraintEvals;}
+    int getNumConstraintJacobianEvals() const 
+    {   return numConstraintJacobianEvals; }
+    int getNumNumericalConstraintJacobianEvals() const 
+    {   return numNumericalConstraintJacobianEvals; }
+    int getNumConstraintEvalsForJacobians() const 
+    {   return numConstraintEvalsForJacobians; }
+    int getNumHessianEvals() const {return numHessianEvals;}
+    double getTimeInUserFunctions() const {return timeInUserFunctions;}
+    double getTimeInOptimizer() const 
+    {   return totalTime - timeInUserFunctions; }
+
+    void setIterationCallback(const Optimizer::IterationCallback& callback)
+    {   iterationCallback = callback; }
+
     static int numericalGradient_static( const OptimizerSystem&, const Vector & parameters,  const bool new_parameters,  Vector &gradient );
     static int numericalJacobian_static(const OptimizerSystem&,
                                    const Vector& parameters, const bool new_parameters, Matrix& jacobian );
@@ -179,6 +212,36 @@ protected:
                                 int nele_hess, int* iRow, int* jCol,
                                 Real* values, void* rep);
 
+    // Optimizers call this at the end of each iteration of their outer
+    // loop, with the current (or for CMAES, best) objective value.
+    void countIteration(Real f) const;
+
+    // Adds the wall clock time from its construction to its destruction to
+    // the given total.
+    class Timer {
+    public:
+        explicit Timer(double& total) : total(total), start(realTime()) {}
+        ~Timer() {total += realTime() - start;}
+    private:
+        double&         total;
+        const double    start;
+    };
+
+    // Statistics; mutable since they are updated by the static wrappers
+    // above, which see only a const OptimizerRep.
+    mutable int     numIterations;
+    mutable int     numObjectiveEvals;
+    mutable int     numGradientEvals;
+    mutable int     numNumericalGradientEvals;
+    mutable int     numObjectiveEvalsForGradients;
+    mutable int     numConstraintEvals;
+    mutable int     numConstraintJacobianEvals;
+    mutable int     numNumericalConstraintJacobianEvals;
+    mutable int     numConstraintEvalsForJacobians;
+    mutable int     numHessianEvals;
+    mutable double  timeInUserFunctions;
+    mutable double  totalTime;
+
     int diagnosticsLevel;
     Real convergenceTolerance;
     Real constraintTolerance;
@@ -204,6 +267,8 @@ private:
     std::map<std::string, bool> advancedBoolOptions;
     std::map<std::string, Vector> advancedVectorOptions;
 
+    Optimizer::IterationCallback iterationCallback;
+
     friend class Optimizer;
     Optimizer* myHandle;   // The owner handle of this Rep.
     
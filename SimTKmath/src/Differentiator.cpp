@@ -29,7 +29,10 @@
 #include "SimTKcommon.h"
 #include "simmath/Differentiator.h"
 
+#include <algorithm>
 #include <exception>
+#include <memory>
+#include <vector>
 
 namespace SimTK {
 
@@ -115,6 +118,9 @@ class JacobianFunctionRep;
 // This is used as a value for y in calculating the step size when
 // the actual y is smaller.
 static const Real YMin = Real(0.1);
+// The most perturbed points passed to a user's batch function at once.
+static const int MaxBatchColumns = 64;
+
 class Differentiator::DifferentiatorRep {
 public:
     DifferentiatorRep(Differentiator* handle,
@@ -133,6 +139,22 @@ public:
     void calcJacobian(const JacobianFunctionRep&, Differentiator::Method, 
                       const Vector& y0, const Vector& fy0, Matrix& dfdy) const;
 
+    // Call body(f, begin, end, numCalls) to evaluate items begin..end-1 (the
+    // parameters, or groups of them) for several contiguous ranges of the
+    // numItems items concurrently, using a separate function for each range
+    // unless f is thread safe. The body counts its calls to f in numCalls.
+    // Returns false without doing anything if that isn't possible; the
+    // caller must then do it serially.
+    template <class FRep> bool calcColumnsInParallel
+       (const FRep& f, int numItems,
+        const std::function<void(const FRep&,int,int,int&)>& body) const;
+
+    // Calculate the values of the Jacobian entries in f's sparsity pattern,
+    // perturbing a group of structurally orthogonal columns at a time.
+    void calcSparseJacobian(const JacobianFunctionRep&, Differentiator::Method,
+                            const Vector& y0, const Vector& fy0,
+                            Array_<Real>& values) const;
+
     const Real& getAccFac(int order) const {
         if (order==1) return AccFac1;
         if (order==2) return AccFac2;
@@ -162,6 +184,11 @@ private:
     // This is set on construction, but can be changed.
     Differentiator::Method defaultMethod;
 
+    // Threads used for gradients and Jacobians; the executor is created
+    // the first time it is needed.
+    int                                       numThreads;
+    mutable std::unique_ptr<ParallelExecutor> executor;
+
     // These are pre-calculated accuracy factors for 1st order and
     // 2nd order step size estimates, derived from EstimatedAccuracy
     // upon construction.
@@ -186,7 +213,7 @@ class Differentiator::Function::FunctionRep {
     friend class Differentiator::Function;
 public:
     FunctionRep(int nf, int np, Real acc)
-      : nFunc(nf), nParam(np), estimatedAccuracy(acc)
+      : nFunc(nf), nParam(np), estimatedAccuracy(acc), threadSafe(false)
     {
         if (estimatedAccuracy < 0) // use default
             estimatedAccuracy = SignificantReal; // ~1e-14 in double
@@ -210,6 +237,20 @@ public:
     virtual void calcJacobian(const DifferentiatorRep&, Differentiator::Method,
                               const Vector& y0, const Vector* fy0p, Matrix& dfdy) const=0;
 
+    // Return a new copy of the user's function for use by another thread,
+    // or null if it can't be copied.
+    virtual Differentiator::Function* cloneForThread() const {return nullptr;}
+
+    static const FunctionRep& getRep(const Differentiator::Function& f)
+    {   return *f.rep; }
+
+    // Function's destructor isn't public; this is for deleting clones.
+    struct Deleter {
+        void operator()(Differentiator::Function* f) const {delete f;}
+    };
+
+    bool isThreadSafe() const {return threadSafe;}
+
     int getNumFunctions()  const {assert(nFunc>=0);  return nFunc;}
     int getNumParameters() const {assert(nParam>=0); return nParam;}
     Real getEstimatedAccuracy() const {
@@ -221,6 +262,11 @@ public:
         nCalls = nFailures = 0;
     }
 
+    // Add in the calls made (concurrently) by worker threads.
+    void addStatistics(int calls, int failures) const {
+        nCalls += calls; nFailures += failures;
+    }
+
 protected:
     // Stats
     mutable int nCalls;
@@ -229,6 +275,7 @@ protected:
 private:
     int  nFunc, nParam;
     Real estimatedAccuracy;
+    bool threadSafe;
 
 };
 
@@ -338,11 +385,19 @@ public:
         diff.calcGradient(*this,m,y0,fy0,~dfdy[0]);
     }
 
+    Differentiator::Function* cloneForThread() const override
+    {   return gf.cloneForThread(); }
+
     // Local stuff
     void call(const Vector& y, Real& fy) const {
         nCalls++;
         nFailures++; // assume failure unless proven otherwise
+        callWithoutStatistics(y, fy);
+        --nFailures;
+    }
 
+    // This is safe to use from several threads if the user function is.
+    void callWithoutStatistics(const Vector& y, Real& fy) const {
         int status;
         try 
           { status = gf.f(y,fy); } 
@@ -354,17 +409,118 @@ public:
 
         if (status != 0)
             SimTK_THROW1(Differentiator::UserFunctionReturnedNonzeroStatus, status);
+    }
 
-        --nFailures;
+    // Evaluate the function at each column of y with a single call to the
+    // user's batch method. Returns false, and remembers, if the user didn't
+    // provide one.
+    bool callBatch(const Matrix& y, Vector& fy) const {
+        if (batchUnavailable) return false;
+        int status;
+        try 
+          { status = gf.fBatch(y,fy); } 
+        catch (const Exception::UnimplementedVirtualMethod&)
+          { batchUnavailable = true; return false; }
+        catch (const std::exception& e)
+          { nCalls += y.ncol(); nFailures++;
+            SimTK_THROW1(Differentiator::UserFunctionThrewAnException, e.what()); }
+        catch (...)
+          { nCalls += y.ncol(); nFailures++;
+            SimTK_THROW1(Differentiator::UserFunctionThrewAnException, 
+                         "UNRECOGNIZED EXCEPTION TYPE"); }
+
+        nCalls += y.ncol();
+        if (status != 0) {
+            nFailures++;
+            SimTK_THROW1(Differentiator::UserFunctionReturnedNonzeroStatus, status);
+        }
+        return true;
     }
 
     const Differentiator::GradientFunction&       gf;
+    mutable bool batchUnavailable = false;
 };
 
+// Partition the columns of a sparsity pattern into groups in which no two
+// columns have an entry in the same row (Curtis, Powell and Reid). Columns
+// are taken densest first and each goes in the lowest numbered group that
+// has no conflicting column. The columns of group g are
+// columns[groupStart[g]] to columns[groupStart[g+1]-1], in increasing order.
+static void groupColumns(const SparseMatrix& pattern,
+                         Array_<int>& groupStart, Array_<int>& columns)
+{
+    const int n = pattern.ncol();
+    const Array_<int>& colStart = pattern.getColumnStarts();
+    const Array_<int>& rowIndex = pattern.getRowIndices();
+    const SparseMatrix byRow = pattern.transpose(); // column i is row i
+    const Array_<int>& rowStart = byRow.getColumnStarts();
+    const Array_<int>& colIndex = byRow.getRowIndices();
+
+    Array_<int> order(n);
+    for (int j=0; j < n; ++j) order[j] = j;
+    std::stable_sort(order.begin(), order.end(), [&](int a, int b)
+        {return colStart[a+1]-colStart[a] > colStart[b+1]-colStart[b];});
+
+    // takenBy[g]==j means group g already has a column conflicting with j.
+    Array_<int> group(n, -1), takenBy;
+    for (int j : order) {
+        for (int k=colStart[j]; k < colStart[j+1]; ++k) {
+            const int row = rowIndex[k];
+            for (int l=rowStart[row]; l < rowStart[row+1]; ++l) {
+                const int g = group[colIndex[l]];
+                if (g >= 0) takenBy[g] = j;
+            }
+        }
+        int g = 0;
+        while (g < (int)takenBy.size() && takenBy[g] == j) ++g;
+        if (g == (int)takenBy.size()) takenBy.push_back(-1);
+        group[j] = g;
+    }
+
+    const int numGroups = (int)takenBy.size();
+    groupStart.assign(numGroups+1, 0);
+    for (int j=0; j < n; ++j) ++groupStart[group[j]+1];
+    for (int g=0; g < numGroups; ++g) groupStart[g+1] += groupStart[g];
+    Array_<int> next(groupStart.begin(), groupStart.end()-1);
+    columns.resize(n);
+    for (int j=0; j < n; ++j) columns[next[group[j]]++] = j;
+}
+
 class JacobianFunctionRep : public Differentiator::Function::FunctionRep {
 public:
     JacobianFunctionRep(const Differentiator::JacobianFunction& func, int nf, int np, Real acc)
-    :   FunctionRep(nf,np,acc), jf(func) {}
+    :   FunctionRep(nf,np,acc), jf(func), hasPattern(false) {}
+
+    void setSparsityPattern(const SparseMatrix& p) {
+        SimTK_APIARGCHECK4_ALWAYS(p.nrow() == getNumFunctions()
+                                  && p.ncol() == getNumParameters(),
+            "Differentiator::JacobianFunction", "setSparsityPattern",
+            "The sparsity pattern is %dx%d but the function is %dx%d.",
+            p.nrow(), p.ncol(), getNumFunctions(), getNumParameters());
+        pattern = p;
+        groupColumns(pattern, groupStart, groupedColumns);
+        hasPattern = true;
+    }
+
+    void clearSparsityPattern() {
+        hasPattern = false;
+        pattern = SparseMatrix();
+        groupStart.clear(); groupedColumns.clear();
+    }
+
+    // The pattern must still match in case the dimensions were changed.
+    bool usePattern() const {
+        if (!hasPattern) return false;
+        SimTK_ERRCHK4_ALWAYS(pattern.nrow() == getNumFunctions()
+                             && pattern.ncol() == getNumParameters(),
+            "Differentiator::calcJacobian()",
+            "The sparsity pattern is %dx%d but the function is now %dx%d.",
+            pattern.nrow(), pattern.ncol(), getNumFunctions(),
+            getNumParameters());
+        return true;
+    }
+
+    int getNumGroups() const {return (int)groupStart.size()-1;}
 
     // Virtuals (from FunctionRep)
     String functionKind() const override {return "JacobianFunction";}
@@ -409,10 +565,18 @@ public:
         }
     }
 
+    Differentiator::Function* cloneForThread() const override
+    {   return jf.cloneForThread(); }
+
     void call(const Vector& y, Vector& fy) const {
         nCalls++;
         nFailures++; // assume failure unless proven otherwise
+        callWithoutStatistics(y, fy);
+        nFailures--;
+    }
 
+    // This is safe to use from several threads if the user function is.
+    void callWithoutStatistics(const Vector& y, Vector& fy) const {
         int status;
         try 
           { status = jf.f(y,fy); } 
@@ -424,11 +588,15 @@ public:
 
         if (status != 0)
             SimTK_THROW1(Differentiator::UserFunctionReturnedNonzeroStatus, status);
-
-        nFailures--;
     }
 
     const Differentiator::JacobianFunction&       jf;
+
+    // Optional sparsity pattern (values unused) and its columns partitioned
+    // into structurally orthogonal groups by groupColumns().
+    bool            hasPattern;
+    SparseMatrix    pattern;
+    Array_<int>     groupStart, groupedColumns;
 };
 
     //////////////////////////////////////
@@ -451,6 +619,22 @@ Differentiator::Method Differentiator::getDefaultMethod() const {
     return rep->defaultMethod;
 }
 
+Differentiator& Differentiator::setNumberOfThreads(int numThreads) {
+    SimTK_APIARGCHECK1_ALWAYS(numThreads >= 0, "Differentiator",
+        "setNumberOfThreads",
+        "The number of threads was %d but must be >= 0", numThreads);
+    if (numThreads == 0)
+        numThreads = std::max(1, ParallelExecutor::getNumProcessors());
+    if (numThreads != rep->numThreads)
+        rep->executor.reset();
+    rep->numThreads = numThreads;
+    return *this;
+}
+
+int Differentiator::getNumberOfThreads() const {
+    return rep->numThreads;
+}
+
 void Differentiator::calcDerivative
    (Real y0, Real fy0, Real& dfdy, Differentiator::Method m) const 
 {
@@ -527,6 +711,35 @@ void Differentiator::calcJacobian
     rep->nDifferentiationFailures--;
 }
 
+void Differentiator::calcJacobian
+   (const Vector& y0, const Vector& fy0, SparseMatrix& dfdy,
+   Differentiator::Method m) const 
+{
+    const JacobianFunctionRep* jrep =
+        dynamic_cast<const JacobianFunctionRep*>(&rep->frep);
+    if (!jrep)
+        SimTK_THROW5(Differentiator::OpNotAllowedForFunctionOfThisShape,
+            "calcJacobian", "sparse", rep->frep.functionKind(),
+            rep->NFunctions, rep->NParameters);
+    SimTK_APIARGCHECK_ALWAYS(jrep->usePattern(), "Differentiator",
+        "calcJacobian",
+        "A sparse Jacobian requires a function with a sparsity pattern.");
+    SimTK_APIARGCHECK2_ALWAYS(y0.size()==rep->NParameters, "Differentiator", "calcJacobian",
+        "Expecting %d elements in the parameter (state) vector but got %d", 
+        rep->NParameters, (int)y0.size());
+    SimTK_APIARGCHECK2_ALWAYS(fy0.size()==rep->NFunctions, "Differentiator", "calcJacobian",
+        "Expecting %d elements in the unperturbed function value but got %d", 
+        rep->NFunctions, (int)fy0.size());
+
+    rep->nDifferentiations++;
+    rep->nDifferentiationFailures++; // assume the worst
+
+    dfdy = jrep->pattern;
+    rep->calcSparseJacobian(*jrep, m, y0, fy0, dfdy.updValues());
+
+    rep->nDifferentiationFailures--;
+}
+
 // The slow version
 Matrix Differentiator::calcJacobian
    (const Vector& y0, Differentiator::Method m) const 
@@ -637,6 +850,16 @@ Differentiator::Function::setEstimatedAccuracy(Real ea) {
     return *this;
 }
 
+Differentiator::Function& 
+Differentiator::Function::setIsThreadSafe(bool threadSafe) {
+    rep->threadSafe = threadSafe;
+    return *this;
+}
+
+bool Differentiator::Function::isThreadSafe() const {
+    return rep->threadSafe;
+}
+
 int Differentiator::Function::getNumFunctions() const {
     return rep->nFunc;
 }
@@ -667,10 +890,43 @@ Differentiator::ScalarFunction::ScalarFunction(Real acc) {
 Differentiator::GradientFunction::GradientFunction(int np, Real acc) {
     rep = new GradientFunctionRep(*this, np, acc);
 }
+int Differentiator::GradientFunction::fBatch(const Matrix&, Vector&) const {
+    SimTK_THROW2(Exception::UnimplementedVirtualMethod,
+                 "Differentiator::GradientFunction", "fBatch");
+    return -1;
+}
+
 Differentiator::JacobianFunction::JacobianFunction(int nf, int np, Real acc) {
     rep = new JacobianFunctionRep(*this, nf, np, acc);
 }
 
+void Differentiator::JacobianFunction::
+setSparsityPattern(const SparseMatrix& pattern) {
+    static_cast<JacobianFunctionRep*>(rep)->setSparsityPattern(pattern);
+}
+
+void Differentiator::JacobianFunction::clearSparsityPattern() {
+    static_cast<JacobianFunctionRep*>(rep)->clearSparsityPattern();
+}
+
+bool Differentiator::JacobianFunction::hasSparsityPattern() const {
+    return static_cast<const JacobianFunctionRep*>(rep)->hasPattern;
+}
+
+const SparseMatrix& 
+Differentiator::JacobianFunction::getSparsityPattern() const {
+    SimTK_APIARGCHECK_ALWAYS(hasSparsityPattern(),
+        "Differentiator::JacobianFunction", "getSparsityPattern",
+        "This function has no sparsity pattern.");
+    return static_cast<const JacobianFunctionRep*>(rep)->pattern;
+}
+
+int Differentiator::JacobianFunction::getNumColumnGroups() const {
+    const JacobianFunctionRep& jrep =
+        *static_cast<const JacobianFunctionRep*>(rep);
+    return jrep.hasPattern ? jrep.getNumGroups() : getNumParameters();
+}
+
 
     //////////////////////////////////////////
     // IMPLEMENTATION OF DIFFERENTIATOR REP //
@@ -686,6 +942,7 @@ Differentiator::DifferentiatorRep::DifferentiatorRep
     NFunctions(fr.getNumFunctions()), 
     EstimatedAccuracy(fr.getEstimatedAccuracy()),
     defaultMethod(getMethodOrThrow(defMthd, DefaultDefaultMethod, "Differentiator")),
+    numThreads(1),
     AccFac1(std::sqrt(EstimatedAccuracy)),
     AccFac2(std::pow(EstimatedAccuracy, OneThird))
 {
@@ -698,6 +955,88 @@ Differentiator::DifferentiatorRep::DifferentiatorRep
     fymtmp.resize(NFunctions);
 }
 
+namespace {
+// Task i evaluates the i'th contiguous range of items, catching any
+// exception so it can be rethrown on the calling thread.
+class ColumnRangeTask : public ParallelExecutor::Task {
+public:
+    ColumnRangeTask(int numItems, int numRanges,
+                    const std::function<void(int,int,int)>& body)
+    :   numItems(numItems), numRanges(numRanges), body(body),
+        errors(numRanges) {}
+
+    void execute(int i) override {
+        try {body(i, begin(i), begin(i+1));}
+        catch (...) {errors[i] = std::current_exception();}
+    }
+
+    int begin(int i) const {return (int)((long long)numItems*i/numRanges);}
+
+    // Rethrow the exception from the lowest numbered range, if any, so the
+    // error reported doesn't depend on thread timing.
+    void rethrowFirstError() const {
+        for (const auto& e : errors)
+            if (e) std::rethrow_exception(e);
+    }
+private:
+    const int                               numItems, numRanges;
+    const std::function<void(int,int,int)>& body;
+    std::vector<std::exception_ptr>         errors;
+};
+}
+
+template <class FRep> bool
+Differentiator::DifferentiatorRep::calcColumnsInParallel
+   (const FRep& f, int numItems,
+    const std::function<void(const FRep&,int,int,int&)>& body) const
+{
+    const int maxRanges = std::min(numThreads, numItems);
+    if (maxRanges <= 1 || ParallelExecutor::isWorkerThread())
+        return false;
+
+    // Range 0 uses f itself; the others need clones unless f is thread safe.
+    typedef Differentiator::Function::FunctionRep::Deleter Deleter;
+    std::vector<std::unique_ptr<Differentiator::Function,Deleter>> clones;
+    std::vector<const FRep*> funcs(1, &f);
+    while ((int)funcs.size() < maxRanges) {
+        if (f.isThreadSafe()) {funcs.push_back(&f); continue;}
+        Differentiator::Function* clone = f.cloneForThread();
+        if (!clone) break;
+        clones.emplace_back(clone);
+        const FRep& crep = static_cast<const FRep&>
+            (Differentiator::Function::FunctionRep::getRep(*clone));
+        SimTK_ERRCHK_ALWAYS(crep.getNumFunctions() == NFunctions
+                            && crep.getNumParameters() == NParameters,
+            "Differentiator", "A function returned by cloneForThread() has "
+            "different dimensions than the original.");
+        funcs.push_back(&crep);
+    }
+    const int numRanges = (int)funcs.size();
+    if (numRanges <= 1)
+        return false;
+
+    // Count the calls made for each range; they are added to the statistics
+    // afterwards so that no counter is shared between threads. The failing
+    // call, if any, is included in its range's count.
+    std::vector<int> calls(numRanges, 0), failed(numRanges, 0);
+    const std::function<void(int,int,int)> rangeBody =
+        [&](int i, int begin, int end) {
+            try {body(*funcs[i], begin, end, calls[i]);}
+            catch (...) {failed[i] = 1; throw;}
+        };
+    ColumnRangeTask task(numItems, numRanges, rangeBody);
+    if (!executor)
+        executor.reset(new ParallelExecutor(numThreads));
+    executor->execute(task, numRanges);
+
+    for (int i=0; i < numRanges; ++i) {
+        nCallsToUserFunction += calls[i];
+        f.addStatistics(calls[i], failed[i]);
+    }
+    task.rethrowFirstError();
+    return true;
+}
+
 void Differentiator::DifferentiatorRep::calcDerivative
    (const ScalarFunctionRep& f, Differentiator::Method m, Real y0, Real fy0, Real& dfdy) const 
 {
@@ -736,23 +1075,76 @@ void Differentiator::DifferentiatorRep::calcGradient
 
     gradf.resize(NParameters);
 
-    ytmp = y0;
     const int order = Differentiator::getMethodOrder(method);
 
-    for (int i=0; i < f.getNumParameters(); ++i) {
-        const Real hEst = getAccFac(order)*std::max(std::abs(y0[i]), YMin);
-        const Real h = cleanUpH(hEst, y0[i]);
-        Real fyplus, fyminus;
-        ytmp[i] = y0[i]+h; 
-        nCallsToUserFunction++; f.call(ytmp, fyplus);
-        if (order==1) {
-            gradf[i] = (fyplus-fy0)/h;
-        } else {
-            ytmp[i] = y0[i]-h; 
-            nCallsToUserFunction++; f.call(ytmp, fyminus);
-            gradf[i] = (fyplus-fyminus)/(2*h);
+    // Calculate elements begin..end-1 of the gradient. On entry y must equal
+    // y0; it is restored on return. Calls are counted in numCalls if given,
+    // otherwise in the usual statistics.
+    auto calcElements = [&](const GradientFunctionRep& func, Vector& y,
+                            int begin, int end, int* numCalls) {
+        auto call = [&](Real& fy) {
+            if (numCalls) {++*numCalls; func.callWithoutStatistics(y, fy);}
+            else {nCallsToUserFunction++; func.call(y, fy);}
+        };
+        for (int i=begin; i < end; ++i) {
+            const Real hEst = getAccFac(order)*std::max(std::abs(y0[i]), YMin);
+            const Real h = cleanUpH(hEst, y0[i]);
+            Real fyplus, fyminus;
+            y[i] = y0[i]+h; 
+            call(fyplus);
+            if (order==1) {
+                gradf[i] = (fyplus-fy0)/h;
+            } else {
+                y[i] = y0[i]-h; 
+                call(fyminus);
+                gradf[i] = (fyplus-fyminus)/(2*h);
+            }
+            y[i] = y0[i]; // restore
+        }
+    };
+
+    const bool doneInParallel = calcColumnsInParallel<GradientFunctionRep>(f, NParameters,
+        [&](const GradientFunctionRep& func, int begin, int end, int& numCalls)
+        {   Vector y(y0);
+            calcElements(func, y, begin, end, &numCalls); });
+    if (doneInParallel)
+        return;
+
+    // If the user provided a batch method, pass it the perturbed points for
+    // up to MaxBatchColumns at a time: the +h points, then the -h points
+    // for central differences.
+    const int perBatch = std::max(1, MaxBatchColumns/order);
+    int done = 0;
+    if (!f.batchUnavailable) {
+        Vector h;
+        Matrix y;
+        Vector fy;
+        while (done < NParameters) {
+            const int nb = std::min(perBatch, NParameters-done);
+            h.resize(nb);
+            y.resize(NParameters, order*nb);
+            for (int k=0; k < nb; ++k) {
+                const int i = done+k;
+                const Real hEst = getAccFac(order)*std::max(std::abs(y0[i]), YMin);
+                h[k] = cleanUpH(hEst, y0[i]);
+                y(k) = y0; y(i, k) = y0[i]+h[k];
+                if (order==2) {y(nb+k) = y0; y(i, nb+k) = y0[i]-h[k];}
+            }
+            nCallsToUserFunction += y.ncol();
+            if (!f.callBatch(y, fy)) { // no batch method; do the rest singly
+                nCallsToUserFunction -= y.ncol();
+                break;
+            }
+            for (int k=0; k < nb; ++k)
+                gradf[done+k] = order==1 ? (fy[k]-fy0)/h[k]
+                                         : (fy[k]-fy[nb+k])/(2*h[k]);
+            done += nb;
         }
-        ytmp[i] = y0[i]; // restore
+    }
+
+    if (done < NParameters) {
+        ytmp = y0;
+        calcElements(f, ytmp, done, NParameters, nullptr);
     }
 }
 
@@ -770,22 +1162,117 @@ void Differentiator::DifferentiatorRep::calcJacobian
 
     dfdy.resize(NFunctions,NParameters);
 
+    if (f.usePattern()) {
+        Array_<Real> values;
+        calcSparseJacobian(f, method, y0, fy0, values);
+        const Array_<int>& colStart = f.pattern.getColumnStarts();
+        const Array_<int>& rowIndex = f.pattern.getRowIndices();
+        dfdy = 0;
+        for (int j=0; j < NParameters; ++j)
+            for (int k=colStart[j]; k < colStart[j+1]; ++k)
+                dfdy(rowIndex[k], j) = values[k];
+        return;
+    }
+
+    const int order = Differentiator::getMethodOrder(method);
+
+    // Calculate columns begin..end-1 of the Jacobian using the given
+    // temporaries. On entry y must equal y0; it is restored on return. Calls
+    // are counted in numCalls if given, otherwise in the usual statistics.
+    auto calcColumns = [&](const JacobianFunctionRep& func, Vector& y,
+                           Vector& fyp, Vector& fym,
+                           int begin, int end, int* numCalls) {
+        auto call = [&](Vector& fy) {
+            if (numCalls) {++*numCalls; func.callWithoutStatistics(y, fy);}
+            else {nCallsToUserFunction++; func.call(y, fy);}
+        };
+        for (int i=begin; i < end; ++i) {
+            const Real hEst = getAccFac(order)*std::max(std::abs(y0[i]), YMin);
+            const Real h = cleanUpH(hEst, y0[i]);
+            y[i] = y0[i]+h; 
+            call(fyp);
+            if (order==1) {
+                dfdy(i) = (fyp-fy0)/h;
+            } else {
+                y[i] = y0[i]-h; 
+                call(fym);
+                dfdy(i) = (fyp-fym)/(2*h);
+            }
+            y[i] = y0[i]; // restore
+        }
+    };
+
+    const bool doneInParallel = calcColumnsInParallel<JacobianFunctionRep>(f, NParameters,
+        [&](const JacobianFunctionRep& func, int begin, int end, int& numCalls)
+        {   Vector y(y0), fyp(NFunctions), fym(NFunctions);
+            calcColumns(func, y, fyp, fym, begin, end, &numCalls); });
+    if (!doneInParallel) {
+        ytmp = y0;
+        calcColumns(f, ytmp, fyptmp, fymtmp, 0, NParameters, nullptr);
+    }
+}
+
+void Differentiator::DifferentiatorRep::calcSparseJacobian
+   (const JacobianFunctionRep& f, Differentiator::Method m,
+    const Vector& y0, const Vector& fy0, Array_<Real>& values) const
+{
+    const Differentiator::Method method = getMethodOrThrow(m, defaultMethod, "calcJacobian");
+    assert(f.hasPattern);
+    assert(y0.size() == NParameters && fy0.size() == NFunctions);
+
+    const Array_<int>& colStart = f.pattern.getColumnStarts();
+    const Array_<int>& rowIndex = f.pattern.getRowIndices();
+    const Array_<int>& groupStart = f.groupStart;
+    const Array_<int>& columns    = f.groupedColumns;
+    values.resize(f.pattern.getNumNonzeros());
+
     const int order = Differentiator::getMethodOrder(method);
+    Vector h(NParameters);
+    for (int j=0; j < NParameters; ++j) {
+        const Real hEst = getAccFac(order)*std::max(std::abs(y0[j]), YMin);
+        h[j] = cleanUpH(hEst, y0[j]);
+    }
 
-    ytmp = y0;
-    for (int i=0; i < NParameters; ++i) {
-        const Real hEst = getAccFac(order)*std::max(std::abs(y0[i]), YMin);
-        const Real h = cleanUpH(hEst, y0[i]);
-        ytmp[i] = y0[i]+h; 
-        nCallsToUserFunction++; f.call(ytmp, fyptmp);
-        if (order==1) {
-            dfdy(i) = (fyptmp-fy0)/h;
-        } else {
-            ytmp[i] = y0[i]-h; 
-            nCallsToUserFunction++; f.call(ytmp, fymtmp);
-            dfdy(i) = (fyptmp-fymtmp)/(2*h);
+    // Perturb all the columns of groups begin..end-1 at once. Because no two
+    // columns in a group share a row, each row of the difference belongs to
+    // at most one of them. On entry y must equal y0; it is restored on
+    // return. Calls are counted as in calcJacobian().
+    auto calcGroups = [&](const JacobianFunctionRep& func, Vector& y,
+                          Vector& fyp, Vector& fym,
+                          int begin, int end, int* numCalls) {
+        auto call = [&](Vector& fy) {
+            if (numCalls) {++*numCalls; func.callWithoutStatistics(y, fy);}
+            else {nCallsToUserFunction++; func.call(y, fy);}
+        };
+        for (int g=begin; g < end; ++g) {
+            const int* first = columns.cbegin() + groupStart[g];
+            const int* last  = columns.cbegin() + groupStart[g+1];
+            for (const int* j=first; j != last; ++j) y[*j] = y0[*j]+h[*j];
+            call(fyp);
+            if (order==2) {
+                for (const int* j=first; j != last; ++j) y[*j] = y0[*j]-h[*j];
+                call(fym);
+            }
+            for (const int* j=first; j != last; ++j) {
+                for (int k=colStart[*j]; k < colStart[*j+1]; ++k) {
+                    const int i = rowIndex[k];
+                    values[k] = order==1 ? (fyp[i]-fy0[i])/h[*j]
+                                         : (fyp[i]-fym[i])/(2*h[*j]);
+                }
+                y[*j] = y0[*j]; // restore
+            }
         }
-        ytmp[i] = y0[i]; // restore
+    };
+
+    const int numGroups = f.getNumGroups();
+    const bool doneInParallel = calcColumnsInParallel<JacobianFunctionRep>
+       (f, numGroups,
+        [&](const JacobianFunctionRep& func, int begin, int end, int& numCalls)
+        {   Vector y(y0), fyp(NFunctions), fym(NFunctions);
+            calcGroups(func, y, fyp, fym, begin, end, &numCalls); });
+    if (!doneInParallel) {
+        ytmp = y0;
+        calcGroups(f, ytmp, fyptmp, fymtmp, 0, numGroups, nullptr);
     }
 }
 
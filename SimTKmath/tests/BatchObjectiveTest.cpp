@@ -0,0 +1,194 @@
+/* -------------------------------------------------------------------------- *
+ *                        Simbody(tm): SimTKmath                              *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2018 Stanford University and the Authors.           *
+ * Authors: Simbody developers                                                *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+// Check that the optimizers hand their independent points to
+// OptimizerSystem::objectiveFuncBatch(): a whole generation for CMAES and the
+// perturbed points of each numerical gradient for the gradient methods. The
+// answers must be the same as when the points are evaluated one at a time.
+
+#include "SimTKmath.h"
+#include "SimTKcommon/Testing.h"
+#include "OptimizerSystems.h"
+
+#include <atomic>
+
+using namespace SimTK;
+
+// A smooth bowl with its minimum at all ones, which the gradient methods
+// can find with numerical gradients.
+class Bowl : public TestOptimizerSystem {
+public:
+    explicit Bowl(int n) : TestOptimizerSystem(n) {}
+    int objectiveFunc(const Vector& x, bool, Real& f) const override {
+        f = square(square(sum(x) - getNumParameters()));
+        for (int i=0; i < getNumParameters(); ++i)
+            f += (i+1)*square(x[i] - 1);
+        return 0;
+    }
+    Vector optimalParameters() const override
+    {   return Vector(getNumParameters(), Real(1)); }
+};
+
+// Sys, counting how it gets evaluated.
+template <class Sys>
+class Batched : public Sys {
+public:
+    explicit Batched(int n) : Sys(n) {}
+    int objectiveFunc(const Vector& x, bool newX, Real& f) const override {
+        ++numSingleCalls;
+        return Sys::objectiveFunc(x, newX, f);
+    }
+    int objectiveFuncBatch(const Matrix& x, Vector& f) const override {
+        ++numBatchCalls;
+        minBatchSize = std::min(minBatchSize, x.ncol());
+        maxBatchSize = std::max(maxBatchSize, x.ncol());
+        f.resize(x.ncol());
+        for (int j=0; j < x.ncol(); ++j)
+            Sys::objectiveFunc(Vector(x(j)), true, f[j]);
+        return 0;
+    }
+    mutable int numSingleCalls = 0, numBatchCalls = 0;
+    mutable int minBatchSize = 1000000, maxBatchSize = 0;
+};
+
+// Each generation is one batch of popsize points, and nothing is evaluated
+// on its own.
+void testCMAES() {
+    const int n = 4, popsize = 12;
+    Vector x[2];
+    for (int batched=0; batched < 2; ++batched) {
+        Rosenbrock plain(n);
+        Batched<Rosenbrock> counted(n);
+        Optimizer opt(batched ? (const OptimizerSystem&)counted 
+                              : (const OptimizerSystem&)plain, CMAES);
+        opt.setAdvancedIntOption("seed", 42);
+        opt.setAdvancedIntOption("popsize", popsize);
+        opt.setAdvancedRealOption("maxTimeFractionForEigendecomposition", 1);
+        opt.setMaxIterations(200);
+        x[batched].resize(n); x[batched] = 0.5;
+        opt.optimize(x[batched]);
+        if (batched) {
+            SimTK_TEST(counted.numBatchCalls > 1);
+            SimTK_TEST(counted.numSingleCalls == 0);
+            SimTK_TEST(counted.minBatchSize == popsize);
+            SimTK_TEST(counted.maxBatchSize == popsize);
+        }
+    }
+    SimTK_TEST((x[1] - x[0]).norm() == 0);
+}
+
+// Forward differences need n perturbed points and central differences 2n.
+void testNumericalGradients() {
+    const int n = 4;
+    const OptimizerAlgorithm algs[] = {LBFGS, LBFGSB, InteriorPoint};
+    for (OptimizerAlgorithm alg : algs) {
+        if (!Optimizer::isAlgorithmAvailable(alg)) continue;
+        for (int central=0; central < 2; ++central) {
+            Vector x[2];
+            for (int batched=0; batched < 2; ++batched) {
+                Bowl plain(n);
+                Batched<Bowl> counted(n);
+                Optimizer opt(batched ? (const OptimizerSystem&)counted 
+                                      : (const OptimizerSystem&)plain, alg);
+                opt.setDifferentiatorMethod(central 
+                    ? Differentiator::CentralDifference
+                    : Differentiator::ForwardDifference);
+                opt.useNumericalGradient(true);
+                opt.setConvergenceTolerance(1e-6);
+                opt.setMaxIterations(1000);
+                x[batched].resize(n); x[batched] = 0.5;
+                opt.optimize(x[batched]);
+                if (batched) {
+                    SimTK_TEST(counted.numBatchCalls > 0);
+                    SimTK_TEST(counted.minBatchSize == (central ? 2 : 1)*n);
+                    SimTK_TEST(counted.maxBatchSize == (central ? 2 : 1)*n);
+                }
+            }
+            SimTK_TEST((x[1] - x[0]).norm() == 0);
+            SimTK_TEST_EQ_TOL(x[1], Vector(n, Real(1)), 1e-4);
+        }
+    }
+}
+
+// A failure reported for a batch of gradient points is an error, as it is
+// for a single point.
+class FailingBatch : public Bowl {
+public:
+    FailingBatch() : Bowl(3) {}
+    int objectiveFuncBatch(const Matrix&, Vector&) const override {return 7;}
+};
+
+void testBatchFailure() {
+    FailingBatch sys;
+    Optimizer opt(sys, LBFGS);
+    opt.useNumericalGradient(true);
+    Vector x(3, Real(.5));
+    SimTK_TEST_MUST_THROW(opt.optimize(x));
+}
+
+// Large gradients are passed to the batch in bounded pieces.
+void testBatchSizeIsBounded() {
+    const int n = 100;
+    Batched<Bowl> sys(n);
+    Optimizer opt(sys, LBFGS);
+    opt.setDifferentiatorMethod(Differentiator::ForwardDifference);
+    opt.useNumericalGradient(true);
+    opt.setMaxIterations(3);
+    Vector x(n, Real(.5));
+    try {opt.optimize(x);} catch (const std::exception&) {}
+    SimTK_TEST(sys.numBatchCalls > 0);
+    SimTK_TEST(sys.maxBatchSize == 64);
+    SimTK_TEST(sys.minBatchSize == n - 64);
+}
+
+// CMAES reports a failed evaluation of a population member.
+class FailingObjective : public Rosenbrock {
+public:
+    FailingObjective() : Rosenbrock(3) {}
+    int objectiveFunc(const Vector& x, bool newX, Real& f) const override {
+        Rosenbrock::objectiveFunc(x, newX, f);
+        return ++numCalls > 20 ? 3 : 0;
+    }
+    mutable std::atomic<int> numCalls{0};
+};
+
+void testCMAESFailure() {
+    for (int parallel=0; parallel < 2; ++parallel) {
+        FailingObjective sys;
+        Optimizer opt(sys, CMAES);
+        opt.setAdvancedIntOption("seed", 42);
+        if (parallel) opt.setAdvancedStrOption("parallel", "multithreading");
+        Vector x(3, Real(.5));
+        SimTK_TEST_MUST_THROW(opt.optimize(x));
+    }
+}
+
+int main() {
+    SimTK_START_TEST("BatchObjectiveTest");
+        SimTK_SUBTEST(testCMAES);
+        SimTK_SUBTEST(testNumericalGradients);
+        SimTK_SUBTEST(testBatchFailure);
+        SimTK_SUBTEST(testBatchSizeIsBounded);
+        SimTK_SUBTEST(testCMAESFailure);
+    SimTK_END_TEST();
+}
@@ -0,0 +1,206 @@
+/* -------------------------------------------------------------------------- *
+ *                        Simbody(tm): SimTKmath                              *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2018 Stanford University and the Authors.           *
+ * Authors: Simbody developers                                                *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+
+// Check FactorCholesky against FactorLU on symmetric positive definite
+// matrices, and make sure indefinite matrices are reported rather than
+// silently producing garbage.
+
+#include "SimTKmath.h"
+#include "SimTKcommon/Testing.h"
+#include "RandomMatrices.h"
+
+#include <iostream>
+using std::cout;
+using std::endl;
+
+using namespace SimTK;
+
+void testSolve() {
+    for (int n=1; n <= 20; n += 3) {
+        Matrix A = randomGram(n,n); A.diag() += 1;
+        const Vector b = randVector(n);
+
+        FactorCholesky chol(lowerOnly(A));
+        SimTK_TEST(chol.isPositiveDefinite());
+        SimTK_TEST(chol.getNotPositiveDefiniteIndex() == 0);
+        SimTK_TEST(0 < chol.getRCondEstimate() && chol.getRCondEstimate() <= 1);
+
+        Vector x, xlu;
+        chol.solve(b, x);
+        FactorLU(A).solve(b, xlu);
+        SimTK_TEST_EQ_SIZE(x, xlu, n);
+        SimTK_TEST_EQ_SIZE(A*x, b, n);
+
+        Matrix B(n,2), X; B(0) = b; B(1) = 2*b;
+        chol.solve(B, X);
+        SimTK_TEST_EQ_SIZE(X(0), x, n);
+        SimTK_TEST_EQ_SIZE(X(1), 2*x, n);
+
+        Matrix L; chol.getL(L);
+        SimTK_TEST_EQ_SIZE(L*~L, A, n);
+
+        Matrix Ainv, I(n,n); I = 1;
+        chol.inverse(Ainv);
+        SimTK_TEST_EQ_SIZE(Ainv*A, I, n);
+    }
+}
+
+void testFloat() {
+    Matrix A = randomGram(5,5); A.diag() += 1;
+    const Vector b = randVector(5);
+    Matrix_<float> Af(5,5); Vector_<float> bf(5), xf;
+    for (int i=0; i<5; ++i) {
+        bf[i] = (float)b[i];
+        for (int j=0; j<5; ++j) Af(i,j) = (float)A(i,j);
+    }
+    FactorCholesky chol; chol.factor(Af);
+    chol.solve(bf, xf);
+    Vector x; FactorCholesky(A).solve(b, x);
+    for (int i=0; i<5; ++i)
+        SimTK_TEST_EQ_TOL(xf[i], x[i], 1e-4);
+}
+
+void testNotPositiveDefinite() {
+    Matrix A = randomGram(6,6); A.diag() += 1;
+    A(3,3) = -1;
+    FactorCholesky chol(A);
+    SimTK_TEST(!chol.isPositiveDefinite());
+    SimTK_TEST(chol.getNotPositiveDefiniteIndex() > 0);
+    SimTK_TEST(chol.getRCondEstimate() == 0);
+    Vector x;
+    SimTK_TEST_MUST_THROW(chol.solve(randVector(6), x));
+
+    // Semidefinite with exact zero row and column.
+    Matrix Z(3,3, Real(0)); Z(0,0) = Z(2,2) = 1;
+    SimTK_TEST(!FactorCholesky(Z).isPositiveDefinite());
+
+    SimTK_TEST_MUST_THROW(FactorCholesky(Matrix(2,3,Real(1))));
+    SimTK_TEST_MUST_THROW(FactorCholesky().solve(Vector(2), x));
+}
+
+void testCopy() {
+    Matrix A = randomGram(4,4); A.diag() += 1;
+    const Vector b = randVector(4);
+    FactorCholesky chol(A), copy(chol), assigned;
+    assigned = chol;
+    Vector x1, x2, x3;
+    chol.solve(b, x1); copy.solve(b, x2); assigned.solve(b, x3);
+    SimTK_TEST_EQ(x1, x2);
+    SimTK_TEST_EQ(x1, x3);
+}
+
+// Compare an updated factorization with one of the modified matrix.
+static void checkSameAs(const FactorCholesky& chol, const Matrix& A) {
+    const int n = A.nrow();
+    FactorCholesky fresh(A);
+    SimTK_TEST(chol.isPositiveDefinite());
+    Matrix L, Lfresh;
+    chol.getL(L); fresh.getL(Lfresh);
+    SimTK_TEST_EQ_SIZE(L, Lfresh, n);
+    SimTK_TEST_EQ_TOL(chol.getRCondEstimate(), fresh.getRCondEstimate(),
+                      1e-8);
+    const Vector b = randVector(n);
+    Vector x; chol.solve(b, x);
+    SimTK_TEST_EQ_SIZE(A*x, b, n);
+}
+
+void testUpdate() {
+    const int n = 7;
+    Matrix A = randomGram(n,n); A.diag() += 1;
+    Matrix V(n,3);
+    for (int j=0; j < 3; ++j) V(j) = randVector(n);
+
+    FactorCholesky chol(A);
+    chol.update(V);                 A += V*~V;      checkSameAs(chol, A);
+    const Vector v1 = V(1);
+    chol.downdate(v1);              A -= v1*~v1;    checkSameAs(chol, A);
+    chol.update(v1);                A += v1*~v1;    checkSameAs(chol, A);
+    chol.downdate(V);               A -= V*~V;      checkSameAs(chol, A);
+
+    // Grow by a row and column, then remove some in different places.
+    Matrix B = randomGram(n+1,n+1); B.diag() += 1;
+    B.updBlock(0,0,n,n) = A;
+    B(n,n) = 1 + B(n)(0,n).normSqr(); // keeps B positive definite
+    chol.appendRowCol(Vector(B(n))); checkSameAs(chol, B);
+    for (int k : {n, 0, 3}) {
+        const int m = B.nrow();
+        Matrix C(m-1,m-1);
+        for (int j=0; j < m-1; ++j)
+            for (int i=0; i < m-1; ++i)
+                C(i,j) = B(i < k ? i : i+1, j < k ? j : j+1);
+        chol.removeRowCol(k);       checkSameAs(chol, C);
+        B = C;
+    }
+
+    // Single precision works too.
+    Matrix_<float> Af(3,3); Vector_<float> vf(3), af(4);
+    for (int i=0; i<3; ++i) {
+        vf[i] = (float)randUniform();
+        for (int j=0; j<3; ++j) Af(i,j) = (float)A(i,j);
+    }
+    af(0,3) = Af(2); af[3] = Af(2,2) + 1;
+    FactorCholesky cf(Af);
+    cf.update(vf); cf.appendRowCol(af); cf.removeRowCol(3); cf.downdate(vf);
+    Matrix_<float> Lf; cf.getL(Lf);
+    Matrix Lfd(3,3);
+    for (int i=0; i<3; ++i) for (int j=0; j<3; ++j) Lfd(i,j) = Lf(i,j);
+    SimTK_TEST_EQ_TOL(Lfd*~Lfd, A.block(0,0,3,3), 1e-4);
+}
+
+// A downdate that removes positive definiteness is reported.
+void testDowndateFails() {
+    Matrix A = randomGram(4,4); A.diag() += 1;
+    FactorCholesky chol(A);
+    Vector v(4, Real(0)); v[2] = 2*std::sqrt(A(2,2));
+    chol.downdate(v);
+    SimTK_TEST(!chol.isPositiveDefinite());
+    SimTK_TEST(chol.getRCondEstimate() == 0);
+    Vector x;
+    SimTK_TEST_MUST_THROW(chol.solve(randVector(4), x));
+    SimTK_TEST_MUST_THROW(chol.update(v));
+
+    chol.factor(A);
+    SimTK_TEST_MUST_THROW(chol.update(Vector(3, Real(1))));
+    SimTK_TEST_MUST_THROW(chol.appendRowCol(Vector(4, Real(1))));
+    SimTK_TEST_MUST_THROW(chol.removeRowCol(4));
+    SimTK_TEST_MUST_THROW(FactorCholesky().removeRowCol(0));
+
+    // Appending a row that makes the matrix indefinite.
+    chol.factor(A);
+    Vector a(5); a(0,4) = A(0); a[4] = A(0,0) - 0.5;
+    chol.appendRowCol(a);
+    SimTK_TEST(!chol.isPositiveDefinite());
+    SimTK_TEST(chol.getNotPositiveDefiniteIndex() == 5);
+}
+
+int main() {
+    SimTK_START_TEST("FactorCholeskyTest");
+        SimTK_SUBTEST(testSolve);
+        SimTK_SUBTEST(testFloat);
+        SimTK_SUBTEST(testNotPositiveDefinite);
+        SimTK_SUBTEST(testCopy);
+        SimTK_SUBTEST(testUpdate);
+        SimTK_SUBTEST(testDowndateFails);
+    SimTK_END_TEST();
+}
@@ -0,0 +1,193 @@
+/* -------------------------------------------------------------------------- *
+ *                        Simbody(tm): SimTKmath                              *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2018 Stanford University and the Authors.           *
+ * Authors: Simbody developers                                                *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+
+// Check the rank-revealing FactorLDLT on positive definite, semidefinite
+// and indefinite symmetric matrices.
+
+#include "SimTKmath.h"
+#include "SimTKcommon/Testing.h"
+#include "RandomMatrices.h"
+
+#include <iostream>
+using std::cout;
+using std::endl;
+
+using namespace SimTK;
+
+void testPositiveDefinite() {
+    for (int n=1; n <= 20; n += 3) {
+        Matrix A = randomGram(n,n); A.diag() += 1;
+        const Vector b = randVector(n);
+
+        FactorLDLT ldlt(lowerOnly(A));
+        SimTK_TEST(ldlt.getRank() == n);
+        SimTK_TEST(ldlt.isPositiveDefinite());
+
+        Vector x, xchol;
+        ldlt.solve(b, x);
+        FactorCholesky(A).solve(b, xchol);
+        SimTK_TEST_EQ_SIZE(x, xchol, n);
+
+        // Reconstruct P*A*~P from the factors.
+        Matrix L; Vector d; Array_<int> p;
+        ldlt.getL(L); ldlt.getD(d); ldlt.getPivots(p);
+        Matrix PAPt(n,n);
+        for (int i=0; i < n; ++i) for (int j=0; j < n; ++j)
+            PAPt(i,j) = A(p[i],p[j]);
+        Matrix DLt = ~L;
+        for (int i=0; i < n; ++i) DLt[i] *= d[i];
+        SimTK_TEST_EQ_SIZE(L*DLt, PAPt, n);
+
+        // Pivots should be in decreasing order for an SPD matrix.
+        for (int i=1; i < n; ++i) SimTK_TEST(d[i] <= d[i-1]);
+
+        Matrix Ainv, I(n,n); I = 1;
+        ldlt.inverse(Ainv);
+        SimTK_TEST_EQ_SIZE(Ainv*A, I, n);
+    }
+}
+
+void testRankDeficient() {
+    // ~B*B with B 4x10 has rank 4.
+    const Matrix A = randomGram(4,10);
+    FactorLDLT ldlt(A);
+    SimTK_TEST(ldlt.getRank() == 4);
+    SimTK_TEST(!ldlt.isPositiveDefinite());
+    SimTK_TEST(ldlt.getRank() == FactorQTZ(A).getRank());
+
+    // A consistent right hand side must be satisfied exactly.
+    const Vector b = A*randVector(10);
+    Vector x;
+    ldlt.solve(b, x);
+    SimTK_TEST_EQ_SIZE(A*x, b, 10);
+
+    // The basic solution has zeroes for the dropped pivots.
+    Array_<int> p; ldlt.getPivots(p);
+    for (int i=4; i < 10; ++i) SimTK_TEST(x[p[i]] == 0);
+
+    // A looser tolerance drops more. Scaling three rows and columns by 1e-4
+    // leaves three pivots around 1e-8.
+    Matrix C = randomGram(10,10); C.diag() += 1;
+    C.updBlock(0,0,3,10) *= 1e-4; C.updBlock(0,0,10,3) *= 1e-4;
+    SimTK_TEST(FactorLDLT(C).getRank() == 10);
+    SimTK_TEST(FactorLDLT(C, 1e-6).getRank() < 10);
+
+    SimTK_TEST(FactorLDLT(Matrix(3,3,Real(0))).getRank() == 0);
+}
+
+void testIndefinite() {
+    Matrix A = randomGram(6,6); A.diag() += 1;
+    A.updBlock(3,3,3,3) *= -1; A.updBlock(3,0,3,3) *= 0.1;
+    A.updBlock(0,3,3,3) = ~A.block(3,0,3,3);
+    const Vector b = randVector(6);
+    FactorLDLT ldlt(A);
+    SimTK_TEST(ldlt.getRank() == 6);
+    SimTK_TEST(!ldlt.isPositiveDefinite());
+    Vector x; ldlt.solve(b, x);
+    SimTK_TEST_EQ_SIZE(A*x, b, 6);
+}
+
+// Returns P*A*~P reassembled from the factors, with D block diagonal.
+static Matrix reassemble(const FactorLDLT& ldlt) {
+    Matrix L; Vector d, e;
+    ldlt.getL(L); ldlt.getD(d); ldlt.getDSubdiagonal(e);
+    const int r = d.size();
+    Matrix D(r,r, Real(0));
+    D.diag() = d;
+    for (int i=0; i < r-1; ++i) D(i+1,i) = D(i,i+1) = e[i];
+    return L*D*~L;
+}
+
+// Matrices with zero diagonals need 2x2 pivots; 1x1 pivoting would report
+// rank 0 for [0 1;1 0].
+void testZeroDiagonal() {
+    Matrix A(2,2); A = 0; A(1,0) = A(0,1) = 1;
+    FactorLDLT ldlt(lowerOnly(A));
+    SimTK_TEST(ldlt.getRank() == 2);
+    SimTK_TEST(!ldlt.isPositiveDefinite());
+    SimTK_TEST_EQ(ldlt.getRCondEstimate(), 1);
+    Vector x; ldlt.solve(Vector(Vec2(1,2)), x);
+    SimTK_TEST_EQ(x, Vector(Vec2(2,1)));
+    Vector e; ldlt.getDSubdiagonal(e);
+    SimTK_TEST(e.size() == 1 && e[0] == 1);
+
+    // Saddle point matrix [H ~J;J 0] with an indefinite H that has a zero
+    // diagonal too.
+    const int nh = 5, nj = 3, n = nh+nj;
+    Matrix K(n,n, Real(0)), J(nj,nh);
+    for (int i=0; i < nj; ++i) for (int j=0; j < nh; ++j) J(i,j)=randUniform();
+    K.updBlock(nh,0,nj,nh) = J; K.updBlock(0,nh,nh,nj) = ~J;
+    for (int i=0; i < nh-1; ++i) K(i+1,i) = K(i,i+1) = randUniform();
+    const Vector b = randVector(n);
+    ldlt.factor(lowerOnly(K));
+    SimTK_TEST(ldlt.getRank() == n);
+    SimTK_TEST(ldlt.getRank() == FactorQTZ(K).getRank());
+    ldlt.solve(b, x);
+    SimTK_TEST_EQ_SIZE(K*x, b, n);
+
+    Array_<int> p; ldlt.getPivots(p);
+    Matrix PKPt(n,n);
+    for (int i=0; i < n; ++i) for (int j=0; j < n; ++j)
+        PKPt(i,j) = K(p[i],p[j]);
+    SimTK_TEST_EQ_SIZE(reassemble(ldlt), PKPt, n);
+
+    // Make J rank deficient; [0 ~J;J 0] then has rank 2*rank(J).
+    Matrix Z(n,n, Real(0));
+    J[2] = J[0] + J[1];
+    Z.updBlock(nh,0,nj,nh) = J; Z.updBlock(0,nh,nh,nj) = ~J;
+    ldlt.factor(Z);
+    SimTK_TEST(ldlt.getRank() == 4);
+    SimTK_TEST(ldlt.getRank() == FactorQTZ(Z).getRank());
+    const Vector bz = Z*randVector(n);
+    ldlt.solve(bz, x);
+    SimTK_TEST_EQ_SIZE(Z*x, bz, n);
+}
+
+void testFloat() {
+    Matrix A = randomGram(5,5); A.diag() += 1;
+    const Vector b = randVector(5);
+    Matrix_<float> Af(5,5); Vector_<float> bf(5), xf;
+    for (int i=0; i<5; ++i) {
+        bf[i] = (float)b[i];
+        for (int j=0; j<5; ++j) Af(i,j) = (float)A(i,j);
+    }
+    FactorLDLT ldlt; ldlt.factor(Af);
+    ldlt.solve(bf, xf);
+    Vector x; FactorLDLT(A).solve(b, x);
+    for (int i=0; i<5; ++i)
+        SimTK_TEST_EQ_TOL(xf[i], x[i], 1e-4);
+
+    Vector xd;
+    SimTK_TEST_MUST_THROW(ldlt.solve(b, xd));
+}
+
+int main() {
+    SimTK_START_TEST("FactorLDLTTest");
+        SimTK_SUBTEST(testPositiveDefinite);
+        SimTK_SUBTEST(testRankDeficient);
+        SimTK_SUBTEST(testIndefinite);
+        SimTK_SUBTEST(testZeroDiagonal);
+        SimTK_SUBTEST(testFloat);
+    SimTK_END_TEST();
+}
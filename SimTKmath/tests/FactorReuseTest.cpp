@@ -0,0 +1,216 @@
+/* -------------------------------------------------------------------------- *
+ *                        Simbody(tm): SimTKmath                              *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2018 Stanford University and the Authors.           *
+ * Authors: Simbody developers                                                *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+// Calling factor() again on an existing factorization object reuses its
+// storage. Check that the answers are exactly those we get from a freshly
+// constructed object, whatever the object was used for before, and that
+// refactoring a matrix no bigger than before doesn't allocate.
+
+#include "SimTKmath.h"
+#include "SimTKcommon/Testing.h"
+#include "RandomMatrices.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+using std::cout;
+using std::endl;
+
+using namespace SimTK;
+
+// Count every heap allocation made by the program, including those made
+// inside the SimTKmath library. The array forms call these by default.
+static std::atomic<long long> numAllocations(0);
+
+void* operator new(std::size_t sz) {
+    ++numAllocations;
+    if (void* p = std::malloc(sz ? sz : 1)) return p;
+    throw std::bad_alloc();
+}
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+
+// Sizes that make the buffers stay the same, grow, and shrink.
+static const int sizes[][2] = {{5,5}, {5,5}, {9,9}, {3,3}, {9,9}, {1,1}};
+
+void testLU() {
+    FactorLU lu;
+    for (auto& sz : sizes) {
+        const Matrix A = randMatrix(sz[0], sz[0]);
+        const Vector b = randVector(sz[0]);
+        lu.factor(A);
+        Vector x, xfresh;
+        lu.solve(b, x);
+        FactorLU(A).solve(b, xfresh);
+        SimTK_TEST(isIdentical(x, xfresh));
+    }
+}
+
+void testQTZ() {
+    const int shapes[][2] = {{6,4}, {6,4}, {4,6}, {8,8}, {2,3}, {7,2}};
+    FactorQTZ qtz;
+    for (auto& sz : shapes) {
+        const Matrix A = randMatrix(sz[0], sz[1]);
+        const Vector b = randVector(sz[0]);
+        qtz.factor(A);
+        FactorQTZ fresh(A);
+        SimTK_TEST(qtz.getRank() == fresh.getRank());
+        SimTK_TEST(qtz.getRCondEstimate() == fresh.getRCondEstimate());
+        Vector x, xfresh;
+        qtz.solve(b, x);
+        fresh.solve(b, xfresh);
+        SimTK_TEST(isIdentical(x, xfresh));
+    }
+
+    // A rank deficient matrix, then a tiny one that has to be scaled, then a
+    // full rank one again; nothing should carry over.
+    Matrix D = randMatrix(6,6); D(5) = D(0) + D(1);
+    const Matrix tiny = 1e-300*randMatrix(6,6), full = randMatrix(6,6);
+    const Vector b = randVector(6);
+    for (const Matrix* A : {(const Matrix*)&D, &tiny, &full}) {
+        qtz.factor(*A, 1e-10);
+        FactorQTZ fresh(*A, 1e-10);
+        SimTK_TEST(qtz.getRank() == fresh.getRank());
+        Vector x, xfresh;
+        qtz.solve(b, x);
+        fresh.solve(b, xfresh);
+        SimTK_TEST(isIdentical(x, xfresh));
+    }
+    SimTK_TEST(qtz.getRank() == 6);
+
+    // Switching element type replaces the rep.
+    Matrix_<float> Af(3,3);
+    for (int j=0; j < 3; ++j) for (int i=0; i < 3; ++i)
+        Af(i,j) = (float)randUniform();
+    Vector_<float> bf(3, 1.f), xf, xffresh;
+    qtz.factor(Af);
+    qtz.solve(bf, xf);
+    FactorQTZ(Af).solve(bf, xffresh);
+    SimTK_TEST(isIdentical(xf, xffresh));
+}
+
+void testSVD() {
+    FactorSVD svd;
+    for (auto& sz : sizes) {
+        const Matrix A = randMatrix(sz[0], sz[1]+1);
+        svd.factor(A);
+        FactorSVD fresh(A);
+        Vector s, sfresh;
+        svd.getSingularValues(s);
+        fresh.getSingularValues(sfresh);
+        SimTK_TEST(isIdentical(s, sfresh));
+        SimTK_TEST(svd.getRank() == fresh.getRank());
+    }
+}
+
+void testCholesky() {
+    FactorCholesky chol;
+    for (auto& sz : sizes) {
+        const int n = sz[0];
+        Matrix A = randomGram(n,n); A.diag() += 1;
+        const Vector b = randVector(n);
+        chol.factor(A);
+        FactorCholesky fresh(A);
+        SimTK_TEST(chol.isPositiveDefinite());
+        SimTK_TEST(chol.getRCondEstimate() == fresh.getRCondEstimate());
+        Vector x, xfresh;
+        chol.solve(b, x);
+        fresh.solve(b, xfresh);
+        SimTK_TEST(isIdentical(x, xfresh));
+
+        // An indefinite matrix is reported, and that doesn't stick.
+        Matrix N = -A;
+        chol.factor(N);
+        SimTK_TEST(!chol.isPositiveDefinite());
+    }
+    Matrix A = randomGram(4,4); A.diag() += 1;
+    chol.factor(A);
+    SimTK_TEST(chol.isPositiveDefinite());
+}
+
+void testLDLT() {
+    FactorLDLT ldlt;
+    for (auto& sz : sizes) {
+        const int n = sz[0];
+        Matrix A = randomGram(n,n); A.diag() -= 0.5; // usually indefinite
+        const Vector b = randVector(n);
+        ldlt.factor(A);
+        FactorLDLT fresh(A);
+        SimTK_TEST(ldlt.getRank() == fresh.getRank());
+        SimTK_TEST(ldlt.isPositiveDefinite() == fresh.isPositiveDefinite());
+        Vector x, xfresh;
+        ldlt.solve(b, x);
+        fresh.solve(b, xfresh);
+        SimTK_TEST(isIdentical(x, xfresh));
+    }
+}
+
+// Refactor with a new matrix of the same size, then a smaller one; neither
+// should allocate once the object has seen the largest size. We only look at
+// factor() here; solve() may allocate its result.
+template <class F>
+static void checkNoAllocation(const Matrix& big, const Matrix& big2,
+                              const Matrix& small) {
+    F f;
+    f.factor(big);
+    const long long before = numAllocations;
+    f.factor(big2);
+    f.factor(small);
+    f.factor(big);
+    SimTK_TEST(numAllocations == before);
+}
+
+void testNoAllocation() {
+    const Matrix A = randMatrix(9,9), A2 = randMatrix(9,9),
+                 S = randMatrix(5,5);
+    Matrix P = randomGram(9,9);  P.diag()  += 1;
+    Matrix P2 = randomGram(9,9); P2.diag() += 1;
+    Matrix PS = randomGram(5,5); PS.diag() += 1;
+
+    // Make sure the counter sees allocations at all; on platforms where the
+    // library doesn't use our operator new there is nothing to check.
+    const long long start = numAllocations;
+    { FactorLU lu(A); }
+    if (numAllocations == start) {
+        cout << "Allocations in SimTKmath not visible; skipping." << endl;
+        return;
+    }
+
+    checkNoAllocation<FactorLU>(A, A2, S);
+    checkNoAllocation<FactorQTZ>(A, A2, S);
+    checkNoAllocation<FactorSVD>(A, A2, S);
+    checkNoAllocation<FactorCholesky>(P, P2, PS);
+    checkNoAllocation<FactorLDLT>(P, P2, PS);
+}
+
+int main() {
+    SimTK_START_TEST("FactorReuseTest");
+        SimTK_SUBTEST(testLU);
+        SimTK_SUBTEST(testQTZ);
+        SimTK_SUBTEST(testSVD);
+        SimTK_SUBTEST(testCholesky);
+        SimTK_SUBTEST(testLDLT);
+        SimTK_SUBTEST(testNoAllocation);
+    SimTK_END_TEST();
+}
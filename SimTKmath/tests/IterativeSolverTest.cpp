@@ -0,0 +1,188 @@
+/* -------------------------------------------------------------------------- *
+ *                        Simbody(tm): SimTKmath                              *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2018 Stanford University and the Authors.           *
+ * Authors: Simbody developers                                                *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+// Check the Krylov solvers against dense factorizations, and that they work
+// through matrix-free operators.
+
+#include "SimTKmath.h"
+#include "SimTKcommon/Testing.h"
+#include "RandomMatrices.h"
+
+#include <iostream>
+using std::cout;
+using std::endl;
+
+using namespace SimTK;
+
+void testConjugateGradient() {
+    const int n = 40;
+    Matrix A = randomGram(n,n); A.diag() += 1;
+    const Vector b = randVector(n);
+    Vector xlu; FactorLU(A).solve(b, xlu);
+
+    IterativeSolver cg; // ConjugateGradient is the default
+    cg.setTolerance(1e-12);
+    Vector x;
+    SimTK_TEST(cg.solve(MatrixOperator(A), b, x));
+    SimTK_TEST(cg.isConverged());
+    SimTK_TEST(cg.getResidualNorm() <= 1e-11*b.norm());
+    SimTK_TEST_EQ_TOL(x, xlu, 1e-9);
+
+    // Starting from the answer takes no iterations beyond the first residual.
+    SimTK_TEST(cg.solve(MatrixOperator(A), b, x));
+    SimTK_TEST(cg.getNumIterations() == 1);
+
+    // Badly scaled: the Jacobi preconditioner should help a lot.
+    Matrix S = A;
+    for (int i=0; i < n; ++i) {
+        const Real s = std::pow(10., (i % 7) - 3);
+        S(i) *= s; S[i] *= s;
+    }
+    Vector xs, xsp;
+    cg.setMaxIterations(5000);
+    SimTK_TEST(cg.solve(MatrixOperator(S), b, xs));
+    const int plainIters = cg.getNumIterations();
+    DiagonalPreconditioner jacobi(S.diag());
+    cg.setPreconditioner(&jacobi);
+    SimTK_TEST(cg.solve(MatrixOperator(S), b, xsp));
+    SimTK_TEST(cg.getNumIterations() < plainIters);
+    SimTK_TEST_EQ_TOL(S*xsp, b, 1e-9);
+
+    // An indefinite matrix makes CG give up.
+    Matrix N = A; N(0,0) = -100;
+    cg.setPreconditioner(nullptr);
+    SimTK_TEST(!cg.solve(MatrixOperator(N), b, x = Vector()));
+}
+
+void testMINRES() {
+    // A symmetric indefinite saddle point matrix [K ~G; G 0].
+    const int nk = 30, ng = 10, n = nk+ng;
+    Matrix K = randomGram(nk,nk); K.diag() += 1;
+    const Matrix G = randMatrix(ng, nk);
+    Matrix A(n,n, Real(0));
+    A.updBlock(0,0,nk,nk) = K;
+    A.updBlock(nk,0,ng,nk) = G;
+    A.updBlock(0,nk,nk,ng) = ~G;
+    const Vector b = randVector(n);
+    Vector xlu; FactorLU(A).solve(b, xlu);
+
+    IterativeSolver minres(IterativeSolver::MINRES);
+    minres.setTolerance(1e-12);
+    Vector x;
+    SimTK_TEST(minres.solve(MatrixOperator(A), b, x));
+    SimTK_TEST_EQ_TOL(x, xlu, 1e-8);
+
+    // With a positive definite block diagonal preconditioner.
+    Vector d(n);
+    for (int i=0; i < nk; ++i) d[i] = K(i,i);
+    for (int i=0; i < ng; ++i) d[nk+i] = G[i].normSqr() / K.diag().normInf();
+    DiagonalPreconditioner M(d);
+    minres.setPreconditioner(&M);
+    SimTK_TEST(minres.solve(MatrixOperator(A), b, x = Vector()));
+    SimTK_TEST_EQ_TOL(A*x, b, 1e-9);
+}
+
+void testGMRES() {
+    const int n = 50;
+    Matrix A = randMatrix(n,n); A.diag() += 10; // nonsymmetric
+    const Vector b = randVector(n);
+    Vector xlu; FactorLU(A).solve(b, xlu);
+
+    IterativeSolver gmres(IterativeSolver::GMRES);
+    gmres.setTolerance(1e-12);
+    Vector x;
+    SimTK_TEST(gmres.solve(MatrixOperator(A), b, x));
+    SimTK_TEST_EQ_TOL(x, xlu, 1e-9);
+
+    // Short restarts still get there; a preconditioner is applied on the
+    // right so the residual is the true one.
+    gmres.setRestart(5);
+    gmres.setMaxIterations(2000);
+    DiagonalPreconditioner jacobi(A.diag());
+    gmres.setPreconditioner(&jacobi);
+    SimTK_TEST(gmres.solve(MatrixOperator(A), b, x = Vector()));
+    SimTK_TEST_EQ_TOL(x, xlu, 1e-9);
+
+    // Hitting the iteration limit.
+    gmres.setPreconditioner(nullptr);
+    gmres.setMaxIterations(3);
+    SimTK_TEST(!gmres.solve(MatrixOperator(A), b, x = Vector()));
+    SimTK_TEST(!gmres.isConverged());
+    SimTK_TEST(gmres.getResidualNorm() > 1e-12*b.norm());
+}
+
+// A large 1-d Laplacian applied matrix-free, and the same one as a
+// SparseMatrix.
+void testMatrixFree() {
+    const int n = 2000;
+    FunctionOperator lap(n, [n](const Vector& x, Vector& y) {
+        y.resize(n);
+        for (int i=0; i < n; ++i)
+            y[i] = 2.01*x[i] - (i > 0 ? x[i-1] : 0) - (i < n-1 ? x[i+1] : 0);
+    });
+    SparseMatrixBuilder builder(n,n);
+    for (int i=0; i < n; ++i) {
+        builder.addEntry(i, i, 2.01);
+        if (i > 0) builder.addEntry(i, i-1, -1);
+        if (i < n-1) builder.addEntry(i, i+1, -1);
+    }
+    const SparseMatrix S(builder);
+    const Vector b = randVector(n);
+
+    for (IterativeSolver::Method m : {IterativeSolver::ConjugateGradient,
+                                      IterativeSolver::MINRES,
+                                      IterativeSolver::GMRES}) {
+        IterativeSolver solver(m);
+        solver.setTolerance(1e-10);
+        solver.setRestart(100);
+        Vector x, xs;
+        SimTK_TEST(solver.solve(lap, b, x));
+        SimTK_TEST(solver.getResidualNorm() <= 1.1e-10*b.norm());
+        SimTK_TEST(solver.solve(SparseMatrixOperator(S), b, xs));
+        SimTK_TEST_EQ_TOL(x, xs, 1e-6);
+    }
+}
+
+void testErrors() {
+    Matrix A(3,3); A = 1;
+    IterativeSolver solver;
+    Vector x;
+    SimTK_TEST_MUST_THROW(solver.solve(MatrixOperator(A), Vector(4, 1.), x));
+    SimTK_TEST_MUST_THROW(MatrixOperator(Matrix(2,3)));
+    SimTK_TEST_MUST_THROW(solver.setTolerance(0));
+    SimTK_TEST_MUST_THROW(solver.setRestart(0));
+
+    // Zero right hand side gives zero without any work.
+    SimTK_TEST(solver.solve(MatrixOperator(A), Vector(3, Real(0)), x));
+    SimTK_TEST(x.norm() == 0 && solver.getNumIterations() == 0);
+}
+
+int main() {
+    SimTK_START_TEST("IterativeSolverTest");
+        SimTK_SUBTEST(testConjugateGradient);
+        SimTK_SUBTEST(testMINRES);
+        SimTK_SUBTEST(testGMRES);
+        SimTK_SUBTEST(testMatrixFree);
+        SimTK_SUBTEST(testErrors);
+    SimTK_END_TEST();
+}
@@ -0,0 +1,181 @@
+/* -------------------------------------------------------------------------- *
+ *                        Simbody(tm): SimTKmath                              *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2018 Stanford University and the Authors.           *
+ * Authors: Simbody developers                                                *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+// Check the Lanczos eigensolver against problems with known eigenvalues and
+// against the residuals of the generalized problem.
+
+#include "SimTKmath.h"
+#include "SimTKcommon/Testing.h"
+
+#include <cmath>
+
+using namespace SimTK;
+
+// The n x n matrix tridiag(-1, 2, -1) applied without forming it.
+static void applyLaplacian(const Vector& x, Vector& y) {
+    const int n = x.size();
+    y.resize(n);
+    for (int i=0; i < n; ++i)
+        y[i] = 2*x[i] - (i > 0 ? x[i-1] : 0) - (i < n-1 ? x[i+1] : 0);
+}
+
+static Real laplacianEigenvalue(int n, int k) {
+    return 2 - 2*std::cos(k*Pi/(n+1));
+}
+
+static Real maxResidual(const LinearOperator& K, const LinearOperator* M,
+                        const Vector& values, const Matrix& vectors) {
+    Real worst = 0;
+    for (int k=0; k < values.size(); ++k) {
+        const Vector x = vectors(k);
+        Vector Kx, Mx;
+        K.apply(x, Kx);
+        if (M) M->apply(x, Mx); else Mx = x;
+        worst = std::max(worst, (Kx - values[k]*Mx).normInf());
+    }
+    return worst;
+}
+
+void testLowestModes() {
+    const int n = 200, nev = 5;
+    FunctionOperator K(n, applyLaplacian);
+    LanczosEigenSolver solver(K);
+    Vector values; Matrix vectors;
+    SimTK_TEST(solver.calcEigenvaluesAndVectors(nev, values, vectors));
+    SimTK_TEST(solver.getNumConverged() == nev);
+    SimTK_TEST(vectors.nrow() == n && vectors.ncol() == nev);
+    for (int k=0; k < nev; ++k)
+        SimTK_TEST_EQ_TOL(values[k], laplacianEigenvalue(n, k+1), 1e-9);
+    SimTK_TEST_EQ_TOL(maxResidual(K, nullptr, values, vectors), 0, 1e-6);
+    SimTK_TEST_EQ_TOL(~vectors*vectors, Matrix(Mat<5,5>(1)), 1e-8);
+}
+
+// Nonzero shift picks out the eigenvalues in the middle of the spectrum.
+void testShift() {
+    const int n = 60, nev = 3;
+    FunctionOperator K(n, applyLaplacian);
+    Matrix Kd(n, n);
+    for (int j=0; j < n; ++j) {
+        Vector e(n, Real(0)), y; e[j] = 1;
+        applyLaplacian(e, y);
+        Kd(j) = y;
+    }
+    FactorLU shifted;
+    const Real sigma = 1.01;
+    shifted.factor(Kd - sigma);
+    FunctionOperator shiftInverse(n, [&](const Vector& b, Vector& x)
+        {shifted.solve(b, x);});
+
+    Vector values, values2; Matrix vectors, vectors2;
+    LanczosEigenSolver solver(K);
+    solver.setShift(sigma);
+    SimTK_TEST(solver.calcEigenvaluesAndVectors(nev, values, vectors));
+    solver.setShiftInverseOperator(&shiftInverse);
+    SimTK_TEST(solver.calcEigenvaluesAndVectors(nev, values2, vectors2));
+
+    // The eigenvalues are cos-spaced; find the three nearest sigma.
+    Array_<Real> exact;
+    for (int k=1; k <= n; ++k) exact.push_back(laplacianEigenvalue(n, k));
+    std::sort(exact.begin(), exact.end(), [&](Real a, Real b)
+        {return std::abs(a-sigma) < std::abs(b-sigma);});
+    std::sort(exact.begin(), exact.begin()+nev);
+    for (int k=0; k < nev; ++k) {
+        SimTK_TEST_EQ_TOL(values[k], exact[k], 1e-9);
+        SimTK_TEST_EQ_TOL(values2[k], exact[k], 1e-9);
+    }
+    SimTK_TEST_EQ_TOL(maxResidual(K, nullptr, values2, vectors2), 0, 1e-6);
+}
+
+// K*x = lambda*M*x with a diagonal mass matrix. A small basis forces
+// several restarts, which must give the same answer as a full one.
+void testGeneralized() {
+    const int n = 120, nev = 6;
+    Vector mass(n);
+    for (int i=0; i < n; ++i) mass[i] = 1 + 0.5*std::sin(Real(i));
+    FunctionOperator K(n, applyLaplacian);
+    FunctionOperator M(n, [&](const Vector& x, Vector& y)
+        {y = x.elementwiseMultiply(mass);});
+
+    LanczosEigenSolver solver(K, &M);
+    solver.setNumLanczosVectors(14);
+    Vector values; Matrix vectors;
+    SimTK_TEST(solver.calcEigenvaluesAndVectors(nev, values, vectors));
+    SimTK_TEST(solver.getNumIterations() > 14);
+    SimTK_TEST_EQ_TOL(maxResidual(K, &M, values, vectors), 0, 1e-6);
+    for (int k=0; k < nev; ++k) {
+        SimTK_TEST_EQ_TOL(~vectors(k)*vectors(k).elementwiseMultiply(mass),
+                          1, 1e-8);
+        if (k > 0) SimTK_TEST(values[k] > values[k-1]);
+    }
+
+    LanczosEigenSolver full(K, &M);
+    full.setNumLanczosVectors(n);
+    Vector fullValues; Matrix fullVectors;
+    SimTK_TEST(full.calcEigenvaluesAndVectors(nev, fullValues, fullVectors));
+    SimTK_TEST_EQ_TOL(values, fullValues, 1e-9);
+}
+
+// A problem small enough for the basis to span the whole space.
+void testSmall() {
+    const int n = 4;
+    Matrix A(n, n, Real(0));
+    for (int i=0; i < n; ++i) A(i,i) = i+1;
+    MatrixOperator K(A);
+    LanczosEigenSolver solver(K);
+    Vector values; Matrix vectors;
+    SimTK_TEST(solver.calcEigenvaluesAndVectors(n, values, vectors));
+    SimTK_TEST_EQ_TOL(values, Vector(Vec4(1,2,3,4)), 1e-10);
+}
+
+void testErrors() {
+    FunctionOperator K(10, applyLaplacian);
+    FunctionOperator M(9, applyLaplacian);
+    SimTK_TEST_MUST_THROW(LanczosEigenSolver(K, &M));
+    LanczosEigenSolver solver(K);
+    Vector values; Matrix vectors;
+    SimTK_TEST_MUST_THROW(solver.calcEigenvaluesAndVectors(0, values, vectors));
+    SimTK_TEST_MUST_THROW(solver.calcEigenvaluesAndVectors(11, values, vectors));
+    solver.setNumLanczosVectors(3);
+    SimTK_TEST_MUST_THROW(solver.calcEigenvaluesAndVectors(3, values, vectors));
+    SimTK_TEST_MUST_THROW(solver.setTolerance(0));
+    SimTK_TEST_MUST_THROW(solver.setNumLanczosVectors(-1));
+
+    // A shift that is exactly an eigenvalue makes K - shift*I singular, so
+    // the MINRES solves can't converge.
+    Matrix A(4, 4, Real(0));
+    for (int i=0; i < 4; ++i) A(i,i) = i+1;
+    MatrixOperator D(A);
+    LanczosEigenSolver singular(D);
+    singular.setShift(2);
+    SimTK_TEST_MUST_THROW(singular.calcEigenvaluesAndVectors(2, values, vectors));
+}
+
+int main() {
+    SimTK_START_TEST("LanczosEigenSolverTest");
+        SimTK_SUBTEST(testLowestModes);
+        SimTK_SUBTEST(testShift);
+        SimTK_SUBTEST(testGeneralized);
+        SimTK_SUBTEST(testSmall);
+        SimTK_SUBTEST(testErrors);
+    SimTK_END_TEST();
+}
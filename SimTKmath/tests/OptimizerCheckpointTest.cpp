@@ -0,0 +1,143 @@
+/* -------------------------------------------------------------------------- *
+ *                        Simbody(tm): SimTKmath                              *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2018 Stanford University and the Authors.           *
+ * Authors: Simbody developers                                                *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+// An optimization that is killed and then resumed from its last checkpoint
+// must finish exactly as if it had never been interrupted.
+
+#include "SimTKmath.h"
+#include "SimTKcommon/Testing.h"
+#include "OptimizerSystems.h"
+
+#include <cstdio>
+
+using namespace SimTK;
+
+static const char* CheckpointFile = "OptimizerCheckpointTest.ckpt";
+
+// Rosenbrock's function, which can be made to fail after a given number of
+// evaluations to simulate the job being killed.
+class Killable : public Rosenbrock {
+public:
+    explicit Killable(int n, int killAfter=-1)
+    :   Rosenbrock(n), killAfter(killAfter) {}
+    int objectiveFunc(const Vector& x, bool newX, Real& f) const override {
+        if (numEvals++ == killAfter)
+            throw std::runtime_error("killed");
+        return Rosenbrock::objectiveFunc(x, newX, f);
+    }
+    int killAfter;
+    mutable int numEvals = 0;
+};
+
+void setOptions(Optimizer& opt, OptimizerAlgorithm alg, int interval) {
+    opt.setAdvancedStrOption("checkpoint_file", CheckpointFile);
+    opt.setAdvancedIntOption("checkpoint_interval", interval);
+    opt.setMaxIterations(2000);
+    if (alg == CMAES) {
+        opt.setAdvancedIntOption("seed", 7);
+        opt.setAdvancedRealOption("maxTimeFractionForEigendecomposition", 1);
+    } else {
+        opt.useNumericalGradient(true);
+        opt.setConvergenceTolerance(1e-6);
+    }
+}
+
+void testResume(OptimizerAlgorithm alg, int interval, int killAfter) {
+    const int n = 5;
+    std::remove(CheckpointFile);
+
+    // Uninterrupted.
+    Killable sys(n);
+    Optimizer opt(sys, alg);
+    setOptions(opt, alg, interval);
+    Vector x(n, Real(.5));
+    const Real f = opt.optimize(x);
+
+    // Killed part way, then resumed by a new Optimizer.
+    Killable doomed(n, killAfter);
+    Optimizer first(doomed, alg);
+    setOptions(first, alg, interval);
+    Vector y(n, Real(.5));
+    SimTK_TEST_MUST_THROW(first.optimize(y));
+
+    Killable revived(n);
+    Optimizer second(revived, alg);
+    setOptions(second, alg, interval);
+    Vector z; // starting point comes from the checkpoint
+    const Real g = second.resume(z);
+    SimTK_TEST(g == f);
+    SimTK_TEST(z.size() == n && (z - x).norm() == 0);
+    SimTK_TEST(revived.numEvals < sys.numEvals);
+
+    // Resuming again from the final checkpoint also gives the same answer.
+    SimTK_TEST(second.resume(z) == f);
+    std::remove(CheckpointFile);
+}
+
+void testCMAES() {
+    testResume(CMAES, 1, 400);
+    testResume(CMAES, 7, 1000);
+}
+
+void testLBFGSB() {
+    testResume(LBFGSB, 1, 200);
+    testResume(LBFGSB, 5, 300);
+}
+
+void testBadCheckpoints() {
+    std::remove(CheckpointFile);
+    Killable sys(5);
+    Vector x(5, Real(.5));
+
+    // No checkpoint option, no file, or an algorithm that can't resume.
+    Optimizer plain(sys, LBFGSB);
+    SimTK_TEST_MUST_THROW(plain.resume(x));
+    Optimizer opt(sys, CMAES);
+    setOptions(opt, CMAES, 1);
+    SimTK_TEST_MUST_THROW(opt.resume(x));
+    Optimizer lbfgs(sys, LBFGS);
+    setOptions(lbfgs, LBFGS, 1);
+    SimTK_TEST_MUST_THROW(lbfgs.resume(x));
+
+    // Wrong algorithm, dimension or population size.
+    opt.setMaxIterations(3);
+    opt.optimize(x);
+    Optimizer lbfgsb(sys, LBFGSB);
+    setOptions(lbfgsb, LBFGSB, 1);
+    SimTK_TEST_MUST_THROW(lbfgsb.resume(x));
+    Killable bigger(6);
+    Optimizer other(bigger, CMAES);
+    setOptions(other, CMAES, 1);
+    SimTK_TEST_MUST_THROW(other.resume(x));
+    opt.setAdvancedIntOption("popsize", 20);
+    SimTK_TEST_MUST_THROW(opt.resume(x));
+    std::remove(CheckpointFile);
+}
+
+int main() {
+    SimTK_START_TEST("OptimizerCheckpointTest");
+        SimTK_SUBTEST(testCMAES);
+        SimTK_SUBTEST(testLBFGSB);
+        SimTK_SUBTEST(testBadCheckpoints);
+    SimTK_END_TEST();
+}
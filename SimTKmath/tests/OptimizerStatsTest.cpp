@@ -0,0 +1,223 @@
+/* -------------------------------------------------------------------------- *
+ *                        Simbody(tm): SimTKmath                              *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2018 Stanford University and the Authors.           *
+ * Authors: Simbody developers                                                *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+// Check the Optimizer's statistics against counts kept by the OptimizerSystem
+// itself, and that the iteration callback is called once per iteration.
+
+#include "SimTKmath.h"
+#include "SimTKcommon/Testing.h"
+
+#include <stdexcept>
+#include <vector>
+
+using namespace SimTK;
+
+// A bowl with its minimum at all ones, optionally constrained to the plane
+// sum(x) = n-1. It counts every call made to it.
+class CountingBowl : public OptimizerSystem {
+public:
+    CountingBowl(int n, bool constrained) : OptimizerSystem(n) {
+        if (constrained) setNumEqualityConstraints(1);
+    }
+    int objectiveFunc(const Vector& x, bool, Real& f) const override {
+        ++numObjective;
+        f = 0;
+        for (int i=0; i < x.size(); ++i)
+            f += (i+1)*square(x[i] - 1);
+        return 0;
+    }
+    int gradientFunc(const Vector& x, bool, Vector& g) const override {
+        ++numGradient;
+        for (int i=0; i < x.size(); ++i)
+            g[i] = 2*(i+1)*(x[i] - 1);
+        return 0;
+    }
+    int constraintFunc(const Vector& x, bool, Vector& c) const override {
+        ++numConstraint; // IPOPT calls this even with no constraints
+        if (c.size()) c[0] = sum(x) - (x.size()-1);
+        return 0;
+    }
+    int constraintJacobian(const Vector& x, bool, Matrix& J) const override {
+        ++numJacobian;
+        J.setTo(1);
+        return 0;
+    }
+    mutable int numObjective = 0, numGradient = 0;
+    mutable int numConstraint = 0, numJacobian = 0;
+};
+
+// Records the callback's arguments, and throws on iteration throwAt.
+struct Recorder {
+    void operator()(const Optimizer& opt, int iteration, Real f) {
+        SimTK_TEST(iteration == opt.getNumIterations());
+        iterations.push_back(iteration);
+        objectives.push_back(f);
+        if (iteration == throwAt)
+            throw std::runtime_error("stop");
+    }
+    std::vector<int> iterations;
+    std::vector<Real> objectives;
+    int throwAt = -1;
+};
+
+// The callback sees iterations 1, 2, ... and was called for all of them.
+void checkIterations(const Optimizer& opt, const Recorder& rec) {
+    SimTK_TEST(opt.getNumIterations() > 0);
+    SimTK_TEST((int)rec.iterations.size() == opt.getNumIterations());
+    for (int i=0; i < (int)rec.iterations.size(); ++i)
+        SimTK_TEST(rec.iterations[i] == i+1);
+}
+
+void checkTimes(const Optimizer& opt) {
+    SimTK_TEST(opt.getTimeInUserFunctions() >= 0);
+    SimTK_TEST(opt.getTimeInOptimizer() >= 0);
+}
+
+void testGradientMethods() {
+    const int n = 4;
+    const OptimizerAlgorithm algs[] = {LBFGS, LBFGSB, InteriorPoint};
+    for (OptimizerAlgorithm alg : algs) {
+        if (!Optimizer::isAlgorithmAvailable(alg)) continue;
+        for (int numerical=0; numerical < 2; ++numerical) {
+            CountingBowl sys(n, false);
+            Optimizer opt(sys, alg);
+            Recorder rec;
+            opt.setIterationCallback(std::ref(rec));
+            opt.setDifferentiatorMethod(Differentiator::ForwardDifference);
+            opt.useNumericalGradient(numerical != 0);
+            opt.setConvergenceTolerance(1e-6);
+            Vector x(n, Real(0));
+            opt.optimize(x);
+            SimTK_TEST_EQ_TOL(x, Vector(n, Real(1)), 1e-4);
+
+            checkIterations(opt, rec);
+            checkTimes(opt);
+            if (numerical) {
+                SimTK_TEST(sys.numGradient == 0);
+                SimTK_TEST(opt.getNumGradientEvals() == 0);
+                SimTK_TEST(opt.getNumNumericalGradientEvals() > 0);
+                SimTK_TEST(opt.getNumObjectiveEvalsForGradients()
+                           == (n+1)*opt.getNumNumericalGradientEvals());
+            } else {
+                SimTK_TEST(sys.numGradient > 0);
+                SimTK_TEST(opt.getNumGradientEvals() == sys.numGradient);
+                SimTK_TEST(opt.getNumNumericalGradientEvals() == 0);
+                SimTK_TEST(opt.getNumObjectiveEvalsForGradients() == 0);
+            }
+            SimTK_TEST(opt.getNumObjectiveEvals() > 0);
+            SimTK_TEST(opt.getNumObjectiveEvals()
+                       + opt.getNumObjectiveEvalsForGradients()
+                       == sys.numObjective);
+            SimTK_TEST(opt.getNumConstraintEvals() == sys.numConstraint);
+        }
+    }
+}
+
+void testConstraints() {
+    if (!Optimizer::isAlgorithmAvailable(InteriorPoint)) return;
+    const int n = 3;
+    for (int numerical=0; numerical < 2; ++numerical) {
+        CountingBowl sys(n, true);
+        Optimizer opt(sys, InteriorPoint);
+        opt.setDifferentiatorMethod(Differentiator::ForwardDifference);
+        opt.useNumericalJacobian(numerical != 0);
+        Vector x(n, Real(0));
+        opt.optimize(x);
+        SimTK_TEST_EQ_TOL(sum(x), n-1, 1e-6);
+
+        SimTK_TEST(opt.getNumConstraintEvals() > 0);
+        SimTK_TEST(opt.getNumConstraintEvals()
+                   + opt.getNumConstraintEvalsForJacobians()
+                   == sys.numConstraint);
+        if (numerical) {
+            SimTK_TEST(sys.numJacobian == 0);
+            SimTK_TEST(opt.getNumConstraintJacobianEvals() == 0);
+            SimTK_TEST(opt.getNumNumericalConstraintJacobianEvals() > 0);
+            SimTK_TEST(opt.getNumConstraintEvalsForJacobians()
+                       == (n+1)*opt.getNumNumericalConstraintJacobianEvals());
+        } else {
+            SimTK_TEST(opt.getNumConstraintJacobianEvals() == sys.numJacobian);
+            SimTK_TEST(opt.getNumNumericalConstraintJacobianEvals() == 0);
+            SimTK_TEST(opt.getNumConstraintEvalsForJacobians() == 0);
+        }
+    }
+}
+
+// Each generation is an iteration that evaluates popsize points, and the
+// callback gets the best objective value so far.
+void testCMAES() {
+    const int n = 3, popsize = 8;
+    CountingBowl sys(n, false);
+    Optimizer opt(sys, CMAES);
+    Recorder rec;
+    opt.setIterationCallback(std::ref(rec));
+    opt.setAdvancedIntOption("seed", 42);
+    opt.setAdvancedIntOption("popsize", popsize);
+    opt.setMaxIterations(50);
+    Vector x(n, Real(0));
+    const Real f = opt.optimize(x);
+
+    checkIterations(opt, rec);
+    checkTimes(opt);
+    SimTK_TEST(opt.getNumObjectiveEvals() == popsize*opt.getNumIterations());
+    SimTK_TEST(opt.getNumObjectiveEvals() == sys.numObjective);
+    for (int i=1; i < (int)rec.objectives.size(); ++i)
+        SimTK_TEST(rec.objectives[i] <= rec.objectives[i-1]);
+    SimTK_TEST(rec.objectives.back() == f);
+}
+
+// Throwing from the callback abandons the optimization, and the statistics
+// describe the work done until then. The next optimization starts counting
+// from zero.
+void testThrowingCallback() {
+    const int n = 4;
+    const OptimizerAlgorithm algs[] = {LBFGS, LBFGSB, InteriorPoint, CMAES};
+    for (OptimizerAlgorithm alg : algs) {
+        if (!Optimizer::isAlgorithmAvailable(alg)) continue;
+        CountingBowl sys(n, false);
+        Optimizer opt(sys, alg);
+        Recorder rec;
+        rec.throwAt = 2;
+        opt.setIterationCallback(std::ref(rec));
+        Vector x(n, Real(0));
+        SimTK_TEST_MUST_THROW_EXC(opt.optimize(x), std::runtime_error);
+        SimTK_TEST(opt.getNumIterations() == 2);
+        SimTK_TEST(opt.getNumObjectiveEvals() == sys.numObjective);
+
+        opt.setIterationCallback(Optimizer::IterationCallback());
+        sys.numObjective = 0;
+        x = 0;
+        opt.optimize(x);
+        SimTK_TEST(rec.iterations.size() == 2);
+        SimTK_TEST(opt.getNumObjectiveEvals() == sys.numObjective);
+    }
+}
+
+int main() {
+    SimTK_START_TEST("OptimizerStatsTest");
+        SimTK_SUBTEST(testGradientMethods);
+        SimTK_SUBTEST(testConstraints);
+        SimTK_SUBTEST(testCMAES);
+        SimTK_SUBTEST(testThrowingCallback);
+    SimTK_END_TEST();
+}
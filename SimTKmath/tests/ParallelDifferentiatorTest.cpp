@@ -0,0 +1,152 @@
+/* -------------------------------------------------------------------------- *
+ *                        Simbody(tm): SimTKmath                              *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2018 Stanford University and the Authors.           *
+ * Authors: Simbody developers                                                *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+// Check that multithreaded Differentiator gradients and Jacobians are
+// bitwise identical to the serial ones, with thread safe and cloned
+// functions, and that functions that are neither are evaluated serially.
+
+#include "SimTKmath.h"
+#include "SimTKcommon/Testing.h"
+#include "RandomMatrices.h"
+
+#include <atomic>
+#include <mutex>
+#include <set>
+#include <thread>
+
+using namespace SimTK;
+
+static std::atomic<int> numClones(0);
+
+// A vector function with some internal scratch space, so it is not safe to
+// call concurrently; it can be cloned, though. It fails for y[0] > 10.
+class ScratchFunc : public Differentiator::JacobianFunction {
+public:
+    ScratchFunc(int nf, int ny) : JacobianFunction(nf, ny), scratch(ny) {}
+    int f(const Vector& y, Vector& fy) const override {
+        if (y[0] > 10) return 3;
+        scratch = y;
+        for (int i=0; i < fy.size(); ++i) {
+            Real s = 0;
+            for (int j=0; j < scratch.size(); ++j)
+                s += std::sin((i+1)*scratch[j]) * std::exp(-0.1*j*scratch[j]);
+            fy[i] = s;
+        }
+        return 0;
+    }
+    ScratchFunc* cloneForThread() const override {
+        ++numClones;
+        return new ScratchFunc(getNumFunctions(), getNumParameters());
+    }
+private:
+    mutable Vector scratch;
+};
+
+// A scalar function with no state at all. It records the threads that
+// called it.
+class PureFunc : public Differentiator::GradientFunction {
+public:
+    explicit PureFunc(int ny) : GradientFunction(ny) {}
+    int f(const Vector& y, Real& fy) const override {
+        {   std::lock_guard<std::mutex> lock(mutex);
+            threads.insert(std::this_thread::get_id()); }
+        fy = 0;
+        for (int j=0; j < y.size(); ++j)
+            fy += std::cos(y[j]*y[(j+1)%y.size()]);
+        return 0;
+    }
+    mutable std::mutex                  mutex;
+    mutable std::set<std::thread::id>   threads;
+};
+
+void testClonedJacobian() {
+    const int nf = 7, ny = 23;
+    ScratchFunc func(nf, ny);
+    const Vector y0 = rampVector(ny, -1, 0.3);
+    for (auto method : {Differentiator::ForwardDifference,
+                        Differentiator::CentralDifference}) {
+        Differentiator serial(func, method);
+        const Matrix J = serial.calcJacobian(y0);
+
+        Differentiator parallel(func, method);
+        parallel.setNumberOfThreads(4);
+        SimTK_TEST(parallel.getNumberOfThreads() == 4);
+        numClones = 0;
+        const Matrix Jp = parallel.calcJacobian(y0);
+        SimTK_TEST(numClones == 3);
+        SimTK_TEST(isIdentical(J, Jp));
+        SimTK_TEST(parallel.getNumCallsToUserFunction()
+                   == serial.getNumCallsToUserFunction());
+
+        // Again with the fast interface, reusing the threads.
+        Vector fy0(nf); func.f(y0, fy0);
+        Matrix Jp2;
+        parallel.calcJacobian(y0, fy0, Jp2);
+        SimTK_TEST(isIdentical(J, Jp2));
+    }
+}
+
+void testThreadSafeGradient() {
+    const int ny = 40;
+    PureFunc func(ny);
+    const Vector y0 = rampVector(ny, -1, 0.3);
+    Differentiator serial(func, Differentiator::CentralDifference);
+    const Vector g = serial.calcGradient(y0);
+
+    // Not declared thread safe and not cloneable: done serially.
+    Differentiator parallel(func, Differentiator::CentralDifference);
+    parallel.setNumberOfThreads(3);
+    func.threads.clear();
+    SimTK_TEST(isIdentical(parallel.calcGradient(y0), g));
+    SimTK_TEST(func.threads.size() == 1);
+
+    func.setIsThreadSafe(true);
+    SimTK_TEST(func.isThreadSafe());
+    func.resetAllStatistics();
+    func.threads.clear();
+    SimTK_TEST(isIdentical(parallel.calcGradient(y0), g));
+    SimTK_TEST(func.threads.size() > 1);
+    SimTK_TEST(func.getNumCalls() == 2*ny+1);
+    SimTK_TEST(func.getNumFailures() == 0);
+}
+
+void testErrors() {
+    ScratchFunc func(2, 8);
+    Differentiator diff(func);
+    diff.setNumberOfThreads(4);
+    Vector y0 = rampVector(8, -1, 0.3);
+    y0[0] = 10; // the perturbed values of y[0] will fail
+    SimTK_TEST_MUST_THROW(diff.calcJacobian(y0));
+    SimTK_TEST(func.getNumFailures() == 1);
+    SimTK_TEST_MUST_THROW(diff.setNumberOfThreads(-1));
+    diff.setNumberOfThreads(0);
+    SimTK_TEST(diff.getNumberOfThreads() >= 1);
+}
+
+int main() {
+    SimTK_START_TEST("ParallelDifferentiatorTest");
+        SimTK_SUBTEST(testClonedJacobian);
+        SimTK_SUBTEST(testThreadSafeGradient);
+        SimTK_SUBTEST(testErrors);
+    SimTK_END_TEST();
+}
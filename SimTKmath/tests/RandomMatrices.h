@@ -0,0 +1,97 @@
+#ifndef SimTK_SIMMATH_RANDOM_MATRICES_H_
+#define SimTK_SIMMATH_RANDOM_MATRICES_H_
+
+/* -------------------------------------------------------------------------- *
+ *                        Simbody(tm): SimTKmath                              *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2018 Stanford University and the Authors.           *
+ * Authors: Simbody developers                                                *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+// Test data, random and otherwise, and comparisons shared by the linear
+// algebra and differentiation tests.
+
+#include "SimTKmath.h"
+
+// Returns a uniform random number in [-1,1). All the functions here draw
+// from the same generator so a test's data depends only on the call order.
+inline SimTK::Real randUniform() {
+    static SimTK::Random::Uniform uni(-1, 1);
+    return uni.getValue();
+}
+
+inline SimTK::Vector randVector(int n) {
+    SimTK::Vector v(n);
+    for (int i=0; i < n; ++i) v[i] = randUniform();
+    return v;
+}
+
+// Returns an m X n matrix of uniform random numbers, filled by columns.
+inline SimTK::Matrix randMatrix(int m, int n) {
+    SimTK::Matrix A(m,n);
+    for (int j=0; j < n; ++j) for (int i=0; i < m; ++i) A(i,j) = randUniform();
+    return A;
+}
+
+// Returns ~B*B for a random m X n matrix B, which is positive semidefinite
+// with rank min(m,n).
+inline SimTK::Matrix randomGram(int m, int n) {
+    SimTK::Matrix B(m,n);
+    for (int i=0; i < m; ++i) for (int j=0; j < n; ++j) B(i,j)=randUniform();
+    return ~B*B;
+}
+
+// Overwrite the strict upper triangle with NaN to make sure a factorization
+// looks only at the lower triangle.
+inline SimTK::Matrix lowerOnly(const SimTK::Matrix& A) {
+    SimTK::Matrix L = A;
+    for (int j=1; j < A.ncol(); ++j)
+        for (int i=0; i < j; ++i) L(i,j) = SimTK::NaN;
+    return L;
+}
+
+// Returns the vector first, first+step, ..., with n elements.
+inline SimTK::Vector rampVector(int n, SimTK::Real first, SimTK::Real step) {
+    SimTK::Vector v(n);
+    for (int i=0; i < n; ++i) v[i] = first + step*i;
+    return v;
+}
+
+// True if a and b have the same dimensions and bitwise equal elements, for
+// results that must not depend on how they were computed.
+template <class T>
+inline bool isIdentical(const SimTK::Vector_<T>& a,
+                        const SimTK::Vector_<T>& b) {
+    if (a.size() != b.size()) return false;
+    for (int i=0; i < a.size(); ++i)
+        if (a[i] != b[i]) return false;
+    return true;
+}
+
+template <class T>
+inline bool isIdentical(const SimTK::Matrix_<T>& a,
+                        const SimTK::Matrix_<T>& b) {
+    if (a.nrow() != b.nrow() || a.ncol() != b.ncol()) return false;
+    for (int j=0; j < a.ncol(); ++j)
+        for (int i=0; i < a.nrow(); ++i)
+            if (a(i,j) != b(i,j)) return false;
+    return true;
+}
+
+#endif // SimTK_SIMMATH_RANDOM_MATRICES_H_
@@ -0,0 +1,166 @@
+/* -------------------------------------------------------------------------- *
+ *                        Simbody(tm): SimTKmath                              *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2018 Stanford University and the Authors.           *
+ * Authors: Simbody developers                                                *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+// Check Jacobians computed with a sparsity pattern and column grouping
+// against the analytic Jacobian and the dense finite difference one.
+
+#include "SimTKmath.h"
+#include "SimTKcommon/Testing.h"
+#include "RandomMatrices.h"
+
+using namespace SimTK;
+
+// f[i] = y[i-1]*y[i] + sin(y[i+1]), with the missing neighbors of the end
+// elements left out, so the Jacobian is tridiagonal.
+class ChainFunc : public Differentiator::JacobianFunction {
+public:
+    explicit ChainFunc(int n) : JacobianFunction(n, n) {}
+    int f(const Vector& y, Vector& fy) const override {
+        const int n = y.size();
+        for (int i=0; i < n; ++i)
+            fy[i] = (i > 0 ? y[i-1]*y[i] : 0)
+                  + (i < n-1 ? std::sin(y[i+1]) : 0);
+        return 0;
+    }
+    Matrix jacobian(const Vector& y) const {
+        const int n = y.size();
+        Matrix J(n, n, Real(0));
+        for (int i=0; i < n; ++i) {
+            if (i > 0) {J(i,i-1) = y[i]; J(i,i) = y[i-1];}
+            if (i < n-1) J(i,i+1) = std::cos(y[i+1]);
+        }
+        return J;
+    }
+    ChainFunc* cloneForThread() const override
+    {   return new ChainFunc(getNumParameters()); }
+};
+
+static SparseMatrix bandPattern(int n, int lower, int upper) {
+    SparseMatrixBuilder b(n, n);
+    for (int i=0; i < n; ++i)
+        for (int j=std::max(0, i-lower); j <= std::min(n-1, i+upper); ++j)
+            b.addEntry(i, j, 1);
+    return SparseMatrix(b);
+}
+
+void testTridiagonal() {
+    const int n = 50;
+    ChainFunc func(n);
+    const Vector y0 = rampVector(n, 1, 0.1);
+    const Matrix exact = func.jacobian(y0);
+    Differentiator dense(func);
+    const Matrix denseJ = dense.calcJacobian(y0);
+
+    SimTK_TEST(!func.hasSparsityPattern());
+    SimTK_TEST(func.getNumColumnGroups() == n);
+    func.setSparsityPattern(bandPattern(n, 1, 1));
+    SimTK_TEST(func.hasSparsityPattern());
+    SimTK_TEST(func.getNumColumnGroups() == 3);
+
+    for (auto method : {Differentiator::ForwardDifference,
+                        Differentiator::CentralDifference}) {
+        Differentiator diff(func, method);
+        const Matrix J = diff.calcJacobian(y0);
+        const int order = Differentiator::getMethodOrder(method);
+        SimTK_TEST(diff.getNumCallsToUserFunction() == 1 + 3*order);
+        SimTK_TEST_EQ_TOL(J, exact, order==1 ? 1e-6 : 1e-8);
+        SimTK_TEST(J(10,20) == 0 && J(0,n-1) == 0);
+
+        // Sparse output has the pattern's structure and the same values.
+        Vector fy0(n); func.f(y0, fy0);
+        SparseMatrix Js;
+        diff.calcJacobian(y0, fy0, Js, method);
+        SimTK_TEST(Js.getNumNonzeros() == 3*n-2);
+        SimTK_TEST(isIdentical(Js.toMatrix(), J));
+    }
+
+    // Each column of the grouped Jacobian uses the same perturbation as the
+    // dense one, so for this function the results agree to roundoff.
+    Differentiator diff(func);
+    SimTK_TEST_EQ_TOL(diff.calcJacobian(y0), denseJ, 1e-10);
+
+    func.clearSparsityPattern();
+    SimTK_TEST(!func.hasSparsityPattern());
+    Differentiator diff2(func);
+    diff2.calcJacobian(y0);
+    SimTK_TEST(diff2.getNumCallsToUserFunction() == n+1);
+}
+
+// A wider pattern (the true Jacobian is tridiagonal but we claim a
+// bandwidth of 2 on each side) still gives the right answer with zeros in
+// the unused entries; an empty column costs nothing.
+void testGroups() {
+    const int n = 30;
+    ChainFunc func(n);
+    const Vector y0 = rampVector(n, 1, 0.1);
+    func.setSparsityPattern(bandPattern(n, 2, 2));
+    SimTK_TEST(func.getNumColumnGroups() == 5);
+    Differentiator diff(func, Differentiator::CentralDifference);
+    SimTK_TEST_EQ_TOL(diff.calcJacobian(y0), func.jacobian(y0), 1e-8);
+
+    // Groups must be structurally orthogonal: check via an arrowhead
+    // pattern, whose dense first row forces every column into its own
+    // group, and a diagonal one, which needs only one.
+    SparseMatrixBuilder arrow(n, n);
+    for (int j=0; j < n; ++j) {arrow.addEntry(0, j, 1); arrow.addEntry(j, j, 1);}
+    func.setSparsityPattern(SparseMatrix(arrow));
+    SimTK_TEST(func.getNumColumnGroups() == n);
+
+    SparseMatrixBuilder diag(n, n);
+    for (int j=0; j < n-1; ++j) diag.addEntry(j, j, 1); // last column empty
+    func.setSparsityPattern(SparseMatrix(diag));
+    SimTK_TEST(func.getNumColumnGroups() == 1);
+}
+
+// Groups can be evaluated concurrently with the same results.
+void testParallel() {
+    const int n = 200;
+    ChainFunc func(n);
+    const Vector y0 = rampVector(n, 1, 0.1);
+    func.setSparsityPattern(bandPattern(n, 3, 3));
+    Differentiator serial(func), parallel(func);
+    parallel.setNumberOfThreads(3);
+    const Matrix J = serial.calcJacobian(y0), Jp = parallel.calcJacobian(y0);
+    SimTK_TEST(isIdentical(J, Jp));
+    SimTK_TEST(parallel.getNumCallsToUserFunction() == 8);
+}
+
+void testErrors() {
+    ChainFunc func(5);
+    SimTK_TEST_MUST_THROW(func.setSparsityPattern(bandPattern(6, 1, 1)));
+    SimTK_TEST_MUST_THROW(func.getSparsityPattern());
+    Differentiator diff(func);
+    Vector y0 = rampVector(5, 1, 0.1), fy0(5);
+    func.f(y0, fy0);
+    SparseMatrix Js;
+    SimTK_TEST_MUST_THROW(diff.calcJacobian(y0, fy0, Js));
+}
+
+int main() {
+    SimTK_START_TEST("SparseDifferentiatorTest");
+        SimTK_SUBTEST(testTridiagonal);
+        SimTK_SUBTEST(testGroups);
+        SimTK_SUBTEST(testParallel);
+        SimTK_SUBTEST(testErrors);
+    SimTK_END_TEST();
+}
@@ -0,0 +1,301 @@
+/* -------------------------------------------------------------------------- *
+ *                        Simbody(tm): SimTKmath                              *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2018 Stanford University and the Authors.           *
+ * Authors: Simbody developers                                                *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+
+#include "SimTKmath.h"
+#include "SimTKcommon/Testing.h"
+#include "RandomMatrices.h"
+
+#include <iostream>
+using std::cout;
+using std::endl;
+
+using namespace SimTK;
+
+// Tests for SparseMatrix_ and the sparse direct factorizations, checked
+// against the dense equivalents.
+
+// A random sparse m x n matrix with roughly the given density.
+static SparseMatrix randSparse(int m, int n, Real density) {
+    Random::Uniform coin(0, 1);
+    SparseMatrixBuilder builder(m, n);
+    for (int j=0; j < n; ++j)
+        for (int i=0; i < m; ++i)
+            if (coin.getValue() < density)
+                builder.addEntry(i, j, randUniform());
+    return SparseMatrix(builder);
+}
+
+// Stiffness-like matrix for a 2d grid of nx*ny nodes: the 5-point Laplacian
+// plus a small diagonal shift so that it is positive definite.
+static SparseMatrix gridLaplacian(int nx, int ny) {
+    const int n = nx*ny;
+    SparseMatrixBuilder builder(n, n);
+    for (int x=0; x < nx; ++x)
+        for (int y=0; y < ny; ++y) {
+            const int k = x*ny + y;
+            builder.addEntry(k, k, 4.1);
+            if (x > 0)    builder.addEntry(k, k-ny, -1);
+            if (x < nx-1) builder.addEntry(k, k+ny, -1);
+            if (y > 0)    builder.addEntry(k, k-1, -1);
+            if (y < ny-1) builder.addEntry(k, k+1, -1);
+        }
+    return SparseMatrix(builder);
+}
+
+// Keep only the lower triangle.
+static SparseMatrix lowerTriangle(const SparseMatrix& A) {
+    Matrix dense = A.toMatrix();
+    for (int j=1; j < A.ncol(); ++j) for (int i=0; i < j; ++i) dense(i,j) = 0;
+    return SparseMatrix(dense);
+}
+
+void testAssembly() {
+    SparseMatrixBuilder builder(3, 4);
+    builder.addEntry(2, 1, 1.5);
+    builder.addEntry(0, 3, 2.0);
+    builder.addEntry(2, 1, 0.5);  // duplicate; should be summed
+    builder.addEntry(1, 1, -1.0);
+    builder.addBlock(1, 2, Matrix(Mat22(1, 0,
+                                        3, 4)));
+    SimTK_TEST(builder.getNumEntries() == 8); // block zero is kept
+    const SparseMatrix A(builder);
+    SimTK_TEST(A.nrow() == 3 && A.ncol() == 4);
+    SimTK_TEST(A.getNumNonzeros() == 7);
+    SimTK_TEST(A.getElt(2,1) == 2.0);
+    SimTK_TEST(A.getElt(1,1) == -1.0);
+    SimTK_TEST(A.getElt(0,0) == 0);
+    SimTK_TEST(A.getElt(1,3) == 0);
+    SimTK_TEST(A.getElt(2,3) == 4);
+
+    Matrix dense(3, 4, Real(0));
+    dense(2,1) = 2; dense(0,3) = 2; dense(1,1) = -1;
+    dense(1,2) = 1; dense(2,2) = 3; dense(2,3) = 4;
+    SimTK_TEST_EQ(A.toMatrix(), dense);
+    SimTK_TEST_EQ(SparseMatrix(dense).toMatrix(), dense);
+    SimTK_TEST(SparseMatrix(dense, 1.5).getNumNonzeros() == 4);
+    SimTK_TEST_EQ(A.transpose().toMatrix(), ~dense);
+
+    // Row indices must be sorted within each column.
+    const Array_<int>& cs = A.getColumnStarts();
+    const Array_<int>& ri = A.getRowIndices();
+    for (int j=0; j < A.ncol(); ++j)
+        for (int p=cs[j]+1; p < cs[j+1]; ++p)
+            SimTK_TEST(ri[p-1] < ri[p]);
+
+    // Rebuild from raw arrays; bad arrays must be rejected.
+    const SparseMatrix B(3, 4, A.getColumnStarts(), A.getRowIndices(),
+                         A.getValues());
+    SimTK_TEST_EQ(B.toMatrix(), dense);
+    Array_<int> badRows = A.getRowIndices(); badRows[0] = 7;
+    SimTK_TEST_MUST_THROW(SparseMatrix(3, 4, A.getColumnStarts(), badRows,
+                                       A.getValues()));
+
+    SparseMatrix C(A);
+    C.updValues()[0] = 100;
+    SimTK_TEST(C.getElt(1,1) == 100 && A.getElt(1,1) == -1);
+
+    SimTK_TEST(SparseMatrix(5, 2).getNumNonzeros() == 0);
+    SimTK_TEST_EQ(SparseMatrix(5, 2).toMatrix(), Matrix(5, 2, Real(0)));
+}
+
+void testProducts() {
+    const SparseMatrix A = randSparse(30, 20, 0.15);
+    const Matrix dense = A.toMatrix();
+    const Vector x = randVector(20), z = randVector(30);
+
+    SimTK_TEST_EQ(A*x, dense*x);
+    Vector y;
+    A.multiplyByTranspose(z, y);
+    SimTK_TEST_EQ(y, ~dense*z);
+
+    Vector w = z;
+    A.multiplyAndAdd(2., x, -3., w);
+    SimTK_TEST_EQ(w, 2.*(dense*x) - 3.*z);
+    Vector v = x;
+    A.multiplyByTransposeAndAdd(-1., z, 0.5, v);
+    SimTK_TEST_EQ(v, -1.*(~dense*z) + 0.5*x);
+
+    Matrix X(20, 3), Y;
+    for (int c=0; c < 3; ++c) X(c) = randVector(20);
+    A.multiply(X, Y);
+    SimTK_TEST_EQ(Y, dense*X);
+    Matrix Z(30, 2);
+    for (int c=0; c < 2; ++c) Z(c) = randVector(30);
+    A.multiplyByTranspose(Z, Y);
+    SimTK_TEST_EQ(Y, ~dense*Z);
+
+    const SparseMatrix S = randSparse(15, 15, 0.2);
+    SimTK_TEST_EQ(S.plusTranspose().toMatrix(), S.toMatrix() + ~S.toMatrix());
+
+    SimTK_TEST_MUST_THROW(A.multiply(z, y));
+}
+
+void testOrdering() {
+    const SparseMatrix A = gridLaplacian(6, 7);
+    Array_<int> perm;
+    calcMinimumDegreeOrdering(A, perm);
+    SimTK_TEST(perm.size() == 42);
+    Array_<int> sorted(perm);
+    std::sort(sorted.begin(), sorted.end());
+    for (int i=0; i < 42; ++i) SimTK_TEST(sorted[i] == i);
+}
+
+void testCholesky() {
+    const SparseMatrix A = gridLaplacian(12, 10);
+    const int n = A.nrow();
+    const Matrix dense = A.toMatrix();
+    const Vector b = randVector(n);
+
+    Vector xdense;
+    FactorLU(dense).solve(b, xdense);
+
+    for (int ord=0; ord < 2; ++ord) {
+        FactorSparseCholesky chol(lowerTriangle(A), SparseOrdering(ord));
+        SimTK_TEST(chol.isPositiveDefinite());
+        Vector x;
+        chol.solve(b, x);
+        SimTK_TEST_EQ_SIZE(x, xdense, n);
+
+        // Check L*~L = P*A*~P.
+        SparseMatrix L; Array_<int> perm;
+        chol.getL(L); chol.getPermutation(perm);
+        const Matrix Ld = L.toMatrix();
+        Matrix PAPt(n, n);
+        for (int i=0; i < n; ++i) for (int j=0; j < n; ++j)
+            PAPt(i,j) = dense(perm[i], perm[j]);
+        SimTK_TEST_EQ_SIZE(Ld*~Ld, PAPt, n);
+        cout << "Cholesky ordering " << ord << ": nnz(L)="
+             << chol.getNumNonzerosInFactor() << endl;
+    }
+
+    // The minimum degree ordering should produce much less fill than the
+    // natural banded ordering for a grid.
+    SimTK_TEST(FactorSparseCholesky(A).getNumNonzerosInFactor()
+               < FactorSparseCholesky(A, SparseOrderingNatural)
+                    .getNumNonzerosInFactor());
+
+    // Only the lower triangle is used, so the full matrix gives the same
+    // answer.
+    Vector xfull;
+    FactorSparseCholesky(A).solve(b, xfull);
+    SimTK_TEST_EQ_SIZE(xfull, xdense, n);
+
+    // Refactor with new values in the same pattern.
+    SparseMatrix A2 = lowerTriangle(A);
+    for (Real& v : A2.updValues()) v *= 2;
+    FactorSparseCholesky chol(lowerTriangle(A));
+    chol.refactor(A2);
+    Vector x2; chol.solve(b, x2);
+    SimTK_TEST_EQ_SIZE(x2, xdense/2, n);
+
+    Matrix B(n, 2), X;
+    B(0) = b; B(1) = 2*b;
+    chol.solve(B, X);
+    SimTK_TEST_EQ_SIZE(X(0), xdense/2, n);
+    SimTK_TEST_EQ_SIZE(X(1), xdense, n);
+
+    // Same number of nonzeros but a different pattern must be rejected
+    // rather than silently using the old analysis.
+    Matrix moved = lowerTriangle(A).toMatrix();
+    int i0 = -1;
+    for (int i=2; i < n && i0 < 0; ++i)
+        if (moved(i,0) == 0) i0 = i;
+    int j0 = -1;
+    for (int i=1; i < n && j0 < 0; ++i)
+        if (moved(i,0) != 0) j0 = i;
+    SimTK_TEST(i0 >= 0 && j0 >= 0);
+    std::swap(moved(i0,0), moved(j0,0));
+    const SparseMatrix Amoved(moved);
+    SimTK_TEST(Amoved.getNumNonzeros() == lowerTriangle(A).getNumNonzeros());
+    SimTK_TEST_MUST_THROW(chol.refactor(Amoved));
+
+    // Indefinite matrix is detected.
+    Matrix Ind = dense; Ind(5,5) = -10;
+    FactorSparseCholesky bad((SparseMatrix(Ind)));
+    SimTK_TEST(!bad.isPositiveDefinite());
+    SimTK_TEST_MUST_THROW(bad.solve(b, x2));
+}
+
+void testLU() {
+    // Unsymmetric, diagonally dominant-ish with random fill.
+    const int n = 60;
+    SparseMatrix R = randSparse(n, n, 0.05);
+    Matrix dense = R.toMatrix();
+    dense.diag() += 0.5;
+    dense(0,0) = 0; // force a pivot away from the diagonal
+    const SparseMatrix A(dense);
+    const Vector b = randVector(n);
+
+    Vector xdense;
+    FactorLU(dense).solve(b, xdense);
+
+    for (int ord=0; ord < 2; ++ord) {
+        for (Real tol : {1., 0.1}) {
+            FactorSparseLU lu(A, SparseOrdering(ord), tol);
+            SimTK_TEST(!lu.isSingular());
+            Vector x;
+            lu.solve(b, x);
+            SimTK_TEST_EQ_TOL(x, xdense, 1e-9);
+            SimTK_TEST_EQ_TOL(dense*x, b, 1e-9);
+        }
+    }
+
+    FactorSparseLU lu(A);
+    Matrix B(n, 2), X;
+    B(0) = b; B(1) = 3*b;
+    lu.solve(B, X);
+    SimTK_TEST_EQ_TOL(X(1), 3*xdense, 1e-9);
+
+    // With pivotTol=0 an explicitly stored zero on the diagonal must not be
+    // chosen as a pivot.
+    SparseMatrixBuilder zb(2, 2);
+    zb.addBlock(0, 0, Matrix(Mat22(0, 1,
+                                   1, 1)));
+    const SparseMatrix Z(zb);
+    SimTK_TEST(Z.getNumNonzeros() == 4);
+    for (int ord=0; ord < 2; ++ord) {
+        FactorSparseLU zlu(Z, SparseOrdering(ord), 0);
+        SimTK_TEST(!zlu.isSingular());
+        Vector x; zlu.solve(Vector(Vec2(1,2)), x);
+        SimTK_TEST_EQ(x, Vector(Vec2(1,1)));
+    }
+
+    // Structurally singular: an empty column.
+    Matrix sing = dense; sing(3) = 0;
+    FactorSparseLU slu((SparseMatrix(sing)));
+    SimTK_TEST(slu.isSingular());
+    SimTK_TEST(slu.getSingularIndex() > 0);
+    Vector x;
+    SimTK_TEST_MUST_THROW(slu.solve(b, x));
+}
+
+int main() {
+    SimTK_START_TEST("SparseMatrixTest");
+        SimTK_SUBTEST(testAssembly);
+        SimTK_SUBTEST(testProducts);
+        SimTK_SUBTEST(testOrdering);
+        SimTK_SUBTEST(testCholesky);
+        SimTK_SUBTEST(testLU);
+    SimTK_END_TEST();
+}
@@ -439,6 +439,54 @@ void testAnalyticalCylinderGeodesic() {
     testAnalyticalGeodesicRandom(cylinder);
 }
 
+// A geodesic shot along the sphere's equator must stop on the plane y=r/2,
+// which it reaches after 1/12 of the way around.
+void testSphereGeodesicPlaneHit() {
+    ContactGeometry::Sphere sphere(r);
+    const Plane plane(Vec3(0,1,0), r/2);
+    Geodesic geod;
+    sphere.shootGeodesicInDirectionUntilPlaneHit(Vec3(r,0,0), UnitVec3(YAxis),
+        plane, GeodesicOptions(), geod);
+
+    ASSERT(std::abs(plane.getDistance(geod.getPointQ())) < 1e-8);
+    assertEqual(geod.getLength(), r*Pi/6);
+    assertEqual(geod.getPointQ(), Vec3(r*std::cos(Pi/6), r/2, 0));
+    assertEqual(geod.getTangentQ(), UnitVec3(Vec3(-1/Real(2), 
+                                                  std::cos(Pi/6), 0)));
+}
+
+// Here the distance to the plane x=h is convex along the geodesic, so the
+// regula falsi iterations keep moving the near end of the bracket. The
+// point reached must still be on the plane, not merely look converged.
+void testSphereGeodesicPlaneHitConvex() {
+    ContactGeometry::Sphere sphere(r);
+    const Real h = r*std::cos(Pi/3);
+    const Plane plane(Vec3(-1,0,0), -h); // distance is h - x
+    Geodesic geod;
+    sphere.shootGeodesicInDirectionUntilPlaneHit(Vec3(r,0,0), UnitVec3(YAxis),
+        plane, GeodesicOptions(), geod);
+
+    ASSERT(std::abs(plane.getDistance(geod.getPointQ())) < 1e-8);
+    assertEqual(geod.getLength(), r*Pi/3);
+    assertEqual(geod.getPointQ(), Vec3(h, r*std::sin(Pi/3), 0));
+}
+
+// The split geodesic between two points on the equator is a quarter of the
+// great circle.
+void testSphereSplitGeodesic() {
+    ContactGeometry::Sphere sphere(r);
+    const Vec3 P(r,0,0), Q(0,r,0);
+    const UnitVec3 e_PQ(Q-P);
+    Geodesic geod;
+    sphere.calcGeodesic(P, Q, e_PQ, e_PQ, geod);
+
+    assertEqual(geod.getLength(), r*Pi/2);
+    assertEqual(geod.getPointP(), P);
+    assertEqual(geod.getPointQ(), Q);
+    assertEqual(geod.getTangentP(), UnitVec3(YAxis));
+    assertEqual(geod.getTangentQ(), UnitVec3(-XAxis));
+}
+
 void testProjectDownhillToNearestPoint(const ContactGeometry& geom, Real r) {
 
     bool inside;
@@ -473,6 +521,9 @@ int main() {
         // TODO clean up these tests and use them
 //        testAnalyticalSphereGeodesic();
 //        testAnalyticalCylinderGeodesic();
+        testSphereGeodesicPlaneHit();
+        testSphereGeodesicPlaneHitConvex();
+        testSphereSplitGeodesic();
         testProjectDownhillToNearestPoint(ContactGeometry::Sphere(r), r);
         testProjectDownhillToNearestPoint(ContactGeometry::Ellipsoid(Vec3(1.5, 2.2, 3.1)), r);
 //        testProjectDownhillToNearestPoint(ContactGeometry::Torus(3*r, r), 3*r);
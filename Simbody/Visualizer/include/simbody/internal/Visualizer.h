@@ -185,6 +185,13 @@ to the desired executable name. For example, if you want to use the
 debug visualizer with release libraries, set SIMBODY_VISUALIZER_NAME
 to simbody-visualizer_d.
 
+On platforms with POSIX shared memory, each frame is handed to the visualizer
+through a small ring of shared memory slots, with only a short notice sent
+through the pipe that connects the two processes. Frames that don't fit in a
+slot, or that are sent while all the slots are still in use, go through the
+pipe instead. To send everything through the pipe, set the environment
+variable SIMBODY_VISUALIZER_SHARED_MEMORY to 0.
+
 The SimTK::Pathname class is used to process the supplied search path, which
 can consist of absolute, working directory-relative, or executable 
 directory-relative path names.
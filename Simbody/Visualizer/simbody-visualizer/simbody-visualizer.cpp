@@ -104,6 +104,8 @@ static void shutdown();
     #define CLOSE _close
 #else
     #include <unistd.h>
+    #include <fcntl.h>
+    #include <sys/mman.h>
     #define READ read
     #define WRITEFUNC write
     #define CLOSE close
@@ -137,6 +139,9 @@ static int inPipe, outPipe;
 // If the simulator told us to stop communication, then we close the outPipe
 // and can no longer write to the simulator.
 static std::atomic<bool> writeToSimulator{true};
+// The shared memory region the simulator sends scenes through, if we were
+// able to map it during the handshake.
+static SharedScenesHeader* sharedScenes = NULL;
 
 static void computeBoundingSphereForVertices(const vector<float>& vertices, float& radius, fVec3& center) {
     fVec3 lower(vertices[0], vertices[1], vertices[2]);
@@ -162,7 +167,7 @@ static void computeBoundingSphereForVertices(const vector<float>& vertices, floa
 
 class Mesh {
 public:
-    Mesh(vector<float>& vertices, vector<float>& normals, vector<GLushort>& faces) 
+    Mesh(vector<float>& vertices, vector<float>& normals, vector<GLuint>& faces) 
     :   numVertices((int)(vertices.size()/3)), faces(faces) {
         // Build OpenGL buffers.
 
@@ -175,20 +180,25 @@ public:
         glBindBuffer(GL_ARRAY_BUFFER, normBuffer);
         glBufferData(GL_ARRAY_BUFFER, normals.size()*sizeof(float), &normals[0], GL_STATIC_DRAW);
 
-        // Create the list of edges.
-
-        set<pair<GLushort, GLushort> > edgeSet;
-        for (int i = 0; i < (int) faces.size(); i += 3) {
-            GLushort v1 = faces[i];
-            GLushort v2 = faces[i+1];
-            GLushort v3 = faces[i+2];
-            edgeSet.insert(make_pair(min(v1, v2), max(v1, v2)));
-            edgeSet.insert(make_pair(min(v2, v3), max(v2, v3)));
-            edgeSet.insert(make_pair(min(v3, v1), max(v3, v1)));
+        // Create the list of edges. Each triangle contributes three; sort
+        // them to remove the ones shared by adjacent triangles.
+
+        vector<pair<GLuint, GLuint> > edgeList;
+        edgeList.reserve(faces.size());
+        for (size_t i = 0; i < faces.size(); i += 3) {
+            GLuint v1 = faces[i];
+            GLuint v2 = faces[i+1];
+            GLuint v3 = faces[i+2];
+            edgeList.push_back(make_pair(min(v1, v2), max(v1, v2)));
+            edgeList.push_back(make_pair(min(v2, v3), max(v2, v3)));
+            edgeList.push_back(make_pair(min(v3, v1), max(v3, v1)));
         }
-        for (set<pair<GLushort, GLushort> >::const_iterator iter = edgeSet.begin(); iter != edgeSet.end(); ++iter) {
-            edges.push_back(iter->first);
-            edges.push_back(iter->second);
+        sort(edgeList.begin(), edgeList.end());
+        edgeList.erase(unique(edgeList.begin(), edgeList.end()), edgeList.end());
+        edges.resize(2*edgeList.size());
+        for (size_t i = 0; i < edgeList.size(); ++i) {
+            edges[2*i]   = edgeList[i].first;
+            edges[2*i+1] = edgeList[i].second;
         }
 
         // Compute the center and radius.
@@ -201,11 +211,11 @@ public:
         glBindBuffer(GL_ARRAY_BUFFER, normBuffer);
         glNormalPointer(GL_FLOAT, 0, 0);
         if (representation == DecorativeGeometry::DrawSurface)
-            glDrawElements(GL_TRIANGLES, (GLsizei)faces.size(), GL_UNSIGNED_SHORT, &faces[0]);
+            glDrawElements(GL_TRIANGLES, (GLsizei)faces.size(), GL_UNSIGNED_INT, &faces[0]);
         else if (representation == DecorativeGeometry::DrawPoints)
             glDrawArrays(GL_POINTS, 0, numVertices);
         else if (representation == DecorativeGeometry::DrawWireframe)
-            glDrawElements(GL_LINES, (GLsizei)edges.size(), GL_UNSIGNED_SHORT, &edges[0]);
+            glDrawElements(GL_LINES, (GLsizei)edges.size(), GL_UNSIGNED_INT, &edges[0]);
     }
     void getBoundingSphere(float& radius, fVec3& center) {
         radius = this->radius;
@@ -214,7 +224,7 @@ public:
 private:
     int numVertices;
     GLuint vertBuffer, normBuffer;
-    vector<GLushort> edges, faces;
+    vector<GLuint> edges, faces;
     fVec3 center;
     float radius;
 };
@@ -223,7 +233,7 @@ static vector<vector<Mesh*> > meshes;
 
 class RenderedMesh {
 public:
-    RenderedMesh(const fTransform& transform, const fVec3& scale, const fVec4& color, short representation, unsigned short meshIndex, unsigned short resolution) :
+    RenderedMesh(const fTransform& transform, const fVec3& scale, const fVec4& color, short representation, unsigned meshIndex, unsigned short resolution) :
             transform(transform), scale(scale), representation(representation), meshIndex(meshIndex), resolution(resolution) {
         this->color[0] = color[0];
         this->color[1] = color[1];
@@ -258,7 +268,8 @@ private:
     fVec3 scale;
     GLfloat color[4];
     short representation;
-    unsigned short meshIndex, resolution;
+    unsigned meshIndex;
+    unsigned short resolution;
 };
 
 class RenderedLine {
@@ -495,7 +506,7 @@ public:
     }
     vector<float> vertices;
     vector<float> normals;
-    vector<GLushort> faces;
+    vector<GLuint> faces;
     int index;
 };
 
@@ -506,10 +517,10 @@ static void addVec(vector<float>& data, float x, float y, float z) {
     data.push_back(z);
 }
 
-static void addVec(vector<unsigned short>& data, int x, int y, int z) {
-    data.push_back((unsigned short) x);
-    data.push_back((unsigned short) y);
-    data.push_back((unsigned short) z);
+static void addVec(vector<GLuint>& data, int x, int y, int z) {
+    data.push_back((GLuint) x);
+    data.push_back((GLuint) y);
+    data.push_back((GLuint) z);
 }
 
 static Mesh* makeBox()  {
@@ -518,7 +529,7 @@ static Mesh* makeBox()  {
     const float halfz = 1;
     vector<GLfloat> vertices;
     vector<GLfloat> normals;
-    vector<GLushort> faces;
+    vector<GLuint> faces;
 
     // lower x face
     addVec(vertices, -halfx, -halfy, -halfz);
@@ -595,7 +606,7 @@ static Mesh* makeSphere(unsigned short resolution) {
     const float radius = 1.0f;
     vector<GLfloat> vertices;
     vector<GLfloat> normals;
-    vector<GLushort> faces;
+    vector<GLuint> faces;
     addVec(vertices, 0, radius, 0);
     addVec(normals, 0, 1, 0);
     for (int i = 0; i < numLatitude; i++) {
@@ -642,7 +653,7 @@ static Mesh* makeCylinder(unsigned short resolution) {
     const float radius = 1;
     vector<GLfloat> vertices;
     vector<GLfloat> normals;
-    vector<GLushort> faces;
+    vector<GLuint> faces;
 
     // Create the top face.
 
@@ -704,7 +715,7 @@ static Mesh* makeCircle(unsigned short resolution) {
     const float radius = 1;
     vector<GLfloat> vertices;
     vector<GLfloat> normals;
-    vector<GLushort> faces;
+    vector<GLuint> faces;
 
     // Create the front face.
 
@@ -741,7 +752,7 @@ static Mesh* makeCircle(unsigned short resolution) {
 
 class PendingStandardMesh : public PendingCommand {
 public:
-    PendingStandardMesh(unsigned short meshIndex, unsigned short resolution) : meshIndex(meshIndex), resolution(resolution) {
+    PendingStandardMesh(unsigned meshIndex, unsigned short resolution) : meshIndex(meshIndex), resolution(resolution) {
     }
     void execute() override {
         if ((int) meshes[meshIndex].size() <= resolution)
@@ -763,7 +774,8 @@ public:
             }
         }
     }
-    unsigned short meshIndex, resolution;
+    unsigned meshIndex;
+    unsigned short resolution;
 };
 
 // Caution -- make sure scene is locked before you call this function.
@@ -2041,11 +2053,94 @@ static void readData(unsigned char* buffer, int bytes) {
     readDataFromPipe(inPipe, buffer, bytes);
 }
 
-// We have just processed a StartOfScene command. Read in all the scene
-// elements until we see an EndOfScene command. We allocate a new Scene
-// object to hold the scene and return a pointer to it. Don't forget to
-// delete that object when you are done with it.
-static Scene* readNewScene() {
+// Read a large block from inPipe in pieces of at most MeshChunkBytes, the
+// same pieces the simulator writes it in.
+static void readDataInChunks(void* data, size_t bytes) {
+    unsigned char* p = (unsigned char*) data;
+    while (bytes > 0) {
+        const size_t chunk = std::min(bytes, (size_t)MeshChunkBytes);
+        readData(p, (int)chunk);
+        p += chunk;
+        bytes -= chunk;
+    }
+}
+
+// We have just received a DefineMesh command. Read the mesh, which will be
+// assigned the next available mesh index; scenes sent after it refer to it by
+// that index.
+static void readMesh() {
+    unsigned counts[2];
+    readData((unsigned char*)counts, (int)sizeof(counts));
+    const unsigned numVertices = counts[0];
+    const unsigned numFaces = counts[1];
+    PendingMesh* mesh = new PendingMesh(); // assigns next mesh index
+    mesh->vertices.resize(3*(size_t)numVertices);
+    mesh->normals.resize(3*(size_t)numVertices, 0);
+    mesh->faces.resize(3*(size_t)numFaces);
+    readDataInChunks(mesh->vertices.data(), mesh->vertices.size()*sizeof(float));
+    readDataInChunks(mesh->faces.data(), mesh->faces.size()*sizeof(GLuint));
+    for (size_t i = 0; i < mesh->faces.size(); i++)
+        SimTK_ERRCHK3_ALWAYS(mesh->faces[i] < numVertices, "simbody-visualizer",
+            "Face vertex %u of mesh %d is out of range for %u vertices.",
+            mesh->faces[i], mesh->index, numVertices);
+
+    // Compute normal vectors for the mesh, accumulating the face normals at
+    // each vertex and then normalizing.
+
+    const float* vertices = mesh->vertices.data();
+    float* normals = mesh->normals.data();
+    for (unsigned i = 0; i < numFaces; i++) {
+        const GLuint v1 = mesh->faces[3*i];
+        const GLuint v2 = mesh->faces[3*i+1];
+        const GLuint v3 = mesh->faces[3*i+2];
+        const fVec3 vert1(vertices[3*v1], vertices[3*v1+1], vertices[3*v1+2]);
+        const fVec3 vert2(vertices[3*v2], vertices[3*v2+1], vertices[3*v2+2]);
+        const fVec3 vert3(vertices[3*v3], vertices[3*v3+1], vertices[3*v3+2]);
+        fVec3 norm = (vert2-vert1)%(vert3-vert1);
+        const float length = norm.norm();
+        if (length > 0) {
+            norm /= length;
+            for (int k = 0; k < 3; k++) {
+                normals[3*v1+k] += norm[k];
+                normals[3*v2+k] += norm[k];
+                normals[3*v3+k] += norm[k];
+            }
+        }
+    }
+    for (unsigned i = 0; i < numVertices; i++) {
+        const fVec3 norm = fVec3(normals[3*i], normals[3*i+1], normals[3*i+2]).normalize();
+        normals[3*i] = norm[0];
+        normals[3*i+1] = norm[1];
+        normals[3*i+2] = norm[2];
+    }
+
+    // A real mesh will be generated from this the next
+    // time the scene is redrawn.
+    std::lock_guard<std::mutex> lock(sceneMutex); //--- LOCK SCENE ----
+    pendingCommands.insert(pendingCommands.begin(), mesh);
+}                                                 //--- UNLOCK SCENE --
+
+// Reads the elements of a scene that was received in one piece, either
+// through the pipe or in a shared memory slot.
+class SceneReader {
+public:
+    SceneReader(const unsigned char* data, unsigned size)
+    :   data(data), size(size), pos(0) {}
+    void read(unsigned char* buffer, int bytes) {
+        SimTK_ERRCHK_ALWAYS(bytes >= 0 && (unsigned)bytes <= size-pos,
+            "simbody-visualizer", "Scene data ended unexpectedly.");
+        memcpy(buffer, data+pos, bytes);
+        pos += bytes;
+    }
+private:
+    const unsigned char* data;
+    unsigned             size, pos;
+};
+
+// Read in all the scene elements until we see an EndOfScene command. We
+// allocate a new Scene object to hold the scene and return a pointer to it.
+// Don't forget to delete that object when you are done with it.
+static Scene* readNewScene(SceneReader& in) {
     unsigned char buffer[256];
     float*          floatBuffer = (float*)          buffer;
     int*            intBuffer   = (int*)            buffer;
@@ -2054,12 +2149,12 @@ static Scene* readNewScene() {
     Scene* newScene = new Scene;
 
     // Simulated time for this frame comes first.
-    readData(buffer, sizeof(float));
+    in.read(buffer, sizeof(float));
     newScene->simTime = floatBuffer[0];
 
     bool finished = false;
     while (!finished) {
-        readData(buffer, 1);
+        in.read(buffer, 1);
         char command = buffer[0];
 
         switch (command) {
@@ -2076,15 +2171,15 @@ static Scene* readNewScene() {
         case AddPointMesh:
         case AddWireframeMesh:
         case AddSolidMesh: {
-            readData(buffer, 13*sizeof(float)+2*sizeof(short));
+            in.read(buffer, 13*sizeof(float)+sizeof(unsigned)+sizeof(short));
             fTransform position;
             position.updR().setRotationToBodyFixedXYZ(fVec3(floatBuffer[0], floatBuffer[1], floatBuffer[2]));
             position.updP() = fVec3(floatBuffer[3], floatBuffer[4], floatBuffer[5]);
             fVec3 scale = fVec3(floatBuffer[6], floatBuffer[7], floatBuffer[8]);
             fVec4 color = fVec4(floatBuffer[9], floatBuffer[10], floatBuffer[11], floatBuffer[12]);
             short representation = (command == AddPointMesh ? DecorativeGeometry::DrawPoints : (command == AddWireframeMesh ? DecorativeGeometry::DrawWireframe : DecorativeGeometry::DrawSurface));
-            unsigned short meshIndex = shortBuffer[13*sizeof(float)/sizeof(short)];
-            unsigned short resolution = shortBuffer[13*sizeof(float)/sizeof(short)+1];
+            unsigned meshIndex = (unsigned)intBuffer[13];
+            unsigned short resolution = shortBuffer[(13*sizeof(float)+sizeof(unsigned))/sizeof(short)];
             RenderedMesh mesh(position, scale, color, representation, meshIndex, resolution);
             if (command != AddSolidMesh)
                 newScene->drawnMeshes.push_back(mesh);
@@ -2103,7 +2198,7 @@ static Scene* readNewScene() {
         }
 
         case AddLine: {
-            readData(buffer, 10*sizeof(float));
+            in.read(buffer, 10*sizeof(float));
             fVec3 color = fVec3(floatBuffer[0], floatBuffer[1], floatBuffer[2]);
             float thickness = floatBuffer[3];
             int index;
@@ -2123,7 +2218,7 @@ static Scene* readNewScene() {
         }
 
         case AddText: {
-            readData(buffer, 12*sizeof(float)+3*sizeof(short));
+            in.read(buffer, 12*sizeof(float)+3*sizeof(short));
             fTransform X_GT;
             X_GT.updR().setRotationToBodyFixedXYZ(fVec3(floatBuffer[0], floatBuffer[1], floatBuffer[2]));
             X_GT.updP() = fVec3(floatBuffer[3], floatBuffer[4], floatBuffer[5]);
@@ -2133,7 +2228,7 @@ static Scene* readNewScene() {
             bool faceCamera = (shortp[0] != 0);
             bool isScreenText = (shortp[1] != 0);
             short length = shortp[2];
-            readData(buffer, length);
+            in.read(buffer, length);
 
             if (isScreenText)
                 newScene->screenText.push_back(
@@ -2145,7 +2240,7 @@ static Scene* readNewScene() {
         }
 
         case AddCoords: {
-            readData(buffer, 12*sizeof(float));
+            in.read(buffer, 12*sizeof(float));
             fRotation rotation;
             rotation.setRotationToBodyFixedXYZ(fVec3(floatBuffer[0], 
                                                      floatBuffer[1], 
@@ -2193,53 +2288,6 @@ static Scene* readNewScene() {
             break;
         }
 
-        // Define a new mesh that will be assigned the next available mesh
-        // index. It will be cached here and then can be referenced in this
-        // scene and others by using it mesh index.
-        case DefineMesh: {
-            readData(buffer, 2*sizeof(short));
-            PendingMesh* mesh = new PendingMesh(); // assigns next mesh index
-            int numVertices = shortBuffer[0];
-            int numFaces = shortBuffer[1];
-            mesh->vertices.resize(3*numVertices, 0);
-            mesh->normals.resize(3*numVertices);
-            mesh->faces.resize(3*numFaces);
-            readData((unsigned char*)&mesh->vertices[0], (int)(mesh->vertices.size()*sizeof(float)));
-            readData((unsigned char*)&mesh->faces[0], (int)(mesh->faces.size()*sizeof(short)));
-
-            // Compute normal vectors for the mesh.
-
-            vector<fVec3> normals(numVertices, fVec3(0));
-            for (int i = 0; i < numFaces; i++) {
-                int v1 = mesh->faces[3*i];
-                int v2 = mesh->faces[3*i+1];
-                int v3 = mesh->faces[3*i+2];
-                fVec3 vert1(mesh->vertices[3*v1], mesh->vertices[3*v1+1], mesh->vertices[3*v1+2]);
-                fVec3 vert2(mesh->vertices[3*v2], mesh->vertices[3*v2+1], mesh->vertices[3*v2+2]);
-                fVec3 vert3(mesh->vertices[3*v3], mesh->vertices[3*v3+1], mesh->vertices[3*v3+2]);
-                fVec3 norm = (vert2-vert1)%(vert3-vert1);
-                float length = norm.norm();
-                if (length > 0) {
-                    norm /= length;
-                    normals[v1] += norm;
-                    normals[v2] += norm;
-                    normals[v3] += norm;
-                }
-            }
-            for (int i = 0; i < numVertices; i++) {
-                normals[i] = normals[i].normalize();
-                mesh->normals[3*i] = normals[i][0];
-                mesh->normals[3*i+1] = normals[i][1];
-                mesh->normals[3*i+2] = normals[i][2];
-            }
-
-            // A real mesh will be generated from this the next
-            // time the scene is redrawn.
-            std::lock_guard<std::mutex> lock(sceneMutex); //--- LOCK SCENE ----
-            pendingCommands.insert(pendingCommands.begin(), mesh);
-            break;                                        //--- UNLOCK SCENE --
-        }
-
         default:
             SimTK_ASSERT_ALWAYS(false, "Unexpected scene data sent to visualizer");
         }
@@ -2248,6 +2296,35 @@ static Scene* readNewScene() {
     return newScene;
 }
 
+// We have just received a StartOfScene or SceneInSharedMemory command. Get
+// the scene's bytes from the pipe or from the indicated shared memory slot
+// and read the scene from them.
+static Scene* receiveScene(unsigned char command) {
+    unsigned header[2];
+    if (command == SceneInSharedMemory) {
+        readData((unsigned char*)header, 2*sizeof(unsigned));
+        const unsigned slot = header[0], size = header[1];
+        SimTK_ERRCHK_ALWAYS(sharedScenes && slot < NumSceneSlots
+            && size <= SceneSlotBytes
+            && sharedScenes->slotInUse[slot].load(std::memory_order_acquire),
+            "simbody-visualizer",
+            "Received a scene in shared memory that we can't read.");
+        SceneReader in(getSharedSceneSlot(sharedScenes, slot), size);
+        Scene* newScene = readNewScene(in);
+        // Let the simulator reuse the slot.
+        sharedScenes->slotInUse[slot].store(0, std::memory_order_release);
+        return newScene;
+    }
+
+    // Reuse this buffer so that we don't allocate for every scene.
+    static vector<unsigned char> sceneData;
+    readData((unsigned char*)header, sizeof(unsigned));
+    sceneData.resize(header[0]);
+    readData(sceneData.data(), (int)sceneData.size());
+    SceneReader in(sceneData.data(), header[0]);
+    return readNewScene(in);
+}
+
 // This is the main program for the listener thread. It reads continuously
 // from the input pipe, which contains data from the simulator's calls
 // to a Visualizer object. Any changes to the scene must wait until the
@@ -2432,8 +2509,13 @@ void listenForInput() {
             showFrameNum = shouldShow;
             break;                                        //--- UNLOCK SCENE ---
         }
-        case StartOfScene: {
-            Scene* newScene = readNewScene();
+        case DefineMesh:
+            readMesh();
+            break;
+
+        case StartOfScene:
+        case SceneInSharedMemory: {
+            Scene* newScene = receiveScene(buffer[0]);
             std::unique_lock<std::mutex> lock(sceneMutex); //--- LOCK SCENE ----
             if (scene != NULL) {
                 // -------- WAIT FOR CONDITION --------
@@ -2702,6 +2784,25 @@ static void setVsync(bool enable) {
 }
 
 
+#ifndef _WIN32
+// Map the shared memory region the simulator created for sending scenes.
+// Returns null if we can't; then the simulator will use only the pipe.
+static SharedScenesHeader* openSharedScenes(const std::string& name) {
+    const int fd = shm_open(name.c_str(), O_RDWR, 0);
+    if (fd == -1)
+        return NULL;
+    void* region = mmap(NULL, SharedScenesBytes, PROT_READ|PROT_WRITE,
+                        MAP_SHARED, fd, 0);
+    close(fd);
+    return region == MAP_FAILED ? NULL
+                                : static_cast<SharedScenesHeader*>(region);
+}
+#else
+// There's no shared memory support on Windows; we always use the pipe.
+static SharedScenesHeader* openSharedScenes(const std::string&) 
+{   return NULL; }
+#endif
+
 // This is executed from the main thread at startup.
 static void shakeHandsWithSimulator(int fromSimPipe, int toSimPipe) {
     unsigned char handshakeCommand;
@@ -2735,8 +2836,20 @@ static void shakeHandsWithSimulator(int fromSimPipe, int toSimPipe) {
 
     simulatorExecutableName = std::string(exeNameBuf, exeNameLength);
 
+    // The simulator may offer a shared memory region to send scenes through.
+    unsigned sharedNameLength;
+    char sharedNameBuf[256];
+    readDataFromPipe(fromSimPipe, (unsigned char*)&sharedNameLength, sizeof(unsigned));
+    SimTK_ASSERT_ALWAYS(sharedNameLength <= 255,
+        "simbody-visualizer: shared memory name length violates protocol.");
+    readDataFromPipe(fromSimPipe, (unsigned char*)sharedNameBuf, sharedNameLength);
+    if (sharedNameLength)
+        sharedScenes = openSharedScenes(std::string(sharedNameBuf, sharedNameLength));
+
     WRITE(outPipe, &ReturnHandshake, 1);
     WRITE(outPipe, &ProtocolVersion, sizeof(unsigned));
+    const unsigned char usesSharedScenes = sharedScenes ? 1 : 0;
+    WRITE(outPipe, &usesSharedScenes, 1);
 }
 
 // Received Shutdown message from simulator. Die immediately.
@@ -31,7 +31,11 @@
 #include <cctype>
 #include <cerrno>
 #include <cstring>
+#include <cassert>
+#include <algorithm>
 #include <string>
+#include <new>
+#include <vector>
 
 using namespace SimTK;
 using namespace std;
@@ -45,6 +49,8 @@ using namespace std;
     #define CLOSE _close
 #else
     #include <unistd.h>
+    #include <fcntl.h>
+    #include <sys/mman.h>
     #define READ read
     #define WRITEFUNC write
     #define CLOSE close
@@ -65,6 +71,86 @@ using namespace std;
 
 static int inPipe;
 
+// Write a large array with a write() call for each MeshChunkBytes of it.
+static void writeInChunks(int pipeno, const void* data, size_t bytes) {
+    const char* p = static_cast<const char*>(data);
+    while (bytes > 0) {
+        const int chunk = (int)std::min(bytes, (size_t)MeshChunkBytes);
+        WRITE(pipeno, p, chunk);
+        p += chunk;
+        bytes -= chunk;
+    }
+}
+
+// Room left at the start of each scene for the StartOfScene command and the
+// number of bytes that follow it.
+static const unsigned SceneHeaderBytes = 1 + sizeof(unsigned);
+
+#ifndef _WIN32
+// Create a shared memory region for sending scenes to the GUI, and return
+// the name the GUI can open it with. Returns null if the region can't be
+// created, or if the environment variable SIMBODY_VISUALIZER_SHARED_MEMORY
+// is set to 0; then we send everything through the pipe.
+static SharedScenesHeader* createSharedScenes(std::string& name) {
+    if (Pathname::environmentVariableExists("SIMBODY_VISUALIZER_SHARED_MEMORY")
+        && Pathname::getEnvironmentVariable("SIMBODY_VISUALIZER_SHARED_MEMORY")
+           == "0")
+        return nullptr;
+
+    // Keep this short; OSX allows only 31 characters.
+    static std::atomic<unsigned> numCreated(0);
+    name = "/simbody-viz-" + std::to_string((long long)getpid()) + "-"
+           + std::to_string((unsigned long long)numCreated++);
+    const int fd = shm_open(name.c_str(), O_CREAT|O_EXCL|O_RDWR, 0600);
+    if (fd == -1) {
+        name.clear();
+        return nullptr;
+    }
+    void* region = MAP_FAILED;
+    if (ftruncate(fd, SharedScenesBytes) == 0)
+        region = mmap(nullptr, SharedScenesBytes, PROT_READ|PROT_WRITE,
+                      MAP_SHARED, fd, 0);
+    close(fd);
+    if (region == MAP_FAILED) {
+        shm_unlink(name.c_str());
+        name.clear();
+        return nullptr;
+    }
+
+    SharedScenesHeader* header = new(region) SharedScenesHeader;
+    for (unsigned i=0; i < NumSceneSlots; ++i)
+        header->slotInUse[i].store(0);
+    return header;
+}
+
+static void releaseSharedScenes(SharedScenesHeader* header) {
+    munmap(header, SharedScenesBytes);
+}
+
+// Removes the name of the shared memory region when it goes out of scope.
+// The region stays mapped in both processes until they unmap it.
+struct SharedScenesName {
+    std::string name;
+    ~SharedScenesName() {if (!name.empty()) shm_unlink(name.c_str());}
+};
+#else
+// There's no shared memory support on Windows; we always use the pipe.
+static SharedScenesHeader* createSharedScenes(std::string&)
+{   return nullptr; }
+static void releaseSharedScenes(SharedScenesHeader*) {}
+struct SharedScenesName {std::string name;};
+#endif
+
+// Unmaps the shared memory region when it goes out of scope, unless release()
+// has handed it over to its permanent owner. This keeps the region from
+// leaking if the handshake with the GUI fails.
+struct SharedScenesMapping {
+    SharedScenesHeader* header = nullptr;
+    ~SharedScenesMapping() {if (header) releaseSharedScenes(header);}
+    SharedScenesHeader* release()
+    {   SharedScenesHeader* h = header; header = nullptr; return h; }
+};
+
 // Create the pipe going *from* simulator *to* visualizer, so only the
 // read end should be inherited by the visualizer.
 static int createPipeSim2Viz(int sim2viz[2]) {
@@ -377,6 +463,18 @@ void VisualizerProtocol::shakeHandsWithGUI(int toGUIPipe, int fromGUIPipe) {
     WRITE(outPipe, &nameLength, sizeof(unsigned));
     WRITE(outPipe, fileName.c_str(), nameLength);
 
+    // Offer the GUI a shared memory region to receive scenes through; an
+    // empty name means we'll use only the pipe. The name is removed when we
+    // leave here, by which time the GUI has opened the region or given up.
+    // The region stays ours to unmap until the handshake has succeeded.
+    SharedScenesName shared;
+    SharedScenesMapping mapping;
+    mapping.header = createSharedScenes(shared.name);
+    unsigned sharedNameLength = (unsigned)shared.name.size();
+    WRITE(outPipe, &sharedNameLength, sizeof(unsigned));
+    if (sharedNameLength)
+        WRITE(outPipe, shared.name.c_str(), sharedNameLength);
+
         // Now wait for handshake response from GUI.
 
     unsigned char handshakeCommand;
@@ -395,7 +493,13 @@ void VisualizerProtocol::shakeHandsWithGUI(int toGUIPipe, int fromGUIPipe) {
         " Can't continue.",
         GUIversion, ProtocolVersion);
 
-    // Handshake was successful.
+    // Find out whether the GUI was able to map the shared memory region.
+    unsigned char GUIusesSharedScenes;
+    readDataFromPipe(fromGUIPipe, &GUIusesSharedScenes, 1);
+
+    // Handshake was successful. Keep the region only if the GUI uses it.
+    if (GUIusesSharedScenes)
+        sharedScenes = mapping.release();
 }
 
 void VisualizerProtocol::shutdownGUI() {
@@ -416,6 +520,8 @@ VisualizerProtocol::~VisualizerProtocol() {
     // If shutdownGUI() was not called, then the listener thread is still
     // running and we should kill it.
     stopListeningIfNecessary();
+    if (sharedScenes)
+        releaseSharedScenes(sharedScenes);
     int retval = CLOSE(outPipe); // TODO(chrisdembia) is this necessary?
     if (retval == -1) {
         std::cout << "Warning in Simbody VisualizerProtocol: "
@@ -442,20 +548,71 @@ void VisualizerProtocol::stopListeningIfNecessary() {
 
 void VisualizerProtocol::beginScene(Real time) {
     sceneLockBeginFinishScene.lock();
-    char command = StartOfScene;
-    WRITE(outPipe, &command, 1);
+    // Leave room for the header; see sendScene(). This keeps the capacity
+    // sceneData had, so steady-state scenes don't allocate.
+    sceneData.assign(SceneHeaderBytes, '\0');
+
+    // Write the scene directly into the first free shared memory slot, if
+    // any. The GUI doesn't look at a slot until sendScene() marks it in use
+    // and tells the GUI which one it is, so any free slot will do.
+    sceneSlotData = nullptr;
+    if (sharedScenes) {
+        for (unsigned i=0; i < NumSceneSlots; ++i) {
+            const unsigned slot = (nextSlot+i) % NumSceneSlots;
+            if (!sharedScenes->slotInUse[slot].load(std::memory_order_acquire))
+            {   sceneSlot = slot;
+                sceneSlotData = getSharedSceneSlot(sharedScenes, slot);
+                sceneSlotBytes = 0;
+                break; }
+        }
+    }
     float fTime = (float)time;
-    WRITE(outPipe, &fTime, sizeof(float));
+    appendToScene(&fTime, sizeof(float));
     // The sceneMutex is NOT unlocked at the end of this scope
     // (sceneLockBeginFinishScene is a member variable); see finishScene().
 }
 
 void VisualizerProtocol::finishScene() {
-    char command = EndOfScene;
-    WRITE(outPipe, &command, 1);
+    appendToScene(&EndOfScene, 1);
+    sendScene();
     sceneLockBeginFinishScene.unlock();
 }
 
+// The scene doesn't fit in what's left of its shared memory slot, or there
+// is no slot. Continue it in sceneData, moving what's already in the slot
+// there first; the slot was never marked in use, so it is simply abandoned.
+void VisualizerProtocol::appendToSceneData(const void* data, size_t len) {
+    if (sceneSlotData) {
+        sceneData.append((const char*)sceneSlotData, sceneSlotBytes);
+        sceneSlotData = nullptr;
+    }
+    sceneData.append(static_cast<const char*>(data), len);
+}
+
+// Hand over the shared memory slot the scene was written into, if it still
+// is in one, otherwise send sceneData through the pipe with a single write.
+// The GUI handles scenes in the order their commands arrive on the pipe, so
+// the two ways of sending can be mixed freely.
+void VisualizerProtocol::sendScene() {
+    if (sceneSlotData) {
+        const unsigned sceneBytes = (unsigned)sceneSlotBytes;
+        sharedScenes->slotInUse[sceneSlot].store(1, std::memory_order_release);
+        unsigned char command[1+2*sizeof(unsigned)];
+        command[0] = SceneInSharedMemory;
+        memcpy(command+1, &sceneSlot, sizeof(unsigned));
+        memcpy(command+1+sizeof(unsigned), &sceneBytes, sizeof(unsigned));
+        WRITE(outPipe, command, (int)sizeof(command));
+        nextSlot = (sceneSlot+1) % NumSceneSlots;
+        sceneSlotData = nullptr;
+        return;
+    }
+
+    const unsigned sceneBytes = (unsigned)(sceneData.size() - SceneHeaderBytes);
+    sceneData[0] = (char)StartOfScene;
+    memcpy(&sceneData[1], &sceneBytes, sizeof(unsigned));
+    WRITE(outPipe, sceneData.data(), (int)sceneData.size());
+}
+
 void VisualizerProtocol::drawBox(const Transform& X_GB, const Vec3& scale, const Vec4& color, int representation) {
     drawMesh(X_GB, scale, color, (short) representation, MeshBox, 0);
 }
@@ -474,7 +631,7 @@ void VisualizerProtocol::drawCircle(const Transform& X_GB, const Vec3& scale, co
 
 void VisualizerProtocol::drawPolygonalMesh(const PolygonalMesh& mesh, const Transform& X_GM, const Vec3& scale, const Vec4& color, int representation) {
     const void* impl = &mesh.getImpl();
-    map<const void*, unsigned short>::const_iterator iter = meshes.find(impl);
+    map<const void*, unsigned>::const_iterator iter = meshes.find(impl);
 
     if (iter != meshes.end()) {
         // This mesh was already cached; just reference it by index number.
@@ -482,95 +639,122 @@ void VisualizerProtocol::drawPolygonalMesh(const PolygonalMesh& mesh, const Tran
         return;
     }
 
-    // This is a new mesh, so we need to send it to the visualizer. Build lists
-    // of vertices and faces, triangulating as necessary.
-
-    vector<float> vertices;
-    vector<unsigned short> faces;
-    for (int i = 0; i < mesh.getNumVertices(); i++) {
-        Vec3 pos = mesh.getVertexPosition(i);
-        vertices.push_back((float) pos[0]);
-        vertices.push_back((float) pos[1]);
-        vertices.push_back((float) pos[2]);
+    // This is a new mesh, so we need to send it to the visualizer. Triangles
+    // are sent as is and quads are split in two. Larger polygons get a new
+    // vertex at their center and are split into a fan of triangles around
+    // it. Count everything first so the buffers are allocated only once.
+    const int numMeshVertices = mesh.getNumVertices();
+    size_t numVertices = numMeshVertices, numFaces = 0;
+    for (int i = 0; i < mesh.getNumFaces(); i++) {
+        const int numVert = mesh.getNumVerticesForFace(i);
+        if (numVert < 3)
+            continue; // Ignore it.
+        if (numVert == 3)
+            numFaces += 1;
+        else if (numVert == 4)
+            numFaces += 2;
+        else {
+            numVertices += 1;
+            numFaces += numVert;
+        }
     }
+    SimTK_ERRCHK1_ALWAYS(numVertices <= 0xffffffffu, 
+        "VisualizerProtocol::drawPolygonalMesh()",
+        "Can't display a DecorativeMesh with more than 2^32-1 vertices;"
+        " received one with %llu.", (unsigned long long)numVertices);
+    SimTK_ERRCHK1_ALWAYS(numFaces <= 0xffffffffu, 
+        "VisualizerProtocol::drawPolygonalMesh()",
+        "Can't display a DecorativeMesh with more than 2^32-1 triangles;"
+        " received one with %llu.", (unsigned long long)numFaces);
+
+    vector<float> vertices(3*numVertices);
+    vector<unsigned> faces(3*numFaces);
+    for (int i = 0; i < numMeshVertices; i++) {
+        const Vec3& pos = mesh.getVertexPosition(i);
+        vertices[3*i]   = (float) pos[0];
+        vertices[3*i+1] = (float) pos[1];
+        vertices[3*i+2] = (float) pos[2];
+    }
+    size_t nextVertex = numMeshVertices, nextFace = 0;
+    auto addFace = [&](unsigned v1, unsigned v2, unsigned v3) {
+        faces[3*nextFace]   = v1;
+        faces[3*nextFace+1] = v2;
+        faces[3*nextFace+2] = v3;
+        ++nextFace;
+    };
     for (int i = 0; i < mesh.getNumFaces(); i++) {
-        int numVert = mesh.getNumVerticesForFace(i);
+        const int numVert = mesh.getNumVerticesForFace(i);
         if (numVert < 3)
             continue; // Ignore it.
         if (numVert == 3) {
-            faces.push_back((unsigned short) mesh.getFaceVertex(i, 0));
-            faces.push_back((unsigned short) mesh.getFaceVertex(i, 1));
-            faces.push_back((unsigned short) mesh.getFaceVertex(i, 2));
+            addFace(mesh.getFaceVertex(i, 0), mesh.getFaceVertex(i, 1),
+                    mesh.getFaceVertex(i, 2));
         }
         else if (numVert == 4) {
             // Split it into two triangles.
-
-            faces.push_back((unsigned short) mesh.getFaceVertex(i, 0));
-            faces.push_back((unsigned short) mesh.getFaceVertex(i, 1));
-            faces.push_back((unsigned short) mesh.getFaceVertex(i, 2));
-            faces.push_back((unsigned short) mesh.getFaceVertex(i, 2));
-            faces.push_back((unsigned short) mesh.getFaceVertex(i, 3));
-            faces.push_back((unsigned short) mesh.getFaceVertex(i, 0));
+            addFace(mesh.getFaceVertex(i, 0), mesh.getFaceVertex(i, 1),
+                    mesh.getFaceVertex(i, 2));
+            addFace(mesh.getFaceVertex(i, 2), mesh.getFaceVertex(i, 3),
+                    mesh.getFaceVertex(i, 0));
         }
         else {
             // Add a vertex at the center, then split it into triangles.
-
             Vec3 center(0);
-            for (int j = 0; j < numVert; j++) {
-                Vec3 pos = mesh.getVertexPosition(mesh.getFaceVertex(i,j));
-                center += pos;
-            }
+            for (int j = 0; j < numVert; j++)
+                center += mesh.getVertexPosition(mesh.getFaceVertex(i,j));
             center /= numVert;
-            vertices.push_back((float) center[0]);
-            vertices.push_back((float) center[1]);
-            vertices.push_back((float) center[2]);
-            const unsigned newIndex = (unsigned)(vertices.size()/3-1);
-            for (int j = 0; j < numVert-1; j++) {
-                faces.push_back((unsigned short) mesh.getFaceVertex(i, j));
-                faces.push_back((unsigned short) mesh.getFaceVertex(i, j+1));
-                faces.push_back((unsigned short) newIndex);
-            }
+            vertices[3*nextVertex]   = (float) center[0];
+            vertices[3*nextVertex+1] = (float) center[1];
+            vertices[3*nextVertex+2] = (float) center[2];
+            const unsigned newIndex = (unsigned)nextVertex++;
+            for (int j = 0; j < numVert-1; j++)
+                addFace(mesh.getFaceVertex(i, j), mesh.getFaceVertex(i, j+1),
+                        newIndex);
             // Close the face (thanks, Alexandra Zobova).
-            faces.push_back((unsigned short) mesh.getFaceVertex(i, numVert-1));
-            faces.push_back((unsigned short) mesh.getFaceVertex(i, 0));
-            faces.push_back((unsigned short) newIndex);
+            addFace(mesh.getFaceVertex(i, numVert-1), mesh.getFaceVertex(i, 0),
+                    newIndex);
         }
     }
-    SimTK_ERRCHK1_ALWAYS(vertices.size() <= 65535*3, 
-        "VisualizerProtocol::drawPolygonalMesh()",
-        "Can't display a DecorativeMesh with more than 65535 vertices;"
-        " received one with %llu.", (unsigned long long)vertices.size());
-    SimTK_ERRCHK1_ALWAYS(faces.size() <= 65535*3, 
-        "VisualizerProtocol::drawPolygonalMesh()",
-        "Can't display a DecorativeMesh with more than 65535 vertices;"
-        " received one with %llu.", (unsigned long long)faces.size());
+    assert(nextVertex == numVertices && nextFace == numFaces);
 
-    const int index = NumPredefinedMeshes + (int)meshes.size();
-    SimTK_ERRCHK_ALWAYS(index <= 65535,
+    const size_t index = NumPredefinedMeshes + meshes.size();
+    SimTK_ERRCHK_ALWAYS(index <= 0xffffffffu,
         "VisualizerProtocol::drawPolygonalMesh()",
-        "Too many unique DecorativeMesh objects; max is 65535.");
+        "Too many unique DecorativeMesh objects; max is 2^32-1.");
     
-    meshes[impl] = (unsigned short)index;    // insert new mesh
-    WRITE(outPipe, &DefineMesh, 1);
-    unsigned short numVertices = (unsigned short)(vertices.size()/3);
-    unsigned short numFaces = (unsigned short)(faces.size()/3);
-    WRITE(outPipe, &numVertices, sizeof(short));
-    WRITE(outPipe, &numFaces, sizeof(short));
-    WRITE(outPipe, &vertices[0], (unsigned)(vertices.size()*sizeof(float)));
-    WRITE(outPipe, &faces[0], (unsigned)(faces.size()*sizeof(short)));
+    meshes[impl] = (unsigned)index;    // insert new mesh
+    sendMesh(vertices, faces);
 
-    drawMesh(X_GM, scale, color, (short) representation, (unsigned short)index, 0);
+    drawMesh(X_GM, scale, color, (short) representation, (unsigned)index, 0);
+}
+
+// Mesh definitions go straight to the pipe rather than into the scene being
+// assembled, so big meshes aren't copied again and don't make the scene too
+// big for shared memory. They still arrive ahead of the scene. The arrays are
+// written in pieces of at most MeshChunkBytes.
+void VisualizerProtocol::sendMesh(const vector<float>& vertices,
+                                  const vector<unsigned>& faces)
+{
+    unsigned char header[1+2*sizeof(unsigned)];
+    const unsigned numVertices = (unsigned)(vertices.size()/3);
+    const unsigned numFaces    = (unsigned)(faces.size()/3);
+    header[0] = DefineMesh;
+    memcpy(header+1, &numVertices, sizeof(unsigned));
+    memcpy(header+1+sizeof(unsigned), &numFaces, sizeof(unsigned));
+    WRITE(outPipe, header, (int)sizeof(header));
+    writeInChunks(outPipe, vertices.data(), vertices.size()*sizeof(float));
+    writeInChunks(outPipe, faces.data(), faces.size()*sizeof(unsigned));
 }
 
 void VisualizerProtocol::
 drawMesh(const Transform& X_GM, const Vec3& scale, const Vec4& color, 
-         short representation, unsigned short meshIndex, unsigned short resolution)
+         short representation, unsigned meshIndex, unsigned short resolution)
 {
     char command = (representation == DecorativeGeometry::DrawPoints 
                     ? AddPointMesh 
                     : (representation == DecorativeGeometry::DrawWireframe 
                         ? AddWireframeMesh : AddSolidMesh));
-    WRITE(outPipe, &command, 1);
+    appendToScene(&command, 1);
     float buffer[13];
     Vec3 rot = X_GM.R().convertRotationToBodyFixedXYZ();
     buffer[0] = (float) rot[0];
@@ -586,17 +770,15 @@ drawMesh(const Transform& X_GM, const Vec3& scale, const Vec4& color,
     buffer[10] = (float) color[1];
     buffer[11] = (float) color[2];
     buffer[12] = (float) color[3];
-    WRITE(outPipe, buffer, 13*sizeof(float));
-    unsigned short buffer2[2];
-    buffer2[0] = meshIndex;
-    buffer2[1] = resolution;
-    WRITE(outPipe, buffer2, 2*sizeof(unsigned short));
+    appendToScene(buffer, 13*sizeof(float));
+    appendToScene(&meshIndex, sizeof(unsigned));
+    appendToScene(&resolution, sizeof(unsigned short));
 }
 
 void VisualizerProtocol::
 drawLine(const Vec3& end1, const Vec3& end2, const Vec4& color, Real thickness)
 {
-    WRITE(outPipe, &AddLine, 1);
+    appendToScene(&AddLine, 1);
     float buffer[10];
     buffer[0] = (float) color[0];
     buffer[1] = (float) color[1];
@@ -608,7 +790,7 @@ drawLine(const Vec3& end1, const Vec3& end2, const Vec4& color, Real thickness)
     buffer[7] = (float) end2[0];
     buffer[8] = (float) end2[1];
     buffer[9] = (float) end2[2];
-    WRITE(outPipe, buffer, 10*sizeof(float));
+    appendToScene(buffer, 10*sizeof(float));
 }
 
 void VisualizerProtocol::
@@ -618,7 +800,7 @@ drawText(const Transform& X_GT, const Vec3& scale, const Vec4& color,
         "VisualizerProtocol::drawText()",
         "Can't display DecorativeText longer than 256 characters;"
         " received text of length %u.", (unsigned)string.size());
-    WRITE(outPipe, &AddText, 1);
+    appendToScene(&AddText, 1);
     float buffer[12];
     const Vec3 rot = X_GT.R().convertRotationToBodyFixedXYZ();
     buffer[0] = (float) rot[0];
@@ -633,19 +815,19 @@ drawText(const Transform& X_GT, const Vec3& scale, const Vec4& color,
     buffer[9] = (float) color[0];
     buffer[10]= (float) color[1];
     buffer[11]= (float) color[2];
-    WRITE(outPipe, buffer, 12*sizeof(float));
+    appendToScene(buffer, 12*sizeof(float));
     short face = (short)faceCamera;
-    WRITE(outPipe, &face, sizeof(short));
+    appendToScene(&face, sizeof(short));
     short screen = (short)isScreenText;
-    WRITE(outPipe, &screen, sizeof(short));
+    appendToScene(&screen, sizeof(short));
     short length = (short)string.size();
-    WRITE(outPipe, &length, sizeof(short));
-    WRITE(outPipe, &string[0], length);
+    appendToScene(&length, sizeof(short));
+    appendToScene(&string[0], length);
 }
 
 void VisualizerProtocol::
 drawCoords(const Transform& X_GF, const Vec3& axisLengths, const Vec4& color) {
-    WRITE(outPipe, &AddCoords, 1);
+    appendToScene(&AddCoords, 1);
     float buffer[12];
     const Vec3 rot = X_GF.R().convertRotationToBodyFixedXYZ();
     buffer[0] = (float) rot[0];
@@ -660,7 +842,7 @@ drawCoords(const Transform& X_GF, const Vec3& axisLengths, const Vec4& color) {
     buffer[9] = (float) color[0];
     buffer[10]= (float) color[1];
     buffer[11]= (float) color[2];
-    WRITE(outPipe, buffer, 12*sizeof(float));
+    appendToScene(buffer, 12*sizeof(float));
 }
 
 void VisualizerProtocol::
@@ -29,6 +29,9 @@
 #include <utility>
 #include <map>
 #include <atomic>
+#include <cstring>
+#include <string>
+#include <vector>
 
 /** @file
  * This file defines commands that are used for communication between the 
@@ -37,19 +40,26 @@
 
 // Increment this every time you make *any* change to the protocol;
 // we insist on an exact match.
-static const unsigned ProtocolVersion   = 34;
+static const unsigned ProtocolVersion   = 36;
 
 // The visualizer has several predefined cached meshes for common
 // shapes so that we don't have to send them. These are the mesh 
 // indices for them; they must start with zero.
-static const unsigned short MeshBox              = 0;
-static const unsigned short MeshEllipsoid        = 1;    // works for sphere
-static const unsigned short MeshCylinder         = 2;
-static const unsigned short MeshCircle           = 3;
+static const unsigned MeshBox                    = 0;
+static const unsigned MeshEllipsoid              = 1;    // works for sphere
+static const unsigned MeshCylinder               = 2;
+static const unsigned MeshCircle                 = 3;
 
 // This serves as the first index number for unique meshes that are 
 // defined during this run.
-static const unsigned short NumPredefinedMeshes  = 4;
+static const unsigned NumPredefinedMeshes        = 4;
+
+// A unique mesh is defined with DefineMesh followed by unsigned vertex and
+// triangle counts, the vertex coordinates as floats and the triangles'
+// vertex indices as unsigned ints. Mesh definitions are sent outside of any
+// scene, ahead of the scene that first uses them, and their arrays are
+// written and read in pieces of at most this many bytes.
+static const unsigned MeshChunkBytes             = 1024*1024;
 
 // Commands sent to the GUI.
 
@@ -87,6 +97,32 @@ static const unsigned char SetShowSimTime        = 28;
 static const unsigned char SetShowFrameNumber    = 29;
 static const unsigned char Shutdown              = 30;
 static const unsigned char StopCommunication     = 31;
+static const unsigned char SceneInSharedMemory   = 32;
+
+// A scene is sent in one piece: StartOfScene is followed by the number of
+// bytes in the rest of the scene (starting with its time and ending with
+// EndOfScene) and then those bytes. If the visualizer was able to map the
+// shared memory region offered during the handshake, the simulator may
+// instead copy the scene bytes into a free slot of that region and send
+// SceneInSharedMemory followed by the slot number and the number of bytes.
+// The visualizer clears the slot's in-use flag once it has read the scene.
+// If no slot is free, or the scene doesn't fit, the scene goes through the
+// pipe as usual.
+static const unsigned NumSceneSlots             = 4;
+static const unsigned SceneSlotBytes            = 4*1024*1024;
+static const unsigned SharedScenesHeaderBytes   = 64;
+static const size_t   SharedScenesBytes         =
+    SharedScenesHeaderBytes + size_t(NumSceneSlots)*SceneSlotBytes;
+
+// This is at the start of the shared memory region, followed by the slots.
+struct SharedScenesHeader {
+    std::atomic<unsigned> slotInUse[NumSceneSlots];
+};
+
+inline unsigned char* getSharedSceneSlot(void* region, unsigned slot) {
+    return static_cast<unsigned char*>(region) + SharedScenesHeaderBytes
+           + size_t(slot)*SceneSlotBytes;
+}
 
 
 // Events sent from the GUI back to the simulation application.
@@ -156,12 +192,39 @@ public:
 private:
     void drawMesh(const Transform& transform, const Vec3& scale, 
                   const Vec4& color, short representation, 
-                  unsigned short meshIndex, unsigned short resolution);
+                  unsigned meshIndex, unsigned short resolution);
+    void sendMesh(const std::vector<float>& vertices,
+                  const std::vector<unsigned>& faces);
+    // Scene elements are collected between beginScene() and finishScene()
+    // and then sent all at once. They are written straight into a free
+    // shared memory slot if beginScene() found one, and otherwise (or once
+    // the scene outgrows the slot) into sceneData to go through the pipe.
+    void appendToScene(const void* data, size_t len) {
+        if (sceneSlotData && sceneSlotBytes + len <= SceneSlotBytes) {
+            memcpy(sceneSlotData + sceneSlotBytes, data, len);
+            sceneSlotBytes += len;
+        } else
+            appendToSceneData(data, len);
+    }
+    void appendToSceneData(const void* data, size_t len);
+    void sendScene();
     int outPipe;
 
+    std::string sceneData;
+
+    // The shared memory region scenes are sent through, or null if we're
+    // using only the pipe. nextSlot is where we start looking for a free
+    // slot. While a scene is being written to a slot, sceneSlotData points
+    // to it and sceneSlotBytes is the number of bytes written so far.
+    SharedScenesHeader* sharedScenes = nullptr;
+    unsigned            nextSlot = 0;
+    unsigned            sceneSlot = 0;
+    unsigned char*      sceneSlotData = nullptr;
+    size_t              sceneSlotBytes = 0;
+
     // For user-defined meshes, map their unique memory addresses to the 
     // assigned visualizer cache index.
-    mutable std::map<const void*, unsigned short> meshes;
+    mutable std::map<const void*, unsigned> meshes;
 
     mutable std::mutex sceneMutex;
     // This lock should only be used in beginScene() and finishScene().
@@ -346,6 +346,48 @@ assemble() instead of track(). See the Assembler class documentation for
 more information and usage examples. **/
 Real track(Real frameTime = -1);
 
+/** Track a whole trajectory of observations, for offline processing of a
+long trial. Frame i's observations are moved into the first Markers and the
+first OrientationSensors condition this Assembler has adopted, and the q's
+are found as by track(). The frames are split into contiguous chunks that
+are solved concurrently. Each chunk is solved by an independent copy of
+this Assembler and its own State. Each chunk is warm started within itself;
+the first frame of each chunk but the first is solved from the current
+internal state with assemble(). Afterwards a serial reconciliation pass
+re-tracks the frames after each chunk boundary, warm started from the end
+of the previous chunk, until the solutions agree with the chunk's own. The
+result is then what tracking frame by frame would have given, to within
+the accuracy setting. On return the internal state holds the solution for
+the last frame.
+
+All the adopted assembly conditions must support 
+AssemblyCondition::cloneForThread(), as the built-in ones do; otherwise the
+frames are tracked serially. Reporters are called only for frames solved by
+this Assembler itself.
+
+@param[in]  markerObservations
+    One entry per frame, each holding all the observations defined for the
+    Markers condition (see Markers::moveAllObservations()). Leave this empty
+    if there is no Markers condition.
+@param[in]  osensorObservations
+    Similarly, for the OrientationSensors condition. If both are given they
+    must have the same number of frames.
+@param[in]  frameTimes
+    The time of each frame, passed on to track(). If empty, the frames are
+    not timed.
+@param[in]  numThreads
+    The maximum number of chunks to solve concurrently; 0 means use the 
+    number of processors.
+@return A matrix with one row per frame holding the internal state's q's 
+    (using Euler angles rather than quaternions) at each solution. 
+@throws TrackFailed or AssembleFailed if some frame can't be solved; the
+    first failing chunk's exception is rethrown. **/
+Matrix trackTrajectory
+   (const Array_< Array_<Vec3> >&       markerObservations,
+    const Array_< Array_<Rotation> >&   osensorObservations,
+    const Vector&                       frameTimes = Vector(),
+    int                                 numThreads = 0);
+
 /** Given an initial value for the State, modify the q's in it to satisfy
 all the assembly conditions to within a tolerance. The actual tolerance 
 achieved is returned as the function value. 
@@ -530,6 +572,22 @@ errors; if not we're using the default infinity norm (max absolute value).
 **/
 bool isUsingRMSErrorNorm() const {return useRMSErrorNorm;}
 
+/** Solve the assembly problem with a Levenberg-Marquardt least squares
+method rather than the general purpose Optimizer. This works directly with
+the assembly errors and their Jacobians, treating each goal's errors as
+residuals and projecting onto the assembly error conditions at each step, and 
+usually converges in a handful of iterations; it is a good choice for 
+tracking many markers or orientation sensors. It requires every goal to
+provide errors via calcErrors(), with its goal value proportional to their
+sum of squares (true for all the built-in assembly conditions); if some goal
+can't do that the Optimizer is used anyway. The default is to use the
+Optimizer. **/
+void setUseLevenbergMarquardt(bool yesno)
+{   useLevenbergMarquardt = yesno; }
+/** Determine whether we are currently using the Levenberg-Marquardt solver
+when possible; see setUseLevenbergMarquardt(). **/
+bool isUsingLevenbergMarquardt() const {return useLevenbergMarquardt;}
+
 /** Uninitialize the Assembler. After this call the Assembler must be
 initialized again before an assembly study can be performed. Normally this
 is called automatically when changes are made; you can call it explicitly
@@ -620,6 +678,23 @@ Vector getFreeQsFromInternalState() const {
 void reinitializeWithExtraQsLocked
     (const Array_<QIndex>& toBeLocked) const;
 
+// Run the selected solver starting from freeQs; see 
+// setUseLevenbergMarquardt().
+void optimize(Vector& freeQs) const;
+
+// Return a new Assembler on the same System with copies of this one's
+// settings, internal state, and assembly conditions, or null if some
+// condition can't be copied. Reporters are not copied.
+Assembler* cloneForThread() const;
+
+// Move frame f's observations into the given conditions (either index may
+// be invalid) and solve it; see trackTrajectory().
+void trackFrame(AssemblyConditionIndex markersIx, 
+                AssemblyConditionIndex osensorsIx,
+                const Array_< Array_<Vec3> >&       markerObservations,
+                const Array_< Array_<Rotation> >&   osensorObservations,
+                const Vector& frameTimes, int f, bool firstInChunk);
+
 
 
 //------------------------------------------------------------------------------
@@ -635,6 +710,7 @@ Real    tolerance;              // 0 means use accuracy/10
 bool    forceNumericalGradient; // ignore analytic gradient methods
 bool    forceNumericalJacobian; // ignore analytic Jacobian methods
 bool    useRMSErrorNorm;        // what norm defines success?
+bool    useLevenbergMarquardt;  // least squares instead of Optimizer?
 
 // Changes to any of these data members set isInitialized()=false.
 State                           internalState;
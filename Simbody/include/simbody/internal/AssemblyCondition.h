@@ -140,6 +140,14 @@ gradient must be calculated numerically using the calcGoal() method. **/
 virtual int calcGoalGradient(const State& state, Vector& gradient) const
 {   return -1; }
 
+/** Override to return a new, heap-allocated copy of this assembly condition,
+not yet adopted by any Assembler, so that it can be used by an independent
+Assembler on another thread; see Assembler::trackTrajectory(). The copy must
+include any step-to-step data, such as current observations. The default
+returns null, meaning that this condition can't be copied and any Assembler
+containing it must do its work serially. **/
+virtual AssemblyCondition* cloneForThread() const {return nullptr;}
+
 /** Return the name assigned to this AssemblyCondition on construction. **/
 const char* getName() const {return name.c_str();}
 
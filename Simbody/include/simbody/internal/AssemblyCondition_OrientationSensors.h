@@ -480,6 +480,7 @@ void uninitializeCondition() const override;
 int calcErrors(const State& state, Vector& err) const override;
 int calcErrorJacobian(const State& state, Matrix& jacobian) const override;
 int getNumErrors(const State& state) const override;
+AssemblyCondition* cloneForThread() const override;
 int calcGoal(const State& state, Real& goal) const override;
 int calcGoalGradient(const State& state, Vector& grad) const override;
 /*@}*/
@@ -55,6 +55,9 @@ public:
     can be done repeatedly during tracking to follow changing requirements. **/
     void setValue(Real newValue) {value=newValue;}
 
+    AssemblyCondition* cloneForThread() const override
+    {   return new QValue(mobodIndex, qIndex, value); }
+
     // For constraint:
     int getNumEquations(const State&) const {return 1;}
     int calcErrors(const State& state, Vector& error) const override {
@@ -160,6 +160,12 @@ may be initiated if necessary the first time this is called at this state
 but will be saved in the cache for subsequent accesses. **/
 Real getCableLengthDot(const State& state) const;
 
+/** Return the wall-clock time in seconds that was spent solving for this
+cable's path for the configuration supplied in \a state. State must have been
+realized through Position stage. This is useful for finding out which cables
+dominate the cost of realizing Position stage. **/
+Real getPathSolveTime(const State& state) const;
+
 /** Given a tension > 0 acting uniformly along this cable, apply the resulting
 forces to the bodies it touches. The body forces are added into the appropriate
 slots in the supplied Array which has one entry per body in the same format
@@ -80,6 +80,24 @@ const CablePath& getCablePath(CablePathIndex cableIx) const;
 /** Get writable access to a particular cable path. **/
 CablePath& updCablePath(CablePathIndex cableIx);
 
+/** Set the number of threads that the CableTrackerSubsystem can use to 
+solve for its cable paths. The paths are independent so they are solved 
+concurrently when Position stage is realized, one path per task. By default,
+the paths are solved serially on the calling thread and no thread pool is
+created; ask for more than one thread here to solve them concurrently, for
+example ParallelExecutor::getNumProcessors(). Setting it back to 1 releases
+the threads.
+
+@note This method should NOT be called while realizing Stage::Position. **/
+void setNumberOfThreads(unsigned numThreads);
+
+/** Returns the number of threads that the CableTrackerSubsystem can use to
+solve for its cable paths.
+
+@return Maximum number of threads CableTrackerSubsystem can use for path
+solving **/
+int getNumberOfThreads() const;
+
 /** @cond **/ // Hide from Doxygen.
 SimTK_PIMPL_DOWNCAST(CableTrackerSubsystem, Subsystem);
 class Impl;
@@ -40,6 +40,10 @@ namespace SimTK {
  * - (optional) A weight for each station, giving its relative importance for fitting
  * 
  * The output is a State giving the set of internal coordinates that best fit the stations to the target locations.
+ *
+ * The initial guess is built by fitting a small subproblem around each body, working down the tree from Ground.
+ * The subproblems for bodies at the same depth in the tree are independent and are solved concurrently on a
+ * ParallelExecutor, so the MultibodySystem must not be modified while findBestFit() is running.
  */
 
 class SimTK_SIMBODY_EXPORT ObservedPointFitter {
@@ -27,8 +27,13 @@
 #include "simbody/internal/SimbodyMatterSubsystem.h"
 #include "simbody/internal/Assembler.h"
 #include "simbody/internal/AssemblyCondition.h"
+#include "simbody/internal/AssemblyCondition_Markers.h"
+#include "simbody/internal/AssemblyCondition_OrientationSensors.h"
+#include <exception>
 #include <map>
+#include <memory>
 #include <iostream>
+#include <vector>
 using std::cout; using std::endl;
 
 using namespace SimTK;
@@ -335,18 +340,26 @@ public:
         if (new_parameters)
             setInternalStateFromFreeQs(parameters);
 
+        return calcConditionErrors(assembler.errors, qerrs);
+    }
+
+    // Stack the errors of the given conditions into errs, in order. errs
+    // must already be the right size.
+    int calcConditionErrors(const Array_<AssemblyConditionIndex>& conds,
+                            Vector& errs) const
+    {
         int nxtEqn = 0;
-        for (unsigned i=0; i < assembler.errors.size(); ++i) {
-            AssemblyConditionIndex   consIx = assembler.errors[i];
-            const AssemblyCondition& cond   = *assembler.conditions[consIx];
+        for (unsigned i=0; i < conds.size(); ++i) {
+            const AssemblyCondition& cond = *assembler.conditions[conds[i]];
             const int m = cond.getNumErrors(getInternalState());
-            int stat = cond.calcErrors(getInternalState(), qerrs(nxtEqn,m));
+            int stat = cond.calcErrors(getInternalState(), errs(nxtEqn,m));
             if (stat != 0)
                 return stat;
             nxtEqn += m;
         }
+        assert(nxtEqn == errs.size());
 
-        //cout << "    err=" << qerrs << endl;
+        //cout << "    err=" << errs << endl;
 
         return 0;
     }
@@ -407,6 +420,16 @@ public:
         assert(J.nrow() == getNumEqualityConstraints());
         assert(J.ncol() == getNumFreeQs());
 
+        return calcConditionJacobian(assembler.errors, J, nEvalConstraints);
+    }
+
+    // Stack the error Jacobians of the given conditions into J, in order. 
+    // J must already be the right size. Any conditions that can't provide
+    // an analytic Jacobian are differentiated numerically together at the
+    // end; the number of error evaluations that took is added to nNumEvals.
+    int calcConditionJacobian(const Array_<AssemblyConditionIndex>& conds,
+                              Matrix& J, int& nNumEvals) const
+    {
         const int n = getNumFreeQs();
 
         // This will record the indices of any constraints we encounter that 
@@ -418,8 +441,8 @@ public:
         int                            needy = 0;
 
         int nxtEqn = 0;
-        for (unsigned i=0; i < assembler.errors.size(); ++i) {
-            AssemblyConditionIndex   consIx = assembler.errors[i];
+        for (unsigned i=0; i < conds.size(); ++i) {
+            AssemblyConditionIndex   consIx = conds[i];
             const AssemblyCondition& cond   = *assembler.conditions[consIx];
             const int m = cond.getNumErrors(getInternalState());
             const int stat = (assembler.forceNumericalJacobian 
@@ -446,7 +469,7 @@ public:
             // rather than the derivative norm.
             Differentiator jacNumCons(numCons);
             Matrix numJ = jacNumCons.calcJacobian(getFreeQsFromInternalState());
-            nEvalConstraints += jacNumCons.getNumCallsToUserFunction();
+            nNumEvals += jacNumCons.getNumCallsToUserFunction();
 
             // Fill in the missing rows.
             int nxtInNumJ = 0;
@@ -461,6 +484,36 @@ public:
         return 0;
     }
 
+    // Solve for the free q's as a constrained nonlinear least squares problem
+    // using Levenberg-Marquardt; see Assembler::setUseLevenbergMarquardt().
+    // On entry freeQs is the starting guess; on return it is the solution and
+    // the internal state has been set to match. Returns -1 without changing 
+    // anything if one of the goals can't supply errors.
+    int optimizeLeastSquares(Vector& freeQs) const;
+
+    // Evaluate the scaled goal residuals r and assembly errors c at the
+    // given free q's, for optimizeLeastSquares().
+    int calcLeastSquaresErrors(const Vector& freeQs, const Array_<Real>& scale,
+                               const Array_<int>& nResiduals,
+                               Vector& r, Vector& c) const
+    {   setInternalStateFromFreeQs(freeQs);
+        ++nEvalObjective; ++nEvalConstraints;
+        int stat = calcConditionErrors(assembler.goals, r);
+        if (stat != 0)
+            return stat;
+        for (unsigned i=0, row=0; i < scale.size(); row += nResiduals[i++])
+            r((int)row, nResiduals[i]) *= scale[i];
+        return calcConditionErrors(assembler.errors, c);
+    }
+
+    // Norm of the assembly errors, as used to define success.
+    Real calcErrorNorm(const Vector& errs) const {
+        if (errs.size() == 0) return 0;
+        return assembler.useRMSErrorNorm
+            ? std::sqrt(~errs*errs / errs.size())   // RMS
+            : max(abs(errs));                       // infinity norm
+    }
+
     int getNumObjectiveEvals()  const {return nEvalObjective;}
     int getNumConstraintEvals() const {return nEvalConstraints;}
     int getNumGradientEvals()   const {return nEvalGradient;}
@@ -494,14 +547,153 @@ private:
 
 
 
+// The problem is to minimize sum_g( w_g * goal_g ) subject to the assembly
+// errors c(q)=0. We require that each goal also be able to supply errors e_g 
+// with goal_g proportional to |e_g|^2, as all the built-in conditions are; 
+// the proportion is measured at the start so that the objective is
+// 1/2 |r|^2, with r the stacked residuals s_g*e_g. Each iteration then solves
+// the damped, linearized problem
+//      min 1/2 |r + Jr dq|^2 + lambda/2 |dq|^2  subject to  c + Jc dq = 0
+// via its (symmetric, indefinite) KKT system, and accepts the step if it
+// reduces the exact penalty merit function 1/2 |r|^2 + mu*|c|_1, with mu
+// kept larger than the multipliers. The damping lambda is adjusted from the
+// ratio of actual to predicted reduction as in Nielsen's method. Bounds on
+// the q's, if any, are enforced by clamping each step.
+int Assembler::AssemblerSystem::optimizeLeastSquares(Vector& freeQs) const {
+    static const int  MaxIterations = 100;
+    static const Real MaxDamping    = 1e16;
+
+    const Array_<AssemblyConditionIndex>& goals = assembler.goals;
+    const int n = getNumFreeQs();
+    const int m = getNumEqualityConstraints();
+
+    setInternalStateFromFreeQs(freeQs);
+
+    // Find the residual scale factors s_g, and the total number of residuals.
+    Array_<Real> scale(goals.size());
+    Array_<int>  nResiduals(goals.size());
+    int nr = 0;
+    for (unsigned i=0; i < goals.size(); ++i) {
+        const AssemblyCondition& cond = *assembler.conditions[goals[i]];
+        const Real weight = assembler.weights[goals[i]];
+        Vector err; Real goal;
+        int stat = cond.calcErrors(getInternalState(), err);
+        if (stat == 0)
+            stat = cond.calcGoal(getInternalState(), goal);
+        if (stat != 0)
+            return stat; // -1 if this goal doesn't provide errors
+        const Real errSqr = err.normSqr();
+        scale[i] = errSqr > 0 && isFinite(goal) 
+                   ? std::sqrt(2*weight*goal/errSqr) 
+                   : std::sqrt(weight); // can't tell; assume goal=|e|^2/2
+        nResiduals[i] = err.size();
+        nr += err.size();
+    }
+
+    Vector x(freeQs), r(nr), c(m);
+    int stat = calcLeastSquaresErrors(x, scale, nResiduals, r, c);
+    if (stat != 0)
+        return stat;
+    Real cost = r.normSqr()/2;
+    Real penalty = 0;       // weight mu on |c|_1 in the merit function
+    Real lambda = -1;       // damping; set from the first Jacobian
+    Real nu = 2;            // growth factor for lambda after a failed step
+
+    const Real tol = assembler.getErrorToleranceInUse();
+    const Real acc = assembler.getAccuracyInUse();
+
+    Matrix Jr(nr, n), Jc(m, n), K(n+m, n+m);
+    Vector rhs(n+m), sol(n+m), xNew(n), rNew(nr), cNew(m);
+    FactorLDLT kkt;
+    bool done = false;
+    for (int iter=0; iter < MaxIterations && !done; ++iter) {
+        for (unsigned i=0; i < assembler.reporters.size(); ++i)
+            assembler.reporters[i]->handleEvent(getInternalState());
+
+        ++nEvalGradient; ++nEvalJacobian;
+        stat = calcConditionJacobian(goals, Jr, nEvalObjective);
+        if (stat == 0)
+            stat = calcConditionJacobian(assembler.errors, Jc, nEvalConstraints);
+        if (stat != 0)
+            return stat;
+        for (unsigned i=0, row=0; i < goals.size(); row += nResiduals[i++])
+            Jr((int)row,0,nResiduals[i],n) *= scale[i];
+
+        const Matrix A = ~Jr*Jr;
+        const Vector g = ~Jr*r;
+        if (lambda < 0) 
+            lambda = 1e-3 * std::max(Real(1), max(A.diag()));
+
+        // Look for a step that reduces the merit function, increasing the
+        // damping until we find one.
+        while (true) {
+            K(0,0,n,n) = A; 
+            for (int i=0; i < n; ++i)
+                K(i,i) += lambda;
+            if (m) {
+                K(n,0,m,n) = Jc; K(0,n,n,m) = ~Jc; K(n,n,m,m) = 0;
+            }
+            rhs(0,n) = g; rhs(n,m) = c; rhs.negateInPlace();
+            kkt.factor(K);
+            kkt.solve(rhs, sol);
+            const Vector dq = sol(0,n);
+            if (m) penalty = std::max(penalty, Real(1.1)*max(abs(sol(n,m))));
+            // The penalty may have just grown, so measure both the predicted
+            // and the actual reduction against the merit function using it.
+            const Real merit = cost + penalty*sum(abs(c));
+
+            xNew = x + dq;
+            if (assembler.lower.size()) // clamp to bounds
+                for (int i=0; i < n; ++i)
+                    xNew[i] = clamp(assembler.lower[i], xNew[i], 
+                                    assembler.upper[i]);
+
+            // Predict from the step actually taken, after clamping.
+            const Vector step = xNew - x;
+            const Real predicted = -(~g*step + (~step*(A*step))/2) 
+                + penalty*(sum(abs(c)) - sum(abs(c + Jc*step)));
+            // Nothing left to gain; we're at a (constrained) minimum.
+            if (predicted <= NTraits<Real>::getEps()*(1 + merit)) 
+            {   done = true; break; }
+
+            stat = calcLeastSquaresErrors(xNew, scale, nResiduals, rNew, cNew);
+            if (stat != 0)
+                return stat;
+            const Real costNew = rNew.normSqr()/2;
+            const Real actual = merit - (costNew + penalty*sum(abs(cNew)));
+            const Real rho = actual/predicted;
+
+            if (rho > Real(1e-4)) { // accept
+                lambda *= std::max(Real(1)/3, 1 - cube(2*rho-1)); nu = 2;
+                const bool smallStep = 
+                    max(abs(step)) <= acc*(acc + max(abs(x)));
+                const bool smallGain = cost - costNew <= acc*cost;
+                x = xNew; r = rNew; c = cNew; cost = costNew;
+                // Stop when feasible and the goal has stopped improving.
+                if (calcErrorNorm(c) <= tol && (smallStep || smallGain))
+                    done = true;
+                break;
+            }
+            lambda *= nu; nu *= 2;
+            if (lambda > MaxDamping) // no progress possible
+            {   done = true; break; }
+        }
+    }
+
+    freeQs = x;
+    setInternalStateFromFreeQs(freeQs);
+    return 0;
+}
+
 //------------------------------------------------------------------------------
 //                                 ASSEMBLER
 //------------------------------------------------------------------------------
 Assembler::Assembler(const MultibodySystem& system)
 :   system(system), accuracy(0), tolerance(0), // i.e., 1e-3, 1e-4
     forceNumericalGradient(false), forceNumericalJacobian(false), 
-    useRMSErrorNorm(false), alreadyInitialized(false), 
-    asmSys(0), optimizer(0), nAssemblySteps(0), nInitializations(0)
+    useRMSErrorNorm(false), useLevenbergMarquardt(false), 
+    alreadyInitialized(false), asmSys(0), optimizer(0), nAssemblySteps(0), 
+    nInitializations(0)
 {
     const SimbodyMatterSubsystem& matter = system.getMatterSubsystem();
     matter.convertToEulerAngles(system.getDefaultState(),
@@ -794,6 +986,20 @@ void Assembler::uninitialize() const {
     extraQsLocked.clear();
 }
 
+// Use the least squares solver if requested and all the goals can supply
+// errors; otherwise use the general purpose Optimizer.
+void Assembler::optimize(Vector& freeQs) const {
+    if (useLevenbergMarquardt) {
+        const int stat = asmSys->optimizeLeastSquares(freeQs);
+        SimTK_ERRCHK1_ALWAYS(stat == 0 || stat == -1, 
+            "Assembler::optimize()",
+            "An assembly condition returned status %d.", stat);
+        if (stat == 0)
+            return;
+    }
+    optimizer->optimize(freeQs);
+}
+
 Real Assembler::calcCurrentGoal() const {
     initialize();
     return asmSys->calcCurrentGoal();
@@ -857,7 +1063,7 @@ Real Assembler::assemble() {
     optimizer->setConvergenceTolerance(getAccuracyInUse());
     optimizer->setConstraintTolerance(getErrorToleranceInUse());
     try
-    {   optimizer->optimize(freeQs); }
+    {   optimize(freeQs); }
     catch (const std::exception& e)
     {   setInternalStateFromFreeQs(freeQs); // realizes to Stage::Position
 
@@ -942,7 +1148,7 @@ Real Assembler::track(Real frameTime) {
     optimizer->setConvergenceTolerance(getAccuracyInUse());
     optimizer->setConstraintTolerance(getErrorToleranceInUse());
     try
-    {   optimizer->optimize(freeQs); }
+    {   optimize(freeQs); }
     catch (const std::exception& e)
     {   setInternalStateFromFreeQs(freeQs); // realizes to Stage::Position
 
@@ -978,6 +1184,206 @@ Real Assembler::track(Real frameTime) {
     return calcCurrentGoal();
 }
 
+Assembler* Assembler::cloneForThread() const {
+    std::unique_ptr<Assembler> copy(new Assembler(system));
+    copy->accuracy               = accuracy;
+    copy->tolerance              = tolerance;
+    copy->forceNumericalGradient = forceNumericalGradient;
+    copy->forceNumericalJacobian = forceNumericalJacobian;
+    copy->useRMSErrorNorm        = useRMSErrorNorm;
+    copy->useLevenbergMarquardt  = useLevenbergMarquardt;
+    copy->internalState          = internalState;
+    copy->userLockedMobilizers   = userLockedMobilizers;
+    copy->userLockedQs           = userLockedQs;
+    copy->userRestrictedQs       = userRestrictedQs;
+
+    // The System's Constraints are always the first condition; the others
+    // are adopted in order so that they keep the same indices.
+    copy->weights[copy->systemConstraints] = weights[systemConstraints];
+    for (AssemblyConditionIndex acx(0); acx < conditions.size(); ++acx) {
+        if (acx == systemConstraints)
+            continue;
+        AssemblyCondition* cond = conditions[acx]->cloneForThread();
+        if (!cond)
+            return nullptr;
+        const AssemblyConditionIndex cx = 
+            copy->adoptAssemblyGoal(cond, weights[acx]);
+        SimTK_ASSERT2_ALWAYS(cx == acx, "Assembler::cloneForThread(): "
+            "condition %d was adopted by the copy as condition %d.",
+            (int)acx, (int)cx);
+    }
+    return copy.release();
+}
+
+void Assembler::trackFrame
+   (AssemblyConditionIndex markersIx, AssemblyConditionIndex osensorsIx,
+    const Array_< Array_<Vec3> >&       markerObservations,
+    const Array_< Array_<Rotation> >&   osensorObservations,
+    const Vector& frameTimes, int f, bool firstInChunk)
+{
+    if (markersIx.isValid())
+        static_cast<Markers*>(conditions[markersIx])
+            ->moveAllObservations(markerObservations[f]);
+    if (osensorsIx.isValid())
+        static_cast<OrientationSensors*>(conditions[osensorsIx])
+            ->moveAllObservations(osensorObservations[f]);
+
+    if (firstInChunk) {
+        if (frameTimes.size())
+            internalState.setTime(frameTimes[f]);
+        assemble();
+    } else 
+        track(frameTimes.size() ? frameTimes[f] : Real(-1));
+}
+
+namespace {
+// Task i solves the i'th chunk of frames, catching any exception so it can
+// be rethrown on the calling thread.
+class TrajectoryChunkTask : public ParallelExecutor::Task {
+public:
+    TrajectoryChunkTask(int numChunks, 
+                        const std::function<void(int)>& solveChunk)
+    :   solveChunk(solveChunk), errors(numChunks) {}
+
+    void execute(int i) override {
+        try {solveChunk(i);}
+        catch (...) {errors[i] = std::current_exception();}
+    }
+
+    // Rethrow the exception from the earliest chunk, if any, so the error
+    // reported doesn't depend on thread timing.
+    void rethrowFirstError() const {
+        for (const auto& e : errors)
+            if (e) std::rethrow_exception(e);
+    }
+private:
+    const std::function<void(int)>& solveChunk;
+    std::vector<std::exception_ptr> errors;
+};
+}
+
+Matrix Assembler::trackTrajectory
+   (const Array_< Array_<Vec3> >&       markerObservations,
+    const Array_< Array_<Rotation> >&   osensorObservations,
+    const Vector&                       frameTimes,
+    int                                 numThreads)
+{
+    SimTK_APIARGCHECK1_ALWAYS(numThreads >= 0, "Assembler", "trackTrajectory",
+        "The number of threads was %d but must be >= 0", numThreads);
+
+    // Find the first Markers and OrientationSensors conditions.
+    AssemblyConditionIndex markersIx, osensorsIx;
+    for (AssemblyConditionIndex acx(0); acx < conditions.size(); ++acx) {
+        if (!markersIx.isValid() 
+            && dynamic_cast<const Markers*>(conditions[acx]))
+            markersIx = acx;
+        if (!osensorsIx.isValid() 
+            && dynamic_cast<const OrientationSensors*>(conditions[acx]))
+            osensorsIx = acx;
+    }
+    SimTK_ERRCHK_ALWAYS(markerObservations.empty() || markersIx.isValid(),
+        "Assembler::trackTrajectory()",
+        "Marker observations were given but there is no Markers condition.");
+    SimTK_ERRCHK_ALWAYS(osensorObservations.empty() || osensorsIx.isValid(),
+        "Assembler::trackTrajectory()", "Orientation sensor observations"
+        " were given but there is no OrientationSensors condition.");
+    if (markerObservations.empty()) markersIx.invalidate();
+    if (osensorObservations.empty()) osensorsIx.invalidate();
+
+    const int nFrames = (int)std::max(markerObservations.size(), 
+                                      osensorObservations.size());
+    SimTK_ERRCHK2_ALWAYS(
+           (!markersIx.isValid()  || (int)markerObservations.size()==nFrames)
+        && (!osensorsIx.isValid() || (int)osensorObservations.size()==nFrames)
+        && (frameTimes.size()==0  || frameTimes.size()==nFrames),
+        "Assembler::trackTrajectory()", "The marker observations, orientation"
+        " sensor observations, and frame times must have the same number of"
+        " frames, but there were %d and %d frames of observations.",
+        (int)markerObservations.size(), (int)osensorObservations.size());
+
+    initialize();
+    const int nq = internalState.getNQ();
+    Matrix qs(nFrames, nq);
+    if (nFrames == 0)
+        return qs;
+
+    // Chunks are contiguous ranges of frames; chunk 0 is solved by this
+    // Assembler and the others by copies of it made now, before anything
+    // changes. We don't bother with very short chunks.
+    static const int MinFramesPerChunk = 10;
+    if (numThreads == 0)
+        numThreads = std::max(1, ParallelExecutor::getNumProcessors());
+    int numChunks = std::max(1, std::min(numThreads, 
+                                         nFrames/MinFramesPerChunk));
+    if (ParallelExecutor::isWorkerThread())
+        numChunks = 1;
+    std::vector<std::unique_ptr<Assembler>> copies;
+    for (int i=1; i < numChunks; ++i) {
+        Assembler* copy = cloneForThread();
+        if (!copy) {numChunks = 1; copies.clear(); break;}
+        copies.emplace_back(copy);
+    }
+    const auto firstFrame = [&](int chunk) 
+    {   return (int)((long long)nFrames*chunk/numChunks); };
+
+    const std::function<void(int)> solveChunk = [&](int chunk) {
+        Assembler& assembler = chunk ? *copies[chunk-1] : *this;
+        for (int f=firstFrame(chunk); f < firstFrame(chunk+1); ++f) {
+            assembler.trackFrame(markersIx, osensorsIx, markerObservations,
+                osensorObservations, frameTimes, f, 
+                chunk > 0 && f == firstFrame(chunk));
+            qs[f] = ~assembler.getInternalState().getQ();
+        }
+    };
+
+    if (numChunks == 1) 
+        solveChunk(0);
+    else {
+        TrajectoryChunkTask task(numChunks, solveChunk);
+        ParallelExecutor executor(numChunks);
+        executor.execute(task, numChunks);
+        task.rethrowFirstError();
+    }
+    copies.clear();
+
+    // Reconcile: re-track the frames after each chunk boundary starting
+    // from the previous frame's solution, until the result agrees with what
+    // the chunk found on its own. Then the rest of the chunk agrees too. 
+    const Real agreeTol = 10*getAccuracyInUse();
+    int reconciledThrough = firstFrame(1) - 1;
+    for (int chunk=1; chunk < numChunks; ++chunk) {
+        if (firstFrame(chunk) <= reconciledThrough)
+            continue; // already re-tracked past this boundary
+        int f = firstFrame(chunk);
+        internalState.updQ() = ~qs[f-1];
+        system.realize(internalState, Stage::Position);
+        for (; f < nFrames; ++f) {
+            trackFrame(markersIx, osensorsIx, markerObservations,
+                       osensorObservations, frameTimes, f, false);
+            const Vector& q = internalState.getQ();
+            const bool agrees = max(abs(q - ~qs[f])) <= agreeTol;
+            qs[f] = ~q;
+            if (agrees) break;
+        }
+        reconciledThrough = f;
+    }
+
+    // Leave the internal state at the last frame's solution.
+    if (reconciledThrough < nFrames-1) {
+        if (markersIx.isValid())
+            static_cast<Markers*>(conditions[markersIx])
+                ->moveAllObservations(markerObservations[nFrames-1]);
+        if (osensorsIx.isValid())
+            static_cast<OrientationSensors*>(conditions[osensorsIx])
+                ->moveAllObservations(osensorObservations[nFrames-1]);
+        if (frameTimes.size())
+            internalState.setTime(frameTimes[nFrames-1]);
+        internalState.updQ() = ~qs[nFrames-1];
+        system.realize(internalState, Stage::Position);
+    }
+    return qs;
+}
+
 int Assembler::getNumGoalEvals()  const 
 {   return asmSys ? asmSys->getNumObjectiveEvals() : 0;}
 int Assembler::getNumErrorEvals() const
@@ -134,18 +134,108 @@ int Markers::calcGoalGradient(const State& state, Vector& gradient) const {
     return 0;
 }
 
-// TODO: We want the constraint version to minimize the same goal as above. But
-// there can never be more than six independent constraints on the pose of
-// a rigid body; this method should attempt to produce a minimal set so that
-// the optimizer doesn't have to figure it out.
-int Markers::calcErrors(const State& state, Vector& err) const
-{   return AssemblyCondition::calcErrors(state,err); } //TODO
-
-
-int Markers::calcErrorJacobian(const State& state, Matrix& jacobian) const
-{   return AssemblyCondition::calcErrorJacobian(state,jacobian); } //TODO
-int Markers::getNumErrors(const State& state) const
-{   return AssemblyCondition::getNumErrors(state); } //TODO
+// As errors, each active marker contributes the three components of its
+// weighted position error sqrt(wi)*ri, in Ground, so that the sum of squares
+// of the errors is 2*sum(wi)*goal. A marker whose observation is missing
+// (NaN) contributes three zeros, so the number of errors stays the same from
+// frame to frame. This is not a minimal set: there can never be more than six
+// independent constraints on the pose of a rigid body.
+int Markers::calcErrors(const State& state, Vector& err) const {
+    const SimbodyMatterSubsystem& matter = getMatterSubsystem();
+    err.resize(getNumErrors(state));
+    int nxt = 0;
+    // Loop over each body that has one or more active markers.
+    PerBodyMarkers::const_iterator bodyp = bodiesWithMarkers.begin();
+    for (; bodyp != bodiesWithMarkers.end(); ++bodyp) {
+        const MobilizedBodyIndex    mobodIx     = bodyp->first;
+        const Array_<MarkerIx>&     bodyMarkers = bodyp->second;
+        const MobilizedBody&        mobod = matter.getMobilizedBody(mobodIx);
+        const Transform&            X_GB  = mobod.getBodyTransform(state);
+        // Loop over each marker on this body.
+        for (unsigned m=0; m < bodyMarkers.size(); ++m, nxt += 3) {
+            const Marker& marker = markers[bodyMarkers[m]];
+            const Vec3& location = 
+                observations[getObservationIxForMarker(bodyMarkers[m])];
+            Vec3::updAs(&err[nxt]) = location.isFinite()
+                ? std::sqrt(marker.weight)*(X_GB*marker.markerInB - location)
+                : Vec3(0);
+        }
+    }
+    assert(nxt == err.size());
+    return 0;
+}
+
+// d(sqrt(wi)*ri)/dq = sqrt(wi) * JSi * N^-1, where JSi is the station 
+// Jacobian of marker i (the partial velocity of the marker's location with
+// respect to the u's). We get the station Jacobians for all the markers at 
+// once, then multiply each row by N^-1 from the right, which is done as 
+// ~N^-1 times a column.
+int Markers::calcErrorJacobian(const State& state, Matrix& jacobian) const {
+    const SimbodyMatterSubsystem& matter = getMatterSubsystem();
+    const int np = getNumFreeQs();
+    const int nq = state.getNQ();
+    const int nerr = getNumErrors(state);
+    jacobian.resize(nerr, np);
+
+    Array_<MobilizedBodyIndex> onBody;
+    Array_<Vec3>               stations;
+    Array_<Real>               scale; // sqrt(weight), or 0 if not observed
+    PerBodyMarkers::const_iterator bodyp = bodiesWithMarkers.begin();
+    for (; bodyp != bodiesWithMarkers.end(); ++bodyp) {
+        const Array_<MarkerIx>& bodyMarkers = bodyp->second;
+        for (unsigned m=0; m < bodyMarkers.size(); ++m) {
+            const Marker& marker = markers[bodyMarkers[m]];
+            const Vec3& location = 
+                observations[getObservationIxForMarker(bodyMarkers[m])];
+            onBody.push_back(bodyp->first);
+            stations.push_back(marker.markerInB);
+            scale.push_back(location.isFinite() ? std::sqrt(marker.weight) 
+                                                : Real(0));
+        }
+    }
+    assert(3*(int)onBody.size() == nerr);
+    if (nerr == 0)
+        return 0;
+
+    Matrix JS; // nerr X nu
+    matter.calcStationJacobian(state, onBody, stations, JS);
+
+    Vector rowU(state.getNU()), rowQ(nq);
+    for (int i=0; i < nerr; ++i) {
+        const Real s = scale[i/3];
+        if (s == 0) {jacobian[i] = 0; continue;}
+        rowU = ~JS[i];
+        matter.multiplyByNInv(state, true, rowU, rowQ);
+        if (np == nq) // all the q's are free
+            jacobian[i] = s * ~rowQ;
+        else for (Assembler::FreeQIndex fx(0); fx < np; ++fx)
+            jacobian(i, fx) = s * rowQ[getQIndexOfFreeQ(fx)];
+    }
+    return 0;
+}
+
+// Three errors for every active marker, whether or not it is observed in
+// the current frame.
+int Markers::getNumErrors(const State& state) const {
+    int nActive = 0;
+    PerBodyMarkers::const_iterator bodyp = bodiesWithMarkers.begin();
+    for (; bodyp != bodiesWithMarkers.end(); ++bodyp)
+        nActive += (int)bodyp->second.size();
+    return 3*nActive;
+}
+
+// Copy the marker definitions, the observation correspondence, and the
+// current observations; the per-body grouping is rebuilt when the copy's
+// Assembler is initialized.
+AssemblyCondition* Markers::cloneForThread() const {
+    Markers* copy = new Markers();
+    copy->markers            = markers;
+    copy->markersByName      = markersByName;
+    copy->observation2marker = observation2marker;
+    copy->marker2observation = marker2observation;
+    copy->observations       = observations;
+    return copy;
+}
 
 // Run through all the Markers to find all the bodies that have at least one
 // active marker. For each of those bodies, we collect all its markers so that
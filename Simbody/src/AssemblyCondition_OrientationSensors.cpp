@@ -142,18 +142,149 @@ calcGoalGradient(const State& state, Vector& gradient) const {
     return 0;
 }
 
-// TODO: We want the constraint version to minimize the same goal as above. But
-// there can never be more than six independent constraints on the pose of
-// a rigid body; this method should attempt to produce a minimal set so that
-// the optimizer doesn't have to figure it out.
-int OrientationSensors::calcErrors(const State& state, Vector& err) const
-{   return AssemblyCondition::calcErrors(state,err); } //TODO
-
-
-int OrientationSensors::calcErrorJacobian(const State& state, Matrix& jacobian) const
-{   return AssemblyCondition::calcErrorJacobian(state,jacobian); } //TODO
-int OrientationSensors::getNumErrors(const State& state) const
-{   return AssemblyCondition::getNumErrors(state); } //TODO
+// As errors, each active osensor contributes the three components of its
+// weighted rotation vector sqrt(wi)*ai*ni, where ai and ni are the angle and
+// axis of the rotation R_SO from the sensor frame to its observed orientation,
+// expressed in S. The sum of squares of the errors is then 2*sum(wi)*goal. An
+// osensor whose observation is missing (NaN) contributes three zeros, so the 
+// number of errors stays the same from frame to frame. This is not a minimal
+// set: there can never be more than six independent constraints on the pose
+// of a rigid body.
+int OrientationSensors::calcErrors(const State& state, Vector& err) const {
+    const SimbodyMatterSubsystem& matter = getMatterSubsystem();
+    err.resize(getNumErrors(state));
+    int nxt = 0;
+    // Loop over each body that has one or more active osensors.
+    PerBodyOSensors::const_iterator bodyp = bodiesWithOSensors.begin();
+    for (; bodyp != bodiesWithOSensors.end(); ++bodyp) {
+        const MobilizedBodyIndex    mobodIx      = bodyp->first;
+        const Array_<OSensorIx>&    bodyOSensors = bodyp->second;
+        const MobilizedBody&        mobod = matter.getMobilizedBody(mobodIx);
+        const Rotation&             R_GB  = mobod.getBodyRotation(state);
+        // Loop over each osensor on this body.
+        for (unsigned m=0; m < bodyOSensors.size(); ++m, nxt += 3) {
+            const OSensorIx mx = bodyOSensors[m];
+            const OSensor&  osensor = osensors[mx];
+            const Rotation& R_GO = observations[getObservationIxForOSensor(mx)];
+            Vec3 a_SO(0);
+            if (R_GO.isFinite()) { // NaNs give zero error
+                const Rotation R_GS = R_GB * osensor.orientationInB;
+                const Rotation R_SO = ~R_GS*R_GO; // error, in S
+                const Vec4 aa_SO = R_SO.convertRotationToAngleAxis();
+                a_SO = std::sqrt(osensor.weight) * aa_SO[0]
+                       * aa_SO.getSubVec<3>(1);
+            }
+            Vec3::updAs(&err[nxt]) = a_SO;
+        }
+    }
+    assert(nxt == err.size());
+    return 0;
+}
+
+// The sensor frame S moves with body B, so with B's angular velocity w_GB 
+// the error rotation changes as dR_SO/dt = -[w_S] R_SO, where 
+// w_S = ~R_GS*w_GB. The rotation vector a of R_SO then changes as
+// da/dt = -inv(Jl(a)) w_S, with Jl the left Jacobian of SO(3):
+//      inv(Jl(a)) = I - 1/2 [a] + c(a) [a]^2,
+//      c(a) = 1/|a|^2 - (1+cos|a|) / (2|a| sin|a|).
+// We get w_GB's partial velocities from the frame Jacobian of each body and 
+// map the resulting rows from u to q by multiplying by N^-1 from the right.
+// c(a) is singular at |a| = pi, where the rotation vector is itself 
+// discontinuous; that is a poor place from which to assemble anyway.
+int OrientationSensors::
+calcErrorJacobian(const State& state, Matrix& jacobian) const {
+    const SimbodyMatterSubsystem& matter = getMatterSubsystem();
+    const int np = getNumFreeQs();
+    const int nq = state.getNQ();
+    const int nu = state.getNU();
+    const int nerr = getNumErrors(state);
+    jacobian.resize(nerr, np);
+    if (nerr == 0)
+        return 0;
+
+    // One frame Jacobian row per body with active osensors.
+    Array_<MobilizedBodyIndex> bodies;
+    Array_<Vec3>               origins;
+    PerBodyOSensors::const_iterator bodyp = bodiesWithOSensors.begin();
+    for (; bodyp != bodiesWithOSensors.end(); ++bodyp) {
+        bodies.push_back(bodyp->first);
+        origins.push_back(Vec3(0));
+    }
+    Matrix_<SpatialVec> JF; // nbodies X nu
+    matter.calcFrameJacobian(state, bodies, origins, JF);
+
+    Matrix dadu(3, nu);
+    Vector rowU(nu), rowQ(nq);
+    int nxt = 0, bx = 0;
+    for (bodyp = bodiesWithOSensors.begin(); bodyp != bodiesWithOSensors.end();
+         ++bodyp, ++bx)
+    {
+        const Array_<OSensorIx>& bodyOSensors = bodyp->second;
+        const MobilizedBody& mobod = matter.getMobilizedBody(bodyp->first);
+        const Rotation& R_GB = mobod.getBodyRotation(state);
+        for (unsigned m=0; m < bodyOSensors.size(); ++m, nxt += 3) {
+            const OSensorIx mx = bodyOSensors[m];
+            const OSensor&  osensor = osensors[mx];
+            const Rotation& R_GO = observations[getObservationIxForOSensor(mx)];
+            if (!R_GO.isFinite()) {
+                jacobian.updBlock(nxt, 0, 3, np) = 0;
+                continue;
+            }
+            const Rotation R_GS = R_GB * osensor.orientationInB;
+            const Rotation R_SO = ~R_GS*R_GO; // error, in S
+            const Vec4 aa_SO = R_SO.convertRotationToAngleAxis();
+            const Real angle = aa_SO[0];
+            const Vec3 a = angle * aa_SO.getSubVec<3>(1);
+            const Mat33 ax = crossMat(a);
+            // Use the series for c(a) near zero to avoid cancellation.
+            const Real c = angle < Real(1e-2)
+                ? Real(1)/12 + square(angle)/720
+                : 1/square(angle) 
+                  - (1+std::cos(angle))/(2*angle*std::sin(angle));
+            const Mat33 JlInv = Mat33(1) - ax/2 + c*(ax*ax);
+            const Mat33 dadw_G = -std::sqrt(osensor.weight) * JlInv * ~R_GS;
+            for (int j=0; j < nu; ++j) {
+                const Vec3 dadu_j = dadw_G * JF(bx,j)[0];
+                for (int i=0; i < 3; ++i)
+                    dadu(i,j) = dadu_j[i];
+            }
+
+            for (int i=0; i < 3; ++i) {
+                rowU = ~dadu[i];
+                matter.multiplyByNInv(state, true, rowU, rowQ);
+                if (np == nq) // all the q's are free
+                    jacobian[nxt+i] = ~rowQ;
+                else for (Assembler::FreeQIndex fx(0); fx < np; ++fx)
+                    jacobian(nxt+i, fx) = rowQ[getQIndexOfFreeQ(fx)];
+            }
+        }
+    }
+    assert(nxt == nerr);
+    return 0;
+}
+
+// Three errors for every active osensor, whether or not it is observed in
+// the current frame.
+int OrientationSensors::getNumErrors(const State& state) const {
+    int nActive = 0;
+    PerBodyOSensors::const_iterator bodyp = bodiesWithOSensors.begin();
+    for (; bodyp != bodiesWithOSensors.end(); ++bodyp)
+        nActive += (int)bodyp->second.size();
+    return 3*nActive;
+}
+
+// Copy the osensor definitions, the observation correspondence, and the
+// current observations; the per-body grouping is rebuilt when the copy's
+// Assembler is initialized.
+AssemblyCondition* OrientationSensors::cloneForThread() const {
+    OrientationSensors* copy = new OrientationSensors();
+    copy->osensors            = osensors;
+    copy->osensorsByName      = osensorsByName;
+    copy->observation2osensor = observation2osensor;
+    copy->osensor2observation = osensor2observation;
+    copy->observations        = observations;
+    return copy;
+}
 
 // Run through all the OSensors to find all the bodies that have at least one
 // active osensor. For each of those bodies, we collect all its osensors so that
@@ -36,6 +36,11 @@
 using std::cout; using std::endl;
 using namespace SimTK;
 
+// A geodesic no longer than this uses path binormals rather than geodesic
+// binormals for its tangent errors. calcSurfacePathError(), its Jacobian, and
+// its time derivative must all make the same choice, so they share this.
+static const Real ShortLength = Real(1e-3);
+
 //==============================================================================
 //            PATH INSTANCE INFO / POS ENTRY / VEL ENTRY
 //==============================================================================
@@ -77,7 +82,8 @@ std::ostream& operator<<(std::ostream& o, const PathInstanceInfo& info) {
 }
 
 std::ostream& operator<<(std::ostream& o, const PathPosEntry& ppe) {
-    cout << "PathPosEntry: length=" << ppe.length << endl;
+    cout << "PathPosEntry: length=" << ppe.length 
+         << " solveTime=" << ppe.solveTime << endl;
     cout << "mapToActive: " << ppe.mapToActive << endl;
     cout << "mapToActiveSurface: " << ppe.mapToActiveSurface << endl;
     cout << "mapToCoords: " << ppe.mapToCoords << endl;
@@ -167,6 +173,9 @@ Real CablePath::getCableLength(const State& state) const
 Real CablePath::getCableLengthDot(const State& state) const 
 {   return getImpl().getCableLengthDot(state); }
 
+Real CablePath::getPathSolveTime(const State& state) const 
+{   return getImpl().getPathSolveTime(state); }
+
 void CablePath::applyBodyForces(const State& state, Real tension, 
                      Vector_<SpatialVec>& bodyForcesInG) const
 {   getImpl().applyBodyForces(state,tension,bodyForcesInG); }
@@ -613,6 +622,8 @@ ensurePositionKinematicsCalculated(const State& state) const {
     if (cables->isDiscreteVarUpdateValueRealized(state, posEntryIx))
         return;
 
+    const double startTime = realTime();
+
     const PathInstanceInfo& instInfo = getInstanceInfo(state);
     const PathPosEntry&     prevPPE  = getPrevPosEntry(state);
     PathPosEntry&           ppe      = updPosEntry(state);
@@ -667,6 +678,7 @@ ensurePositionKinematicsCalculated(const State& state) const {
         eventTriggers[eventIx+i] = ppe.witnesses[i];
     }
 
+    ppe.solveTime = Real(realTime() - startTime);
     cables->markDiscreteVarUpdateValueRealized(state, posEntryIx);
 }
 
@@ -726,35 +738,6 @@ ensureVelocityKinematicsCalculated(const State& state) const {
     cables->markDiscreteVarUpdateValueRealized(state, velEntryIx);
 }
 
-// Numerical Jacobian calculation.
-
-class PathError : public Differentiator::JacobianFunction {
-public:
-    // Caution: we're holding references.
-    PathError(int nx, 
-              const CablePath::Impl&  path,
-              const State&            state,
-              const PathInstanceInfo& instInfo,
-              const PathPosEntry&     ppe, 
-              Real                    accuracy)
-    :   Differentiator::JacobianFunction(nx, nx), path(path),
-        state(state),instInfo(instInfo),localPpe(ppe)
-    {   setEstimatedAccuracy(accuracy); }
-
-    int f(const Vector& x, Vector& fx) const override {
-        localPpe.x = x;
-        path.calcPathError(state, instInfo, localPpe);
-        fx = localPpe.err;
-        return 0;
-    }
-
-private:
-    const CablePath::Impl&  path;
-    const State&            state;
-    const PathInstanceInfo& instInfo;
-    mutable PathPosEntry    localPpe;
-};
-
 //------------------------------------------------------------------------------
 //                         PROJECT ONTO SURFACE
 //------------------------------------------------------------------------------
@@ -811,11 +794,6 @@ solveForPathPoints(const State& state, const PathInstanceInfo& instInfo,
     const Real ftol = Real(1e-12)*1000; // TODO
     const Real xtol = Real(1e-12)*1000;
 
-    const Real estimatedPathErrorAccuracy = ftol;
-    PathError pathErrorFnc(ppe.x.size(), *this, state, instInfo, ppe, 
-                           estimatedPathErrorAccuracy);
-    Differentiator diff(pathErrorFnc);
-
     Vector dx, xold, xchg;
 
     Real f = ppe.err.norm();
@@ -836,16 +814,12 @@ solveForPathPoints(const State& state, const PathInstanceInfo& instInfo,
         }
         //cout << "obstacle err = " << f << ", x = " << ppe.x << endl;
 
-        //diff.calcJacobian(ppe.x, ppe.err, ppe.J, 
-        //                  Differentiator::ForwardDifference);
-       // Matrix Jnum = ppe.J;
+        // The Jacobian is assembled from per-obstacle blocks computed
+        // analytically from the geodesics found by calcPathError(), so this
+        // doesn't shoot any more geodesics.
         calcPathErrorJacobian(state, instInfo, ppe);
 
-        //cout << "DIFF J=" << Jnum-ppe.J;
-        //cout << "DIFF NORM=" << (Jnum-ppe.J).norm() << "\n";
-
         ppe.JInv.factor(ppe.J);
-        //ppe.JInv.factor(Jnum);
 
         fold = f;
         xold = ppe.x;
@@ -1436,20 +1410,8 @@ Vec6 CableObstacle::Surface::Impl::calcSurfacePathError
     //XXX 
     //signP = signQ = 1;
 
-    // If length is very short, or geodesic is backwards, use path binormals
-    // rather than geodesic binormals.
-    const Real ShortLength = Real(1e-3);
-    if (length <= ShortLength)
-        cout << "==> Using short formulation for length=" << length << endl;
-    if (signP < 0 || signQ < 0) { 
-        cout << "==> Backwards geodesic with length=" << length 
-             << " eIn*tP=" << ~eIn*tP << " eOut*tQ=" << ~eOut*tQ << endl;
-        if (signP != signQ) {
-            cout <<"    Mismatch eIn="<<eIn << " eOut="<<eOut<<endl;
-            cout <<"             tP=" <<tP << " tQ="<<tQ<<endl;
-        }
-    }
-
+    // If length is very short use path binormals rather than geodesic
+    // binormals; a backwards geodesic is handled by the signs above.
     const Vec3 bbarP = length<=ShortLength ? eOut % nP : Vec3(bP);
     const Vec3 bbarQ = length<=ShortLength ? eIn  % nQ : Vec3(bQ);
 
@@ -1457,8 +1419,8 @@ Vec6 CableObstacle::Surface::Impl::calcSurfacePathError
     err[0] = ~eIn*nP;   // tangent error in normal direction
     err[1] = ~eOut*nQ;
     
-    err[2] = ~eIn*bbarP;   // tangent errors in geodesic direction
-    err[3] = ~eOut*bbarQ;
+    err[2] = signP*(~eIn*bbarP);   // tangent errors in geodesic direction
+    err[3] = signQ*(~eOut*bbarQ);
 
     // These are the implicit surface errors forcing P and Q to lie on the
     // surface.
@@ -1510,34 +1472,48 @@ calcSurfacePathErrorJacobianAnalytically
     const Real muP = current.getBinormalCurvatureP(),
                muQ = current.getBinormalCurvatureQ();
 
-    DerrDentry = Mat63( ~nP,    Row3(0), signP*~bP,   Row3(0), Row3(0), Row3(0) );
-    DerrDexit  = Mat63( Row3(0), ~nQ,   Row3(0), signP*~bQ,    Row3(0), Row3(0) );
     const Vec3 gP = surface.calcSurfaceGradient(xP),
                gQ = surface.calcSurfaceGradient(xQ);
     const Mat33 HP = surface.calcSurfaceHessian(xP),
                 HQ = surface.calcSurfaceHessian(xQ);
-    const Real oojP = std::abs(jP) < SqrtEps ? Real(0) : 1/jP, 
-               oojQ = std::abs(jQ) < SqrtEps ? Real(0) : 1/jQ;
     const Mat33 DnPDxP = (Mat33(1) - nP*~nP)*HP / (~gP*nP),
                 DnQDxQ = (Mat33(1) - nQ*~nQ)*HQ / (~gQ*nQ);
+
+    // The normal tangent errors and the implicit surface errors are the same
+    // for either formulation of the binormal tangent errors.
+    DerrDentry = Mat63( ~nP,    Row3(0), Row3(0), Row3(0), Row3(0), Row3(0) );
+    DerrDexit  = Mat63( Row3(0), ~nQ,    Row3(0), Row3(0), Row3(0), Row3(0) );
+    DerrDxP    = Mat63( ~eIn*DnPDxP, Row3(0), Row3(0), Row3(0), ~gP, Row3(0) );
+    DerrDxQ    = Mat63( Row3(0), ~eOut*DnQDxQ, Row3(0), Row3(0), Row3(0), ~gQ );
+
+    // This must match the choice of binormals in calcSurfacePathError().
+    if (current.getLength() <= ShortLength) {
+        // err2 = eIn.(eOut x nP), err3 = eOut.(eIn x nQ). These depend on the
+        // geodesic only through the surface normals at P and Q.
+        DerrDentry[2] =  signP*~(eOut % nP);
+        DerrDexit[2]  =  signP*~(nP % eIn);
+        DerrDxP[2]    =  signP*(~(eIn % eOut) * DnPDxP);
+        DerrDentry[3] =  signQ*~(nQ % eOut);
+        DerrDexit[3]  =  signQ*~(eIn % nQ);
+        DerrDxQ[3]    =  signQ*(~(eOut % eIn) * DnQDxQ);
+        return;
+    }
+
+    // Moving P or Q changes the geodesic; the resulting rotation of the
+    // binormals at both ends is given by the Jacobi field along it.
+    const Real oojP = std::abs(jP) < SqrtEps ? Real(0) : 1/jP, 
+               oojQ = std::abs(jQ) < SqrtEps ? Real(0) : 1/jQ;
     const Mat33 DbPDxP = -tauP*nP*~tP - (oojP*jdP*tP + muP*nP)*~bP,
                 DbQDxQ = -tauQ*nQ*~tQ - (oojQ*jdQ*tQ + muQ*nQ)*~bQ;
     const Mat33 DbPDxQ = -oojQ*tP*~bQ,
                 DbQDxP =  oojP*tQ*~bP;
 
-    DerrDxP = Mat63( ~eIn  * DnPDxP,
-                         Row3(0),
-                     signP*(~eIn  * DbPDxP),
-                     signQ*(~eOut * DbQDxP),
-                          ~gP,
-                         Row3(0)    );
-
-    DerrDxQ = Mat63(     Row3(0),
-                     ~eOut * DnQDxQ,
-                     signP*(~eIn  * DbPDxQ),
-                     signQ*(~eOut * DbQDxQ),
-                         Row3(0),
-                          ~gQ       );
+    DerrDentry[2] = signP*~bP;
+    DerrDexit[3]  = signQ*~bQ;
+    DerrDxP[2]    = signP*(~eIn  * DbPDxP);
+    DerrDxP[3]    = signQ*(~eOut * DbQDxP);
+    DerrDxQ[2]    = signP*(~eIn  * DbPDxQ);
+    DerrDxQ[3]    = signQ*(~eOut * DbQDxQ);
 }
 
 //------------------------------------------------------------------------------
@@ -1574,8 +1550,13 @@ Vec6 CableObstacle::Surface::Impl::calcSurfaceNegKinematicVelocityError
     // error calculation, but negated.
     errdotK[0] = - ~eInDot*nP; 
     errdotK[1] = - ~eOutDot*nQ;
-    errdotK[2] = -signP*(~eInDot*bP);
-    errdotK[3] = -signQ*(~eOutDot*bQ);
+    if (geodesic.getLength() <= ShortLength) {
+        errdotK[2] = -signP*(~eInDot*(eOut % nP) + ~eIn*(eOutDot % nP));
+        errdotK[3] = -signQ*(~eOutDot*(eIn % nQ) + ~eOut*(eInDot % nQ));
+    } else {
+        errdotK[2] = -signP*(~eInDot*bP);
+        errdotK[3] = -signQ*(~eOutDot*bQ);
+    }
     // Implicit surface error is frozen since xP and xQ are.
     errdotK[4] = 0;
     errdotK[5] = 0;
@@ -104,7 +104,7 @@ public:
 // quantities.
 class PathPosEntry {
 public:
-    PathPosEntry() : length(NaN) {}
+    PathPosEntry() : length(NaN), solveTime(0) {}
 
     // Set the number of obstacles to n. If there is any information already
     // in this object, it is lost.
@@ -154,6 +154,9 @@ public:
     // configuration and values for contact point coordinates x stored here.
     Real length;
 
+    // Wall-clock time in seconds spent calculating this entry.
+    Real solveTime;
+
     //                         ALL OBSTACLES
 
     // Map each cable obstacle to its ActiveObstacleIndex if it is currently
@@ -414,6 +417,11 @@ public:
         return posEntry.length;
     }
 
+    Real getPathSolveTime(const State& state) const {
+        const PathPosEntry& posEntry = getPosEntry(state);
+        return posEntry.solveTime;
+    }
+
     Real getCableLengthDot(const State& state) const {
         const PathVelEntry& velEntry = getVelEntry(state);
         return velEntry.lengthDot;
@@ -31,11 +31,66 @@
 #include "CableTrackerSubsystem_Impl.h"
 
 #include <cassert>
+#include <exception>
 #include <iostream>
+#include <vector>
 using std::cout; using std::endl;
 
 using namespace SimTK;
 
+namespace {
+// Task k solves for the k'th cable path, catching any exception so it can be
+// rethrown on the calling thread.
+class RealizePathPositionTask : public ParallelExecutor::Task {
+public:
+    RealizePathPositionTask(const Array_<CablePath,CablePathIndex>& paths,
+                            const State& state)
+    :   paths(paths), state(state), errors(paths.size()) {}
+
+    void execute(int k) override {
+        try {paths[CablePathIndex(k)].getImpl().realizePosition(state);}
+        catch (...) {errors[k] = std::current_exception();}
+    }
+
+    // Rethrow the exception from the lowest-numbered path, if any, so the
+    // error reported doesn't depend on thread timing.
+    void rethrowFirstError() const {
+        for (const auto& e : errors)
+            if (e) std::rethrow_exception(e);
+    }
+private:
+    const Array_<CablePath,CablePathIndex>& paths;
+    const State&                            state;
+    std::vector<std::exception_ptr>         errors;
+};
+}
+
+//==============================================================================
+//                     CABLE TRACKER SUBSYSTEM :: IMPL
+//==============================================================================
+// Each path's position kinematics lives in its own discrete variable update
+// value and depends only on already-realized matter kinematics, and each 
+// obstacle owns its own copy of its ContactGeometry, so the paths can be 
+// solved independently. We don't try to do that from inside another
+// ParallelExecutor's worker thread.
+int CableTrackerSubsystem::Impl::
+realizeSubsystemPositionImpl(const State& state) const {
+    const int nPaths = cablePaths.size();
+    if (nPaths > 1 && pathExecutor && pathExecutor->getMaxThreads() > 1
+        && !ParallelExecutor::isWorkerThread()) {
+        RealizePathPositionTask task(cablePaths, state);
+        pathExecutor->execute(task, nPaths);
+        task.rethrowFirstError();
+        return 0;
+    }
+
+    for (CablePathIndex ix(0); ix < cablePaths.size(); ++ix) {
+        const CablePath& path = getCablePath(ix);
+        path.getImpl().realizePosition(state);
+    }
+    return 0;
+}
+
 //==============================================================================
 //                        CABLE TRACKER SUBSYSTEM
 //==============================================================================
@@ -85,3 +140,9 @@ CablePath& CableTrackerSubsystem::
 updCablePath(CablePathIndex cableIx)
 {   return updImpl().updCablePath(cableIx); }
 
+void CableTrackerSubsystem::setNumberOfThreads(unsigned numThreads)
+{   updImpl().setNumberOfThreads(numThreads); }
+
+int CableTrackerSubsystem::getNumberOfThreads() const
+{   return getImpl().getNumberOfThreads(); }
+
@@ -47,7 +47,9 @@ namespace SimTK {
 class CableTrackerSubsystem::Impl : public Subsystem::Guts {
 public:
 // Constructor registers a default set of Trackers to use with geometry
-// we know about. These can be overridden later.
+// we know about. These can be overridden later. Paths are solved serially
+// unless setNumberOfThreads() asks for more than one thread; we don't start
+// a thread pool for every model that has cables.
 Impl() {}
 
 ~Impl() {}
@@ -69,6 +71,17 @@ CablePathIndex adoptCablePath(CablePath& path) {
     return CablePathIndex(cablePaths.size()-1);
 }
 
+void setNumberOfThreads(unsigned numThreads) {
+    SimTK_APIARGCHECK_ALWAYS(numThreads > 0, "CableTrackerSubsystem::Impl",
+                "setNumberOfThreads", "Number of threads must be positive");
+    if (numThreads == 1) pathExecutor.reset();
+    else pathExecutor = new ParallelExecutor(numThreads);
+}
+
+int getNumberOfThreads() const {
+    return pathExecutor ? pathExecutor->getMaxThreads() : 1;
+}
+
 // Return the MultibodySystem which owns this CableTrackerSubsystem.
 const MultibodySystem& getMultibodySystem() const 
 {   return MultibodySystem::downcast(getSystem()); }
@@ -124,13 +137,9 @@ int realizeSubsystemInstanceImpl(const State& state) const override {
     return 0;
 }
 
-int realizeSubsystemPositionImpl(const State& state) const override {
-    for (CablePathIndex ix(0); ix < cablePaths.size(); ++ix) {
-        const CablePath& path = getCablePath(ix);
-        path.getImpl().realizePosition(state);
-    }
-    return 0;
-}
+// Solving for a path touches only that path's own cache entries and 
+// obstacles, so the paths are solved concurrently; see the .cpp file.
+int realizeSubsystemPositionImpl(const State& state) const override;
 
 int realizeSubsystemVelocityImpl(const State& state) const override {
     for (CablePathIndex ix(0); ix < cablePaths.size(); ++ix) {
@@ -260,6 +269,10 @@ SimTK_DOWNCAST(Impl, Subsystem::Guts);
 private:
 // TOPOLOGY STATE
 Array_<CablePath, CablePathIndex> cablePaths;
+
+// Used to solve for the paths concurrently at Position stage.
+// Empty when solving serially.
+mutable ClonePtr<ParallelExecutor> pathExecutor;
 };
 
 } // namespace SimTK
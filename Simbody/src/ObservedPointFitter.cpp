@@ -28,7 +28,11 @@
 #include "simbody/internal/MultibodySystem.h"
 #include "simbody/internal/ObservedPointFitter.h"
 #include "simbody/internal/SimbodyMatterSubsystem.h"
+#include <exception>
+#include <functional>
 #include <map>
+#include <memory>
+#include <vector>
 
 using namespace SimTK;
 
@@ -95,13 +99,20 @@ public:
         constraints = state.getQErr();
         return 0;
     }
+    // We always fit with Euler angles, so the only qerrs are the position
+    // constraint errors, whose Jacobian is Pq.
+    int constraintJacobian(const Vector& parameters, bool new_parameters, Matrix& jac) const override {
+        state.updQ() = parameters;
+        system.realize(state, Stage::Position);
+        system.getMatterSubsystem().calcPq(state, jac);
+        return 0;
+    }
     void optimize(Vector& q, Real tolerance) {
         Optimizer opt(*this
             //, LBFGSB // XXX
             //, InteriorPoint // XXX
             );
         //opt.useNumericalGradient(true); //XXX
-        opt.useNumericalJacobian(true);
         opt.setConvergenceTolerance(tolerance);
         opt.setMaxIterations(3000);
         opt.setLimitedMemoryHistory(40);
@@ -117,6 +128,47 @@ private:
     mutable State state;
 };
 
+namespace {
+// One of the subproblems solved to estimate the q's of a single body, using
+// a cloned system containing that body and some of its neighbors.
+struct SubtreeFit {
+    MobilizedBodyIndex          bodyIx;
+    Array_<MobilizedBodyIndex>  originalBodyIxs;
+    Array_<MobilizedBodyIndex>  copyBodyIxs;
+    bool                        hasArtificialBaseBody = false;
+    MultibodySystem             copy;
+    State                       copyState;
+    Array_<Array_<Vec3> >       copyStations;
+    Array_<Array_<Vec3> >       copyTargetLocations;
+    Array_<Array_<Real> >       copyWeights;
+    bool                        succeeded = false;
+    String                      failure; // the optimizer's message
+};
+
+// Task k solves the k'th fit, catching any exception so it can be rethrown
+// on the calling thread.
+class SubtreeFitTask : public ParallelExecutor::Task {
+public:
+    SubtreeFitTask(int numFits, const std::function<void(int)>& solveFit)
+    :   solveFit(solveFit), errors(numFits) {}
+
+    void execute(int k) override {
+        try {solveFit(k);}
+        catch (...) {errors[k] = std::current_exception();}
+    }
+
+    // Rethrow the exception from the earliest fit, if any, so the error
+    // reported doesn't depend on thread timing.
+    void rethrowFirstError() const {
+        for (const auto& e : errors)
+            if (e) std::rethrow_exception(e);
+    }
+private:
+    const std::function<void(int)>& solveFit;
+    std::vector<std::exception_ptr> errors;
+};
+}
+
 /**
  * Create a new MultibodySystem which is identical to a subset of the original MultibodySystem.  This is called once for each MobilizedBody
  * in the original system, and is used to find an initial estimate of that MobilizedBody's conformation.
@@ -283,69 +335,109 @@ Real ObservedPointFitter::findBestFit
     for (MobilizedBodyIndex mbx(1); mbx < guessX_GB.size(); ++mbx)
         guessX_GB[mbx] = matter.getMobilizedBody(mbx).getBodyTransform(tempState);
 
-    for (int i = 0; i < matter.getNumBodies(); ++i) {
-        MobilizedBodyIndex id(i);
+    // A body's subproblem starts from the estimates for its ancestors, so we
+    // work down the tree a level at a time. The subproblems for the bodies
+    // at one level are independent, so those are solved concurrently. The
+    // results are then copied back in body order, so they don't depend on
+    // thread timing. Level 0 is just Ground.
+    Array_<Array_<MobilizedBodyIndex> > bodiesAtLevel(1);
+    Array_<int> level(matter.getNumBodies(), 0);
+    for (MobilizedBodyIndex id(1); id < matter.getNumBodies(); ++id) {
         const MobilizedBody& body = matter.getMobilizedBody(id);
-        if (body.getNumQ(tempState) == 0)
-            continue; // No degrees of freedom to determine.
-        if (children[id].size() == 0 && numStations[id] == 0)
-            continue; // There are no stations whose positions are affected by this.
-        Array_<MobilizedBodyIndex> originalBodyIxs;
-        int currentBodyIndex = findBodiesForClonedSystem(body.getMobilizedBodyIndex(), numStations, matter, children, originalBodyIxs);
-        if (currentBodyIndex == (int)originalBodyIxs.size()-1 
-            && (bodyIndex[id] == -1 || stations[bodyIndex[id]].size() == 0))
-            continue; // There are no stations whose positions are affected by this.
-        MultibodySystem copy;
-        Array_<MobilizedBodyIndex> copyBodyIxs;
-        bool hasArtificialBaseBody;
-        createClonedSystem(system, copy, originalBodyIxs, copyBodyIxs, hasArtificialBaseBody);
-        const SimbodyMatterSubsystem& copyMatter = copy.getMatterSubsystem();
-        // Construct an initial state.
-        State copyState = copy.getDefaultState();
-        assert(copyBodyIxs.size() == originalBodyIxs.size());
-        for (int ob=0; ob < (int)originalBodyIxs.size(); ++ob) {
-            const MobilizedBody& copyMobod = copyMatter.getMobilizedBody(copyBodyIxs[ob]);
-            const MobilizedBody& origMobod = matter.getMobilizedBody(originalBodyIxs[ob]);
-            if (ob==0 && hasArtificialBaseBody)
-                copyMobod.setQToFitTransform(copyState, guessX_GB[origMobod.getMobilizedBodyIndex()]);
-            else
-                copyMobod.setQFromVector(copyState, origMobod.getQAsVector(tempState));
+        level[id] = 1 + level[body.getParentMobilizedBody().getMobilizedBodyIndex()];
+        if (level[id] == (int)bodiesAtLevel.size())
+            bodiesAtLevel.push_back(Array_<MobilizedBodyIndex>());
+        bodiesAtLevel[level[id]].push_back(id);
+    }
+
+    for (int lev = 1; lev < (int)bodiesAtLevel.size(); ++lev) {
+        std::vector<std::unique_ptr<SubtreeFit> > fits;
+        for (MobilizedBodyIndex id : bodiesAtLevel[lev]) {
+            const MobilizedBody& body = matter.getMobilizedBody(id);
+            if (body.getNumQ(tempState) == 0)
+                continue; // No degrees of freedom to determine.
+            if (children[id].size() == 0 && numStations[id] == 0)
+                continue; // There are no stations whose positions are affected by this.
+            Array_<MobilizedBodyIndex> originalBodyIxs;
+            int currentBodyIndex = findBodiesForClonedSystem(body.getMobilizedBodyIndex(), numStations, matter, children, originalBodyIxs);
+            if (currentBodyIndex == (int)originalBodyIxs.size()-1 
+                && (bodyIndex[id] == -1 || stations[bodyIndex[id]].size() == 0))
+                continue; // There are no stations whose positions are affected by this.
+            fits.emplace_back(new SubtreeFit);
+            SubtreeFit& fit = *fits.back();
+            fit.bodyIx = id;
+            fit.originalBodyIxs = originalBodyIxs;
+            createClonedSystem(system, fit.copy, originalBodyIxs, fit.copyBodyIxs, fit.hasArtificialBaseBody);
+            const SimbodyMatterSubsystem& copyMatter = fit.copy.getMatterSubsystem();
+            // Construct an initial state.
+            fit.copyState = fit.copy.getDefaultState();
+            assert(fit.copyBodyIxs.size() == originalBodyIxs.size());
+            for (int ob=0; ob < (int)originalBodyIxs.size(); ++ob) {
+                const MobilizedBody& copyMobod = copyMatter.getMobilizedBody(fit.copyBodyIxs[ob]);
+                const MobilizedBody& origMobod = matter.getMobilizedBody(originalBodyIxs[ob]);
+                if (ob==0 && fit.hasArtificialBaseBody)
+                    copyMobod.setQToFitTransform(fit.copyState, guessX_GB[origMobod.getMobilizedBodyIndex()]);
+                else
+                    copyMobod.setQFromVector(fit.copyState, origMobod.getQAsVector(tempState));
+            }
+
+            fit.copyStations.resize(copyMatter.getNumBodies());
+            fit.copyTargetLocations.resize(copyMatter.getNumBodies());
+            fit.copyWeights.resize(copyMatter.getNumBodies());
+            for (int j = 0; j < (int)originalBodyIxs.size(); ++j) {
+                int index = bodyIndex[originalBodyIxs[j]];
+                if (index != -1) {
+                    fit.copyStations[fit.copyBodyIxs[j]] = stations[index];
+                    fit.copyTargetLocations[fit.copyBodyIxs[j]] = targetLocations[index];
+                    fit.copyWeights[fit.copyBodyIxs[j]] = weights[index];
+                }
+            }
         }
 
-        Array_<Array_<Vec3> > copyStations(copyMatter.getNumBodies());
-        Array_<Array_<Vec3> > copyTargetLocations(copyMatter.getNumBodies());
-        Array_<Array_<Real> > copyWeights(copyMatter.getNumBodies());
-        for (int j = 0; j < (int)originalBodyIxs.size(); ++j) {
-            int index = bodyIndex[originalBodyIxs[j]];
-            if (index != -1) {
-                copyStations[copyBodyIxs[j]] = stations[index];
-                copyTargetLocations[copyBodyIxs[j]] = targetLocations[index];
-                copyWeights[copyBodyIxs[j]] = weights[index];
+        // Each fit touches only its own cloned system.
+        const std::function<void(int)> solveFit = [&](int k) {
+            SubtreeFit& fit = *fits[k];
+            try {
+                OptimizerFunction optimizer(fit.copy, fit.copyState, fit.copyBodyIxs, fit.copyStations, fit.copyTargetLocations, fit.copyWeights);
+                Vector q(fit.copyState.getQ());
+                optimizer.optimize(q, tolerance);
+                fit.copyState.updQ() = q;
+                fit.copy.realize(fit.copyState, Stage::Position);
+                fit.succeeded = true;
             }
+            catch (const Exception::OptimizerFailed& ex) {
+                fit.failure = ex.getMessage();
+            }
+        };
+        if (fits.size() > 1 && !ParallelExecutor::isWorkerThread()) {
+            SubtreeFitTask task((int)fits.size(), solveFit);
+            ParallelExecutor executor;
+            executor.execute(task, (int)fits.size());
+            task.rethrowFirstError();
+        }
+        else {
+            for (int k = 0; k < (int)fits.size(); ++k)
+                solveFit(k);
         }
-        try {
-            OptimizerFunction optimizer(copy, copyState, copyBodyIxs, copyStations, copyTargetLocations, copyWeights);
-            Vector q(copyState.getQ());
-            //std::cout << "BODY " << i << " q0=" << q << std::endl;
-            optimizer.optimize(q, tolerance);
-            //std::cout << "  qf=" << q << std::endl;
-            copyState.updQ() = q;
-            copy.realize(copyState, Stage::Position);
+
+        for (const auto& fitp : fits) {
+            const SubtreeFit& fit = *fitp;
+            if (!fit.succeeded) {
+                std::cout << "Optimization failure for body "<<fit.bodyIx<<": "<<fit.failure << std::endl;
+                // Just leave this body's state variables set to 0, and rely on the final optimization to fix them.
+                continue;
+            }
             // Transfer updated state back to tempState as improved initial guesses.
             // However, all but the currentBody will get overwritten later.
-            for (int ob=0; ob < (int)originalBodyIxs.size(); ++ob) {
-                const MobilizedBody& copyMobod = copyMatter.getMobilizedBody(copyBodyIxs[ob]);
-                guessX_GB[originalBodyIxs[ob]] = copyMobod.getBodyTransform(copyState);
+            const SimbodyMatterSubsystem& copyMatter = fit.copy.getMatterSubsystem();
+            for (int ob=0; ob < (int)fit.originalBodyIxs.size(); ++ob) {
+                const MobilizedBody& copyMobod = copyMatter.getMobilizedBody(fit.copyBodyIxs[ob]);
+                guessX_GB[fit.originalBodyIxs[ob]] = copyMobod.getBodyTransform(fit.copyState);
 
-                if (ob==0 && hasArtificialBaseBody) continue; // leave default state
-                const MobilizedBody& origMobod = matter.getMobilizedBody(originalBodyIxs[ob]);
-                origMobod.setQFromVector(tempState, copyMobod.getQAsVector(copyState));
+                if (ob==0 && fit.hasArtificialBaseBody) continue; // leave default state
+                const MobilizedBody& origMobod = matter.getMobilizedBody(fit.originalBodyIxs[ob]);
+                origMobod.setQFromVector(tempState, copyMobod.getQAsVector(fit.copyState));
             }
-            //body.setQFromVector(tempState, copyMatter.getMobilizedBody(copyBodyIxs[currentBodyIndex]).getQAsVector(copyState));
-        }
-        catch (const Exception::OptimizerFailed& ex) {
-            std::cout << "Optimization failure for body "<<i<<": "<<ex.getMessage() << std::endl;
-            // Just leave this body's state variables set to 0, and rely on the final optimization to fix them.
         }
     }
 
@@ -477,6 +477,11 @@ int SimbodyMatterSubsystemRep::realizeSubsystemTopologyImpl(State& s) const {
         allocateLazyCacheEntry(s, Stage::Dynamics,
                                new Value<SBConstrainedAccelerationCache>());
 
+    // Factorizations reused by the constraint multiplier and impulse solves.
+    tc.constraintSolverWorkspaceIndex =
+        allocateLazyCacheEntry(s, Stage::Instance,
+                               new Value<SBConstraintSolverWorkspace>());
+
     tc.valid = true;
 
     // Allocate a cache entry for the topologyCache, and save a copy there.
@@ -3559,6 +3564,68 @@ calcGMInvGt(const State&   s,
 
 
 
+// =============================================================================
+//                         SOLVE WITH G*M^-1*~G
+// =============================================================================
+// G*M^-1*~G is symmetric and positive semidefinite when the constraint forces
+// are ~G*lambda, and positive definite unless there are redundant constraints.
+// But it need not be symmetric in general: some constraints (sliding friction,
+// Constraint::Custom implementations) apply forces that are not ~G*lambda; see
+// the TODO above calcGMInvGt(). Cholesky reads only the lower triangle so it
+// would silently solve the wrong system in that case; we use it only when the
+// matrix is symmetric to within the conditioning tolerance and well
+// conditioned. In that common case Cholesky is several times cheaper than QTZ
+// and gives the same answer. Otherwise we fall back to QTZ so that redundant
+// constraints get the same rank-revealing least squares treatment as before.
+// The Cholesky condition estimate is for the 1-norm, which can be off from the
+// 2-norm estimate QTZ uses by a factor of m, so we demand that much margin
+// before trusting it.
+static bool isNumericallySymmetric(const Matrix& A, Real tol) {
+    const int m = A.nrow();
+    Real maxAbs = 0, maxAsym = 0;
+    for (int j=0; j < m; ++j) {
+        maxAbs = std::max(maxAbs, std::abs(A(j,j)));
+        for (int i=j+1; i < m; ++i) {
+            maxAbs  = std::max(maxAbs, std::max(std::abs(A(i,j)),
+                                                std::abs(A(j,i))));
+            maxAsym = std::max(maxAsym, std::abs(A(i,j)-A(j,i)));
+        }
+    }
+    return maxAsym <= tol*maxAbs;
+}
+
+// This is called every time step with a matrix that usually has the same size
+// as last time, so the factorizations are kept in the State's workspace and
+// refactored in place rather than allocated anew.
+static void solveWithGMInvGt(const Matrix& GMInvGt, Real conditioningTol,
+                             const Vector& rhs, Vector& x,
+                             SBConstraintSolverWorkspace& workspace)
+{
+    FactorCholesky& chol = workspace.chol;
+    FactorQTZ&      qtz  = workspace.qtz;
+
+    const int m = GMInvGt.nrow();
+    if (isNumericallySymmetric(GMInvGt, conditioningTol)) {
+        chol.factor(GMInvGt);
+        if (chol.isPositiveDefinite()
+            && chol.getRCondEstimate() > m*conditioningTol) {
+            chol.solve(rhs, x);
+            return;
+        }
+    }
+
+    // specify 1/cond at which we declare rank deficiency
+    qtz.factor(GMInvGt, conditioningTol); 
+
+    //printf("fwdDynamics: m=%d condTol=%g rank=%d rcond=%g\n",
+    //    GMInvGt.nrow(), conditioningTol, qtz.getRank(),
+    //    qtz.getRCondEstimate());
+
+    qtz.solve(rhs, x);
+}
+
+
+
 // =============================================================================
 //                     SOLVE FOR CONSTRAINT IMPULSES
 // =============================================================================
@@ -3575,8 +3642,8 @@ solveForConstraintImpulses(const State&     state,
     // MUST DUPLICATE SIMBODY'S METHOD HERE:
     const Real conditioningTol = GMInvGt.nrow() 
                                     * SqrtEps*std::sqrt(SqrtEps); // Eps^(3/4)
-    FactorQTZ qtz(GMInvGt, conditioningTol); 
-    qtz.solve(deltaV, impulse);
+    solveWithGMInvGt(GMInvGt, conditioningTol, deltaV, impulse,
+                     updConstraintSolverWorkspace(state));
 }
 
 
@@ -5124,15 +5191,8 @@ void SimbodyMatterSubsystemRep::calcLoopForwardDynamicsOperator
     // of O(n) operators. Then we'll factor it here in O(m^3) time. 
     Matrix GMInvGt(m,m);
     calcGMInvGt(s, GMInvGt);
-    
-    // specify 1/cond at which we declare rank deficiency
-    FactorQTZ qtz(GMInvGt, conditioningTol); 
-
-    //printf("fwdDynamics: m=%d condTol=%g rank=%d rcond=%g\n",
-    //    GMInvGt.nrow(), conditioningTol, qtz.getRank(),
-    //    qtz.getRCondEstimate());
-
-    qtz.solve(udotErr, multipliers);
+    solveWithGMInvGt(GMInvGt, conditioningTol, udotErr, multipliers,
+                     updConstraintSolverWorkspace(s));
 
     // We have the multipliers, now turn them into forces.
 
@@ -1139,6 +1139,12 @@ public:
             (s.updCacheEntry(getMySubsystemIndex(),topologyCache.constrainedAccelerationCacheIndex)).upd();
     }
 
+    // This is scratch space that is never valid, so there is no get method.
+    SBConstraintSolverWorkspace& updConstraintSolverWorkspace(const State& s) const { //mutable
+        return Value<SBConstraintSolverWorkspace>::updDowncast
+            (s.updCacheEntry(getMySubsystemIndex(),topologyCache.constraintSolverWorkspaceIndex)).upd();
+    }
+
 
     const SBModelVars& getModelVars(const State& s) const {
         return Value<SBModelVars>::downcast
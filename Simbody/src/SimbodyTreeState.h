@@ -65,6 +65,7 @@ allocated if necessary), and then advance to stage Whatever. */
 
 #include "simbody/internal/common.h"
 #include "simbody/internal/Motion.h"
+#include "simmath/LinearAlgebra.h"
 
 #include <cassert>
 #include <iostream>
@@ -92,6 +93,7 @@ class SBConstrainedVelocityCache;
 class SBDynamicsCache;
 class SBTreeAccelerationCache;
 class SBConstrainedAccelerationCache;
+class SBConstraintSolverWorkspace;
 
 class SBModelVars;
 class SBInstanceVars;
@@ -156,7 +158,8 @@ public:
                           articulatedBodyVelocityCacheIndex,
                           dynamicsCacheIndex, 
                           treeAccelerationCacheIndex, 
-                          constrainedAccelerationCacheIndex;
+                          constrainedAccelerationCacheIndex,
+                          constraintSolverWorkspaceIndex;
 
 
     // These are instance variables that exist regardless of modeling
@@ -1230,6 +1233,24 @@ public:
 
 
 
+// =============================================================================
+//                        CONSTRAINT SOLVER WORKSPACE
+// =============================================================================
+// The factorizations of G M^-1 ~G used to solve for constraint multipliers and
+// impulses. These aren't computed results; the entry is never marked valid.
+// It is kept in the State so that each State has its own, and so that the
+// memory goes away with the State. The matrix usually has the same size from
+// one step to the next, and then the factorizations are redone in place
+// without allocating.
+class SBConstraintSolverWorkspace {
+public:
+    FactorCholesky chol;
+    FactorQTZ      qtz;
+};
+//....................... CONSTRAINT SOLVER WORKSPACE ..........................
+
+
+
 
 /* 
  * Generalized state variable collection for a SimbodyMatterSubsystem. 
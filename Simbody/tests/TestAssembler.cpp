@@ -0,0 +1,275 @@
+/* -------------------------------------------------------------------------- *
+ *                               Simbody(tm)                                  *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2018 Stanford University and the Authors.           *
+ * Authors: Simbody developers                                                *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+// Compare the Assembler's Levenberg-Marquardt solver against the general
+// purpose Optimizer on marker fitting problems, with and without built-in
+// Constraints as assembly requirements.
+
+#include "SimTKsimbody.h"
+#include "SimTKcommon/Testing.h"
+
+using namespace SimTK;
+
+namespace {
+
+// A chain of pin and ball jointed links hanging from a free base, with
+// optionally a rod holding the last link a fixed distance from Ground.
+struct Model {
+    explicit Model(bool closeLoop) : matter(system) {
+        Body::Rigid body(MassProperties(1, Vec3(0), UnitInertia(1)));
+        MobilizedBody parent = MobilizedBody::Free(matter.Ground(), Vec3(0),
+                                                   body, Vec3(0));
+        links.push_back(parent);
+        for (int i=0; i < 6; ++i) {
+            if (i % 2)
+                parent = MobilizedBody::Ball(parent, Vec3(0,-.5,0),
+                                             body, Vec3(0,.5,0));
+            else
+                parent = MobilizedBody::Pin(parent, Vec3(0,-.5,0),
+                                            body, Vec3(0,.5,0));
+            links.push_back(parent);
+        }
+        if (closeLoop)
+            Constraint::Rod(matter.Ground(), Vec3(1,-2,0),
+                            links.back(), Vec3(0,-.5,0), 3);
+        system.realizeTopology();
+    }
+
+    // Markers on each link, with observations taken from the given state
+    // and disturbed by a little noise.
+    Markers* createMarkers(const State& truth, Real noise) const {
+        Markers* markers = new Markers();
+        const Vec3 stations[] = {Vec3(.1,.3,0), Vec3(0,-.2,.1), Vec3(-.1,0,0)};
+        for (unsigned b=0; b < links.size(); ++b)
+            for (int k=0; k < 3; ++k)
+                markers->addMarker(links[b], stations[k], 1+b%3);
+        markers->defineObservationOrder(Array_<Markers::MarkerIx>());
+        moveObservations(*markers, truth, noise);
+        return markers;
+    }
+
+    void moveObservations(Markers& markers, const State& truth,
+                          Real noise) const {
+        Random::Gaussian rand(0, noise);
+        rand.setSeed(5);
+        for (Markers::MarkerIx mx(0); mx < markers.getNumMarkers(); ++mx) {
+            const MobilizedBody& mobod =
+                matter.getMobilizedBody(markers.getMarkerBody(mx));
+            const Vec3 p = mobod.findStationLocationInGround
+                (truth, markers.getMarkerStation(mx));
+            markers.moveOneObservation(markers.getObservationIxForMarker(mx),
+                p + Vec3(rand.getValue(), rand.getValue(), rand.getValue()));
+        }
+    }
+
+    // Satisfy the constraints tightly so observations taken from s are
+    // exactly reachable.
+    void satisfyConstraints(State& s) const {
+        Assembler(system).setErrorTolerance(1e-12).assemble(s);
+        system.realize(s, Stage::Position);
+    }
+
+    State pose(Real angle) const {
+        State s = system.getDefaultState();
+        for (int i=0; i < s.getNQ(); ++i)
+            s.updQ()[i] = angle*std::sin(Real(i+1));
+        system.realize(s, Stage::Position);
+        return s;
+    }
+
+    MultibodySystem         system;
+    SimbodyMatterSubsystem  matter;
+    Array_<MobilizedBody>   links;
+};
+
+// A goal that doesn't supply errors; the Assembler must fall back on the
+// Optimizer when this is present.
+class GoalOnly : public AssemblyCondition {
+public:
+    explicit GoalOnly(MobilizedBodyIndex mbx)
+    :   AssemblyCondition("GoalOnly"), mbx(mbx) {}
+    int calcGoal(const State& s, Real& goal) const override {
+        const MobilizedBody& mobod = getMatterSubsystem().getMobilizedBody(mbx);
+        goal = square(mobod.getBodyOriginLocation(s)[2]);
+        return 0;
+    }
+private:
+    MobilizedBodyIndex mbx;
+};
+
+// Fit the markers with each solver, starting from the same guess, and
+// return the goals achieved.
+Vec2 fitBothWays(const Model& model, const State& truth, Real noise,
+                 const State& guess, bool goalOnly=false) {
+    Vec2 goal;
+    for (int lm=0; lm < 2; ++lm) {
+        Assembler assembler(model.system);
+        assembler.setUseLevenbergMarquardt(lm != 0);
+        SimTK_TEST(assembler.isUsingLevenbergMarquardt() == (lm != 0));
+        assembler.setAccuracy(1e-6);
+        assembler.adoptAssemblyGoal(model.createMarkers(truth, noise));
+        if (goalOnly)
+            assembler.adoptAssemblyGoal(new GoalOnly(model.links[3]), .1);
+        State s = guess;
+        goal[lm] = assembler.assemble(s);
+        model.system.realize(s, Stage::Position);
+        SimTK_TEST(s.getQErr().size()==0
+                   || max(abs(s.getQErr())) <= assembler.getErrorToleranceInUse());
+    }
+    return goal;
+}
+
+// Exact observations: both find the true pose, with zero goal.
+void testExactFit() {
+    Model model(false);
+    const State truth = model.pose(.3);
+    const Vec2 goal = fitBothWays(model, truth, 0, model.pose(.1));
+    SimTK_TEST_EQ_TOL(goal[1], 0, 1e-10);
+    SimTK_TEST_EQ_TOL(goal[0], 0, 1e-6);
+}
+
+// Noisy observations and a loop-closing constraint: the least squares
+// solution must be feasible and at least as good as the Optimizer's.
+void testNoisyConstrainedFit() {
+    for (int loop=0; loop < 2; ++loop) {
+        Model model(loop != 0);
+        State truth = model.pose(.3);
+        if (loop) model.satisfyConstraints(truth);
+        const Vec2 goal = fitBothWays(model, truth, .01, model.pose(.2));
+        SimTK_TEST(goal[1] > 0);
+        SimTK_TEST(goal[1] <= goal[0]*(1+1e-4));
+    }
+}
+
+// A goal without errors makes the least squares solver unusable; we should
+// still get the Optimizer's answer.
+void testFallBack() {
+    Model model(false);
+    const Vec2 goal =
+        fitBothWays(model, model.pose(.3), .01, model.pose(.2), true);
+    SimTK_TEST_EQ_TOL(goal[1], goal[0], 1e-12);
+}
+
+// Tracking a moving model; each frame should need only a few iterations.
+void testTrack() {
+    Model model(true);
+    State truth = model.pose(.3);
+    model.satisfyConstraints(truth);
+
+    Assembler assembler(model.system);
+    assembler.setUseLevenbergMarquardt(true);
+    assembler.setAccuracy(1e-8);
+    Markers* markers = model.createMarkers(truth, 0);
+    assembler.adoptAssemblyGoal(markers);
+    assembler.initialize(truth);
+    for (int frame=0; frame < 10; ++frame) {
+        State next = model.pose(.3 + .01*frame);
+        model.satisfyConstraints(next);
+        model.moveObservations(*markers, next, 0);
+        assembler.resetStats();
+        assembler.track(frame*.005);
+        SimTK_TEST(assembler.getNumErrorJacobianEvals() <= 10);
+        SimTK_TEST_EQ_TOL(assembler.calcCurrentGoal(), 0, 1e-10);
+    }
+}
+
+// A trajectory solved in parallel chunks must match tracking it frame by
+// frame, including orientation sensors and timed frames.
+void testTrackTrajectory() {
+    Model model(true);
+    const int nFrames = 60;
+    Array_< Array_<Vec3> >     markerFrames(nFrames);
+    Array_< Array_<Rotation> > osensorFrames(nFrames);
+    Vector times(nFrames);
+    Markers* proto = model.createMarkers(model.pose(.3), 0);
+    for (int f=0; f < nFrames; ++f) {
+        State truth = model.pose(.3 + .02*f);
+        model.satisfyConstraints(truth);
+        model.moveObservations(*proto, truth, .002);
+        for (Markers::ObservationIx ox(0); 
+             ox < proto->getNumObservations(); ++ox)
+            markerFrames[f].push_back(proto->getObservation(ox));
+        osensorFrames[f].push_back(model.links[2].getBodyRotation(truth));
+        osensorFrames[f].push_back(model.links[5].getBodyRotation(truth));
+        times[f] = .01*f;
+    }
+    delete proto;
+
+    Matrix qs[3];
+    for (int run=0; run < 3; ++run) {
+        Assembler assembler(model.system);
+        assembler.setUseLevenbergMarquardt(true);
+        assembler.setAccuracy(1e-6);
+        Markers* markers = model.createMarkers(model.pose(.3), 0);
+        OrientationSensors* osensors = new OrientationSensors();
+        osensors->addOSensor(model.links[2], Rotation());
+        osensors->addOSensor(model.links[5], Rotation(), 2);
+        assembler.adoptAssemblyGoal(markers);
+        assembler.adoptAssemblyGoal(osensors, .5);
+
+        State s = model.pose(.3);
+        model.satisfyConstraints(s);
+        assembler.initialize(s);
+        if (run == 0) { // frame by frame
+            qs[0].resize(nFrames, s.getNQ());
+            for (int f=0; f < nFrames; ++f) {
+                markers->moveAllObservations(markerFrames[f]);
+                osensors->moveAllObservations(osensorFrames[f]);
+                assembler.track(times[f]);
+                qs[0][f] = ~assembler.getInternalState().getQ();
+            }
+        } else {
+            qs[run] = assembler.trackTrajectory(markerFrames, osensorFrames,
+                                                times, run==1 ? 1 : 4);
+            SimTK_TEST(assembler.getInternalState().getTime() == times[nFrames-1]);
+            SimTK_TEST_EQ(~assembler.getInternalState().getQ(), qs[run][nFrames-1]);
+        }
+    }
+    SimTK_TEST((qs[1] - qs[0]).norm() == 0); // serial is exactly the same
+    SimTK_TEST_EQ_TOL(qs[2], qs[0], 1e-4);
+
+    // A condition that can't be copied forces serial tracking.
+    Assembler assembler(model.system);
+    assembler.adoptAssemblyGoal(model.createMarkers(model.pose(.3), 0));
+    assembler.adoptAssemblyGoal(new GoalOnly(model.links[3]), 1e-6);
+    assembler.initialize(model.pose(.3));
+    const Matrix q = assembler.trackTrajectory(markerFrames,
+                                    Array_< Array_<Rotation> >(), Vector(), 4);
+    SimTK_TEST(q.nrow() == nFrames);
+
+    // Mismatched frame counts.
+    SimTK_TEST_MUST_THROW(assembler.trackTrajectory
+       (markerFrames, Array_< Array_<Rotation> >(), Vector(3)));
+}
+
+}
+
+int main() {
+    SimTK_START_TEST("TestAssembler");
+        SimTK_SUBTEST(testExactFit);
+        SimTK_SUBTEST(testNoisyConstrainedFit);
+        SimTK_SUBTEST(testFallBack);
+        SimTK_SUBTEST(testTrack);
+        SimTK_SUBTEST(testTrackTrajectory);
+    SimTK_END_TEST();
+}
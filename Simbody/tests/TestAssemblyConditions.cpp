@@ -0,0 +1,225 @@
+/* -------------------------------------------------------------------------- *
+ *                               Simbody(tm)                                  *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2018 Stanford University and the Authors.           *
+ * Authors: Simbody developers                                                *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+// Check the errors and analytic error Jacobians of the Markers and
+// OrientationSensors assembly conditions against the goals they are meant to
+// match and against central differences of the errors.
+
+#include "SimTKsimbody.h"
+#include "SimTKcommon/Testing.h"
+
+using namespace SimTK;
+
+namespace {
+
+// A free base body with a pin and a ball joint below it.
+struct Chain {
+    Chain() : matter(system) {
+        Body::Rigid body(MassProperties(1, Vec3(0), UnitInertia(1)));
+        base  = MobilizedBody::Free(matter.Ground(), Vec3(0),
+                                    body, Vec3(0));
+        upper = MobilizedBody::Pin(base, Vec3(0,-1,0), body, Vec3(0,.5,0));
+        lower = MobilizedBody::Ball(upper, Vec3(0,-.5,0), body, Vec3(0,.5,0));
+        system.realizeTopology();
+        state = system.getDefaultState();
+        Random::Uniform rand(-1, 1);
+        rand.setSeed(17);
+        for (int i=0; i < state.getNQ(); ++i)
+            state.updQ()[i] = rand.getValue();
+        matter.setUseEulerAngles(state, true);
+        system.realizeModel(state);
+        system.realize(state, Stage::Position);
+    }
+    MultibodySystem         system;
+    SimbodyMatterSubsystem  matter;
+    MobilizedBody           base, upper, lower;
+    State                   state;
+};
+
+// Central differences of cond's errors with respect to the Assembler's
+// free q's, at its current internal state.
+Matrix calcNumericalJacobian(const Assembler& assembler,
+                             const AssemblyCondition& cond) {
+    const Real h = 1e-6;
+    State s = assembler.getInternalState();
+    const int np = assembler.getNumFreeQs();
+    const int m = cond.getNumErrors(s);
+    Matrix J(m, np);
+    Vector ep, em;
+    for (Assembler::FreeQIndex fx(0); fx < np; ++fx) {
+        const QIndex qx = assembler.getQIndexOfFreeQ(fx);
+        const Real q0 = s.getQ()[qx];
+        s.updQ()[qx] = q0 + h;
+        assembler.getMultibodySystem().realize(s, Stage::Position);
+        cond.calcErrors(s, ep);
+        s.updQ()[qx] = q0 - h;
+        assembler.getMultibodySystem().realize(s, Stage::Position);
+        cond.calcErrors(s, em);
+        s.updQ()[qx] = q0;
+        J(fx) = (ep - em)/(2*h);
+    }
+    return J;
+}
+
+void checkJacobian(const Assembler& assembler, const AssemblyCondition& cond) {
+    const State& s = assembler.getInternalState();
+    Matrix J;
+    SimTK_TEST(cond.calcErrorJacobian(s, J) == 0);
+    SimTK_TEST(J.nrow() == cond.getNumErrors(s));
+    SimTK_TEST(J.ncol() == assembler.getNumFreeQs());
+    SimTK_TEST_EQ_TOL(J, calcNumericalJacobian(assembler, cond), 1e-6);
+}
+
+// The errors should reproduce the goal, with missing observations giving
+// zero rows. With the pin locked there is one fewer free q.
+void testMarkers() {
+    Chain chain;
+    for (int locked=0; locked < 2; ++locked) {
+        Markers* markers = new Markers();
+        markers->addMarker(chain.base,  Vec3(.1,.2,.3));
+        markers->addMarker(chain.upper, Vec3(0,-.2,.1), 2);
+        markers->addMarker(chain.lower, Vec3(.3,0,0), .5);
+        markers->addMarker(chain.lower, Vec3(0,0,.4));
+        markers->addMarker(chain.upper, Vec3(1,1,1), 0); // inactive
+
+        Assembler assembler(chain.system);
+        assembler.adoptAssemblyGoal(markers);
+        if (locked) assembler.lockMobilizer(chain.upper);
+        assembler.initialize(chain.state);
+        const State& s = assembler.getInternalState();
+        SimTK_TEST(assembler.getNumFreeQs() == s.getNQ() - locked);
+
+        for (Markers::MarkerIx mx(0); mx < markers->getNumMarkers(); ++mx)
+            markers->moveOneObservation(markers->getObservationIxForMarker(mx),
+                markers->findCurrentMarkerLocation(mx) + Vec3(.1,-.2,.05*mx));
+        markers->moveOneObservation(Markers::ObservationIx(3), Vec3(NaN));
+
+        Vector err;
+        SimTK_TEST(markers->calcErrors(s, err) == 0);
+        SimTK_TEST(err.size() == 12);
+        SimTK_TEST(err(9,3).norm() == 0); // not observed
+        Real goal; markers->calcGoal(s, goal);
+        SimTK_TEST_EQ(err.normSqr(), 2*(1+2+.5)*goal);
+
+        checkJacobian(assembler, *markers);
+    }
+}
+
+void testOrientationSensors() {
+    Chain chain;
+    OrientationSensors* osensors = new OrientationSensors();
+    osensors->addOSensor(chain.base,  Rotation(.3, Vec3(1,2,3)));
+    osensors->addOSensor(chain.upper, Rotation(), 2);
+    osensors->addOSensor(chain.lower, Rotation(-1.1, UnitVec3(0,1,1)), .5);
+    osensors->addOSensor(chain.lower, Rotation(.2, ZAxis));
+
+    Assembler assembler(chain.system);
+    assembler.adoptAssemblyGoal(osensors);
+    assembler.initialize(chain.state);
+    const State& s = assembler.getInternalState();
+
+    // Perturb the observations by rotations of various sizes, including one
+    // small enough to use the series expansion.
+    const Real angles[] = {.8, 1e-3, 2.5, .4};
+    for (OrientationSensors::OSensorIx ox(0);
+         ox < osensors->getNumOSensors(); ++ox)
+    {
+        const Rotation R_GS = osensors->findCurrentOSensorOrientation(ox);
+        osensors->moveOneObservation
+           (osensors->getObservationIxForOSensor(ox),
+            R_GS*Rotation(angles[ox], UnitVec3(1,-1,.5*ox)));
+    }
+
+    Vector err;
+    SimTK_TEST(osensors->calcErrors(s, err) == 0);
+    SimTK_TEST(err.size() == 12);
+    SimTK_TEST_EQ(err(3,3).norm(), std::sqrt(2.)*1e-3);
+    Real goal; osensors->calcGoal(s, goal);
+    SimTK_TEST_EQ(err.normSqr(), 2*(1+2+.5+1)*goal);
+    checkJacobian(assembler, *osensors);
+
+    Rotation missing; missing.setRotationToNaN();
+    osensors->moveOneObservation(OrientationSensors::ObservationIx(0), missing);
+    osensors->calcErrors(s, err);
+    SimTK_TEST(err(0,3).norm() == 0);
+    checkJacobian(assembler, *osensors);
+}
+
+// Requiring a single observation to be met exactly gives a square system
+// in each case here; assembly should recover the pose that produced the
+// observation using either the analytic or the numerical Jacobian.
+void testAssembleWithErrors() {
+    MultibodySystem system;
+    SimbodyMatterSubsystem matter(system);
+    Body::Rigid body(MassProperties(1, Vec3(0), UnitInertia(1)));
+    MobilizedBody::Ball ball(matter.Ground(), Vec3(0), body, Vec3(0));
+    MobilizedBody::Universal arm(matter.Ground(), Vec3(2,0,0), body, Vec3(0));
+    MobilizedBody::Pin forearm(arm, Vec3(0,-1,0), body, Vec3(0,.5,0));
+    system.realizeTopology();
+    State target = system.getDefaultState();
+    ball.setQToFitRotation(target, Rotation(.7, UnitVec3(1,2,-1)));
+    arm.setOneQ(target, 0, .3); arm.setOneQ(target, 1, -.4);
+    forearm.setOneQ(target, 0, .9);
+    system.realize(target, Stage::Position);
+    const Vec3 tipInB(.2, -.5, .1);
+
+    for (int numerical=0; numerical < 2; ++numerical) {
+        Markers* markers = new Markers();
+        markers->addMarker(forearm, tipInB);
+        markers->defineObservationOrder(Array_<Markers::MarkerIx>());
+        markers->moveOneObservation(Markers::ObservationIx(0),
+            forearm.findStationLocationInGround(target, tipInB));
+
+        OrientationSensors* osensors = new OrientationSensors();
+        osensors->addOSensor(ball, Rotation());
+        osensors->defineObservationOrder(Array_<OrientationSensors::OSensorIx>());
+        osensors->moveOneObservation(OrientationSensors::ObservationIx(0),
+            ball.getBodyRotation(target));
+
+        Assembler assembler(system);
+        assembler.setForceNumericalJacobian(numerical != 0);
+        assembler.adoptAssemblyError(markers);
+        assembler.adoptAssemblyError(osensors);
+        assembler.setErrorTolerance(1e-10);
+
+        State s = system.getDefaultState();
+        arm.setOneQ(s, 0, .2); arm.setOneQ(s, 1, -.3); // same branch
+        forearm.setOneQ(s, 0, .5);
+        assembler.assemble(s);
+        system.realize(s, Stage::Position);
+        SimTK_TEST_EQ_TOL(ball.getBodyRotation(s),
+                          ball.getBodyRotation(target), 1e-7);
+        SimTK_TEST_EQ_TOL(forearm.getBodyTransform(s),
+                          forearm.getBodyTransform(target), 1e-7);
+    }
+}
+
+}
+
+int main() {
+    SimTK_START_TEST("TestAssemblyConditions");
+        SimTK_SUBTEST(testMarkers);
+        SimTK_SUBTEST(testOrientationSensors);
+        SimTK_SUBTEST(testAssembleWithErrors);
+    SimTK_END_TEST();
+}
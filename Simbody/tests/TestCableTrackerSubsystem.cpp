@@ -0,0 +1,158 @@
+/* -------------------------------------------------------------------------- *
+ *                               Simbody(tm)                                  *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2018 Stanford University and the Authors.           *
+ * Authors: Simbody developers                                                *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+// Check that cable paths solved concurrently at Position stage give the same
+// results as when they are solved one at a time, and that the solved paths
+// have consistent length rates.
+
+#include "SimTKsimbody.h"
+#include "SimTKcommon/Testing.h"
+
+#include <vector>
+
+using namespace SimTK;
+
+namespace {
+const int NumPaths = 6;
+const Real Rad = Real(0.25);
+
+// A chain of five bodies hanging from ground, with cables running from
+// ground to points on the chain through via points on the intermediate
+// bodies. Even-numbered cables also wrap a sphere on the middle body.
+struct CableModel {
+    CableModel() : matter(system), cables(system) {
+        Body::Rigid body(MassProperties(1.0, Vec3(0), Inertia(1)));
+        MobilizedBody parent = matter.Ground();
+        for (int i=0; i < 5; ++i) {
+            MobilizedBody::Ball link(parent, Transform(Vec3(0)),
+                                     body, Transform(Vec3(0, 1, 0)));
+            links.push_back(link);
+            parent = link;
+        }
+        for (int k=0; k < NumPaths; ++k) {
+            const Real angle = 2*Pi*k/NumPaths;
+            const Vec3 dir(std::cos(angle), 0, std::sin(angle));
+            CablePath path(cables, matter.Ground(), 2*dir + Vec3(0,1,0),
+                           links[4], Rad*dir);
+            CableObstacle::ViaPoint(path, links[1], 2*Rad*dir);
+            if (k % 2 == 0) {
+                CableObstacle::Surface obs(path, links[2], Transform(),
+                                           ContactGeometry::Sphere(Rad));
+                obs.setContactPointHints(Rad*UnitVec3(dir + Vec3(0,1,0)),
+                                         Rad*UnitVec3(dir - Vec3(0,1,0)));
+            }
+            CableObstacle::ViaPoint(path, links[3], 2*Rad*dir);
+            paths.push_back(path);
+        }
+        system.realizeTopology();
+    }
+
+    State makeState() const {
+        State state = system.getDefaultState();
+        Random::Uniform random(-Real(0.2), Real(0.2));
+        random.setSeed(7);
+        for (int i=0; i < state.getNQ(); ++i)
+            state.updQ()[i] = random.getValue();
+        system.realizeModel(state);
+        return state;
+    }
+
+    MultibodySystem         system;
+    SimbodyMatterSubsystem  matter;
+    CableTrackerSubsystem   cables;
+    Array_<MobilizedBody>   links;
+    Array_<CablePath>       paths;
+};
+}
+
+void testNumberOfThreads() {
+    CableModel model;
+    SimTK_TEST(model.cables.getNumberOfThreads() == 1);
+    model.cables.setNumberOfThreads(3);
+    SimTK_TEST(model.cables.getNumberOfThreads() == 3);
+    model.cables.setNumberOfThreads(1);
+    SimTK_TEST(model.cables.getNumberOfThreads() == 1);
+    SimTK_TEST_MUST_THROW(model.cables.setNumberOfThreads(0));
+}
+
+// The same paths are found whether or not they are solved concurrently, and
+// each path reports how long it took.
+void testConcurrentPaths() {
+    CableModel serial, concurrent;
+    serial.cables.setNumberOfThreads(1);
+    concurrent.cables.setNumberOfThreads(4);
+
+    State serialState = serial.makeState();
+    State concurrentState = concurrent.makeState();
+    serial.system.realize(serialState, Stage::Position);
+    concurrent.system.realize(concurrentState, Stage::Position);
+
+    for (int k=0; k < NumPaths; ++k) {
+        const CablePath& sp = serial.paths[k];
+        const CablePath& cp = concurrent.paths[k];
+        SimTK_TEST(cp.getCableLength(concurrentState)
+                   == sp.getCableLength(serialState));
+        SimTK_TEST(sp.getCableLength(serialState) > 0);
+        SimTK_TEST(sp.getPathSolveTime(serialState) >= 0);
+        SimTK_TEST(cp.getPathSolveTime(concurrentState) >= 0);
+    }
+}
+
+// Check the cable length rates against a central difference of the cable
+// lengths along the velocity. This requires the Newton solves with the
+// analytic path error Jacobian to converge in the perturbed configurations.
+void testCableLengthDot() {
+    CableModel model;
+    State state = model.system.getDefaultState();
+    Random::Uniform random(-1, 1);
+    random.setSeed(11);
+    for (int i=0; i < state.getNU(); ++i)
+        state.updU()[i] = random.getValue();
+    model.system.realize(state, Stage::Velocity);
+    const Vector qdot = state.getQDot();
+    const Vector q0 = state.getQ();
+
+    const Real h = Real(1e-5);
+    std::vector<Real> lplus(NumPaths), lminus(NumPaths);
+    State tmp = state;
+    tmp.updQ() = q0 + h*qdot;
+    model.system.realize(tmp, Stage::Position);
+    for (int k=0; k < NumPaths; ++k)
+        lplus[k] = model.paths[k].getCableLength(tmp);
+    tmp.updQ() = q0 - h*qdot;
+    model.system.realize(tmp, Stage::Position);
+    for (int k=0; k < NumPaths; ++k)
+        lminus[k] = model.paths[k].getCableLength(tmp);
+
+    for (int k=0; k < NumPaths; ++k)
+        SimTK_TEST_EQ_TOL(model.paths[k].getCableLengthDot(state),
+                          (lplus[k] - lminus[k])/(2*h), 1e-5);
+}
+
+int main() {
+    SimTK_START_TEST("TestCableTrackerSubsystem");
+        SimTK_SUBTEST(testNumberOfThreads);
+        SimTK_SUBTEST(testConcurrentPaths);
+        SimTK_SUBTEST(testCableLengthDot);
+    SimTK_END_TEST();
+}
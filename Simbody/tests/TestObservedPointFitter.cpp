@@ -194,6 +194,53 @@ static void testObservedPointFitter(bool useConstraint) {
     std::cout << "Done" << std::endl;
 }
 
+// A root body with many side chains. The subproblems for the bodies in
+// different chains are fit concurrently, and the fit must be as good as
+// for the chains above.
+static void testBranched() {
+    static const int NUM_CHAINS = 6, CHAIN_LENGTH = 3;
+    MultibodySystem mbs;
+    SimbodyMatterSubsystem matter(mbs);
+    Body::Rigid body = Body::Rigid(MassProperties(1, Vec3(0), Inertia(1)));
+    MobilizedBody::Ball root(matter.Ground(), Transform(), body, Transform(Vec3(0, BOND_LENGTH, 0)));
+    vector<MobilizedBody*> bodies(1, &root);
+    for (int c = 0; c < NUM_CHAINS; ++c) {
+        MobilizedBody* parent = &root;
+        for (int i = 0; i < CHAIN_LENGTH; ++i) {
+            MobilizedBody::Pin pin(*parent, Transform(Vec3(0)), body, Transform(Vec3(0, BOND_LENGTH, 0)));
+            parent = &matter.updMobilizedBody(pin.getMobilizedBodyIndex());
+            bodies.push_back(parent);
+        }
+    }
+    mbs.realizeTopology();
+    State s = mbs.getDefaultState();
+    matter.setUseEulerAngles(s, true);
+    mbs.realizeModel(s);
+
+    Random::Uniform random(0.0, 1.0);
+    random.setSeed(1);
+    for (int i = 0; i < s.getNQ(); ++i)
+        s.updQ()[i] = random.getValue();
+    mbs.realize(s, Stage::Position);
+
+    vector<vector<Vec3> > stations(bodies.size());
+    vector<vector<Vec3> > targetLocations(bodies.size());
+    vector<MobilizedBodyIndex> bodyIxs;
+    for (int i = 0; i < (int)bodies.size(); ++i) {
+        bodyIxs.push_back(bodies[i]->getMobilizedBodyIndex());
+        for (int j = 0; j < 3; ++j) {
+            Vec3 pos(2.0*random.getValue()-1.0, 2.0*random.getValue()-1.0, 2.0*random.getValue()-1.0);
+            stations[i].push_back(pos);
+            targetLocations[i].push_back(bodies[i]->getBodyTransform(s)*pos);
+        }
+    }
+
+    s = mbs.getDefaultState();
+    matter.setUseEulerAngles(s, true);
+    mbs.realizeModel(s);
+    SimTK_TEST(testFitting(mbs, s, bodyIxs, stations, targetLocations, 0.0, 0.03, -1));
+}
+
 static void testUnconstrained() {
     testObservedPointFitter(false);
 }
@@ -206,5 +253,6 @@ int main() {
     SimTK_START_TEST("TestObservedPointFitter");
         SimTK_SUBTEST(testUnconstrained);
         SimTK_SUBTEST(testConstrained);
+        SimTK_SUBTEST(testBranched);
     SimTK_END_TEST();
 }
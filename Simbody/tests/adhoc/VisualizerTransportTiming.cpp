@@ -0,0 +1,112 @@
+/* -------------------------------------------------------------------------- *
+ *             Simbody(tm) Adhoc Test: Visualizer Transport Timing            *
+ * -------------------------------------------------------------------------- *
+ * This is part of the SimTK biosimulation toolkit originating from           *
+ * Simbios, the NIH National Center for Physics-Based Simulation of           *
+ * Biological Structures at Stanford, funded under the NIH Roadmap for        *
+ * Medical Research, grant U54 GM072970. See https://simtk.org/home/simbody.  *
+ *                                                                            *
+ * Portions copyright (c) 2018 Stanford University and the Authors.           *
+ * Authors: Simbody developers                                                *
+ * Contributors:                                                              *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+/* Measure how many frames per second the Visualizer can get displayed as the
+number of decorations in each frame grows, once with scenes sent through
+shared memory (where that is supported) and once with everything sent through
+the pipe. Small scenes are limited by the renderer's frame rate, so the
+difference shows up only once sending the scene is the bottleneck. */
+
+#include "Simbody.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+
+using namespace SimTK;
+
+// Generates a grid of numBricks small bricks that wobble with time.
+class ManyBricks : public DecorationGenerator {
+public:
+    int numBricks = 0;
+
+    void generateDecorations(const State& state,
+                             Array_<DecorativeGeometry>& geometry) override
+    {
+        const int side = (int)std::ceil(std::sqrt((double)numBricks));
+        for (int i=0; i < numBricks; ++i) {
+            const Vec3 p(Real(0.05)*(i%side), Real(0.05)*(i/side),
+                         Real(0.01)*std::sin(state.getTime() + i));
+            geometry.push_back(DecorativeBrick(Vec3(Real(0.02)))
+                               .setTransform(p).setColor(Blue));
+        }
+    }
+};
+
+static void setUseSharedMemory(bool useSharedMemory) {
+    const char* value = useSharedMemory ? "1" : "0";
+#ifdef _WIN32
+    _putenv_s("SIMBODY_VISUALIZER_SHARED_MEMORY", value);
+#else
+    setenv("SIMBODY_VISUALIZER_SHARED_MEMORY", value, 1);
+#endif
+}
+
+// Draw frames with the given number of decorations for about the given time
+// and return the number of frames drawn per second.
+static double timeFrames(const Visualizer& viz, ManyBricks& bricks,
+                         State& state, int numBricks, double seconds) {
+    bricks.numBricks = numBricks;
+    viz.drawFrameNow(state); // any new meshes are sent with this one
+    int numFrames = 0;
+    const double start = realTime();
+    while (realTime() - start < seconds) {
+        state.updTime() += Real(0.01);
+        viz.drawFrameNow(state);
+        ++numFrames;
+    }
+    return numFrames / (realTime() - start);
+}
+
+int main() {
+  try {
+    MultibodySystem system;
+    SimbodyMatterSubsystem matter(system);
+    system.realizeTopology();
+    State state = system.getDefaultState();
+
+    const int counts[] = {10, 100, 1000, 5000, 20000, 50000};
+    const int numCounts = (int)(sizeof(counts)/sizeof(counts[0]));
+    double fps[2][numCounts];
+
+    // Index 0 is shared memory, 1 is the pipe alone.
+    for (int transport=0; transport < 2; ++transport) {
+        setUseSharedMemory(transport == 0);
+        Visualizer viz(system);
+        ManyBricks* bricks = new ManyBricks;
+        viz.addDecorationGenerator(bricks); // takes ownership
+        for (int i=0; i < numCounts; ++i)
+            fps[transport][i] = timeFrames(viz, *bricks, state, counts[i], 3);
+        viz.shutdown();
+    }
+
+    printf("%12s %14s %14s\n", "decorations", "shared fps", "pipe fps");
+    for (int i=0; i < numCounts; ++i)
+        printf("%12d %14.1f %14.1f\n", counts[i], fps[0][i], fps[1][i]);
+  } catch (const std::exception& e) {
+    printf("EXCEPTION THROWN: %s\n", e.what());
+    return 1;
+  }
+    return 0;
+}